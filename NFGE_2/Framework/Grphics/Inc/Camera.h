@@ -47,6 +47,9 @@ namespace NFGE::Graphics {
 		Math::Matrix4 GetPerspectiveMatrix(float aspectRatio = 0.0f) const;
 		Math::Matrix4 GetOrthographicMatrix(float width, float height) const;
 
+		// World space frustum of the perspective projection, for culling
+		Math::Frustum GetFrustum(float aspectRatio = 0.0f) const { return Math::Frustum(GetViewMatrix() * GetPerspectiveMatrix(aspectRatio)); }
+
 	private:
 		Math::Vector3 mPosition{ 0.0f };
 		Math::Vector3 mDirection{ 0.0f, 0.0f, 1.0f };
@@ -0,0 +1,77 @@
+//====================================================================================================
+// Filename:	BVH.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Static bounding volume hierarchy built with binned SAH. Nodes live in one flat array
+//				with siblings stored next to each other, so an interior node only needs the index of
+//				its left child. Primitives are either boxes (one per object) or triangles.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	class BVH
+	{
+	public:
+		static constexpr uint32_t kMaxLeafSize = 4;
+		static constexpr uint32_t kMaxDepth = 64;
+
+		struct Node // 32 bytes
+		{
+			AABB bounds;
+			uint32_t leftFirst = 0; // Interior: left child index, the right child is leftFirst + 1. Leaf: first primitive slot
+			uint32_t count = 0;		// Number of primitives in a leaf, 0 for interior nodes
+
+			bool IsLeaf() const { return count > 0; }
+		};
+
+		struct RayHit
+		{
+			uint32_t index = 0;			// Primitive index in the order it was passed to Build
+			float distance = FLT_MAX;	// Distance along ray.dir
+		};
+
+		// Object build, one box per primitive. Ray queries report the entry distance of the primitive box.
+		void Build(const AABB* bounds, size_t count);
+		void Build(const std::vector<AABB>& bounds) { Build(bounds.data(), bounds.size()); }
+
+		// Triangle build. The soup overload reads three consecutive vertices per triangle, the indexed
+		// overload reads three consecutive indices per triangle.
+		void Build(const Vector3* vertices, size_t triangleCount);
+		void Build(const Vector3* vertices, const uint32_t* indices, size_t triangleCount);
+
+		void Clear();
+
+		// Closest hit within [0, maxDistance]. A ray starting inside or on a primitive box hits it at distance
+		// 0, triangles are only hit in front of the origin, within (0, maxDistance]. Returns false and leaves
+		// hit untouched on a miss.
+		bool Raycast(const Ray& ray, RayHit& hit, float maxDistance = FLT_MAX) const;
+
+		// Any hit in the same range as Raycast, stops at the first one found. For line of sight checks.
+		bool RaycastAny(const Ray& ray, float maxDistance = FLT_MAX) const;
+
+		// Append the index of every primitive whose box overlaps the query. Sphere queries against a
+		// triangle build test the triangle itself.
+		void Query(const AABB& aabb, std::vector<uint32_t>& results) const;
+		void Query(const Sphere& sphere, std::vector<uint32_t>& results) const;
+
+		bool Empty() const { return mNodes.empty(); }
+		size_t GetPrimitiveCount() const { return mIndices.size(); }
+		const std::vector<Node>& GetNodes() const { return mNodes; }
+		AABB GetBounds() const { return mNodes.empty() ? AABB() : mNodes[0].bounds; }
+
+	private:
+		struct Triangle
+		{
+			Vector3 a, b, c;
+		};
+
+		void BuildNodes(const std::vector<AABB>& bounds);
+
+		std::vector<Node> mNodes;
+		std::vector<uint32_t> mIndices;		// Leaf slot to original primitive index
+		std::vector<AABB> mBoxes;			// Object build, in leaf slot order
+		std::vector<Triangle> mTriangles;	// Triangle build, in leaf slot order
+	};
+}
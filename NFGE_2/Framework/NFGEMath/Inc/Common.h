@@ -10,5 +10,12 @@
 #include <Core/Inc/Core.h>
 
 // Standard headers
+#include <atomic>
+#include <cfloat>
 #include <cmath>
+#include <cstring>
+#include <future>
+#include <limits>
 #include <numeric>
+#include <thread>
+#include <type_traits>
@@ -0,0 +1,132 @@
+//====================================================================================================
+// Filename:	Constexpr.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Compile-time versions of the functions whose runtime version calls the C library or the
+//				SIMD kernels, for building constant rotation tables and transforms. The math is done in
+//				double and rounded once, results match sinf/cosf/sqrtf to within 1 ulp.
+//				At runtime prefer the regular functions, these are slower.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math::Constexpr
+{
+	namespace Internal
+	{
+		constexpr double kPi = 3.14159265358979323846;
+		constexpr double kHalfPi = kPi * 0.5;
+		constexpr double kTwoPi = kPi * 2.0;
+
+		// Taylor series, |x| <= pi / 2 keeps the truncation error below 1e-15
+		constexpr double SinSeries(double x)
+		{
+			const double x2 = x * x;
+			double term = x;
+			double sum = x;
+			for (int i = 1; i <= 10; ++i)
+			{
+				term *= -x2 / ((2.0 * i) * (2.0 * i + 1.0));
+				sum += term;
+			}
+			return sum;
+		}
+
+		constexpr double Sin(double x)
+		{
+			const double turns = x / kTwoPi;
+			const long long n = static_cast<long long>(turns >= 0.0 ? turns + 0.5 : turns - 0.5);
+			x -= static_cast<double>(n) * kTwoPi;
+			if (x > kHalfPi)
+				x = kPi - x;
+			else if (x < -kHalfPi)
+				x = -kPi - x;
+			return SinSeries(x);
+		}
+	}
+
+	constexpr float Sin(float rad) { return static_cast<float>(Internal::Sin(rad)); }
+	constexpr float Cos(float rad) { return static_cast<float>(Internal::Sin(static_cast<double>(rad) + Internal::kHalfPi)); }
+
+	// Scales the value into [1, 4) by powers of 4, which halves its exponent exactly, so Newton's method
+	// starts close and converges in a few steps anywhere in the float range, denormals included
+	constexpr float Sqrt(float value)
+	{
+		if (!(value > 0.0f))
+			return value == 0.0f ? value : std::numeric_limits<float>::quiet_NaN();
+		if (value == std::numeric_limits<float>::infinity())
+			return value;
+
+		double m = value;
+		double scale = 1.0;
+		for (; m >= 4294967296.0; m *= 1.0 / 4294967296.0) scale *= 65536.0;
+		for (; m < 1.0 / 4294967296.0; m *= 4294967296.0) scale *= 1.0 / 65536.0;
+		for (; m >= 4.0; m *= 0.25) scale *= 2.0;
+		for (; m < 1.0; m *= 4.0) scale *= 0.5;
+
+		// Seeded above the root, the iterates fall monotonically until rounding stops them
+		double x = 0.5 * (1.0 + m);
+		for (;;)
+		{
+			const double next = 0.5 * (x + m / x);
+			if (next >= x)
+				break;
+			x = next;
+		}
+		return static_cast<float>(x * scale);
+	}
+
+	// Same result as Matrix4::operator* up to rounding
+	constexpr Matrix4 Multiply(const Matrix4& a, const Matrix4& b)
+	{
+		return Matrix4
+		(
+			a._11 * b._11 + a._12 * b._21 + a._13 * b._31 + a._14 * b._41,
+			a._11 * b._12 + a._12 * b._22 + a._13 * b._32 + a._14 * b._42,
+			a._11 * b._13 + a._12 * b._23 + a._13 * b._33 + a._14 * b._43,
+			a._11 * b._14 + a._12 * b._24 + a._13 * b._34 + a._14 * b._44,
+
+			a._21 * b._11 + a._22 * b._21 + a._23 * b._31 + a._24 * b._41,
+			a._21 * b._12 + a._22 * b._22 + a._23 * b._32 + a._24 * b._42,
+			a._21 * b._13 + a._22 * b._23 + a._23 * b._33 + a._24 * b._43,
+			a._21 * b._14 + a._22 * b._24 + a._23 * b._34 + a._24 * b._44,
+
+			a._31 * b._11 + a._32 * b._21 + a._33 * b._31 + a._34 * b._41,
+			a._31 * b._12 + a._32 * b._22 + a._33 * b._32 + a._34 * b._42,
+			a._31 * b._13 + a._32 * b._23 + a._33 * b._33 + a._34 * b._43,
+			a._31 * b._14 + a._32 * b._24 + a._33 * b._34 + a._34 * b._44,
+
+			a._41 * b._11 + a._42 * b._21 + a._43 * b._31 + a._44 * b._41,
+			a._41 * b._12 + a._42 * b._22 + a._43 * b._32 + a._44 * b._42,
+			a._41 * b._13 + a._42 * b._23 + a._43 * b._33 + a._44 * b._43,
+			a._41 * b._14 + a._42 * b._24 + a._43 * b._34 + a._44 * b._44
+		);
+	}
+
+	// Same layout as Matrix4::sRotationX/Y/Z
+	constexpr Matrix4 MatrixRotationX(float rad)
+	{
+		const float c = Cos(rad), s = Sin(rad);
+		return Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, c, s, 0.0f, 0.0f, -s, c, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	constexpr Matrix4 MatrixRotationY(float rad)
+	{
+		const float c = Cos(rad), s = Sin(rad);
+		return Matrix4(c, 0.0f, -s, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, s, 0.0f, c, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	constexpr Matrix4 MatrixRotationZ(float rad)
+	{
+		const float c = Cos(rad), s = Sin(rad);
+		return Matrix4(c, s, 0.0f, 0.0f, -s, c, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	// Same as NFGE::Math::QuaternionRotationAxis
+	constexpr Quaternion QuaternionRotationAxis(const Vector3& axis, float rad)
+	{
+		const Vector3 a = axis / Sqrt(Dot(axis, axis));
+		const float s = Sin(rad * 0.5f);
+		return Quaternion(a.x * s, a.y * s, a.z * s, Cos(rad * 0.5f));
+	}
+}
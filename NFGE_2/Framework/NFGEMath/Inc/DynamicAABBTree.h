@@ -0,0 +1,162 @@
+//====================================================================================================
+// Filename:	DynamicAABBTree.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Incrementally updated AABB tree for broadphase collision. Leaves hold fattened boxes so
+//				small movements do not touch the tree, and inserts/removes rebalance with rotations.
+//				Nodes live in a pooled array with a free list, proxies are node indices.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	class DynamicAABBTree
+	{
+	public:
+		static constexpr int32_t kNullNode = -1;
+		static constexpr int32_t kMaxStackSize = 128;
+		static constexpr int32_t kMaxImbalance = 4; // Child height difference above which a height rotation replaces the area rotation
+
+		struct Pair
+		{
+			int32_t proxyA; // proxyA < proxyB
+			int32_t proxyB;
+
+			bool operator==(const Pair& other) const { return proxyA == other.proxyA && proxyB == other.proxyB; }
+			bool operator<(const Pair& other) const { return proxyA < other.proxyA || (proxyA == other.proxyA && proxyB < other.proxyB); }
+		};
+
+		// margin is added to every side of a proxy box. Moves also stretch the box along the displacement
+		// scaled by displacementMultiplier, predicting where the object is going next.
+		explicit DynamicAABBTree(float margin = 0.1f, float displacementMultiplier = 2.0f);
+
+		int32_t CreateProxy(const AABB& aabb, uint32_t userData);
+		void DestroyProxy(int32_t proxyId);
+
+		// Returns true when the proxy left its fat box and was reinserted
+		bool MoveProxy(int32_t proxyId, const AABB& aabb, const Vector3& displacement = Vector3::Zero());
+
+		void Clear();
+
+		const AABB& GetFatAABB(int32_t proxyId) const;
+		uint32_t GetUserData(int32_t proxyId) const;
+		size_t GetProxyCount() const { return mProxyCount; }
+		int32_t GetHeight() const { return mRoot == kNullNode ? 0 : mNodes[mRoot].height; }
+
+		// Calls callback(proxyId) for every proxy whose fat box overlaps aabb. Return false from the
+		// callback to stop early.
+		template <typename Callback>
+		void Query(const AABB& aabb, Callback&& callback) const;
+		void Query(const AABB& aabb, std::vector<int32_t>& results) const;
+
+		// Broadphase update: every pair involving a proxy created or moved since the last call, sorted and
+		// without duplicates. Clears the move buffer.
+		void UpdatePairs(std::vector<Pair>& pairs);
+
+		// Checks parent links, heights and bounds. Debug builds assert on failure.
+		bool Validate() const;
+
+	private:
+		struct Node
+		{
+			AABB aabb;
+			uint32_t userData = 0;
+			int32_t parent = kNullNode; // Next free node while on the free list
+			int32_t child1 = kNullNode;
+			int32_t child2 = kNullNode;
+			int32_t height = -1;		// 0 for leaves, -1 for free nodes
+			bool moved = false;
+
+			bool IsLeaf() const { return child1 == kNullNode; }
+		};
+
+		int32_t AllocateNode();
+		void FreeNode(int32_t nodeId);
+		void InsertLeaf(int32_t leaf);
+		void RemoveLeaf(int32_t leaf);
+		int32_t Balance(int32_t nodeId, bool rotateForArea);
+		void RotateForArea(int32_t nodeId);
+		int32_t ValidateNode(int32_t nodeId) const;
+
+		// Traversal stack for Query. The fixed array covers balanced trees, deeper trees spill into the heap.
+		class NodeStack
+		{
+		public:
+			void Push(int32_t nodeId)
+			{
+				if (mSize < kMaxStackSize)
+				{
+					mFixed[mSize] = nodeId;
+				}
+				else
+				{
+					mSpill.push_back(nodeId);
+				}
+				++mSize;
+			}
+
+			int32_t Pop()
+			{
+				--mSize;
+				if (mSize < kMaxStackSize)
+				{
+					return mFixed[mSize];
+				}
+				const int32_t nodeId = mSpill.back();
+				mSpill.pop_back();
+				return nodeId;
+			}
+
+			bool IsEmpty() const { return mSize == 0; }
+
+		private:
+			int32_t mFixed[kMaxStackSize];
+			std::vector<int32_t> mSpill;
+			int32_t mSize = 0;
+		};
+
+		std::vector<Node> mNodes;
+		std::vector<int32_t> mMoveBuffer;
+		int32_t mRoot = kNullNode;
+		int32_t mFreeList = kNullNode;
+		size_t mProxyCount = 0;
+		float mMargin;
+		float mDisplacementMultiplier;
+	};
+
+	//----------------------------------------------------------------------------------------------------
+
+	template <typename Callback>
+	void DynamicAABBTree::Query(const AABB& aabb, Callback&& callback) const
+	{
+		if (mRoot == kNullNode)
+		{
+			return;
+		}
+
+		NodeStack stack;
+		stack.Push(mRoot);
+		while (!stack.IsEmpty())
+		{
+			const int32_t nodeId = stack.Pop();
+			const Node& node = mNodes[nodeId];
+			if (!Intersect(node.aabb, aabb))
+			{
+				continue;
+			}
+			if (node.IsLeaf())
+			{
+				if (!callback(nodeId))
+				{
+					return;
+				}
+			}
+			else
+			{
+				stack.Push(node.child1);
+				stack.Push(node.child2);
+			}
+		}
+	}
+}
@@ -0,0 +1,122 @@
+//====================================================================================================
+// Filename:	FastMath.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Opt-in approximations of the libm functions used on hot paths. Nothing outside this
+//				namespace calls them, use Fast:: explicitly where the error bounds below are acceptable.
+//				The array overloads run 8 values per step with AVX2 and give the same bounds.
+// Resources:	Cephes sinf/cosf, https://www.netlib.org/cephes/
+//				Abramowitz and Stegun 4.4.46 (acos)
+//====================================================================================================
+
+#pragma once
+
+#if NFGE_SIMD_X86
+#include <xmmintrin.h>
+#endif
+
+namespace NFGE::Math::Fast
+{
+	namespace Internal
+	{
+		// pi / 2 split so that q * kPiOver2A is exact for |q| < 2^16
+		constexpr float kPiOver2A = 1.5703125f;
+		constexpr float kPiOver2B = 4.8375129699707031e-4f;
+		constexpr float kPiOver2C = 7.5497899548918821e-8f;
+		constexpr float kTwoOverPi = 0.63661977236758134f;
+
+		constexpr float kSin[3] = { -1.6666654611e-1f, 8.3321608736e-3f, -1.9515295891e-4f };
+		constexpr float kCos[3] = { 4.166664568298827e-2f, -1.388731625493765e-3f, 2.443315711809948e-5f };
+		constexpr float kAtan[6] = { 0.99997726f, -0.33262347f, 0.19354346f, -0.11643287f, 0.05265332f, -0.01172120f };
+		constexpr float kAcos[8] = { 1.5707963050f, -0.2145988016f, 0.0889789874f, -0.0501743046f, 0.0308918810f, -0.0170881256f, 0.0066700901f, -0.0012624911f };
+	}
+
+	// 1 / sqrt(x) for x > 0, relative error below 3e-7
+	inline float RSqrt(float x)
+	{
+#if NFGE_SIMD_X86
+		const float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+		return y * (1.5f - 0.5f * x * y * y);
+#else
+		return 1.0f / sqrtf(x);
+#endif
+	}
+
+	// Components within 4e-7 of the exact unit vector. Zero length gives NaN, as Normalize does.
+	inline Vector2 Normalize(const Vector2& v) { return v * RSqrt(MagnitudeSqr(v)); }
+	inline Vector3 Normalize(const Vector3& v) { return v * RSqrt(MagnitudeSqr(v)); }
+	inline Quaternion Normalize(const Quaternion& q) { return q * RSqrt((q.x * q.x) + (q.y * q.y) + (q.z * q.z) + (q.w * q.w)); }
+
+	// Absolute error below 1.2e-7 for |rad| < 8192, the reduction loses accuracy past that
+	inline void SinCos(float rad, float& sinOut, float& cosOut)
+	{
+		using namespace Internal;
+
+		// Adding 1.5 * 2^23 rounds to the nearest quadrant and leaves it in the low mantissa bits
+		constexpr float kRound = 12582912.0f;
+		const float biased = rad * kTwoOverPi + kRound;
+		uint32_t q;
+		std::memcpy(&q, &biased, sizeof(q));
+		const float qf = biased - kRound;
+
+		const float x = ((rad - qf * kPiOver2A) - qf * kPiOver2B) - qf * kPiOver2C;
+		const float z = x * x;
+		const float s = x + x * z * (kSin[0] + z * (kSin[1] + z * kSin[2]));
+		const float c = 1.0f - 0.5f * z + z * z * (kCos[0] + z * (kCos[1] + z * kCos[2]));
+
+		// Odd quadrants swap sin and cos, then the signs follow the quadrant. Done on the bits because the
+		// quadrant is unpredictable for arbitrary input and branches cost more than the polynomials.
+		uint32_t sBits, cBits;
+		std::memcpy(&sBits, &s, sizeof(sBits));
+		std::memcpy(&cBits, &c, sizeof(cBits));
+		const uint32_t swap = 0u - (q & 1u);
+		const uint32_t sinBits = ((sBits & ~swap) | (cBits & swap)) ^ ((q & 2u) << 30);
+		const uint32_t cosBits = ((cBits & ~swap) | (sBits & swap)) ^ (((q + 1u) & 2u) << 30);
+		std::memcpy(&sinOut, &sinBits, sizeof(sinOut));
+		std::memcpy(&cosOut, &cosBits, sizeof(cosOut));
+	}
+
+	inline float Sin(float rad) { float s, c; SinCos(rad, s, c); return s; }
+	inline float Cos(float rad) { float s, c; SinCos(rad, s, c); return c; }
+
+	// Absolute error below 2e-6 rad over the whole range, Atan2(0, 0) is 0
+	inline float Atan2(float y, float x)
+	{
+		using namespace Internal;
+		const float ax = Abs(x), ay = Abs(y);
+		const float mx = Max(ax, ay), mn = Min(ax, ay);
+		const float a = mx > 0.0f ? mn / mx : 0.0f;
+		const float s = a * a;
+		float r = a * (kAtan[0] + s * (kAtan[1] + s * (kAtan[2] + s * (kAtan[3] + s * (kAtan[4] + s * kAtan[5])))));
+		r = ay > ax ? Constants::Pi * 0.5f - r : r;
+		r = x < 0.0f ? Constants::Pi - r : r;
+		return y < 0.0f ? -r : r;
+	}
+
+	inline float Atan(float x) { return Atan2(x, 1.0f); }
+
+	// Absolute error below 5e-7 rad for x in [-1, 1], input outside is clamped
+	inline float Acos(float x)
+	{
+		using namespace Internal;
+		x = Clamp(x, -1.0f, 1.0f);
+		const float a = Abs(x);
+		const float p = kAcos[0] + a * (kAcos[1] + a * (kAcos[2] + a * (kAcos[3] + a * (kAcos[4] + a * (kAcos[5] + a * (kAcos[6] + a * kAcos[7]))))));
+		const float r = sqrtf(1.0f - a) * p;
+		return x < 0.0f ? Constants::Pi - r : r;
+	}
+
+	inline float Asin(float x) { return Constants::Pi * 0.5f - Acos(x); }
+
+	// Fast versions of the hot functions, same conventions as the originals
+	Quaternion ToQuaternion(float pitch, float yaw, float roll); // Quaternion::ToQuaternion
+	Vector3 GetEular(const Quaternion& quaternion);
+	Matrix4 MatrixRotation(float xDegrees, float yDegrees, float zDegrees); // Matrix4::Rotation
+	Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t); // SlerpBatch's polynomial, see QuaternionBatch.h
+
+	// Array versions. out may alias the input.
+	void SinCos(const float* rad, float* sinOut, float* cosOut, size_t count);
+	void Atan2(const float* y, const float* x, float* out, size_t count);
+	void Acos(const float* x, float* out, size_t count);
+	void Normalize(const Vector3* in, Vector3* out, size_t count);
+}
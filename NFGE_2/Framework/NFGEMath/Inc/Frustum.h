@@ -0,0 +1,45 @@
+//====================================================================================================
+// Filename:	Frustum.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	View frustum as six planes extracted from a view-projection matrix, plus batched culling
+//				of boxes and spheres stored as separate component arrays. Visibility is conservative:
+//				an object is culled only when it lies fully outside one of the planes.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	struct Frustum
+	{
+		enum PlaneIndex { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+		// Normals are unit length and point inward, a point p is inside a plane when Dot(n, p) >= d
+		std::array<Plane, PlaneCount> planes;
+
+		Frustum() = default;
+		explicit Frustum(const Matrix4& viewProjection); // Row vector convention with D3D clip depth [0, 1]
+	};
+
+	bool Intersect(const Frustum& frustum, const Vector3& point);
+	bool Intersect(const Frustum& frustum, const AABB& aabb);
+	bool Intersect(const Frustum& frustum, const Sphere& sphere);
+
+	// Batched culling. Bit i % 32 of visibleMask[i / 32] is set when object i may be visible, the mask
+	// holds (count + 31) / 32 words and is fully overwritten.
+	//
+	// lastPlane is optional, one byte per object and initialised to 0. Each object's last rejecting plane
+	// is tested first and updated when a different plane rejects it, so objects that stay culled from frame
+	// to frame usually cost a single plane test.
+	void CullAABBs(const Frustum& frustum,
+		const float* centerX, const float* centerY, const float* centerZ,
+		const float* extendX, const float* extendY, const float* extendZ,
+		size_t count, uint32_t* visibleMask, uint8_t* lastPlane = nullptr);
+	void CullAABBs(const Frustum& frustum, const Vector3Stream& centers, const Vector3Stream& extends, uint32_t* visibleMask, uint8_t* lastPlane = nullptr);
+
+	void CullSpheres(const Frustum& frustum,
+		const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+		size_t count, uint32_t* visibleMask, uint8_t* lastPlane = nullptr);
+	void CullSpheres(const Frustum& frustum, const Vector3Stream& centers, const float* radius, uint32_t* visibleMask, uint8_t* lastPlane = nullptr);
+}
@@ -0,0 +1,73 @@
+//====================================================================================================
+// Filename:	GJK.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Narrow phase for convex shapes described by support functions. GJK finds the distance
+//				between two shapes, or that they overlap, and EPA then finds the penetration depth.
+//				Spheres and capsules run GJK on their center point or segment and subtract the radii,
+//				which is exact and keeps them out of EPA unless the cores themselves overlap. A
+//				GJKCache carries the final simplex of a pair to its next query.
+// Resources:	Gino van den Bergen, Collision Detection in Interactive 3D Environments, chapter 4
+//				Christer Ericson, Real-Time Collision Detection, 5.1.5 and 5.1.6 (closest points on
+//				triangles and tetrahedra)
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	// A convex shape as seen by GJK: a core shape with its support function, plus a radius around it
+	struct ConvexShape
+	{
+		enum class Type : uint8_t { Point, Segment, Box, Hull };
+
+		std::array<Vector3, 3> axis{ Vector3::XAxis, Vector3::YAxis, Vector3::ZAxis }; // Box and hull rotation, as in CachedOBB
+		Vector3 center;
+		Vector3 extend;							// Box half size, or half of the segment
+		const Vector3* points = nullptr;		// Hull points in local space, not owned
+		uint32_t pointCount = 0;
+		float radius = 0.0f;
+		Type type = Type::Point;
+
+		ConvexShape() = default;
+		explicit ConvexShape(const Vector3& point);
+		explicit ConvexShape(const Sphere& sphere);
+		explicit ConvexShape(const Capsule& capsule);
+		explicit ConvexShape(const AABB& aabb);
+		explicit ConvexShape(const OBB& obb);
+		explicit ConvexShape(const CachedOBB& obb);
+
+		// The convex hull of a point cloud, placed at position with orientation. The points are read on
+		// every query, so they have to outlive the shape. Support is a linear scan, keep hulls small.
+		ConvexShape(const Vector3* points, uint32_t count, const Vector3& position = Vector3::Zero(), const Quaternion& orientation = Quaternion::Identity());
+
+		// Furthest point of the core along direction, the radius is not included
+		Vector3 Support(const Vector3& direction) const;
+	};
+
+	struct ConvexContact
+	{
+		Vector3 pointA;			// Closest points when apart, deepest points when overlapping
+		Vector3 pointB;
+		Vector3 normal;			// Unit, from A towards B. Moving B by -distance * normal makes overlapping shapes touch.
+		float distance;			// Negative when the shapes overlap, then it is the penetration depth
+		uint32_t iterations;	// GJK iterations after the warm start
+		uint32_t epaIterations;	// Points EPA added, 0 unless the cores overlap
+	};
+
+	// Per pair warm start: the search directions of the last query's final simplex. The next query
+	// rebuilds its first simplex from them on the moved shapes, so a pair that moved a little starts next
+	// to the answer and usually converges in one or two iterations. Value initialised is empty.
+	struct GJKCache
+	{
+		std::array<Vector3, 4> directions;
+		uint32_t count = 0;
+	};
+
+	// Overlap only, stops as soon as a separating plane is found. Touching counts as overlapping.
+	bool Intersect(const ConvexShape& a, const ConvexShape& b, GJKCache* cache = nullptr);
+
+	// Distance and closest points, or penetration depth and deepest points when the shapes overlap.
+	// Returns true when they overlap. Distances are accurate to about 1e-5 of the shapes' size.
+	bool GetContact(const ConvexShape& a, const ConvexShape& b, ConvexContact& contact, GJKCache* cache = nullptr);
+}
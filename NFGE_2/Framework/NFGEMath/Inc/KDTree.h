@@ -0,0 +1,61 @@
+//====================================================================================================
+// Filename:	KDTree.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Static k-d tree over a point cloud for nearest neighbour and radius queries. The tree is
+//				implicit: the points are reordered so every range [first, first + count) splits at its
+//				middle element, and the children are the halves on either side of it. Only the split
+//				axis is stored per node, there are no child links and no per node allocations.
+// Resources:	Jon Louis Bentley, Multidimensional binary search trees used for associative searching
+//				Sunil Arya and David Mount, Algorithms for fast vector quantization (incremental distance)
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	class KDTree
+	{
+	public:
+		static constexpr uint32_t kMaxLeafSize = 8;		// Ranges this small are scanned instead of split
+		static constexpr uint32_t kMaxNeighbors = 64;	// Largest k for FindNearest, the heap lives on the stack
+		static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+		// Indices reported by queries are positions in this array. Large clouds build on several threads.
+		void Build(const Vector3* points, size_t count);
+		void Build(const std::vector<Vector3>& points) { Build(points.data(), points.size()); }
+		void Clear();
+
+		// Closest point within maxDistance. Returns kInvalidIndex when there is none.
+		uint32_t FindNearest(const Vector3& point, float maxDistance = FLT_MAX, float* distanceSqr = nullptr) const;
+
+		// Up to k closest points within maxDistance, nearest first. Returns how many were found, the rest of
+		// indices and distancesSqr is left untouched. distancesSqr may be null.
+		uint32_t FindNearest(const Vector3& point, uint32_t k, uint32_t* indices, float* distancesSqr, float maxDistance = FLT_MAX) const;
+
+		// Every point within radius, in no particular order. Writes at most capacity of them and returns how
+		// many there are, so a return value above capacity means the buffers were too small. distancesSqr
+		// may be null.
+		size_t FindInRadius(const Vector3& point, float radius, uint32_t* indices, float* distancesSqr, size_t capacity) const;
+		void FindInRadius(const Vector3& point, float radius, std::vector<uint32_t>& results) const;
+
+		// Batch versions split across threads. Query i writes k entries from indices + i * k, padded with
+		// kInvalidIndex and FLT_MAX when fewer than k points are in range.
+		void FindNearest(const Vector3* points, size_t count, uint32_t k, uint32_t* indices, float* distancesSqr, float maxDistance = FLT_MAX) const;
+
+		// Query i writes up to maxPerQuery indices from indices + i * maxPerQuery and stores the number of
+		// points in range, which can be larger than maxPerQuery, in counts[i].
+		void FindInRadius(const Vector3* points, size_t count, float radius, uint32_t maxPerQuery, uint32_t* indices, uint32_t* counts) const;
+
+		bool Empty() const { return mPoints.empty(); }
+		size_t GetPointCount() const { return mPoints.size(); }
+
+	private:
+		template <typename Visit>
+		void Traverse(const Vector3& point, float boundSqr, Visit&& visit) const;
+
+		std::vector<Vector3> mPoints;	// In tree order
+		std::vector<uint32_t> mIndices;	// Tree order to the index passed to Build
+		std::vector<uint8_t> mAxes;		// Split axis of the range whose middle element is at this position
+	};
+}
@@ -0,0 +1,167 @@
+//====================================================================================================
+// Filename:	Matrix3x4.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Affine transform in 48 bytes for instance buffers and bone palettes, where a Matrix4's
+//				last column is always (0, 0, 0, 1). The layout is the one QuaternionToMatrix3x4Batch and
+//				ToMatrix3x4 already write: three rows of 4 floats, each holding one column of the Matrix4
+//				3x3 part with the translation in its 4th float. That is a row major HLSL float3x4 used as
+//				mul(m, float4(p, 1)), so arrays of them copy straight into constant and structured buffers
+//				(48 bytes is a multiple of 16, no padding between elements in either).
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	// _rc is row r, column c of the column vector form, x' = _11 * x + _12 * y + _13 * z + _14. Mind that
+	// this is the transpose of Matrix4's subscripts: Matrix3x4 _12 is Matrix4 _21 and _14 is _41.
+	struct Matrix3x4
+	{
+		float _11, _12, _13, _14;
+		float _21, _22, _23, _24;
+		float _31, _32, _33, _34;
+
+		Matrix3x4() = default;
+		constexpr Matrix3x4(
+			float _11, float _12, float _13, float _14,
+			float _21, float _22, float _23, float _24,
+			float _31, float _32, float _33, float _34) noexcept
+			: _11(_11), _12(_12), _13(_13), _14(_14)
+			, _21(_21), _22(_22), _23(_23), _24(_24)
+			, _31(_31), _32(_32), _33(_33), _34(_34)
+		{}
+
+		static constexpr Matrix3x4 Identity() { return Matrix3x4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f); }
+		static constexpr Matrix3x4 Translation(const Vector3& t) { return Matrix3x4(1.0f, 0.0f, 0.0f, t.x, 0.0f, 1.0f, 0.0f, t.y, 0.0f, 0.0f, 1.0f, t.z); }
+		static constexpr Matrix3x4 Scaling(const Vector3& s) { return Matrix3x4(s.x, 0.0f, 0.0f, 0.0f, 0.0f, s.y, 0.0f, 0.0f, 0.0f, 0.0f, s.z, 0.0f); }
+
+		constexpr Vector3 GetTranslation() const { return Vector3(_14, _24, _34); }
+
+		constexpr bool operator==(const Matrix3x4& other) const
+		{
+			return _11 == other._11 && _12 == other._12 && _13 == other._13 && _14 == other._14 &&
+				_21 == other._21 && _22 == other._22 && _23 == other._23 && _24 == other._24 &&
+				_31 == other._31 && _32 == other._32 && _33 == other._33 && _34 == other._34;
+		}
+		constexpr bool operator!=(const Matrix3x4& other) const { return !(*this == other); }
+
+		// Same order as Matrix4: a * b applies a first, then b, so a world transform is local * parent
+		constexpr Matrix3x4 operator*(const Matrix3x4& b) const
+		{
+			return Matrix3x4
+			(
+				b._11 * _11 + b._12 * _21 + b._13 * _31,
+				b._11 * _12 + b._12 * _22 + b._13 * _32,
+				b._11 * _13 + b._12 * _23 + b._13 * _33,
+				b._11 * _14 + b._12 * _24 + b._13 * _34 + b._14,
+
+				b._21 * _11 + b._22 * _21 + b._23 * _31,
+				b._21 * _12 + b._22 * _22 + b._23 * _32,
+				b._21 * _13 + b._22 * _23 + b._23 * _33,
+				b._21 * _14 + b._22 * _24 + b._23 * _34 + b._24,
+
+				b._31 * _11 + b._32 * _21 + b._33 * _31,
+				b._31 * _12 + b._32 * _22 + b._33 * _32,
+				b._31 * _13 + b._32 * _23 + b._33 * _33,
+				b._31 * _14 + b._32 * _24 + b._33 * _34 + b._34
+			);
+		}
+		constexpr Matrix3x4& operator*=(const Matrix3x4& b) { return *this = *this * b; }
+	};
+
+	// Drops the last column, lossless when it is (0, 0, 0, 1)
+	constexpr Matrix3x4 ToMatrix3x4(const Matrix4& m)
+	{
+		return Matrix3x4
+		(
+			m._11, m._21, m._31, m._41,
+			m._12, m._22, m._32, m._42,
+			m._13, m._23, m._33, m._43
+		);
+	}
+
+	constexpr Matrix4 ToMatrix4(const Matrix3x4& m)
+	{
+		return Matrix4
+		(
+			m._11, m._21, m._31, 0.0f,
+			m._12, m._22, m._32, 0.0f,
+			m._13, m._23, m._33, 0.0f,
+			m._14, m._24, m._34, 1.0f
+		);
+	}
+
+	constexpr Vector3 TransformCoord(const Vector3& v, const Matrix3x4& m)
+	{
+		return Vector3
+		(
+			m._11 * v.x + m._12 * v.y + m._13 * v.z + m._14,
+			m._21 * v.x + m._22 * v.y + m._23 * v.z + m._24,
+			m._31 * v.x + m._32 * v.y + m._33 * v.z + m._34
+		);
+	}
+
+	// Translation is ignored, like the Matrix4 overload. Surface normals under non-uniform scale need the
+	// matrix from NormalMatrix instead.
+	constexpr Vector3 TransformNormal(const Vector3& v, const Matrix3x4& m)
+	{
+		return Vector3
+		(
+			m._11 * v.x + m._12 * v.y + m._13 * v.z,
+			m._21 * v.x + m._22 * v.y + m._23 * v.z,
+			m._31 * v.x + m._32 * v.y + m._33 * v.z
+		);
+	}
+
+	// Of the 3x3 part
+	constexpr float Determinant(const Matrix3x4& m)
+	{
+		return m._11 * (m._22 * m._33 - m._23 * m._32) - m._12 * (m._21 * m._33 - m._23 * m._31) + m._13 * (m._21 * m._32 - m._22 * m._31);
+	}
+
+	// The inverse transpose of the 3x3 part scaled by |determinant|, with no translation. TransformNormal
+	// with it keeps surface normals perpendicular under any scale or shear, normalize the result. Cheaper
+	// than Inverse since there is no divide, and it stays finite for singular matrices.
+	constexpr Matrix3x4 NormalMatrix(const Matrix3x4& m)
+	{
+		const float s = Determinant(m) < 0.0f ? -1.0f : 1.0f;
+		return Matrix3x4
+		(
+			(m._22 * m._33 - m._23 * m._32) * s, (m._23 * m._31 - m._21 * m._33) * s, (m._21 * m._32 - m._22 * m._31) * s, 0.0f,
+			(m._13 * m._32 - m._12 * m._33) * s, (m._11 * m._33 - m._13 * m._31) * s, (m._12 * m._31 - m._11 * m._32) * s, 0.0f,
+			(m._12 * m._23 - m._13 * m._22) * s, (m._13 * m._21 - m._11 * m._23) * s, (m._11 * m._22 - m._12 * m._21) * s, 0.0f
+		);
+	}
+
+	// Affine inverse: inverts the 3x3 part and back-transforms the translation, same as InverseAffine
+	constexpr Matrix3x4 Inverse(const Matrix3x4& m)
+	{
+		const float c11 = m._22 * m._33 - m._23 * m._32;
+		const float c12 = m._23 * m._31 - m._21 * m._33;
+		const float c13 = m._21 * m._32 - m._22 * m._31;
+		const float invDet = 1.0f / (m._11 * c11 + m._12 * c12 + m._13 * c13);
+
+		const float i11 = c11 * invDet;
+		const float i12 = (m._13 * m._32 - m._12 * m._33) * invDet;
+		const float i13 = (m._12 * m._23 - m._13 * m._22) * invDet;
+		const float i21 = c12 * invDet;
+		const float i22 = (m._11 * m._33 - m._13 * m._31) * invDet;
+		const float i23 = (m._13 * m._21 - m._11 * m._23) * invDet;
+		const float i31 = c13 * invDet;
+		const float i32 = (m._12 * m._31 - m._11 * m._32) * invDet;
+		const float i33 = (m._11 * m._22 - m._12 * m._21) * invDet;
+
+		return Matrix3x4
+		(
+			i11, i12, i13, -(i11 * m._14 + i12 * m._24 + i13 * m._34),
+			i21, i22, i23, -(i21 * m._14 + i22 * m._24 + i23 * m._34),
+			i31, i32, i33, -(i31 * m._14 + i32 * m._24 + i33 * m._34)
+		);
+	}
+
+	// out[i] = local[i] * parent[i], or local[i] * parent for the shared parent overload. Two rows per
+	// step with AVX2, one with SSE4.1. out may alias either input.
+	void MultiplyBatch(const Matrix3x4* local, const Matrix3x4* parent, Matrix3x4* out, size_t count);
+	void MultiplyBatch(const Matrix3x4* local, const Matrix3x4& parent, Matrix3x4* out, size_t count);
+}
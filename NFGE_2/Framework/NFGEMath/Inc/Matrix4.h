@@ -6,12 +6,11 @@
 
 #pragma once
 
+#include "Vector4.h"
+
 namespace NFGE {
 	namespace Math {
 
-		struct Vector3;
-		struct Vector4;
-
 		struct Transform3D
 		{
 			float tX, tY, tZ;
@@ -25,22 +24,32 @@ namespace NFGE {
 				, shX(0.0f), shY(0.0f), shZ(0.0f)
 			{}
 		};
+		// Trivially copyable, and everything that does not call the C library or the SIMD kernels is constexpr
 		struct Matrix4
 		{
 			// copy operations
 			Matrix4() = default;
-			Matrix4(float _11, float _12, float _13, float _14,
+			constexpr Matrix4(float _11, float _12, float _13, float _14,
 				float _21, float _22, float _23, float _24,
 				float _31, float _32, float _33, float _34,
 				float _41, float _42, float _43, float _44
-			);
-			Matrix4(const Matrix4& other);
-			Matrix4& operator=(const Matrix4& other);
+			) noexcept
+				: _11(_11), _12(_12), _13(_13), _14(_14)
+				, _21(_21), _22(_22), _23(_23), _24(_24)
+				, _31(_31), _32(_32), _33(_33), _34(_34)
+				, _41(_41), _42(_42), _43(_43), _44(_44)
+			{}
 
 			// comparison
-			bool operator==(const Matrix4& other) const;
-			bool operator!=(const Matrix4& other) const;
-			bool IsIdentity() const;
+			constexpr bool operator==(const Matrix4& other) const
+			{
+				return _11 == other._11 && _12 == other._12 && _13 == other._13 && _14 == other._14 &&
+					_21 == other._21 && _22 == other._22 && _23 == other._23 && _24 == other._24 &&
+					_31 == other._31 && _32 == other._32 && _33 == other._33 && _34 == other._34 &&
+					_41 == other._41 && _42 == other._42 && _43 == other._43 && _44 == other._44;
+			}
+			constexpr bool operator!=(const Matrix4& other) const { return !(*this == other); }
+			constexpr bool IsIdentity() const { return *this == sIdentity(); }
 			bool IsZero() const;
 
 			// manipulators
@@ -71,36 +80,63 @@ namespace NFGE {
 			Matrix4& RotationZ(float angle);
 			Matrix4& Rotation(const Vector3& axis, float angle);
 
-			static Matrix4 sZero() { return Matrix4(); }
-			static Matrix4 sIdentity() { return Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
-			static Matrix4 sTranslation(float x, float y, float z) { return Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, x, y, z, 1.0f); }
-			static Matrix4 sTranslation(const Vector3& v);
+			static constexpr Matrix4 sZero() { return Matrix4(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f); }
+			static constexpr Matrix4 sIdentity() { return Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
+			static constexpr Matrix4 sTranslation(float x, float y, float z) { return Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, x, y, z, 1.0f); }
+			static constexpr Matrix4 sTranslation(const Vector3& v) { return sTranslation(v.x, v.y, v.z); }
 			static Matrix4 sRotationX(float rad) { return Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, cosf(rad), sinf(rad), 0.0f, 0.0f, -sinf(rad), cosf(rad), 0.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
 			static Matrix4 sRotationY(float rad) { return Matrix4(cosf(rad), 0.0f, -sinf(rad), 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, sinf(rad), 0.0f, cosf(rad), 0.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
 			static Matrix4 sRotationZ(float rad) { return Matrix4(cosf(rad), sinf(rad), 0.0f, 0.0f, -sinf(rad), cosf(rad), 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
-			static Matrix4 sScaling(float s) { return Matrix4(s, 0.0f, 0.0f, 0.0f, 0.0f, s, 0.0f, 0.0f, 0.0f, 0.0f, s, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
-			static Matrix4 sScaling(float sx, float sy, float sz) { return Matrix4(sx, 0.0f, 0.0f, 0.0f, 0.0f, sy, 0.0f, 0.0f, 0.0f, 0.0f, sz, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
-			static Matrix4 sScaling(const Vector3& s);
+			static constexpr Matrix4 sScaling(float s) { return Matrix4(s, 0.0f, 0.0f, 0.0f, 0.0f, s, 0.0f, 0.0f, 0.0f, 0.0f, s, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
+			static constexpr Matrix4 sScaling(float sx, float sy, float sz) { return Matrix4(sx, 0.0f, 0.0f, 0.0f, 0.0f, sy, 0.0f, 0.0f, 0.0f, 0.0f, sz, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
+			static constexpr Matrix4 sScaling(const Vector3& s) { return sScaling(s.x, s.y, s.z); }
 
 
 			// operators
 			// addition and subtraction
-			Matrix4 operator+(const Matrix4& other) const;
-			Matrix4& operator+=(const Matrix4& other);
-			Matrix4 operator-(const Matrix4& other) const;
-			Matrix4& operator-=(const Matrix4& other);
-
-			Matrix4 operator-() const;
-
-			// multiplication
+			constexpr Matrix4 operator+(const Matrix4& other) const
+			{
+				return Matrix4
+				(
+					_11 + other._11, _12 + other._12, _13 + other._13, _14 + other._14,
+					_21 + other._21, _22 + other._22, _23 + other._23, _24 + other._24,
+					_31 + other._31, _32 + other._32, _33 + other._33, _34 + other._34,
+					_41 + other._41, _42 + other._42, _43 + other._43, _44 + other._44
+				);
+			}
+			constexpr Matrix4& operator+=(const Matrix4& other) { return *this = *this + other; }
+			constexpr Matrix4 operator-(const Matrix4& other) const { return *this + -other; }
+			constexpr Matrix4& operator-=(const Matrix4& other) { return *this = *this - other; }
+
+			constexpr Matrix4 operator-() const { return *this * -1.0f; }
+
+			// multiplication, dispatched to the SIMD kernels. Constexpr::Multiply is the compile-time version.
 			Matrix4& operator*=(const Matrix4& matrix);
 			Matrix4 operator*(const Matrix4& matrix) const;
 
 			// column vector multiplier
-			Vector4 operator*(const Vector4& vector) const;
-
-			Matrix4& operator*=(float scalar);
-			Matrix4 operator*(float scalar) const;
+			constexpr Vector4 operator*(const Vector4& vector) const
+			{
+				return Vector4
+				(
+					_11 * vector.x + _12 * vector.y + _13 * vector.z + _14 * vector.w,
+					_21 * vector.x + _22 * vector.y + _23 * vector.z + _24 * vector.w,
+					_31 * vector.x + _32 * vector.y + _33 * vector.z + _34 * vector.w,
+					_41 * vector.x + _42 * vector.y + _43 * vector.z + _44 * vector.w
+				);
+			}
+
+			constexpr Matrix4& operator*=(float scalar) { return *this = *this * scalar; }
+			constexpr Matrix4 operator*(float scalar) const
+			{
+				return Matrix4
+				(
+					_11 * scalar, _12 * scalar, _13 * scalar, _14 * scalar,
+					_21 * scalar, _22 * scalar, _23 * scalar, _24 * scalar,
+					_31 * scalar, _32 * scalar, _33 * scalar, _34 * scalar,
+					_41 * scalar, _42 * scalar, _43 * scalar, _44 * scalar
+				);
+			}
 
 			// Member
 			union
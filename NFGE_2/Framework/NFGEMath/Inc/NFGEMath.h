@@ -15,19 +15,26 @@
 #include "Vector3.h"
 #include "Vector4.h"
 #include "Quaternion.h"
+#include "QuaternionBatch.h"
+#include "Random.h"
+#include "RayPacket.h"
+#include "SIMD.h"
+#include "SimplexNoise.h"
+#include "Stream.h"
+#include "TransformBatch.h"
 
 namespace NFGE {
 	namespace Math {
 
 
 		// Matrix4
-		Matrix4 Translation(float x, float y, float z);
-		Matrix4 Translation(const Vector3& v);
-		Matrix4 Transpose(const Matrix4& mat);  // Compute matrix transpose
+		constexpr Matrix4 Translation(float x, float y, float z);
+		constexpr Matrix4 Translation(const Vector3& v);
+		constexpr Matrix4 Transpose(const Matrix4& mat);  // Compute matrix transpose
 		Matrix4 Transform(Transform3D transformInfo, Vector3 toOrigin);
 		Vector3 operator*(const Vector3& vector, const Matrix4& matrix); // Convert vector3 to vector4 first then do calculation then convert back by wTo1
 		Vector4 operator*(const Vector4& vector, const Matrix4& matrix); // row vector multiplier
-		Matrix4 operator*(float scalar, const Matrix4& matrix);
+		constexpr Matrix4 operator*(float scalar, const Matrix4& matrix) { return matrix * scalar; }
 		Vector3 TransfromCoord(const Vector3& vector, const Matrix4& matrix);
 		Vector3 TransfromNormal(const Vector3& vector, const Matrix4& matrix);
 
@@ -40,13 +47,13 @@ namespace NFGE {
 			float _21, _22, _23;
 			float _31, _32, _33;
 
-			Matrix3()
+			constexpr Matrix3()
 				: _11(1.0f), _12(0.0f), _13(0.0f)
 				, _21(0.0f), _22(1.0f), _23(0.0f)
 				, _31(0.0f), _32(0.0f), _33(1.0f)
 			{}
 
-			Matrix3(
+			constexpr Matrix3(
 				float _11, float _12, float _13,
 				float _21, float _22, float _23,
 				float _31, float _32, float _33)
@@ -55,37 +62,37 @@ namespace NFGE {
 				, _31(_31), _32(_32), _33(_33)
 			{}
 
-			static Matrix3 Zero() { return Matrix3(); }
-			static Matrix3 Identity() { return Matrix3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
-			static Matrix3 Translation(float x, float y) { return Matrix3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, x, y, 1.0f); }
-			static Matrix3 Translation(const Vector2& v) { return Matrix3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, v.x, v.y, 1.0f); }
+			static constexpr Matrix3 Zero() { return Matrix3(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f); }
+			static constexpr Matrix3 Identity() { return Matrix3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f); }
+			static constexpr Matrix3 Translation(float x, float y) { return Matrix3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, x, y, 1.0f); }
+			static constexpr Matrix3 Translation(const Vector2& v) { return Matrix3(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, v.x, v.y, 1.0f); }
 			static Matrix3 Rotation(float rad) { return Matrix3(cosf(rad), sinf(rad), 0.0f, -sinf(rad), cosf(rad), 0.0f, 0.0f, 0.0f, 1.0f); }
-			static Matrix3 Scaling(float s) { return Matrix3(s, 0.0f, 0.0f, 0.0f, s, 0.0f, 0.0f, 0.0f, 1.0f); }
-			static Matrix3 Scaling(float sx, float sy) { return Matrix3(sx, 0.0f, 0.0f, 0.0f, sy, 0.0f, 0.0f, 0.0f, 1.0f); }
-			static Matrix3 Scaling(const Vector2& s) { return Matrix3(s.x, 0.0f, 0.0f, 0.0f, s.y, 0.0f, 0.0f, 0.0f, 1.0f); }
+			static constexpr Matrix3 Scaling(float s) { return Matrix3(s, 0.0f, 0.0f, 0.0f, s, 0.0f, 0.0f, 0.0f, 1.0f); }
+			static constexpr Matrix3 Scaling(float sx, float sy) { return Matrix3(sx, 0.0f, 0.0f, 0.0f, sy, 0.0f, 0.0f, 0.0f, 1.0f); }
+			static constexpr Matrix3 Scaling(const Vector2& s) { return Matrix3(s.x, 0.0f, 0.0f, 0.0f, s.y, 0.0f, 0.0f, 0.0f, 1.0f); }
 
-			Matrix3 operator-() const
+			constexpr Matrix3 operator-() const
 			{
 				return Matrix3(
 					-_11, -_12, -_13,
 					-_21, -_22, -_23,
 					-_31, -_32, -_33);
 			}
-			Matrix3 operator+(const Matrix3& rhs) const
+			constexpr Matrix3 operator+(const Matrix3& rhs) const
 			{
 				return Matrix3(
 					_11 + rhs._11, _12 + rhs._12, _13 + rhs._13,
 					_21 + rhs._21, _22 + rhs._22, _23 + rhs._23,
 					_31 + rhs._31, _32 + rhs._32, _33 + rhs._33);
 			}
-			Matrix3 operator-(const Matrix3& rhs) const
+			constexpr Matrix3 operator-(const Matrix3& rhs) const
 			{
 				return Matrix3(
 					_11 - rhs._11, _12 - rhs._12, _13 - rhs._13,
 					_21 - rhs._21, _22 - rhs._22, _23 - rhs._23,
 					_31 - rhs._31, _32 - rhs._32, _33 - rhs._33);
 			}
-			Matrix3 operator*(const Matrix3& rhs) const
+			constexpr Matrix3 operator*(const Matrix3& rhs) const
 			{
 				return Matrix3(
 					(_11 * rhs._11) + (_12 * rhs._21) + (_13 * rhs._31),
@@ -100,21 +107,21 @@ namespace NFGE {
 					(_31 * rhs._12) + (_32 * rhs._22) + (_33 * rhs._32),
 					(_31 * rhs._13) + (_32 * rhs._23) + (_33 * rhs._33));
 			}
-			Matrix3 operator*(float s) const
+			constexpr Matrix3 operator*(float s) const
 			{
 				return Matrix3(
 					_11 * s, _12 * s, _13 * s,
 					_21 * s, _22 * s, _23 * s,
 					_31 * s, _32 * s, _33 * s);
 			}
-			Matrix3 operator/(float s) const
+			constexpr Matrix3 operator/(float s) const
 			{
 				return Matrix3(
 					_11 / s, _12 / s, _13 / s,
 					_21 / s, _22 / s, _23 / s,
 					_31 / s, _32 / s, _33 / s);
 			}
-			Matrix3 operator+=(const Matrix3& rhs)
+			constexpr Matrix3& operator+=(const Matrix3& rhs)
 			{
 				_11 += rhs._11; _12 += rhs._12; _13 += rhs._13;
 				_21 += rhs._21; _22 += rhs._22; _23 += rhs._23;
@@ -173,6 +180,18 @@ namespace NFGE {
 			Sphere(float x, float y, float z, float radius) : center(x, y, z), radius(radius) {}
 			Sphere(const Vector3& center, float radius) : center(center), radius(radius) {}
 		};
+
+		// Capsule ---------------------------------------------------------------------------------------------------------------------------------
+		// Every point within radius of the segment from a to b
+		struct Capsule
+		{
+			Vector3 a;
+			Vector3 b;
+			float radius;
+
+			Capsule() : a(0.0f, -0.5f, 0.0f), b(0.0f, 0.5f, 0.0f), radius(0.5f) {}
+			Capsule(const Vector3& a, const Vector3& b, float radius) : a(a), b(b), radius(radius) {}
+		};
 		// AABB ---------------------------------------------------------------------------------------------------------------------------------
 
 		struct AABB
@@ -198,7 +217,7 @@ namespace NFGE {
 		{
 			Vector3 center;
 			Vector3 extend;
-			Quaternion orientation;
+			Quaternion orientation; // Expected to be unit length
 
 			OBB()
 				: center(0.0f, 0.0f, 0.0f)
@@ -225,6 +244,25 @@ namespace NFGE {
 			{}
 		};
 
+		// CachedOBB ---------------------------------------------------------------------------------------------------------------------------------
+		// OBB with its rotation basis precomputed for repeated queries against the same box. The axes are the
+		// rows of the local-to-world rotation, so world-to-local is a dot product with each axis.
+
+		struct CachedOBB
+		{
+			Vector3 center;
+			Vector3 extend;
+			std::array<Vector3, 3> axis;
+
+			CachedOBB() : center(0.0f, 0.0f, 0.0f), extend(1.0f, 1.0f, 1.0f), axis{ Vector3::XAxis, Vector3::YAxis, Vector3::ZAxis } {}
+			explicit CachedOBB(const OBB& obb);
+
+			Vector3 ToLocal(const Vector3& point) const;
+			Vector3 ToLocalDirection(const Vector3& dir) const;
+			Vector3 ToWorld(const Vector3& point) const;
+			Vector3 ToWorldDirection(const Vector3& dir) const;
+		};
+
 		//----------------------------------------------------------------------------------------------------
 
 		struct Ray
@@ -237,6 +275,25 @@ namespace NFGE {
 			Ray(const Vector3& org, const Vector3& dir) : org(org), dir(dir) {}
 		};
 
+		// Ray with the reciprocal direction and its signs precomputed, for testing one ray against many boxes.
+		// A sign is 1 where the reciprocal is not >= 0, matching the swap in Intersect(Ray, AABB).
+
+		struct CachedRay
+		{
+			Vector3 org;
+			Vector3 dir;
+			Vector3 invDir;
+			std::array<int, 3> sign;
+
+			CachedRay() : CachedRay(Ray()) {}
+			explicit CachedRay(const Ray& ray)
+				: org(ray.org)
+				, dir(ray.dir)
+				, invDir(1.0f / ray.dir.x, 1.0f / ray.dir.y, 1.0f / ray.dir.z)
+				, sign{ !(invDir.x >= 0.0f), !(invDir.y >= 0.0f), !(invDir.z >= 0.0f) }
+			{}
+		};
+
 		//----------------------------------------------------------------------------------------------------
 
 		struct Plane
@@ -250,29 +307,29 @@ namespace NFGE {
 
 
 		// Helper functuons -----------------------------------------------------------------------------------------------------
-		template <typename T> inline T Min(T a, T b) { return (a > b) ? b : a; }
-		template <typename T> inline T Max(T a, T b) { return (a < b) ? b : a; }
-		template <typename T> inline T Clamp(T value, T min, T max) { return Max(min, Min(max, value)); }
+		template <typename T> constexpr T Min(T a, T b) { return (a > b) ? b : a; }
+		template <typename T> constexpr T Max(T a, T b) { return (a < b) ? b : a; }
+		template <typename T> constexpr T Clamp(T value, T min, T max) { return Max(min, Min(max, value)); }
 
-		inline float Abs(float value) { return (value >= 0.0f) ? value : -value; }
-		inline float Sign(float value) { return (value >= 0.0f) ? 1.0f : -1.0f; }
-		inline float Sqr(float value) { return value * value; }
+		constexpr float Abs(float value) { return (value >= 0.0f) ? value : -value; }
+		constexpr float Sign(float value) { return (value >= 0.0f) ? 1.0f : -1.0f; }
+		constexpr float Sqr(float value) { return value * value; }
 		inline float Sqrt(float value) { return sqrtf(value); }
 
-		inline bool Compare(float a, float b, float epsilon = FLT_MIN) { return Abs(a - b) <= epsilon; }
+		constexpr bool Compare(float a, float b, float epsilon = FLT_MIN) { return Abs(a - b) <= epsilon; }
 		inline bool IsZero(const Vector2& v) { return IsZero(v.x) && IsZero(v.y); }
 		inline bool IsZero(const Vector3& v) { return IsZero(v.x) && IsZero(v.y) && IsZero(v.z); }
 		inline bool IsZero(const Vector4& v) { return IsZero(v.x) && IsZero(v.y) && IsZero(v.z) && IsZero(v.w); }
-		inline bool IsEmpty(const Rect& rect) { return rect.right <= rect.left || rect.bottom <= rect.top; }
+		constexpr bool IsEmpty(const Rect& rect) { return rect.right <= rect.left || rect.bottom <= rect.top; }
 
-		inline Vector2 PerpendicularLH(const Vector2& v) { return Vector2(-v.y, v.x); }
-		inline Vector2 PerpendicularRH(const Vector2& v) { return Vector2(v.y, -v.x); }
+		constexpr Vector2 PerpendicularLH(const Vector2& v) { return Vector2(-v.y, v.x); }
+		constexpr Vector2 PerpendicularRH(const Vector2& v) { return Vector2(v.y, -v.x); }
 
-		inline float MagnitudeSqr(const Vector2& v) { return (v.x * v.x) + (v.y * v.y); }
-		inline float MagnitudeSqr(const Vector3& v) { return (v.x * v.x) + (v.y * v.y) + (v.z * v.z); }
+		constexpr float MagnitudeSqr(const Vector2& v) { return (v.x * v.x) + (v.y * v.y); }
+		constexpr float MagnitudeSqr(const Vector3& v) { return (v.x * v.x) + (v.y * v.y) + (v.z * v.z); }
 		inline float Magnitude(const Vector2& v) { return Sqrt(MagnitudeSqr(v)); }
 		inline float Magnitude(const Vector3& v) { return Sqrt(MagnitudeSqr(v)); }
-		inline float MagnitudeXZSqr(const Vector3& v) { return (v.x * v.x) + (v.z * v.z); }
+		constexpr float MagnitudeXZSqr(const Vector3& v) { return (v.x * v.x) + (v.z * v.z); }
 		inline float MagnitudeXZ(const Vector3& v) { return Sqrt(MagnitudeXZSqr(v)); }
 		inline float Magnitude(const Quaternion& q) { return Sqrt((q.x * q.x) + (q.y * q.y) + (q.z * q.z) + (q.w * q.w)); }
 
@@ -280,31 +337,31 @@ namespace NFGE {
 		inline Vector3 Normalize(const Vector3& v) { return v / Magnitude(v); }
 		inline Quaternion Normalize(const Quaternion& q) { return q / Magnitude(q); }
 
-		inline float DistanceSqr(const Vector2& a, const Vector2& b) { return MagnitudeSqr(a - b); }
-		inline float DistanceSqr(const Vector3& a, const Vector3& b) { return MagnitudeSqr(a - b); }
+		constexpr float DistanceSqr(const Vector2& a, const Vector2& b) { return MagnitudeSqr(a - b); }
+		constexpr float DistanceSqr(const Vector3& a, const Vector3& b) { return MagnitudeSqr(a - b); }
 		inline float Distance(const Vector2& a, const Vector2& b) { return Sqrt(DistanceSqr(a, b)); }
 		inline float Distance(const Vector3& a, const Vector3& b) { return Sqrt(DistanceSqr(a, b)); }
-		inline float DistanceXZSqr(const Vector3& a, const Vector3& b) { return MagnitudeXZSqr(a - b); }
+		constexpr float DistanceXZSqr(const Vector3& a, const Vector3& b) { return MagnitudeXZSqr(a - b); }
 		inline float DistanceXZ(const Vector3& a, const Vector3& b) { return Sqrt(DistanceXZSqr(a, b)); }
-		inline float Dot(const Vector2& a, const Vector2& b) { return (a.x * b.x) + (a.y * b.y); }
-		inline float Dot(const Vector3& a, const Vector3& b) { return (a.x * b.x) + (a.y * b.y) + (a.z * b.z); }
-		inline Vector3 Cross(const Vector3& a, const Vector3& b) { return Vector3((a.y * b.z) - (a.z * b.y), (a.z * b.x) - (a.x * b.z), (a.x * b.y) - (a.y * b.x)); }
-		inline Vector2 Project(const Vector2& v, const Vector2& n) { return n * (Dot(v, n) / Dot(n, n)); }
-		inline Vector3 Project(const Vector3& v, const Vector3& n) { return n * (Dot(v, n) / Dot(n, n)); }
-		inline Vector2 Reflect(const Vector2& v, const Vector2& normal) { return v - (normal * Dot(v, normal) * 2.0f); }
-		inline Vector3 Reflect(const Vector3& v, const Vector3& normal) { return v - (normal * Dot(v, normal) * 2.0f); }
-		Vector3 Mean(const Vector3* v, uint32_t count);
-
-		inline Vector3 GetTranslation(const Matrix4& m) { return Vector3(m._41, m._42, m._43); }
-		inline Vector3 GetRight(const Matrix4& m) { return Vector3(m._11, m._12, m._13); }
-		inline Vector3 GetUp(const Matrix4& m) { return Vector3(m._21, m._22, m._23); }
-		inline Vector3 GetForward(const Matrix4& m) { return Vector3(m._31, m._32, m._33); }
-
-		inline float Lerp(float v0, float v1, float t) { return v0 + ((v1 - v0) * t); }
-		inline Vector2 Lerp(const Vector2& v0, const Vector2& v1, float t) { return v0 + ((v1 - v0) * t); }
-		inline Vector3 Lerp(const Vector3& v0, const Vector3& v1, float t) { return v0 + ((v1 - v0) * t); }
-		inline Vector4 Lerp(const Vector4& v0, const Vector4& v1, float t) { return v0 + ((v1 - v0) * t); }
-		inline Quaternion Lerp(Quaternion q0, Quaternion q1, float t) { return q0 * (1.0f - t) + (q1 * t); }
+		constexpr float Dot(const Vector2& a, const Vector2& b) { return (a.x * b.x) + (a.y * b.y); }
+		constexpr float Dot(const Vector3& a, const Vector3& b) { return (a.x * b.x) + (a.y * b.y) + (a.z * b.z); }
+		constexpr Vector3 Cross(const Vector3& a, const Vector3& b) { return Vector3((a.y * b.z) - (a.z * b.y), (a.z * b.x) - (a.x * b.z), (a.x * b.y) - (a.y * b.x)); }
+		constexpr Vector2 Project(const Vector2& v, const Vector2& n) { return n * (Dot(v, n) / Dot(n, n)); }
+		constexpr Vector3 Project(const Vector3& v, const Vector3& n) { return n * (Dot(v, n) / Dot(n, n)); }
+		constexpr Vector2 Reflect(const Vector2& v, const Vector2& normal) { return v - (normal * Dot(v, normal) * 2.0f); }
+		constexpr Vector3 Reflect(const Vector3& v, const Vector3& normal) { return v - (normal * Dot(v, normal) * 2.0f); }
+		Vector3 Mean(const Vector3* v, uint32_t count); // Pairwise SIMD sum, see PointCloud.h
+
+		constexpr Vector3 GetTranslation(const Matrix4& m) { return Vector3(m._41, m._42, m._43); }
+		constexpr Vector3 GetRight(const Matrix4& m) { return Vector3(m._11, m._12, m._13); }
+		constexpr Vector3 GetUp(const Matrix4& m) { return Vector3(m._21, m._22, m._23); }
+		constexpr Vector3 GetForward(const Matrix4& m) { return Vector3(m._31, m._32, m._33); }
+
+		constexpr float Lerp(float v0, float v1, float t) { return v0 + ((v1 - v0) * t); }
+		constexpr Vector2 Lerp(const Vector2& v0, const Vector2& v1, float t) { return v0 + ((v1 - v0) * t); }
+		constexpr Vector3 Lerp(const Vector3& v0, const Vector3& v1, float t) { return v0 + ((v1 - v0) * t); }
+		constexpr Vector4 Lerp(const Vector4& v0, const Vector4& v1, float t) { return v0 + ((v1 - v0) * t); }
+		constexpr Quaternion Lerp(Quaternion q0, Quaternion q1, float t) { return q0 * (1.0f - t) + (q1 * t); }
 
 		inline Vector2 Rotate(const Vector2& v, float rad)
 		{
@@ -316,7 +373,7 @@ namespace NFGE {
 				v.y * kCosAngle + v.x * kSinAngle
 			);
 		}
-		inline float Determinant(const Matrix3& m)
+		constexpr float Determinant(const Matrix3& m)
 		{
 			float det = 0.0f;
 			det = (m._11 * (m._22 * m._33 - m._23 * m._32));
@@ -325,7 +382,7 @@ namespace NFGE {
 			return det;
 		}
 
-		inline float Determinant(const Matrix4& m)
+		constexpr float Determinant(const Matrix4& m)
 		{
 			float det = 0.0f;
 			det = (m._11 * (m._22 * (m._33 * m._44 - (m._43 * m._34)) - m._23 * (m._32 * m._44 - (m._42 * m._34)) + m._24 * (m._32 * m._43 - (m._42 * m._33))));
@@ -335,7 +392,7 @@ namespace NFGE {
 			return det;
 		}
 
-		inline Matrix3 Adjoint(const Matrix3& m)
+		constexpr Matrix3 Adjoint(const Matrix3& m)
 		{
 			return Matrix3
 			(
@@ -353,7 +410,7 @@ namespace NFGE {
 			);
 		}
 
-		inline Matrix4 Adjoint(const Matrix4& m)
+		constexpr Matrix4 Adjoint(const Matrix4& m)
 		{
 			return Matrix4
 			(
@@ -380,7 +437,7 @@ namespace NFGE {
 		}
 
 
-		inline Matrix3 Inverse(const Matrix3& m)
+		constexpr Matrix3 Inverse(const Matrix3& m)
 		{
 			const float determinant = Determinant(m);
 			const float invDet = 1.0f / determinant;
@@ -388,24 +445,105 @@ namespace NFGE {
 		}
 
 
-		inline Matrix4 Inverse(const Matrix4& m)
+		constexpr Matrix4 Inverse(const Matrix4& m)
 		{
 			const float determinant = Determinant(m);
 			const float invDet = 1.0f / determinant;
 			return Adjoint(m) * invDet;
 		}
 
-		inline Matrix4 Translation(float x, float y, float z)
+		// Inverse of a matrix whose last column is (0, 0, 0, 1): inverts the 3x3 part and back-transforms the translation
+		constexpr Matrix4 InverseAffine(const Matrix4& m)
+		{
+			const float c11 = m._22 * m._33 - m._23 * m._32;
+			const float c12 = m._23 * m._31 - m._21 * m._33;
+			const float c13 = m._21 * m._32 - m._22 * m._31;
+			const float invDet = 1.0f / (m._11 * c11 + m._12 * c12 + m._13 * c13);
+
+			const float i11 = c11 * invDet;
+			const float i12 = (m._13 * m._32 - m._12 * m._33) * invDet;
+			const float i13 = (m._12 * m._23 - m._13 * m._22) * invDet;
+			const float i21 = c12 * invDet;
+			const float i22 = (m._11 * m._33 - m._13 * m._31) * invDet;
+			const float i23 = (m._13 * m._21 - m._11 * m._23) * invDet;
+			const float i31 = c13 * invDet;
+			const float i32 = (m._12 * m._31 - m._11 * m._32) * invDet;
+			const float i33 = (m._11 * m._22 - m._12 * m._21) * invDet;
+
+			return Matrix4
+			(
+				i11, i12, i13, 0.0f,
+				i21, i22, i23, 0.0f,
+				i31, i32, i33, 0.0f,
+				-(m._41 * i11 + m._42 * i21 + m._43 * i31),
+				-(m._41 * i12 + m._42 * i22 + m._43 * i32),
+				-(m._41 * i13 + m._42 * i23 + m._43 * i33),
+				1.0f
+			);
+		}
+
+		// Inverse of a rotation * translation matrix (orthonormal 3x3 part, no scale): transpose the rotation
+		constexpr Matrix4 InverseOrthonormal(const Matrix4& m)
+		{
+			return Matrix4
+			(
+				m._11, m._21, m._31, 0.0f,
+				m._12, m._22, m._32, 0.0f,
+				m._13, m._23, m._33, 0.0f,
+				-(m._41 * m._11 + m._42 * m._12 + m._43 * m._13),
+				-(m._41 * m._21 + m._42 * m._22 + m._43 * m._23),
+				-(m._41 * m._31 + m._42 * m._32 + m._43 * m._33),
+				1.0f
+			);
+		}
+
+		// TaggedMatrix4 ----------------------------------------------------------------------------------------------------
+		// Remembers how a matrix was built so Inverse can take the cheapest correct path
+
+		enum class MatrixKind
+		{
+			Rigid,		// Rotation and translation only
+			Affine,		// Any 3x3 part plus translation, last column (0, 0, 0, 1)
+			General
+		};
+
+		struct TaggedMatrix4
+		{
+			Matrix4 matrix;
+			MatrixKind kind{ MatrixKind::General };
+
+			TaggedMatrix4() : matrix(Matrix4::sIdentity()), kind(MatrixKind::Rigid) {}
+			TaggedMatrix4(const Matrix4& matrix, MatrixKind kind) : matrix(matrix), kind(kind) {}
+
+			static TaggedMatrix4 Rigid(const Matrix4& m) { return TaggedMatrix4(m, MatrixKind::Rigid); }
+			static TaggedMatrix4 Affine(const Matrix4& m) { return TaggedMatrix4(m, MatrixKind::Affine); }
+			static TaggedMatrix4 General(const Matrix4& m) { return TaggedMatrix4(m, MatrixKind::General); }
+
+			// The product is only as special as the least special operand
+			TaggedMatrix4 operator*(const TaggedMatrix4& rhs) const { return TaggedMatrix4(matrix * rhs.matrix, Max(kind, rhs.kind)); }
+		};
+
+		inline Matrix4 Inverse(const TaggedMatrix4& m)
+		{
+			switch (m.kind)
+			{
+			case MatrixKind::Rigid: return InverseOrthonormal(m.matrix);
+			case MatrixKind::Affine: return InverseAffine(m.matrix);
+			default: return Inverse(m.matrix);
+			}
+		}
+
+		constexpr Matrix4 Translation(float x, float y, float z)
 		{
 			return Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, x, y, z, 1.0f);
 		}
 
-		inline Matrix4 Translation(const Vector3& v)
+		constexpr Matrix4 Translation(const Vector3& v)
 		{
 			return Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, v.x, v.y, v.z, 1.0f);
 		}
 
-		inline Matrix4 Transpose(const Matrix4& m)
+		constexpr Matrix4 Transpose(const Matrix4& m)
 		{
 			return Matrix4
 			(
@@ -430,7 +568,7 @@ namespace NFGE {
 
 		}
 
-		inline Vector2 TransformCoord(const Vector2& v, const Matrix3& m)
+		constexpr Vector2 TransformCoord(const Vector2& v, const Matrix3& m)
 		{
 			return Vector2
 			(
@@ -438,7 +576,7 @@ namespace NFGE {
 				v.x * m._12 + v.y * m._22 + m._32
 			);
 		}
-		inline Vector2 TransformNormal(const Vector2& v, const Matrix3& m)
+		constexpr Vector2 TransformNormal(const Vector2& v, const Matrix3& m)
 		{
 			return Vector2
 			(
@@ -448,7 +586,7 @@ namespace NFGE {
 		}
 
 
-		inline Vector3 TransformCoord(const Vector3& v, const Matrix4& m)
+		constexpr Vector3 TransformCoord(const Vector3& v, const Matrix4& m)
 		{
 			float w = v.x * m._14 + v.y * m._24 + v.z * m._34 + m._44 * 1.0f;
 			return Vector3
@@ -459,7 +597,7 @@ namespace NFGE {
 			);
 		}
 
-		inline Vector3 TransformNormal(const Vector3& v, const Matrix4& m)
+		constexpr Vector3 TransformNormal(const Vector3& v, const Matrix4& m)
 		{
 			return Vector3
 			(
@@ -474,10 +612,23 @@ namespace NFGE {
 		Quaternion QuaternionRotationAxis(const Vector3& axis, float rad);
 		Quaternion QuaternionFromTo(const Vector3& from, const Vector3& to);
 		Matrix4 MatrixRotationAxis(const Vector3& axis, float rad);
-		Matrix4 MatrixRotationQuaternion(const Quaternion& q);
+		constexpr Matrix4 MatrixRotationQuaternion(const Quaternion& q)
+		{
+			const float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+			const float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+			const float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+			const float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+			return Matrix4
+			(
+				1.0f - yy - zz, xy + wz, xz - wy, 0.0f,
+				xy - wz, 1.0f - xx - zz, yz + wx, 0.0f,
+				xz + wy, yz - wx, 1.0f - xx - yy, 0.0f,
+				0.0f, 0.0f, 0.0f, 1.0f
+			);
+		}
 		Vector3 GetEular(const Quaternion& quaternion);
 
-		Quaternion Slerp(Quaternion q0, Quaternion q1, float t);
+		Quaternion Slerp(const Quaternion& q0, const Quaternion& q1, float t);
 
 		NFGE::Math::Vector3 GetBarycentric(const Vector2& a, const Vector2& b, const Vector2& c, const Vector2& point);
 
@@ -510,30 +661,41 @@ namespace NFGE {
 		bool Intersect(const Ray& ray, const Vector3& a, const Vector3& b, const Vector3& c, float& distance);
 		bool Intersect(const Ray& ray, const Plane& plane, float& distance);
 		bool Intersect(const Ray& ray, const AABB& aabb, float& distEntry, float& distExit);
+		bool Intersect(const CachedRay& ray, const AABB& aabb, float& distEntry, float& distExit); // Same results as the Ray overload
 		bool Intersect(const Ray& ray, const OBB& obb, float& distEntry, float& distExit);
 		bool Intersect(const Vector3& point, const AABB& aabb);
 		bool Intersect(const Vector3& point, const OBB& obb);
 		bool Intersect(const AABB& aabb1, const AABB& aabb2);
 
+		bool Intersect(const Ray& ray, const CachedOBB& obb, float& distEntry, float& distExit);
+		bool Intersect(const Vector3& point, const CachedOBB& obb);
+		bool Intersect(const CachedOBB& obb1, const CachedOBB& obb2); // Separating axis test
+		bool Intersect(const OBB& obb1, const OBB& obb2);
+		bool Intersect(const Sphere& sphere, const AABB& aabb);
+		bool Intersect(const Sphere& sphere, const Vector3& a, const Vector3& b, const Vector3& c);
+
 		void GetCorners(const OBB& obb, std::vector<Vector3>& corners);
+		void GetCorners(const OBB& obb, std::array<Vector3, 8>& corners);
+		void GetCorners(const CachedOBB& obb, std::array<Vector3, 8>& corners);
 		bool GetContactPoint(const Ray& ray, const OBB& obb, Vector3& point, Vector3& normal);
+		bool GetContactPoint(const Ray& ray, const CachedOBB& obb, Vector3& point, Vector3& normal);
 
 		Vector3 GetClosestPoint(const Ray& ray, const Vector3& point);
-
-		Vector3 Mean(const Vector3* v, uint32_t count);
+		Vector3 GetClosestPoint(const Vector3& point, const AABB& aabb);
+		Vector3 GetClosestPoint(const Vector3& point, const Vector3& a, const Vector3& b, const Vector3& c); // Closest point on triangle abc
 
 
-		// Random Functions
+		// Random Functions, all drawing from the calling thread's engine (see Random.h)
 		int Random();
 		int Random(int min, int max);
 		float RandomFloat();
 		float RandomFloat(float min, float max);
 		Math::Vector2 RandomVector2();
 		Math::Vector2 RandomVector2(const Math::Vector2& min, const Math::Vector2& max);
-		Math::Vector2 RandomUnitCircle(bool normalized = true);
+		Math::Vector2 RandomUnitCircle(bool normalized = true); // On the circle, or uniform inside it
 		Math::Vector3 RandomVector3();
 		Math::Vector3 RandomVector3(const Math::Vector3& min, const Math::Vector3& max);
-		Math::Vector3 RandomUnitSphere();
+		Math::Vector3 RandomUnitSphere(); // Uniform on the sphere surface
 
 		namespace Interpolation
 		{
@@ -543,24 +705,24 @@ namespace NFGE {
 				return Lerp(start, end, t);
 			}
 
+			// The Bezier forms below use the Bernstein weights, the same curve as repeated Lerps in fewer
+			// operations. For many evaluations of one curve see SplinePath.
 			template<typename T>
 			inline T QuadraticBezier(T v0, T v1, T v2, float t)
 			{
-				return Lerp(Lerp(v0, v1, t), lerp(v1, v2, t), t);
+				const float s = 1.0f - t;
+				return v0 * (s * s) + v1 * (2.0f * s * t) + v2 * (t * t);
 			}
 
 			template<typename T>
 			inline T CubicBezier(T v0, T v1, T v2, T v3, float t)
 			{
-				T a = Lerp(v0, v1, t);
-				T b = Lerp(v1, v2, t);
-				T c = Lerp(v2, v3, t);
-				T e = Lerp(a, b, t);
-				T f = Lerp(b, c, t);
-
-				return Lerp(e, f, t);
+				const float s = 1.0f - t;
+				const float st3 = 3.0f * s * t;
+				return v0 * (s * s * s) + v1 * (st3 * s) + v2 * (st3 * t) + v3 * (t * t * t);
 			}
 
+			// Hermite curve from A to D with tangent U at A and V at D
 			template<typename T>
 			inline T CutmulRomspline(T U, T V, T A, T D, float t)
 			{
@@ -569,22 +731,101 @@ namespace NFGE {
 				T B = A + U * oneThrid;
 				T C = D - V * oneThrid;
 
-				T a = Lerp(A, B, t);
-				T b = Lerp(B, C, t);
-				T c = Lerp(C, D, t);
-				T e = Lerp(a, b, t);
-				T f = Lerp(b, c, t);
-
-				return Lerp(e, f, t);
+				return CubicBezier(A, B, C, D, t);
 			}
 		}
 
+		// Closed forms from https://easings.net, each maps [0, 1] to a value that starts at 0 and ends at 1.
+		// Defined inline so that TweenPool's batched updates can inline them, EaseMachine still takes
+		// them as function pointers.
 		namespace Ease
 		{
-			float EaseNone(float t);
-			float EaseInSine(float t);
-			float EaseOutCirc(float t);
-			float EaseOutMushroom(float t);
+			inline float EaseNone(float t) { return Interpolation::LinearSpline(0.0f, 1.0f, t); }
+
+			inline float EaseInSine(float t) { return 1.0f - cosf(t * Constants::Pi * 0.5f); }
+			inline float EaseOutSine(float t) { return sinf(t * Constants::Pi * 0.5f); }
+			inline float EaseInOutSine(float t) { return 0.5f - 0.5f * cosf(t * Constants::Pi); }
+
+			inline float EaseInQuad(float t) { return t * t; }
+			inline float EaseOutQuad(float t) { const float s = 1.0f - t; return 1.0f - s * s; }
+			inline float EaseInOutQuad(float t) { const float s = 2.0f - 2.0f * t; return t < 0.5f ? 2.0f * t * t : 1.0f - 0.5f * s * s; }
+
+			inline float EaseInCubic(float t) { return t * t * t; }
+			inline float EaseOutCubic(float t) { const float s = 1.0f - t; return 1.0f - s * s * s; }
+			inline float EaseInOutCubic(float t) { const float s = 2.0f - 2.0f * t; return t < 0.5f ? 4.0f * t * t * t : 1.0f - 0.5f * s * s * s; }
+
+			inline float EaseInQuart(float t) { const float t2 = t * t; return t2 * t2; }
+			inline float EaseOutQuart(float t) { const float s2 = (1.0f - t) * (1.0f - t); return 1.0f - s2 * s2; }
+			inline float EaseInOutQuart(float t) { const float t2 = t * t, s = 2.0f - 2.0f * t, s2 = s * s; return t < 0.5f ? 8.0f * t2 * t2 : 1.0f - 0.5f * s2 * s2; }
+
+			inline float EaseInQuint(float t) { const float t2 = t * t; return t2 * t2 * t; }
+			inline float EaseOutQuint(float t) { const float s = 1.0f - t, s2 = s * s; return 1.0f - s2 * s2 * s; }
+			inline float EaseInOutQuint(float t) { const float t2 = t * t, s = 2.0f - 2.0f * t, s2 = s * s; return t < 0.5f ? 16.0f * t2 * t2 * t : 1.0f - 0.5f * s2 * s2 * s; }
+
+			// Exact 0 and 1 at the ends, 2^-10 is not quite 0
+			inline float EaseInExpo(float t) { return t <= 0.0f ? 0.0f : exp2f(10.0f * t - 10.0f); }
+			inline float EaseOutExpo(float t) { return t >= 1.0f ? 1.0f : 1.0f - exp2f(-10.0f * t); }
+			inline float EaseInOutExpo(float t)
+			{
+				if (t <= 0.0f || t >= 1.0f)
+					return t <= 0.0f ? 0.0f : 1.0f;
+				return t < 0.5f ? 0.5f * exp2f(20.0f * t - 10.0f) : 1.0f - 0.5f * exp2f(10.0f - 20.0f * t);
+			}
+
+			inline float EaseInCirc(float t) { return 1.0f - sqrtf(Max(1.0f - t * t, 0.0f)); }
+			inline float EaseOutCirc(float t) { const float s = 1.0f - t; return sqrtf(Max(1.0f - s * s, 0.0f)); }
+			inline float EaseInOutCirc(float t)
+			{
+				const float s = 2.0f * t - 2.0f;
+				return t < 0.5f ? 0.5f - 0.5f * sqrtf(Max(1.0f - 4.0f * t * t, 0.0f)) : 0.5f + 0.5f * sqrtf(Max(1.0f - s * s, 0.0f));
+			}
+
+			// Overshoots below 0 or above 1 by about 10%
+			inline float EaseInBack(float t) { constexpr float c1 = 1.70158f; return t * t * ((c1 + 1.0f) * t - c1); }
+			inline float EaseOutBack(float t) { constexpr float c1 = 1.70158f; const float s = t - 1.0f; return 1.0f + s * s * ((c1 + 1.0f) * s + c1); }
+			inline float EaseInOutBack(float t)
+			{
+				constexpr float c2 = 1.70158f * 1.525f;
+				const float u = 2.0f * t, s = 2.0f * t - 2.0f;
+				return t < 0.5f ? 0.5f * u * u * ((c2 + 1.0f) * u - c2) : 0.5f * (s * s * ((c2 + 1.0f) * s + c2) + 2.0f);
+			}
+
+			inline float EaseInElastic(float t)
+			{
+				if (t <= 0.0f || t >= 1.0f)
+					return t <= 0.0f ? 0.0f : 1.0f;
+				return -exp2f(10.0f * t - 10.0f) * sinf((10.0f * t - 10.75f) * (Constants::TwoPi / 3.0f));
+			}
+			inline float EaseOutElastic(float t)
+			{
+				if (t <= 0.0f || t >= 1.0f)
+					return t <= 0.0f ? 0.0f : 1.0f;
+				return exp2f(-10.0f * t) * sinf((10.0f * t - 0.75f) * (Constants::TwoPi / 3.0f)) + 1.0f;
+			}
+			inline float EaseInOutElastic(float t)
+			{
+				if (t <= 0.0f || t >= 1.0f)
+					return t <= 0.0f ? 0.0f : 1.0f;
+				const float s = sinf((20.0f * t - 11.125f) * (Constants::TwoPi / 4.5f));
+				return t < 0.5f ? -0.5f * exp2f(20.0f * t - 10.0f) * s : 0.5f * exp2f(10.0f - 20.0f * t) * s + 1.0f;
+			}
+
+			inline float EaseOutBounce(float t)
+			{
+				constexpr float n1 = 7.5625f;
+				constexpr float d1 = 2.75f;
+				if (t < 1.0f / d1)
+					return n1 * t * t;
+				if (t < 2.0f / d1) { t -= 1.5f / d1; return n1 * t * t + 0.75f; }
+				if (t < 2.5f / d1) { t -= 2.25f / d1; return n1 * t * t + 0.9375f; }
+				t -= 2.625f / d1;
+				return n1 * t * t + 0.984375f;
+			}
+			inline float EaseInBounce(float t) { return 1.0f - EaseOutBounce(1.0f - t); }
+			inline float EaseInOutBounce(float t) { return t < 0.5f ? 0.5f - 0.5f * EaseOutBounce(1.0f - 2.0f * t) : 0.5f + 0.5f * EaseOutBounce(2.0f * t - 1.0f); }
+
+			// cubic-bezier(.86, 0, .07, 1), which easings.net lists as easeInOutQuint
+			inline float EaseOutMushroom(float t) { return EaseInOutQuint(t); }
 		}
 
 		//----------------------------------------------------------------------------------------------------
@@ -611,3 +852,21 @@ namespace NFGE {
 
 	} // namespace NFGE 
 } // namespace Math 
+
+// Modules built on the types above
+#include "BVH.h"
+#include "Constexpr.h"
+#include "DynamicAABBTree.h"
+#include "FastMath.h"
+#include "Frustum.h"
+#include "GJK.h"
+#include "KDTree.h"
+#include "Matrix3x4.h"
+#include "Packing.h"
+#include "Parallel.h"
+#include "PointCloud.h"
+#include "SpatialHashGrid.h"
+#include "SplinePath.h"
+#include "Sweep.h"
+#include "TransformTRS.h"
+#include "TweenPool.h"
@@ -0,0 +1,97 @@
+//====================================================================================================
+// Filename:	Packing.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Quantized storage formats for vertex buffers, instance streams and animation data.
+//				Every format has a scalar pair for single values and array versions that convert 8
+//				values per step with AVX2. Both paths do the same operations in the same order, so they
+//				agree bit for bit. Rounding is to nearest even and out of range input is clamped, the
+//				same as the GPU's conversions.
+// Resources:	Cigolle et al., A Survey of Efficient Representations for Independent Unit Vectors,
+//				http://jcgt.org/published/0003/02/01/
+//				Glenn Fiedler, Snapshot Compression, https://gafferongames.com/post/snapshot_compression/
+//====================================================================================================
+
+#pragma once
+
+#if NFGE_SIMD_X86
+#include <xmmintrin.h>
+#endif
+
+namespace NFGE::Math
+{
+	namespace Internal
+	{
+		// Current rounding mode, i.e. to nearest even, the same as cvtps2dq in the array versions
+		inline int RoundToInt(float value)
+		{
+#if NFGE_SIMD_X86
+			return _mm_cvt_ss2si(_mm_set_ss(value));
+#else
+			return static_cast<int>(lrintf(value));
+#endif
+		}
+	}
+
+	// IEEE binary16, round to nearest even. Overflow gives infinity and NaN stays NaN.
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t half);
+
+	// snorm maps [-1, 1] to [-max, max] so 0 is exact, and both -max - 1 and -max decode to -1.
+	// unorm maps [0, 1] to [0, max].
+	inline int16_t PackSnorm16(float value) { return static_cast<int16_t>(Internal::RoundToInt(Clamp(value, -1.0f, 1.0f) * 32767.0f)); }
+	inline int8_t PackSnorm8(float value) { return static_cast<int8_t>(Internal::RoundToInt(Clamp(value, -1.0f, 1.0f) * 127.0f)); }
+	inline uint16_t PackUnorm16(float value) { return static_cast<uint16_t>(Internal::RoundToInt(Clamp(value, 0.0f, 1.0f) * 65535.0f)); }
+	inline uint8_t PackUnorm8(float value) { return static_cast<uint8_t>(Internal::RoundToInt(Clamp(value, 0.0f, 1.0f) * 255.0f)); }
+	inline float UnpackSnorm16(int16_t value) { return Max(value * (1.0f / 32767.0f), -1.0f); }
+	inline float UnpackSnorm8(int8_t value) { return Max(value * (1.0f / 127.0f), -1.0f); }
+	inline float UnpackUnorm16(uint16_t value) { return value * (1.0f / 65535.0f); }
+	inline float UnpackUnorm8(uint8_t value) { return value * (1.0f / 255.0f); }
+
+	// Unit vector as two snorm16 on the octahedron, x in the low 16 bits. The decoded vector is unit length
+	// and within 6.5e-5 rad of the input, where three snorm16 in 48 bits get 2.6e-5 rad. Meant for normals
+	// and tangent directions, a tangent's handedness sign has to be stored separately.
+	uint32_t PackOctahedral(const Vector3& unit);
+	Vector3 UnpackOctahedral(uint32_t packed);
+
+	// Smallest three: the largest component is dropped and rebuilt from the unit length, its index goes in
+	// the top 2 bits. The input should be unit length, the sign is flipped when needed since q and -q are
+	// the same rotation. 32 bits keeps 10 bits per component and the rotation within 4.3e-3 rad, enough for
+	// tangent frames. 64 bits keeps 20 bits per component and the rotation within 4.5e-6 rad, for animation keys.
+	uint32_t PackQuaternion32(const Quaternion& unit);
+	Quaternion UnpackQuaternion32(uint32_t packed);
+	uint64_t PackQuaternion64(const Quaternion& unit);
+	Quaternion UnpackQuaternion64(uint64_t packed);
+
+	// Graphics::Color as DXGI_FORMAT_R8G8B8A8_UNORM and DXGI_FORMAT_R10G10B10A2_UNORM, r in the low bits
+	uint32_t PackRGBA8(const Vector4& color);
+	Vector4 UnpackRGBA8(uint32_t packed);
+	uint32_t PackRGB10A2(const Vector4& color);
+	Vector4 UnpackRGB10A2(uint32_t packed);
+
+	// Array versions of the above
+	void FloatToHalf(const float* in, uint16_t* out, size_t count);
+	void HalfToFloat(const uint16_t* in, float* out, size_t count);
+
+	void PackSnorm16(const float* in, int16_t* out, size_t count);
+	void PackSnorm8(const float* in, int8_t* out, size_t count);
+	void PackUnorm16(const float* in, uint16_t* out, size_t count);
+	void PackUnorm8(const float* in, uint8_t* out, size_t count);
+	void UnpackSnorm16(const int16_t* in, float* out, size_t count);
+	void UnpackSnorm8(const int8_t* in, float* out, size_t count);
+	void UnpackUnorm16(const uint16_t* in, float* out, size_t count);
+	void UnpackUnorm8(const uint8_t* in, float* out, size_t count);
+
+	void PackOctahedral(const Vector3* in, uint32_t* out, size_t count);
+	void UnpackOctahedral(const uint32_t* in, Vector3* out, size_t count);
+
+	void PackQuaternion32(const Quaternion* in, uint32_t* out, size_t count);
+	void UnpackQuaternion32(const uint32_t* in, Quaternion* out, size_t count);
+	void PackQuaternion64(const Quaternion* in, uint64_t* out, size_t count);
+	void UnpackQuaternion64(const uint64_t* in, Quaternion* out, size_t count);
+
+	void PackRGBA8(const Vector4* in, uint32_t* out, size_t count);
+	void UnpackRGBA8(const uint32_t* in, Vector4* out, size_t count);
+	void PackRGB10A2(const Vector4* in, uint32_t* out, size_t count);
+	void UnpackRGB10A2(const uint32_t* in, Vector4* out, size_t count);
+}
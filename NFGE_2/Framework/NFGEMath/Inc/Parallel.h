@@ -0,0 +1,43 @@
+//====================================================================================================
+// Filename:	Parallel.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Minimal fork/join helper for splitting bulk math work across hardware threads.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	// Splits [0, count) into contiguous ranges of at least minPerTask items and calls func(begin, end) for
+	// each, one range per hardware thread at most. The calling thread takes the first range and the call
+	// returns once all ranges are done. Small counts run inline without starting any threads.
+	template <typename Func>
+	void ParallelFor(size_t count, size_t minPerTask, Func&& func)
+	{
+		const size_t threads = Max(1u, std::thread::hardware_concurrency());
+		const size_t tasks = Min(threads, count / Max<size_t>(minPerTask, 1));
+		if (tasks <= 1)
+		{
+			if (count > 0)
+			{
+				func(size_t(0), count);
+			}
+			return;
+		}
+
+		const size_t chunk = (count + tasks - 1) / tasks;
+		std::vector<std::future<void>> futures;
+		futures.reserve(tasks - 1);
+		for (size_t begin = chunk; begin < count; begin += chunk)
+		{
+			const size_t end = Min(count, begin + chunk);
+			futures.push_back(std::async(std::launch::async, [&func, begin, end]() { func(begin, end); }));
+		}
+		func(size_t(0), chunk);
+		for (auto& future : futures)
+		{
+			future.get();
+		}
+	}
+}
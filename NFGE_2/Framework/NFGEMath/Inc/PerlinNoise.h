@@ -10,18 +10,68 @@
 #pragma once
 
 namespace NFGE::Math {
+	struct Vector2;
+	struct Vector3;
+
+	namespace Internal
+	{
+		// Fill table[0, 512) with 256 permutation entries repeated twice so corner hashes never wrap. The
+		// noise classes share these so the same seed gives the same lattice.
+		void FillReferencePermutation(uint8_t* table);				// Ken Perlin's reference values
+		void FillSeededPermutation(uint8_t* table, uint32_t seed);	// Shuffle of 0-255 by std::default_random_engine(seed)
+	}
+
 	class PerlinNoise
 	{
 	public:
+		// Octave sums over the noise. All types return values in [0, 1] like Get.
+		enum class FractalType
+		{
+			FBm,		// Sum of signed noise
+			Ridged,		// Sum of (1 - |noise|)^2, sharp crests where the noise crosses zero
+			Turbulence	// Sum of |noise|, creases where the noise crosses zero
+		};
+
+		struct Fractal
+		{
+			FractalType type = FractalType::FBm;
+			uint32_t octaves = 6;
+			float lacunarity = 2.0f;	// Frequency multiplier per octave
+			float gain = 0.5f;			// Amplitude multiplier per octave
+		};
+
 		PerlinNoise();
 		PerlinNoise(uint32_t seed);
 
-		float Get(float x, float y, float z);
+		// Returns noise in [0, 1]
+		float Get(float x, float y, float z) const;
+		float Get(float x, float y, float z, const Fractal& fractal) const;
+
+		// Bulk evaluation, 8 samples at a time with AVX2. Large requests are split across threads.
+		// Fill2D writes out[y * width + x] = Get(origin.x + x * step, origin.y + y * step, z).
+		// Fill3D writes out[(z * height + y) * width + x] sampled from origin in the same way.
+		void Fill2D(float* out, uint32_t width, uint32_t height, const Vector2& origin, float step, float z = 0.0f) const;
+		void Fill2D(float* out, uint32_t width, uint32_t height, const Vector2& origin, float step, float z, const Fractal& fractal) const;
+		void Fill3D(float* out, uint32_t width, uint32_t height, uint32_t depth, const Vector3& origin, float step) const;
+		void Fill3D(float* out, uint32_t width, uint32_t height, uint32_t depth, const Vector3& origin, float step, const Fractal& fractal) const;
+
+		void GetBatch(const Vector3* points, float* out, size_t count) const;
+		void GetBatch(const Vector3* points, float* out, size_t count, const Fractal& fractal) const;
+		void GetBatch(const float* x, const float* y, const float* z, float* out, size_t count) const;
+		void GetBatch(const float* x, const float* y, const float* z, float* out, size_t count, const Fractal& fractal) const;
 
 	private:
-		float Fade(float t);
-		float Grad(int hash, float x, float y, float z);
+		// 256 entries duplicated to 512 so hashes never wrap, plus padding so a 32 bit gather at the last
+		// entry stays inside the table
+		static constexpr size_t kTableSize = 512 + 4;
+
+		float Noise(float x, float y, float z) const; // Signed, in [-1, 1]
+		float Fade(float t) const;
+		float Grad(int hash, float x, float y, float z) const;
+
+		void FillRows(float* out, uint32_t width, uint32_t rows, uint32_t rowsPerSlice, float originX, float originY, float originZ, float step, const Fractal* fractal) const;
+		void Evaluate(const float* x, const float* y, const float* z, size_t stride, float* out, size_t count, const Fractal* fractal) const;
 
-		std::vector<int> p;
+		std::array<uint8_t, kTableSize> p{};
 	};
 }
@@ -0,0 +1,34 @@
+//====================================================================================================
+// Filename:	PointCloud.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Bounds and statistics of Vector3 arrays, for mesh import and bound refits. Every function
+//				is a reduction over the whole array, 8 points per step with AVX2, and arrays of more than
+//				a few hundred thousand points are split across threads. Sums are pairwise, so the error
+//				grows with log(count) instead of count, and the results do not depend on the thread count.
+// Resources:	Jack Ritter, An Efficient Bounding Sphere, Graphics Gems (1990)
+//				Thomas Larsson, Fast and Tight Fitting Bounding Spheres, SIGRAD 2008 (EPOS)
+//				Emo Welzl, Smallest enclosing disks (balls and ellipsoids) (1991)
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	// Smallest box containing the points
+	AABB ComputeAABB(const Vector3* points, size_t count);
+
+	// Population covariance, the mean is written when requested. Two passes, one for the mean and one for
+	// the centered products, so a cloud far from the origin loses nothing to cancellation.
+	Matrix3 ComputeCovariance(const Vector3* points, size_t count, Vector3* mean = nullptr);
+
+	// Box along the principal axes of the points (PCA), longest axis first. Tight for elongated clouds,
+	// but the axes follow the point density, so it can be looser than the AABB for boxy, uneven meshes.
+	OBB ComputeOBB(const Vector3* points, size_t count);
+
+	// Both spheres contain every point. Ritter starts from a far apart pair and grows, it is the cheaper
+	// of the two. EPOS starts from the exact smallest sphere of the extreme points along 7 directions and
+	// usually ends within a few percent of the optimal radius.
+	Sphere ComputeBoundingSphereRitter(const Vector3* points, size_t count);
+	Sphere ComputeBoundingSphereEPOS(const Vector3* points, size_t count);
+}
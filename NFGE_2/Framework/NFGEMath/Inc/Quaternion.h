@@ -15,17 +15,17 @@ namespace NFGE::Math
 		constexpr Quaternion() noexcept : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
 		constexpr Quaternion(float x, float y, float z, float w) noexcept : x(x), y(y), z(z), w(w) {}
 
-		static Quaternion Zero() { return Quaternion(0.0f, 0.0f, 0.0f, 0.0f); }
-		static Quaternion Identity() { return Quaternion(0.0f, 0.0f, 0.0f, 1.0f); }
+		static constexpr Quaternion Zero() { return Quaternion(0.0f, 0.0f, 0.0f, 0.0f); }
+		static constexpr Quaternion Identity() { return Quaternion(0.0f, 0.0f, 0.0f, 1.0f); }
 
 		//const static Quaternion Zero;
 		//const static Quaternion Identity;
 
-		inline Quaternion operator+(const Quaternion& rhs) const { return Quaternion(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w); }
-		inline Quaternion operator*(const Quaternion& rhs) const;
-		inline Quaternion operator*(float s) const { return Quaternion(x * s, y * s, z * s, w * s); }
-		inline Quaternion operator/(float s) const { return Quaternion(x / s, y / s, z / s, w / s); }
-		inline bool operator==(const Quaternion& rhs) const { return (x == rhs.x && y == rhs.y && z == rhs.z && w == rhs.w); }
+		constexpr Quaternion operator+(const Quaternion& rhs) const { return Quaternion(x + rhs.x, y + rhs.y, z + rhs.z, w + rhs.w); }
+		constexpr Quaternion operator*(const Quaternion& rhs) const;
+		constexpr Quaternion operator*(float s) const { return Quaternion(x * s, y * s, z * s, w * s); }
+		constexpr Quaternion operator/(float s) const { return Quaternion(x / s, y / s, z / s, w / s); }
+		constexpr bool operator==(const Quaternion& rhs) const { return (x == rhs.x && y == rhs.y && z == rhs.z && w == rhs.w); }
 
 		static Quaternion ToQuaternion(float pitch, float yaw, float roll) // yaw (Z), pitch (Y), roll (X)
 		{
@@ -39,7 +39,7 @@ namespace NFGE::Math
 		}
 	};
 
-	inline Quaternion Quaternion::operator*(const Quaternion& v) const
+	constexpr Quaternion Quaternion::operator*(const Quaternion& v) const
 	{
 		return Quaternion(w * v.x + x * v.w + y * v.z - z * v.y,
 			w * v.y + y * v.w + z * v.x - x * v.z,
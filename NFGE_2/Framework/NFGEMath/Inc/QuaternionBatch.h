@@ -0,0 +1,39 @@
+//====================================================================================================
+// Filename:	QuaternionBatch.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Array-at-a-time quaternion blending and conversion for animation, 8 quaternions per step
+//				with AVX2. Inputs are expected to be unit length. out may alias either input.
+// Resources:	David Eberly, A Fast and Accurate Algorithm for Computing SLERP,
+//				https://www.geometrictools.com/Documentation/FastAndAccurateSlerp.pdf
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	struct Matrix3x4;
+	struct Matrix4;
+	struct Quaternion;
+
+	// Slerp along the shorter arc using an 8 term polynomial in t and Dot(q0, q1) instead of acos and sin.
+	// Components are within 3e-5 of double precision slerp, the worst case is near 80 degrees between the
+	// inputs and the error falls off quickly below that (under 1e-6 when Dot > 0.5). Slerp itself agrees
+	// with exact slerp to about 1e-6, so the same 3e-5 bound holds against it.
+	void SlerpBatch(const Quaternion* q0, const Quaternion* q1, float t, Quaternion* out, size_t count);
+	void SlerpBatch(const Quaternion* q0, const Quaternion* q1, const float* t, Quaternion* out, size_t count);
+
+	// Normalized lerp along the shorter arc. Cheaper than slerp but not constant speed, so the rotation
+	// differs from slerp by up to 0.0012 rad for inputs 30 degrees apart, 0.0048 rad at 60 degrees, 0.039 rad
+	// at 120 degrees and 0.12 rad at 170 degrees.
+	void NlerpBatch(const Quaternion* q0, const Quaternion* q1, float t, Quaternion* out, size_t count);
+	void NlerpBatch(const Quaternion* q0, const Quaternion* q1, const float* t, Quaternion* out, size_t count);
+
+	// Same result as MatrixRotationQuaternion
+	void QuaternionToMatrixBatch(const Quaternion* q, Matrix4* out, size_t count);
+
+	// 12 floats per quaternion in GPU order: three rows of 4 floats holding the rotation matrix's first three
+	// columns, the 4th float of each row is the translation and is written as 0
+	void QuaternionToMatrix3x4Batch(const Quaternion* q, float* out, size_t count);
+	void QuaternionToMatrix3x4Batch(const Quaternion* q, Matrix3x4* out, size_t count);
+}
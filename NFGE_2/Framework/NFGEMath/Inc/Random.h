@@ -0,0 +1,70 @@
+//====================================================================================================
+// Filename:	Random.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Small, fast random number engine (xoshiro128+) with a per-thread instance behind the
+//				Random* functions, plus bulk fills that run 8 interleaved streams at once.
+// Resources:	https://prng.di.unimi.it/
+//				https://arxiv.org/abs/1805.10941 (Lemire, unbiased bounded integers)
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	struct Vector2;
+	struct Vector3;
+
+	// 16 bytes of state with a 2^128 - 1 period. Meets UniformRandomBitGenerator, so it also works with
+	// std::shuffle and the <random> distributions. The lowest bits are weaker than the rest, NextFloat and
+	// NextBounded only use the upper bits.
+	class RandomEngine
+	{
+	public:
+		using result_type = uint32_t;
+		static constexpr result_type min() { return 0u; }
+		static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+		RandomEngine() : RandomEngine(0) {}
+		explicit RandomEngine(uint64_t seed) { Seed(seed); }
+
+		// The same seed always gives the same sequence
+		void Seed(uint64_t seed);
+
+		uint32_t Next()
+		{
+			const uint32_t result = mState[0] + mState[3];
+			const uint32_t t = mState[1] << 9;
+			mState[2] ^= mState[0];
+			mState[3] ^= mState[1];
+			mState[1] ^= mState[2];
+			mState[0] ^= mState[3];
+			mState[2] ^= t;
+			mState[3] = (mState[3] << 11) | (mState[3] >> 21);
+			return result;
+		}
+		result_type operator()() { return Next(); }
+
+		uint32_t NextBounded(uint32_t bound); // Unbiased in [0, bound), bound must be > 0
+		float NextFloat() { return static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f); } // [0, 1)
+		float NextFloat(float min, float max) { return min + (max - min) * NextFloat(); }
+
+	private:
+		uint32_t mState[4];
+	};
+
+	// The calling thread's engine. Each thread starts from a different nondeterministic seed, call
+	// SeedThreadRandomEngine first when a thread needs a reproducible sequence.
+	RandomEngine& GetThreadRandomEngine();
+	void SeedThreadRandomEngine(uint64_t seed);
+
+	// Bulk fills. Each call seeds 8 interleaved streams from the engine and produces 8 values per step with
+	// AVX2. The output depends only on the engine state, not on the instruction set.
+	void RandomFloats(RandomEngine& engine, float* out, size_t count, float min = 0.0f, float max = 1.0f);
+	void RandomUnitCircle(RandomEngine& engine, Vector2* out, size_t count, bool normalized = true); // On the circle, or uniform inside it
+	void RandomUnitSphere(RandomEngine& engine, Vector3* out, size_t count); // Uniform on the sphere surface
+
+	void RandomFloats(float* out, size_t count, float min = 0.0f, float max = 1.0f);
+	void RandomUnitCircle(Vector2* out, size_t count, bool normalized = true);
+	void RandomUnitSphere(Vector3* out, size_t count);
+}
@@ -0,0 +1,56 @@
+//====================================================================================================
+// Filename:	RayPacket.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	4/8 wide branchless slab tests, either N rays against one box or one ray against N
+//				boxes. Results match Intersect(Ray, AABB) lane for lane, including the swap on a
+//				negative reciprocal direction and the NaN behaviour of the comparisons.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	struct AABB;
+	struct CachedRay;
+	struct Ray;
+
+	template <size_t N>
+	struct RayPacket
+	{
+		static_assert(N == 4 || N == 8, "RayPacket only supports 4 or 8 lanes.");
+		static constexpr size_t kLaneCount = N;
+
+		alignas(32) std::array<float, N> orgX{};
+		alignas(32) std::array<float, N> orgY{};
+		alignas(32) std::array<float, N> orgZ{};
+		alignas(32) std::array<float, N> invDirX{};
+		alignas(32) std::array<float, N> invDirY{};
+		alignas(32) std::array<float, N> invDirZ{};
+
+		void Set(size_t lane, const Ray& ray);
+	};
+
+	template <size_t N>
+	struct AABBPacket
+	{
+		static_assert(N == 4 || N == 8, "AABBPacket only supports 4 or 8 lanes.");
+		static constexpr size_t kLaneCount = N;
+
+		alignas(32) std::array<float, N> minX{};
+		alignas(32) std::array<float, N> minY{};
+		alignas(32) std::array<float, N> minZ{};
+		alignas(32) std::array<float, N> maxX{};
+		alignas(32) std::array<float, N> maxY{};
+		alignas(32) std::array<float, N> maxZ{};
+
+		void Set(size_t lane, const AABB& aabb);
+	};
+
+	// Returns the hit mask, bit i set when lane i hits. distEntry/distExit hold N floats and are only
+	// meaningful for lanes that hit.
+	uint32_t Intersect(const RayPacket<4>& rays, const AABB& aabb, float* distEntry, float* distExit);
+	uint32_t Intersect(const RayPacket<8>& rays, const AABB& aabb, float* distEntry, float* distExit);
+	uint32_t Intersect(const CachedRay& ray, const AABBPacket<4>& boxes, float* distEntry, float* distExit);
+	uint32_t Intersect(const CachedRay& ray, const AABBPacket<8>& boxes, float* distEntry, float* distExit);
+}
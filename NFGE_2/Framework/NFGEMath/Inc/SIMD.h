@@ -0,0 +1,62 @@
+//====================================================================================================
+// Filename:	SIMD.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Runtime selection of the instruction set used by the vectorized math kernels.
+//				The best set supported by the CPU is picked once at startup; Scalar is always
+//				available and is the only path on non-x86 targets.
+//====================================================================================================
+
+#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NFGE_SIMD_X86 1
+#else
+#define NFGE_SIMD_X86 0
+#endif
+
+// MSVC emits any intrinsic regardless of /arch, gcc/clang need the target enabled per function.
+// NFGE_TARGET_AVX2_NO_FMA is for kernels that promise the same bits as their scalar path: without FMA
+// enabled the compiler cannot contract their multiply-adds.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define NFGE_TARGET_SSE41
+#define NFGE_TARGET_AVX2
+#define NFGE_TARGET_AVX2_NO_FMA
+#else
+#define NFGE_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define NFGE_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#define NFGE_TARGET_AVX2_NO_FMA __attribute__((target("avx2,f16c")))
+#endif
+
+namespace NFGE::Math
+{
+	struct Matrix4;
+	struct Vector3;
+	struct Vector4;
+}
+
+namespace NFGE::Math::SIMD
+{
+	enum class InstructionSet
+	{
+		Scalar,
+		SSE41,
+		AVX2	// AVX2 + FMA3 + F16C
+	};
+
+	namespace Internal
+	{
+		extern InstructionSet sInstructionSet;
+	}
+
+	inline InstructionSet GetInstructionSet() { return Internal::sInstructionSet; }
+	InstructionSet GetSupportedInstructionSet();
+	void SetInstructionSet(InstructionSet instructionSet); // Clamped to what the CPU supports, mainly for benchmarking
+	const char* GetInstructionSetName(InstructionSet instructionSet);
+
+	// out may alias a or b
+	void MatrixMultiply(Matrix4& out, const Matrix4& a, const Matrix4& b);
+	Vector4 Transform(const Vector4& v, const Matrix4& m); // row vector * matrix
+	Vector3 TransformCoord(const Vector3& v, const Matrix4& m);
+	Vector3 TransformNormal(const Vector3& v, const Matrix4& m);
+}
@@ -0,0 +1,51 @@
+//====================================================================================================
+// Filename:	SimplexNoise.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Simplex noise in 2D, 3D and 4D with analytic derivatives. Each sample touches 3, 4 or 5
+//				simplex corners instead of the 4, 8 or 16 lattice corners of PerlinNoise.
+// Resources:	https://weber.itn.liu.se/~stegu/simplexnoise/simplexnoise.pdf
+//				https://weber.itn.liu.se/~stegu/aqsis/aqsis-newnoise/sdnoise1234.c
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	struct Vector2;
+	struct Vector3;
+	struct Vector4;
+
+	class SimplexNoise
+	{
+	public:
+		// Same lattice permutation as PerlinNoise() and PerlinNoise(seed)
+		SimplexNoise();
+		SimplexNoise(uint32_t seed);
+
+		// Returns noise in [0, 1] like PerlinNoise::Get
+		float Get(float x, float y) const;
+		float Get(float x, float y, float z) const;
+		float Get(float x, float y, float z, float w) const;
+
+		// Also returns the analytic gradient of the returned value
+		float Get(float x, float y, Vector2& derivative) const;
+		float Get(float x, float y, float z, Vector3& derivative) const;
+		float Get(float x, float y, float z, float w, Vector4& derivative) const;
+
+		// Bulk evaluation, 8 points at a time with AVX2. Large batches are split across threads.
+		// derivatives is optional and holds count entries when given.
+		void GetBatch(const Vector2* points, float* out, size_t count, Vector2* derivatives = nullptr) const;
+		void GetBatch(const Vector3* points, float* out, size_t count, Vector3* derivatives = nullptr) const;
+		void GetBatch(const Vector4* points, float* out, size_t count, Vector4* derivatives = nullptr) const;
+
+	private:
+		// 512 entries plus padding so 32 bit gathers at the last entry stay inside the table
+		static constexpr size_t kTableSize = 512 + 4;
+
+		void Batch(int dimension, const float* points, float* out, size_t count, float* derivatives) const;
+
+		std::array<uint8_t, kTableSize> mPermutation{};
+		std::array<uint8_t, kTableSize> mPermutationMod12{};
+	};
+}
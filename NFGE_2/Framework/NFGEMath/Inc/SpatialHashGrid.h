@@ -0,0 +1,95 @@
+//====================================================================================================
+// Filename:	SpatialHashGrid.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Uniform 2D grid over circles or rects, rebuilt in bulk each frame. Occupied cells are
+//				found through an open addressing hash on the cell coordinates and each cell's entries
+//				are stored contiguously. Buffers keep their capacity, so once warmed up a rebuild does
+//				not allocate.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	class SpatialHashGrid
+	{
+	public:
+		struct Pair
+		{
+			uint32_t a; // a < b
+			uint32_t b;
+		};
+
+		explicit SpatialHashGrid(float cellSize = 1.0f);
+
+		// Cell size should be about the size of a typical entity. Takes effect on the next Build.
+		void SetCellSize(float cellSize);
+		float GetCellSize() const { return mCellSize; }
+
+		// Indices reported by queries are positions in these arrays
+		void Build(const Circle* circles, size_t count);
+		void Build(const std::vector<Circle>& circles) { Build(circles.data(), circles.size()); }
+		void Build(const Rect* rects, size_t count);
+		void Build(const std::vector<Rect>& rects) { Build(rects.data(), rects.size()); }
+		void Clear();
+
+		// Append each entity that intersects the query once, using the Intersect overloads for the shape pair
+		void Query(const Circle& circle, std::vector<uint32_t>& results) const;
+		void Query(const Rect& rect, std::vector<uint32_t>& results) const;
+		void Query(const LineSegment& segment, std::vector<uint32_t>& results) const;
+
+		// Every intersecting pair once, in cell order
+		void QueryPairs(std::vector<Pair>& pairs) const;
+
+		// First entity hit walking from segment.from to segment.to. t is the hit position along the
+		// segment in [0, 1]; a segment starting inside an entity hits it at t = 0.
+		bool Raycast(const LineSegment& segment, uint32_t& index, float& t) const;
+
+		size_t GetEntityCount() const { return mBounds.size(); }
+		size_t GetCellCount() const { return mCells.size(); }
+
+	private:
+		struct CellRange
+		{
+			int32_t minX, minY, maxX, maxY;
+
+			bool Contains(int32_t x, int32_t y) const { return x >= minX && x <= maxX && y >= minY && y <= maxY; }
+		};
+
+		struct Cell
+		{
+			int32_t x, y;
+			uint32_t start; // Into mEntries
+			uint32_t count;
+		};
+
+		struct Slot
+		{
+			int32_t x, y;
+			int32_t cell; // -1 when empty
+		};
+
+		void BuildCells();
+		CellRange GetCellRange(const Rect& bounds) const;
+		int32_t FindCell(int32_t x, int32_t y) const;
+		int32_t FindOrAddCell(int32_t x, int32_t y);
+		bool TestEntity(uint32_t index, const LineSegment& segment, float& t) const;
+
+		template <typename Func>
+		void ForEachCandidate(const Rect& bounds, Func&& func) const;
+
+		float mCellSize;
+		float mInvCellSize;
+
+		std::vector<Circle> mCircles;	// Circle build
+		std::vector<Rect> mRects;		// Rect build
+		std::vector<Rect> mBounds;
+		std::vector<CellRange> mRanges;
+
+		std::vector<Slot> mSlots;		// Power of two sized hash table
+		std::vector<Cell> mCells;
+		std::vector<uint32_t> mEntries;
+		std::vector<int32_t> mRefCells;	// Scratch for the build, the cell of each entity/cell reference
+	};
+}
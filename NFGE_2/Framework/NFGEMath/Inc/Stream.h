@@ -0,0 +1,134 @@
+//====================================================================================================
+// Filename:	Stream.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Structure-of-arrays containers for processing many vectors/quaternions 8 lanes at a
+//				time. Each component lives in its own 32 byte aligned array padded to a multiple of
+//				kLaneCount, and the padding lanes are kept at zero.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	struct Vector3;
+	struct Quaternion;
+
+	template <typename T, size_t Alignment = 32>
+	struct AlignedAllocator
+	{
+		using value_type = T;
+		template <typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+		AlignedAllocator() noexcept = default;
+		template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+		T* allocate(size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+		void deallocate(T* p, size_t) noexcept { ::operator delete(p, std::align_val_t(Alignment)); }
+
+		template <typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+		template <typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+	};
+
+	template <typename T>
+	using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+	// Vector3Stream ----------------------------------------------------------------------------------------------------
+
+	class Vector3Stream
+	{
+	public:
+		static constexpr size_t kLaneCount = 8;
+
+		Vector3Stream() = default;
+		explicit Vector3Stream(size_t count) { Resize(count); }
+		explicit Vector3Stream(const std::vector<Vector3>& v) { Assign(v); }
+
+		void Resize(size_t count);
+		void Clear() { Resize(0); }
+
+		void Assign(const Vector3* v, size_t count);
+		void Assign(const std::vector<Vector3>& v) { Assign(v.data(), v.size()); }
+		void ToVector(std::vector<Vector3>& v) const;
+		std::vector<Vector3> ToVector() const { std::vector<Vector3> v; ToVector(v); return v; }
+
+		size_t Size() const { return mCount; }
+		size_t PaddedSize() const { return mX.size(); }
+		bool Empty() const { return mCount == 0; }
+
+		Vector3 Get(size_t i) const;
+		void Set(size_t i, const Vector3& v);
+
+		float* X() { return mX.data(); }
+		float* Y() { return mY.data(); }
+		float* Z() { return mZ.data(); }
+		const float* X() const { return mX.data(); }
+		const float* Y() const { return mY.data(); }
+		const float* Z() const { return mZ.data(); }
+
+	private:
+		AlignedVector<float> mX;
+		AlignedVector<float> mY;
+		AlignedVector<float> mZ;
+		size_t mCount = 0;
+	};
+
+	// QuaternionStream ----------------------------------------------------------------------------------------------------
+
+	class QuaternionStream
+	{
+	public:
+		static constexpr size_t kLaneCount = 8;
+
+		QuaternionStream() = default;
+		explicit QuaternionStream(size_t count) { Resize(count); }
+		explicit QuaternionStream(const std::vector<Quaternion>& q) { Assign(q); }
+
+		void Resize(size_t count);
+		void Clear() { Resize(0); }
+
+		void Assign(const Quaternion* q, size_t count);
+		void Assign(const std::vector<Quaternion>& q) { Assign(q.data(), q.size()); }
+		void ToVector(std::vector<Quaternion>& q) const;
+		std::vector<Quaternion> ToVector() const { std::vector<Quaternion> q; ToVector(q); return q; }
+
+		size_t Size() const { return mCount; }
+		size_t PaddedSize() const { return mX.size(); }
+		bool Empty() const { return mCount == 0; }
+
+		Quaternion Get(size_t i) const;
+		void Set(size_t i, const Quaternion& q);
+
+		float* X() { return mX.data(); }
+		float* Y() { return mY.data(); }
+		float* Z() { return mZ.data(); }
+		float* W() { return mW.data(); }
+		const float* X() const { return mX.data(); }
+		const float* Y() const { return mY.data(); }
+		const float* Z() const { return mZ.data(); }
+		const float* W() const { return mW.data(); }
+
+	private:
+		AlignedVector<float> mX;
+		AlignedVector<float> mY;
+		AlignedVector<float> mZ;
+		AlignedVector<float> mW;
+		size_t mCount = 0;
+	};
+
+	// Stream functions ----------------------------------------------------------------------------------------------------
+	// Binary operations require both inputs to have the same size. Outputs are resized to match and may
+	// be one of the inputs.
+
+	void Dot(const Vector3Stream& a, const Vector3Stream& b, float* out); // out holds a.Size() floats
+	void Cross(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out);
+	void Normalize(const Vector3Stream& v, Vector3Stream& out); // Zero length vectors stay zero
+	void Lerp(const Vector3Stream& a, const Vector3Stream& b, float t, Vector3Stream& out);
+
+	void Normalize(const QuaternionStream& q, QuaternionStream& out);
+	void Nlerp(const QuaternionStream& a, const QuaternionStream& b, float t, QuaternionStream& out); // Takes the shortest path
+
+	Vector3 Min(const Vector3Stream& v);
+	Vector3 Max(const Vector3Stream& v);
+	void MinMax(const Vector3Stream& v, Vector3& min, Vector3& max); // Empty stream leaves min/max untouched
+}
@@ -0,0 +1,42 @@
+//====================================================================================================
+// Filename:	Sweep.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Continuous collision: a shape moving by displacement over one step against a static target.
+//				Returns the first time of contact as a fraction of the displacement, so a projectile
+//				that would pass through a thin wall between two steps still reports the hit. Shapes that
+//				already overlap at the start report time 0. Touching counts as contact, as in Intersect.
+// Resources:	Christer Ericson, Real-Time Collision Detection, 5.3 (ray vs sphere and cylinder), 5.5
+//				(moving sphere vs plane, triangle and box, moving AABBs)
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	struct SweepHit
+	{
+		Vector3 point;	// On the target at the time of contact
+		Vector3 normal;	// Unit, from the target towards the moving shape
+		float time;		// In [0, 1], the moving shape is at start + displacement * time
+	};
+
+	// plane.n is expected to be unit length. Both sides of the plane are solid.
+	bool Sweep(const Sphere& sphere, const Vector3& displacement, const Plane& plane, SweepHit& hit);
+
+	// Triangles are two sided
+	bool Sweep(const Sphere& sphere, const Vector3& displacement, const Vector3& a, const Vector3& b, const Vector3& c, SweepHit& hit);
+	bool Sweep(const Capsule& capsule, const Vector3& displacement, const Vector3& a, const Vector3& b, const Vector3& c, SweepHit& hit);
+
+	bool Sweep(const AABB& aabb, const Vector3& displacement, const AABB& target, SweepHit& hit);
+	bool Sweep(const Sphere& sphere, const Vector3& displacement, const OBB& obb, SweepHit& hit);
+	bool Sweep(const Sphere& sphere, const Vector3& displacement, const CachedOBB& obb, SweepHit& hit);
+
+	// First hit against a triangle list, three vertices per triangle, or an indexed list with three indices
+	// per triangle. Each hit shortens the sweep, so triangles behind it are rejected by a bounding box and
+	// plane test before any exact test runs. Writes the hit triangle's index when triangle is not null.
+	bool Sweep(const Sphere& sphere, const Vector3& displacement, const Vector3* vertices, size_t triangleCount, SweepHit& hit, uint32_t* triangle = nullptr);
+	bool Sweep(const Sphere& sphere, const Vector3& displacement, const Vector3* vertices, const uint32_t* indices, size_t triangleCount, SweepHit& hit, uint32_t* triangle = nullptr);
+	bool Sweep(const Capsule& capsule, const Vector3& displacement, const Vector3* vertices, size_t triangleCount, SweepHit& hit, uint32_t* triangle = nullptr);
+	bool Sweep(const Capsule& capsule, const Vector3& displacement, const Vector3* vertices, const uint32_t* indices, size_t triangleCount, SweepHit& hit, uint32_t* triangle = nullptr);
+}
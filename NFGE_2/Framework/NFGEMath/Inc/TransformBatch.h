@@ -0,0 +1,28 @@
+//====================================================================================================
+// Filename:	TransformBatch.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Transform many points with one matrix per call. The strided overloads take byte
+//				strides so they can run directly on interleaved vertex buffers; strides must be a
+//				multiple of 4. in and out may point to the same memory.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	struct Matrix4;
+	struct Vector3;
+
+	// Same as TransformCoord, including the divide by w
+	void TransformCoordBatch(const Vector3* in, Vector3* out, size_t count, const Matrix4& m);
+	void TransformCoordBatch(const void* in, size_t inStride, void* out, size_t outStride, size_t count, const Matrix4& m);
+
+	// Same as TransformNormal, translation is ignored
+	void TransformNormalBatch(const Vector3* in, Vector3* out, size_t count, const Matrix4& m);
+	void TransformNormalBatch(const void* in, size_t inStride, void* out, size_t outStride, size_t count, const Matrix4& m);
+
+	// TransformCoord for matrices whose last column is (0, 0, 0, 1), skips the divide by w
+	void TransformAffineBatch(const Vector3* in, Vector3* out, size_t count, const Matrix4& m);
+	void TransformAffineBatch(const void* in, size_t inStride, void* out, size_t outStride, size_t count, const Matrix4& m);
+}
@@ -0,0 +1,77 @@
+//====================================================================================================
+// Filename:	TransformTRS.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Translation, rotation and scale kept as separate parts. Points are scaled, then rotated,
+//				then translated, which matches the row vector matrix Scaling * Rotation * Translation.
+//				Composition and conversion work on the parts directly, no intermediate matrices.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	struct TransformTRS
+	{
+		Vector3 translation{ 0.0f, 0.0f, 0.0f };
+		Quaternion rotation;
+		Vector3 scale{ 1.0f, 1.0f, 1.0f };
+
+		TransformTRS() = default;
+		TransformTRS(const Vector3& translation, const Quaternion& rotation, const Vector3& scale = Vector3(1.0f, 1.0f, 1.0f))
+			: translation(translation), rotation(rotation), scale(scale)
+		{}
+	};
+
+	inline Vector3 Rotate(const Vector3& v, const Quaternion& q)
+	{
+		// v + 2w(u x v) + 2u x (u x v), u = q.xyz
+		const Vector3 u(q.x, q.y, q.z);
+		const Vector3 t = Cross(u, v) * 2.0f;
+		return v + t * q.w + Cross(u, t);
+	}
+
+	inline Vector3 TransformPoint(const TransformTRS& transform, const Vector3& point)
+	{
+		return Rotate(Vector3(point.x * transform.scale.x, point.y * transform.scale.y, point.z * transform.scale.z), transform.rotation) + transform.translation;
+	}
+
+	// Scale and rotation only
+	inline Vector3 TransformDirection(const TransformTRS& transform, const Vector3& direction)
+	{
+		return Rotate(Vector3(direction.x * transform.scale.x, direction.y * transform.scale.y, direction.z * transform.scale.z), transform.rotation);
+	}
+
+	// Exact for any scale, unlike TransformPoint(Inverse(transform), point)
+	inline Vector3 InverseTransformPoint(const TransformTRS& transform, const Vector3& point)
+	{
+		const Quaternion& q = transform.rotation;
+		const Vector3 local = Rotate(point - transform.translation, Quaternion(-q.x, -q.y, -q.z, q.w));
+		return Vector3(local.x / transform.scale.x, local.y / transform.scale.y, local.z / transform.scale.z);
+	}
+
+	// local * parent applies local first, the same order as multiplying the matrices. Scales multiply per
+	// axis, so the result is exact when the parent scale is uniform or the local rotation is identity,
+	// otherwise the shear a matrix product would produce is dropped.
+	TransformTRS operator*(const TransformTRS& local, const TransformTRS& parent);
+
+	// Exact for uniform scale, see InverseTransformPoint for non-uniform scale
+	TransformTRS Inverse(const TransformTRS& transform);
+
+	Matrix4 ToMatrix(const TransformTRS& transform);
+
+	// 12 floats in the QuaternionToMatrix3x4Batch layout, the translation in the 4th float of each row
+	void ToMatrix3x4(const TransformTRS& transform, float* out);
+	Matrix3x4 ToMatrix3x4(const TransformTRS& transform);
+
+	void TransformTRSToMatrixBatch(const TransformTRS* transforms, Matrix4* out, size_t count);
+	void TransformTRSToMatrix3x4Batch(const TransformTRS* transforms, float* out, size_t count);
+	void TransformTRSToMatrix3x4Batch(const TransformTRS* transforms, Matrix3x4* out, size_t count);
+
+	// World transforms for a flattened hierarchy. parents[i] is the index of node i's parent or
+	// kNoParent for a root, and every parent must come before its children. world may not alias local.
+	constexpr uint32_t kNoParent = 0xFFFFFFFFu;
+	void UpdateHierarchy(const TransformTRS* local, const uint32_t* parents, TransformTRS* world, size_t count);
+	void UpdateHierarchy(const TransformTRS* local, const uint32_t* parents, TransformTRS* world, Matrix4* worldMatrices, size_t count);
+	void UpdateHierarchy(const TransformTRS* local, const uint32_t* parents, TransformTRS* world, Matrix3x4* worldMatrices, size_t count);
+}
@@ -0,0 +1,118 @@
+//====================================================================================================
+// Filename:	TweenPool.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Container that advances many tweens at once. Tweens are grouped by value type and ease
+//				curve, and each group keeps its fields in separate arrays, so an update is a few tight
+//				loops per group with the curve inlined instead of one EaseMachine call per tween.
+//				Handles carry a generation and go stale when their tween finishes or is stopped.
+//====================================================================================================
+
+#pragma once
+
+namespace NFGE::Math
+{
+	enum class EaseType : uint8_t
+	{
+		None,
+		InSine, OutSine, InOutSine,
+		InQuad, OutQuad, InOutQuad,
+		InCubic, OutCubic, InOutCubic,
+		InQuart, OutQuart, InOutQuart,
+		InQuint, OutQuint, InOutQuint,
+		InExpo, OutExpo, InOutExpo,
+		InCirc, OutCirc, InOutCirc,
+		InBack, OutBack, InOutBack,
+		InElastic, OutElastic, InOutElastic,
+		InBounce, OutBounce, InOutBounce,
+		OutMushroom,
+		Count
+	};
+
+	// The Ease:: function for the type, for EaseMachine::funcPtr
+	float(*GetEaseFunction(EaseType type))(float);
+
+	struct TweenHandle
+	{
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		bool operator==(const TweenHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const TweenHandle& other) const { return !(*this == other); }
+	};
+
+	class TweenPool
+	{
+	public:
+		// Tweens target from 'from' to 'to' over duration seconds after waiting delay seconds. Every Update
+		// writes the current value through the reference, including while the delay runs, so the target
+		// has to stay at the same address until the tween finishes or is stopped. Quaternions use
+		// SlerpBatch, the other types Lerp component wise, and the Back and Elastic curves carry both past
+		// the end values. Use Vector4 for Graphics::Color.
+		TweenHandle Add(float& target, float from, float to, float duration, EaseType ease = EaseType::None, float delay = 0.0f);
+		TweenHandle Add(Vector2& target, const Vector2& from, const Vector2& to, float duration, EaseType ease = EaseType::None, float delay = 0.0f);
+		TweenHandle Add(Vector3& target, const Vector3& from, const Vector3& to, float duration, EaseType ease = EaseType::None, float delay = 0.0f);
+		TweenHandle Add(Vector4& target, const Vector4& from, const Vector4& to, float duration, EaseType ease = EaseType::None, float delay = 0.0f);
+		TweenHandle Add(Quaternion& target, const Quaternion& from, const Quaternion& to, float duration, EaseType ease = EaseType::None, float delay = 0.0f);
+
+		// Removes the tween without writing its end value. Returns false for stale handles.
+		bool Stop(TweenHandle handle);
+		bool IsActive(TweenHandle handle) const;
+		void Clear();
+
+		size_t GetActiveCount() const { return mActiveCount; }
+
+		// Advances every tween by deltaTime and writes the targets. Tweens that reached their end value are
+		// removed and their handles returned, the list stays valid until the next Update or Clear.
+		const std::vector<TweenHandle>& Update(float deltaTime);
+
+	private:
+		static constexpr size_t kEaseCount = static_cast<size_t>(EaseType::Count);
+		static constexpr uint8_t kFreeSlot = UINT8_MAX;
+		static constexpr size_t kChunkSize = 256;
+
+		enum ValueType : uint8_t { FloatValue, Vector2Value, Vector3Value, Vector4Value, QuaternionValue };
+
+		template <typename T>
+		struct Group
+		{
+			std::vector<float> elapsed;		// Starts at -delay
+			std::vector<float> invDuration;
+			std::vector<T> from;
+			std::vector<T> to;
+			std::vector<T*> targets;
+			std::vector<uint32_t> slots;	// Back to mSlots, to fix the slot's index when a tween moves
+		};
+
+		// Handle index points here. While the slot is free, index is the next free slot.
+		struct Slot
+		{
+			uint32_t index = 0;
+			uint32_t generation = 1;
+			uint8_t valueType = kFreeSlot;
+			EaseType ease = EaseType::None;
+		};
+
+		template <typename T>
+		TweenHandle AddTween(std::array<Group<T>, kEaseCount>& groups, ValueType valueType, T& target, const T& from, const T& to, float duration, EaseType ease, float delay);
+		template <typename T>
+		void RemoveTween(Group<T>& group, uint32_t index);
+		template <typename T>
+		void UpdateGroups(std::array<Group<T>, kEaseCount>& groups, float deltaTime);
+
+		uint32_t AllocateSlot();
+		void FreeSlot(uint32_t slot);
+
+		std::array<Group<float>, kEaseCount> mFloats;
+		std::array<Group<Vector2>, kEaseCount> mVector2s;
+		std::array<Group<Vector3>, kEaseCount> mVector3s;
+		std::array<Group<Vector4>, kEaseCount> mVector4s;
+		std::array<Group<Quaternion>, kEaseCount> mQuaternions;
+
+		std::vector<Slot> mSlots;
+		std::vector<TweenHandle> mCompleted;
+		std::vector<uint32_t> mFinished;	// Update scratch, indices of the finished tweens in one group
+		uint32_t mFreeSlot = UINT32_MAX;
+		size_t mActiveCount = 0;
+	};
+}
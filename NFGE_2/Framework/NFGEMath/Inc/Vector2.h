@@ -25,12 +25,12 @@ namespace NFGE {
 			constexpr Vector2 operator+(const Vector2& v) const { return { x + v.x, y + v.y }; }
 			constexpr Vector2 operator-(const Vector2& v) const { return { x - v.x, y - v.y }; }
 			constexpr Vector2 operator*(float s) const { return { x * s, y * s }; }
-			Vector2 operator/(float s) const { return Vector2(x / s, y / s); }
+			constexpr Vector2 operator/(float s) const { return Vector2(x / s, y / s); }
 
-			Vector2& operator+=(const Vector2& v) { x += v.x; y += v.y; return *this; }
-			Vector2& operator-=(const Vector2& v) { x -= v.x; y -= v.y; return *this; }
-			Vector2& operator*=(float s) { x *= s; y *= s; return *this; }
-			Vector2& operator/=(float s) { x /= s; y /= s; return *this; }
+			constexpr Vector2& operator+=(const Vector2& v) { x += v.x; y += v.y; return *this; }
+			constexpr Vector2& operator-=(const Vector2& v) { x -= v.x; y -= v.y; return *this; }
+			constexpr Vector2& operator*=(float s) { x *= s; y *= s; return *this; }
+			constexpr Vector2& operator/=(float s) { x /= s; y /= s; return *this; }
 		};
 
 	} // namespace Math
@@ -21,8 +21,8 @@ namespace NFGE {
 			constexpr Vector3(float f) noexcept : x(f), y(f), z(f) {}
 			constexpr Vector3(float _x, float _y, float _z) noexcept : x(_x), y(_y), z(_z) {}
 
-			static Vector3 Zero() { return Vector3(); }
-			static Vector3 One() { return Vector3(1.0f, 1.0f, 1.0f); }
+			static constexpr Vector3 Zero() { return Vector3(); }
+			static constexpr Vector3 One() { return Vector3(1.0f, 1.0f, 1.0f); }
 
 			const static Vector3 XAxis;
 			const static Vector3 YAxis;
@@ -33,12 +33,12 @@ namespace NFGE {
 			constexpr Vector3 operator-(const Vector3& v) const { return { x - v.x, y - v.y, z - v.z }; }
 			constexpr Vector3 operator*(float s) const { return { x * s, y * s, z * s }; }
 			constexpr bool operator==(const Vector3& v) const { return x == v.x && y == v.y && z == v.z; }
-			Vector3 operator/(float s) const { return Vector3(x / s, y / s, z / s); }
+			constexpr Vector3 operator/(float s) const { return Vector3(x / s, y / s, z / s); }
 
-			Vector3& operator+=(const Vector3& v) { x += v.x; y += v.y; z += v.z; return *this; }
-			Vector3& operator-=(const Vector3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
-			Vector3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
-			Vector3& operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
+			constexpr Vector3& operator+=(const Vector3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+			constexpr Vector3& operator-=(const Vector3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+			constexpr Vector3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+			constexpr Vector3& operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
 		};
 
 	} // namespace Math
@@ -45,12 +45,12 @@ namespace NFGE {
 			constexpr Vector4 operator+(const Vector4& v) const { return { x + v.x, y + v.y, z + v.z, w + v.w }; }				//|TODO:UNITTest
 			constexpr Vector4 operator-(const Vector4& v) const { return { x - v.x, y - v.y, z - v.z, w - v.w }; }				//|TODO:UNITTest
 			constexpr Vector4 operator*(float s) const { return { x * s, y * s, z * s, w * s }; }								//|TODO:UNITTest
-			Vector4 operator/(float s) const { return Vector4(x / s, y / s, z / s, w / s); }									//|TODO:UNITTest
+			constexpr Vector4 operator/(float s) const { return Vector4(x / s, y / s, z / s, w / s); }									//|TODO:UNITTest
 																																//|TODO:UNITTest
-			Vector4& operator+=(const Vector4& v) { x += v.x; y += v.y; z += v.z, w += v.w; return *this; }						//|TODO:UNITTest
-			Vector4& operator-=(const Vector4& v) { x -= v.x; y -= v.y; z -= v.z, w -= v.w; return *this; }						//|TODO:UNITTest
-			Vector4& operator*=(float s) { x *= s; y *= s; z *= s, w *= s; return *this; }										//|TODO:UNITTest
-			Vector4& operator/=(float s) { x /= s; y /= s; z /= s, w /= s; return *this; }										//|TODO:UNITTest
+			constexpr Vector4& operator+=(const Vector4& v) { x += v.x; y += v.y; z += v.z, w += v.w; return *this; }						//|TODO:UNITTest
+			constexpr Vector4& operator-=(const Vector4& v) { x -= v.x; y -= v.y; z -= v.z, w -= v.w; return *this; }						//|TODO:UNITTest
+			constexpr Vector4& operator*=(float s) { x *= s; y *= s; z *= s, w *= s; return *this; }										//|TODO:UNITTest
+			constexpr Vector4& operator/=(float s) { x /= s; y /= s; z /= s, w /= s; return *this; }										//|TODO:UNITTest
 
 			float Length3D() const;
 			float LengthSquard3D() const;
@@ -0,0 +1,536 @@
+//====================================================================================================
+// Filename:	BVH.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+using namespace NFGE::Math;
+
+namespace
+{
+	constexpr uint32_t kBinCount = 16;
+	constexpr uint32_t kMedianSplitDepth = BVH::kMaxDepth / 2;	// Past this depth split at the median so the tree stays within kMaxDepth
+	constexpr uint32_t kParallelThreshold = 4096;				// Smallest subtree worth handing to another thread
+
+	struct Bounds
+	{
+		Vector3 min{ FLT_MAX };
+		Vector3 max{ -FLT_MAX };
+
+		void Grow(const Vector3& p)
+		{
+			min = { Min(min.x, p.x), Min(min.y, p.y), Min(min.z, p.z) };
+			max = { Max(max.x, p.x), Max(max.y, p.y), Max(max.z, p.z) };
+		}
+
+		void Grow(const Bounds& b)
+		{
+			Grow(b.min);
+			Grow(b.max);
+		}
+
+		float HalfArea() const
+		{
+			if (min.x > max.x)
+			{
+				return 0.0f;
+			}
+			const Vector3 d = max - min;
+			return d.x * d.y + d.y * d.z + d.z * d.x;
+		}
+	};
+
+	struct BuildPrimitive
+	{
+		Bounds bounds;
+		Vector3 centroid;
+	};
+
+	struct Bin
+	{
+		Bounds bounds;
+		uint32_t count = 0;
+	};
+
+	class Builder
+	{
+	public:
+		Builder(std::vector<BVH::Node>& nodes, std::vector<uint32_t>& indices, const std::vector<BuildPrimitive>& primitives)
+			: mNodes(nodes)
+			, mIndices(indices)
+			, mPrimitives(primitives)
+		{
+			const uint32_t threads = Max(1u, std::thread::hardware_concurrency());
+			while ((1u << mParallelDepth) < threads)
+			{
+				++mParallelDepth;
+			}
+		}
+
+		uint32_t GetNodeCount() const { return mNodeCount; }
+
+		void Subdivide(uint32_t nodeIndex, uint32_t first, uint32_t count, uint32_t depth)
+		{
+			Bounds bounds, centroidBounds;
+			for (uint32_t i = first; i < first + count; ++i)
+			{
+				const BuildPrimitive& prim = mPrimitives[mIndices[i]];
+				bounds.Grow(prim.bounds);
+				centroidBounds.Grow(prim.centroid);
+			}
+
+			BVH::Node& node = mNodes[nodeIndex];
+			node.bounds = AABB::FromMinMax(bounds.min, bounds.max);
+			if (count <= 1)
+			{
+				MakeLeaf(node, first, count);
+				return;
+			}
+
+			int axis = -1;
+			uint32_t splitBin = 0;
+			float splitCost = FLT_MAX;
+			if (depth < kMedianSplitDepth)
+			{
+				FindSplit(first, count, centroidBounds, axis, splitBin, splitCost);
+			}
+
+			// Splitting costs one extra box test, so only keep a small leaf when SAH finds nothing cheaper
+			const float leafCost = static_cast<float>(count) * bounds.HalfArea();
+			if (count <= BVH::kMaxLeafSize && (axis < 0 || splitCost + bounds.HalfArea() >= leafCost))
+			{
+				MakeLeaf(node, first, count);
+				return;
+			}
+
+			uint32_t leftCount = 0;
+			if (axis >= 0)
+			{
+				const float lo = centroidBounds.min.v[axis];
+				const float scale = kBinCount / (centroidBounds.max.v[axis] - lo);
+				uint32_t* middle = std::partition(&mIndices[first], &mIndices[first] + count, [&](uint32_t i)
+				{
+					return BinIndex(mPrimitives[i].centroid.v[axis], lo, scale) <= splitBin;
+				});
+				leftCount = static_cast<uint32_t>(middle - &mIndices[first]);
+			}
+			if (leftCount == 0 || leftCount == count)
+			{
+				// No usable SAH split (coincident centroids or too deep), fall back to an object median
+				const Vector3 extent = centroidBounds.max - centroidBounds.min;
+				const int medianAxis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z) ? 1 : 2;
+				leftCount = count / 2;
+				std::nth_element(&mIndices[first], &mIndices[first] + leftCount, &mIndices[first] + count, [&](uint32_t a, uint32_t b)
+				{
+					return mPrimitives[a].centroid.v[medianAxis] < mPrimitives[b].centroid.v[medianAxis];
+				});
+			}
+
+			const uint32_t left = mNodeCount.fetch_add(2);
+			node.leftFirst = left;
+			node.count = 0;
+
+			const uint32_t rightFirst = first + leftCount;
+			const uint32_t rightCount = count - leftCount;
+			if (depth < mParallelDepth && Min(leftCount, rightCount) >= kParallelThreshold)
+			{
+				auto task = std::async(std::launch::async, [=]() { Subdivide(left, first, leftCount, depth + 1); });
+				Subdivide(left + 1, rightFirst, rightCount, depth + 1);
+				task.get();
+			}
+			else
+			{
+				Subdivide(left, first, leftCount, depth + 1);
+				Subdivide(left + 1, rightFirst, rightCount, depth + 1);
+			}
+		}
+
+	private:
+		static uint32_t BinIndex(float c, float lo, float scale)
+		{
+			return Min(kBinCount - 1, static_cast<uint32_t>((c - lo) * scale));
+		}
+
+		static void MakeLeaf(BVH::Node& node, uint32_t first, uint32_t count)
+		{
+			node.leftFirst = first;
+			node.count = count;
+		}
+
+		void FindSplit(uint32_t first, uint32_t count, const Bounds& centroidBounds, int& bestAxis, uint32_t& bestBin, float& bestCost) const
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float lo = centroidBounds.min.v[axis];
+				const float hi = centroidBounds.max.v[axis];
+				if (!(hi > lo))
+				{
+					continue;
+				}
+
+				Bin bins[kBinCount];
+				const float scale = kBinCount / (hi - lo);
+				for (uint32_t i = first; i < first + count; ++i)
+				{
+					const BuildPrimitive& prim = mPrimitives[mIndices[i]];
+					Bin& bin = bins[BinIndex(prim.centroid.v[axis], lo, scale)];
+					bin.bounds.Grow(prim.bounds);
+					++bin.count;
+				}
+
+				// Sweep from both ends to get the cost of splitting after each bin
+				float leftArea[kBinCount - 1], rightArea[kBinCount - 1];
+				uint32_t leftCount[kBinCount - 1], rightCount[kBinCount - 1];
+				Bounds leftBounds, rightBounds;
+				uint32_t leftSum = 0, rightSum = 0;
+				for (uint32_t i = 0; i < kBinCount - 1; ++i)
+				{
+					leftBounds.Grow(bins[i].bounds);
+					leftSum += bins[i].count;
+					leftArea[i] = leftBounds.HalfArea();
+					leftCount[i] = leftSum;
+
+					const uint32_t j = kBinCount - 1 - i;
+					rightBounds.Grow(bins[j].bounds);
+					rightSum += bins[j].count;
+					rightArea[j - 1] = rightBounds.HalfArea();
+					rightCount[j - 1] = rightSum;
+				}
+
+				for (uint32_t i = 0; i < kBinCount - 1; ++i)
+				{
+					if (leftCount[i] == 0 || rightCount[i] == 0)
+					{
+						continue;
+					}
+					const float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+					if (cost < bestCost)
+					{
+						bestAxis = axis;
+						bestBin = i;
+						bestCost = cost;
+					}
+				}
+			}
+		}
+
+		std::vector<BVH::Node>& mNodes;
+		std::vector<uint32_t>& mIndices;
+		const std::vector<BuildPrimitive>& mPrimitives;
+		std::atomic<uint32_t> mNodeCount{ 1 };
+		uint32_t mParallelDepth = 0;
+	};
+
+	// Box test shared by all traversals. Rejects boxes entirely behind the ray or beyond maxDistance.
+	inline bool HitNode(const CachedRay& ray, const AABB& bounds, float maxDistance, float& distEntry)
+	{
+		float distExit;
+		if (!Intersect(ray, bounds, distEntry, distExit))
+		{
+			return false;
+		}
+		return distExit >= 0.0f && distEntry <= maxDistance;
+	}
+
+	AABB TriangleBounds(const Vector3& a, const Vector3& b, const Vector3& c)
+	{
+		Bounds bounds;
+		bounds.Grow(a);
+		bounds.Grow(b);
+		bounds.Grow(c);
+		return AABB::FromMinMax(bounds.min, bounds.max);
+	}
+
+	// Visits every node whose box passes nodeTest and hands leaves to leafFunc(first, count)
+	template <typename NodeTest, typename LeafFunc>
+	void Traverse(const std::vector<BVH::Node>& nodes, NodeTest&& nodeTest, LeafFunc&& leafFunc)
+	{
+		if (nodes.empty() || !nodeTest(nodes[0].bounds))
+		{
+			return;
+		}
+
+		uint32_t stack[BVH::kMaxDepth];
+		uint32_t stackSize = 0;
+		uint32_t current = 0;
+		while (true)
+		{
+			const BVH::Node& node = nodes[current];
+			if (node.IsLeaf())
+			{
+				leafFunc(node.leftFirst, node.count);
+			}
+			else
+			{
+				const bool hitLeft = nodeTest(nodes[node.leftFirst].bounds);
+				const bool hitRight = nodeTest(nodes[node.leftFirst + 1].bounds);
+				if (hitLeft || hitRight)
+				{
+					if (hitLeft && hitRight)
+					{
+						stack[stackSize++] = node.leftFirst + 1;
+					}
+					current = hitLeft ? node.leftFirst : node.leftFirst + 1;
+					continue;
+				}
+			}
+			if (stackSize == 0)
+			{
+				return;
+			}
+			current = stack[--stackSize];
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::BVH::Build(const AABB* bounds, size_t count)
+{
+	Clear();
+	if (count == 0)
+	{
+		return;
+	}
+
+	std::vector<AABB> boxes(bounds, bounds + count);
+	BuildNodes(boxes);
+
+	mBoxes.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		mBoxes[i] = boxes[mIndices[i]];
+	}
+}
+
+void NFGE::Math::BVH::Build(const Vector3* vertices, size_t triangleCount)
+{
+	std::vector<uint32_t> indices(triangleCount * 3);
+	std::iota(indices.begin(), indices.end(), 0u);
+	Build(vertices, indices.data(), triangleCount);
+}
+
+void NFGE::Math::BVH::Build(const Vector3* vertices, const uint32_t* indices, size_t triangleCount)
+{
+	Clear();
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	std::vector<AABB> boxes(triangleCount);
+	for (size_t i = 0; i < triangleCount; ++i)
+	{
+		const uint32_t* tri = indices + i * 3;
+		boxes[i] = TriangleBounds(vertices[tri[0]], vertices[tri[1]], vertices[tri[2]]);
+	}
+	BuildNodes(boxes);
+
+	mTriangles.resize(triangleCount);
+	for (size_t i = 0; i < triangleCount; ++i)
+	{
+		const uint32_t* tri = indices + mIndices[i] * 3;
+		mTriangles[i] = { vertices[tri[0]], vertices[tri[1]], vertices[tri[2]] };
+	}
+}
+
+void NFGE::Math::BVH::Clear()
+{
+	mNodes.clear();
+	mIndices.clear();
+	mBoxes.clear();
+	mTriangles.clear();
+}
+
+void NFGE::Math::BVH::BuildNodes(const std::vector<AABB>& bounds)
+{
+	ASSERT(bounds.size() < 0x7fffffff, "[BVH] Too many primitives.");
+	const uint32_t count = static_cast<uint32_t>(bounds.size());
+
+	std::vector<BuildPrimitive> primitives(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		primitives[i].bounds.min = bounds[i].Min();
+		primitives[i].bounds.max = bounds[i].Max();
+		primitives[i].centroid = bounds[i].center;
+	}
+
+	mIndices.resize(count);
+	std::iota(mIndices.begin(), mIndices.end(), 0u);
+
+	// A binary tree with count leaves has at most 2 * count - 1 nodes. Children are allocated in pairs after the root.
+	mNodes.resize(2 * count);
+	Builder builder(mNodes, mIndices, primitives);
+	builder.Subdivide(0, 0, count, 0);
+	mNodes.resize(builder.GetNodeCount());
+	mNodes.shrink_to_fit();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool NFGE::Math::BVH::Raycast(const Ray& ray, RayHit& hit, float maxDistance) const
+{
+	if (mNodes.empty())
+	{
+		return false;
+	}
+
+	const CachedRay cachedRay(ray);
+	float closest = maxDistance;
+	uint32_t closestSlot = 0;
+	bool found = false;
+
+	float distEntry = 0.0f;
+	if (!HitNode(cachedRay, mNodes[0].bounds, closest, distEntry))
+	{
+		return false;
+	}
+
+	// Same loop as Traverse, but children are visited near to far and pruned against the closest hit so far
+	std::pair<uint32_t, float> stack[kMaxDepth];
+	uint32_t stackSize = 0;
+	uint32_t current = 0;
+	while (true)
+	{
+		const Node& node = mNodes[current];
+		if (node.IsLeaf())
+		{
+			for (uint32_t slot = node.leftFirst; slot < node.leftFirst + node.count; ++slot)
+			{
+				float distance = 0.0f;
+				bool hitPrimitive = false;
+				if (mTriangles.empty())
+				{
+					// Entry distance is negative when the origin is inside the box, which reports 0
+					hitPrimitive = HitNode(cachedRay, mBoxes[slot], closest, distance);
+					distance = Max(distance, 0.0f);
+				}
+				else
+				{
+					const Triangle& tri = mTriangles[slot];
+					hitPrimitive = Intersect(ray, tri.a, tri.b, tri.c, distance) && distance <= closest;
+				}
+				if (hitPrimitive && (!found || distance < closest))
+				{
+					closest = distance;
+					closestSlot = slot;
+					found = true;
+				}
+			}
+		}
+		else
+		{
+			uint32_t near = node.leftFirst;
+			uint32_t far = node.leftFirst + 1;
+			float distNear = 0.0f, distFar = 0.0f;
+			bool hitNear = HitNode(cachedRay, mNodes[near].bounds, closest, distNear);
+			bool hitFar = HitNode(cachedRay, mNodes[far].bounds, closest, distFar);
+			if (hitFar && (!hitNear || distFar < distNear))
+			{
+				std::swap(near, far);
+				std::swap(distNear, distFar);
+				std::swap(hitNear, hitFar);
+			}
+			if (hitNear)
+			{
+				if (hitFar)
+				{
+					stack[stackSize++] = { far, distFar };
+				}
+				current = near;
+				continue;
+			}
+		}
+
+		// Pop, skipping nodes that are now further away than the closest hit
+		bool popped = false;
+		while (stackSize > 0)
+		{
+			const auto [index, distance] = stack[--stackSize];
+			if (distance <= closest)
+			{
+				current = index;
+				popped = true;
+				break;
+			}
+		}
+		if (!popped)
+		{
+			break;
+		}
+	}
+
+	if (found)
+	{
+		hit.index = mIndices[closestSlot];
+		hit.distance = closest;
+	}
+	return found;
+}
+
+bool NFGE::Math::BVH::RaycastAny(const Ray& ray, float maxDistance) const
+{
+	const CachedRay cachedRay(ray);
+	bool found = false;
+	float distEntry = 0.0f;
+	Traverse(mNodes,
+		[&](const AABB& bounds) { return !found && HitNode(cachedRay, bounds, maxDistance, distEntry); },
+		[&](uint32_t first, uint32_t count)
+	{
+		for (uint32_t slot = first; slot < first + count && !found; ++slot)
+		{
+			if (mTriangles.empty())
+			{
+				found = HitNode(cachedRay, mBoxes[slot], maxDistance, distEntry);
+			}
+			else
+			{
+				const Triangle& tri = mTriangles[slot];
+				float distance = 0.0f;
+				found = Intersect(ray, tri.a, tri.b, tri.c, distance) && distance <= maxDistance;
+			}
+		}
+	});
+	return found;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::BVH::Query(const AABB& aabb, std::vector<uint32_t>& results) const
+{
+	Traverse(mNodes,
+		[&](const AABB& bounds) { return Intersect(bounds, aabb); },
+		[&](uint32_t first, uint32_t count)
+	{
+		for (uint32_t slot = first; slot < first + count; ++slot)
+		{
+			const AABB bounds = mTriangles.empty() ? mBoxes[slot] : TriangleBounds(mTriangles[slot].a, mTriangles[slot].b, mTriangles[slot].c);
+			if (Intersect(bounds, aabb))
+			{
+				results.push_back(mIndices[slot]);
+			}
+		}
+	});
+}
+
+void NFGE::Math::BVH::Query(const Sphere& sphere, std::vector<uint32_t>& results) const
+{
+	Traverse(mNodes,
+		[&](const AABB& bounds) { return Intersect(sphere, bounds); },
+		[&](uint32_t first, uint32_t count)
+	{
+		for (uint32_t slot = first; slot < first + count; ++slot)
+		{
+			const bool overlap = mTriangles.empty()
+				? Intersect(sphere, mBoxes[slot])
+				: Intersect(sphere, mTriangles[slot].a, mTriangles[slot].b, mTriangles[slot].c);
+			if (overlap)
+			{
+				results.push_back(mIndices[slot]);
+			}
+		}
+	});
+}
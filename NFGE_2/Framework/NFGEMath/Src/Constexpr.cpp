@@ -0,0 +1,96 @@
+//====================================================================================================
+// Filename:	Constexpr.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Compile-time checks for the constexpr parts of the math types. Nothing here runs, a
+//				failing check stops the build.
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+using namespace NFGE::Math;
+
+namespace
+{
+	constexpr bool NearlyEqual(float a, float b, float epsilon = 1e-6f) { return Abs(a - b) <= epsilon; }
+
+	constexpr bool NearlyEqual(const Matrix4& a, const Matrix4& b, float epsilon = 1e-6f)
+	{
+		return NearlyEqual(a._11, b._11, epsilon) && NearlyEqual(a._12, b._12, epsilon) && NearlyEqual(a._13, b._13, epsilon) && NearlyEqual(a._14, b._14, epsilon) &&
+			NearlyEqual(a._21, b._21, epsilon) && NearlyEqual(a._22, b._22, epsilon) && NearlyEqual(a._23, b._23, epsilon) && NearlyEqual(a._24, b._24, epsilon) &&
+			NearlyEqual(a._31, b._31, epsilon) && NearlyEqual(a._32, b._32, epsilon) && NearlyEqual(a._33, b._33, epsilon) && NearlyEqual(a._34, b._34, epsilon) &&
+			NearlyEqual(a._41, b._41, epsilon) && NearlyEqual(a._42, b._42, epsilon) && NearlyEqual(a._43, b._43, epsilon) && NearlyEqual(a._44, b._44, epsilon);
+	}
+
+	constexpr bool NearlyEqual(const Vector3& a, const Vector3& b, float epsilon = 1e-6f)
+	{
+		return NearlyEqual(a.x, b.x, epsilon) && NearlyEqual(a.y, b.y, epsilon) && NearlyEqual(a.z, b.z, epsilon);
+	}
+
+	// Copies must stay memcpy-able for the batch and stream functions
+	static_assert(std::is_trivially_copyable_v<Vector2>);
+	static_assert(std::is_trivially_copyable_v<Vector3>);
+	static_assert(std::is_trivially_copyable_v<Vector4>);
+	static_assert(std::is_trivially_copyable_v<Quaternion>);
+	static_assert(std::is_trivially_copyable_v<Matrix3>);
+	static_assert(std::is_trivially_copyable_v<Matrix4>);
+	static_assert(std::is_trivially_default_constructible_v<Matrix4>);
+	static_assert(sizeof(Matrix4) == 16 * sizeof(float));
+	static_assert(std::is_trivially_copyable_v<Matrix3x4>);
+	static_assert(sizeof(Matrix3x4) == 12 * sizeof(float));
+
+	// Factories and comparison
+	static_assert(Matrix4::sIdentity().IsIdentity());
+	static_assert(Matrix4::sZero() == Matrix4::sIdentity() * 0.0f);
+	static_assert(Matrix4::sTranslation(Vector3(1.0f, 2.0f, 3.0f)) == Translation(1.0f, 2.0f, 3.0f));
+	static_assert(Matrix4::sScaling(2.0f) == Matrix4::sScaling(Vector3(2.0f, 2.0f, 2.0f)));
+	static_assert(Determinant(Matrix3::Translation(4.0f, 5.0f) * Matrix3::Scaling(Vector2(2.0f, 3.0f))) == 6.0f);
+	static_assert(Transpose(Transpose(Matrix4::sTranslation(1.0f, 2.0f, 3.0f))) == Matrix4::sTranslation(1.0f, 2.0f, 3.0f));
+
+	// Transforms evaluated at compile time
+	constexpr Matrix4 kWorld = Constexpr::Multiply(Matrix4::sScaling(2.0f), Matrix4::sTranslation(1.0f, 2.0f, 3.0f));
+	static_assert(NearlyEqual(TransformCoord(Vector3(1.0f, 1.0f, 1.0f), kWorld), Vector3(3.0f, 4.0f, 5.0f)));
+	static_assert(NearlyEqual(TransformNormal(Vector3(1.0f, 0.0f, 0.0f), kWorld), Vector3(2.0f, 0.0f, 0.0f)));
+	static_assert(NearlyEqual(Constexpr::Multiply(kWorld, InverseAffine(kWorld)), Matrix4::sIdentity()));
+	static_assert(NearlyEqual(Constexpr::Multiply(kWorld, Inverse(kWorld)), Matrix4::sIdentity()));
+	static_assert(NearlyEqual(Determinant(kWorld), 8.0f));
+
+	constexpr Matrix4 kParent = Constexpr::Multiply(Constexpr::MatrixRotationZ(0.5f), Matrix4::sTranslation(-4.0f, 0.0f, 1.0f));
+	static_assert(ToMatrix4(ToMatrix3x4(kWorld)) == kWorld);
+	static_assert(NearlyEqual(ToMatrix4(ToMatrix3x4(kWorld) * ToMatrix3x4(kParent)), Constexpr::Multiply(kWorld, kParent)));
+	static_assert(NearlyEqual(TransformCoord(Vector3(1.0f, -2.0f, 0.5f), ToMatrix3x4(kParent)), TransformCoord(Vector3(1.0f, -2.0f, 0.5f), kParent)));
+	static_assert(NearlyEqual(ToMatrix4(ToMatrix3x4(kParent) * Inverse(ToMatrix3x4(kParent))), Matrix4::sIdentity()));
+	static_assert(NearlyEqual(Determinant(ToMatrix3x4(kWorld)), 8.0f));
+
+	// Trigonometry and rotations
+	static_assert(NearlyEqual(Constexpr::Sin(0.5f), 0.4794255386f));
+	static_assert(NearlyEqual(Constexpr::Cos(0.5f), 0.8775825619f));
+	static_assert(NearlyEqual(Constexpr::Sin(-100.0f), 0.5063656411f));
+	static_assert(NearlyEqual(Constexpr::Sqrt(2.0f), 1.4142135624f));
+	static_assert(Constexpr::Sqrt(0.0f) == 0.0f && Constexpr::Sqrt(4.0f) == 2.0f);
+	static_assert(Constexpr::Sqrt(FLT_MAX) == 0x1.fffffep+63f);
+	static_assert(Constexpr::Sqrt(3e38f) == 0x1.e0bd9cp+63f);
+	static_assert(Constexpr::Sqrt(FLT_MIN) == 0x1p-63f);
+	static_assert(Constexpr::Sqrt(1e-38f) == 0x1.d83c94p-64f);
+	static_assert(Constexpr::Sqrt(0x1p-149f) == 0x1.6a09e6p-75f); // Smallest denormal
+
+	constexpr float kQuarterTurn = Constants::Pi * 0.5f;
+	static_assert(NearlyEqual(TransformNormal(Vector3(1.0f, 0.0f, 0.0f), Constexpr::MatrixRotationZ(kQuarterTurn)), Vector3(0.0f, 1.0f, 0.0f)));
+	static_assert(NearlyEqual(TransformNormal(Vector3(0.0f, 1.0f, 0.0f), Constexpr::MatrixRotationX(kQuarterTurn)), Vector3(0.0f, 0.0f, 1.0f)));
+	static_assert(NearlyEqual(TransformNormal(Vector3(0.0f, 0.0f, 1.0f), Constexpr::MatrixRotationY(kQuarterTurn)), Vector3(1.0f, 0.0f, 0.0f)));
+	static_assert(NearlyEqual(MatrixRotationQuaternion(Constexpr::QuaternionRotationAxis(Vector3(0.0f, 0.0f, 2.0f), kQuarterTurn)), Constexpr::MatrixRotationZ(kQuarterTurn)));
+
+	// A compile-time rotation table
+	template <size_t N>
+	constexpr std::array<Matrix4, N> MakeRotationTableY()
+	{
+		std::array<Matrix4, N> table{};
+		for (size_t i = 0; i < N; ++i)
+			table[i] = Constexpr::MatrixRotationY(Constants::TwoPi * static_cast<float>(i) / static_cast<float>(N));
+		return table;
+	}
+	constexpr auto kRotationTable = MakeRotationTableY<8>();
+	static_assert(NearlyEqual(Constexpr::Multiply(kRotationTable[1], kRotationTable[1]), kRotationTable[2]));
+	static_assert(NearlyEqual(Constexpr::Multiply(kRotationTable[4], kRotationTable[4]), kRotationTable[0]));
+}
@@ -0,0 +1,508 @@
+//====================================================================================================
+// Filename:	DynamicAABBTree.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+using namespace NFGE::Math;
+
+namespace
+{
+	AABB Union(const AABB& a, const AABB& b)
+	{
+		const Vector3 aMin = a.Min(), aMax = a.Max();
+		const Vector3 bMin = b.Min(), bMax = b.Max();
+		return AABB::FromMinMax(
+			{ Min(aMin.x, bMin.x), Min(aMin.y, bMin.y), Min(aMin.z, bMin.z) },
+			{ Max(aMax.x, bMax.x), Max(aMax.y, bMax.y), Max(aMax.z, bMax.z) });
+	}
+
+	bool Contains(const AABB& outer, const AABB& inner, float tolerance = 0.0f)
+	{
+		const Vector3 d = inner.center - outer.center;
+		return Abs(d.x) + inner.extend.x <= outer.extend.x + tolerance
+			&& Abs(d.y) + inner.extend.y <= outer.extend.y + tolerance
+			&& Abs(d.z) + inner.extend.z <= outer.extend.z + tolerance;
+	}
+
+	// Surface area up to a constant factor, the insert heuristic only compares areas
+	float Area(const AABB& aabb)
+	{
+		const Vector3& e = aabb.extend;
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+
+	// Area(Union(a, b)) without building the box
+	float UnionArea(const AABB& a, const AABB& b)
+	{
+		const Vector3 d = a.center - b.center;
+		const float ex = (Abs(d.x) + a.extend.x + b.extend.x) * 0.5f;
+		const float ey = (Abs(d.y) + a.extend.y + b.extend.y) * 0.5f;
+		const float ez = (Abs(d.z) + a.extend.z + b.extend.z) * 0.5f;
+		return Max(ex, Max(a.extend.x, b.extend.x)) * Max(ey, Max(a.extend.y, b.extend.y))
+			+ Max(ey, Max(a.extend.y, b.extend.y)) * Max(ez, Max(a.extend.z, b.extend.z))
+			+ Max(ez, Max(a.extend.z, b.extend.z)) * Max(ex, Max(a.extend.x, b.extend.x));
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+NFGE::Math::DynamicAABBTree::DynamicAABBTree(float margin, float displacementMultiplier)
+	: mMargin(margin)
+	, mDisplacementMultiplier(displacementMultiplier)
+{
+}
+
+int32_t NFGE::Math::DynamicAABBTree::CreateProxy(const AABB& aabb, uint32_t userData)
+{
+	const int32_t proxyId = AllocateNode();
+	Node& node = mNodes[proxyId];
+	node.aabb = AABB(aabb.center, aabb.extend + Vector3(mMargin));
+	node.userData = userData;
+	node.height = 0;
+	node.moved = true;
+
+	InsertLeaf(proxyId);
+	mMoveBuffer.push_back(proxyId);
+	++mProxyCount;
+	return proxyId;
+}
+
+void NFGE::Math::DynamicAABBTree::DestroyProxy(int32_t proxyId)
+{
+	ASSERT(0 <= proxyId && proxyId < static_cast<int32_t>(mNodes.size()) && mNodes[proxyId].IsLeaf() && mNodes[proxyId].height == 0, "[DynamicAABBTree] Invalid proxy.");
+
+	if (mNodes[proxyId].moved)
+	{
+		std::replace(mMoveBuffer.begin(), mMoveBuffer.end(), proxyId, kNullNode);
+	}
+	RemoveLeaf(proxyId);
+	FreeNode(proxyId);
+	--mProxyCount;
+}
+
+bool NFGE::Math::DynamicAABBTree::MoveProxy(int32_t proxyId, const AABB& aabb, const Vector3& displacement)
+{
+	ASSERT(0 <= proxyId && proxyId < static_cast<int32_t>(mNodes.size()) && mNodes[proxyId].IsLeaf() && mNodes[proxyId].height == 0, "[DynamicAABBTree] Invalid proxy.");
+
+	Node& node = mNodes[proxyId];
+	if (Contains(node.aabb, aabb))
+	{
+		// Still inside the fat box, but shrink it if it has become much larger than needed
+		const AABB hugeAABB(aabb.center, aabb.extend + Vector3(mMargin * 4.0f));
+		if (Contains(hugeAABB, node.aabb))
+		{
+			return false;
+		}
+	}
+
+	// Fatten, then stretch towards the predicted movement
+	Vector3 fatMin = aabb.Min() - Vector3(mMargin);
+	Vector3 fatMax = aabb.Max() + Vector3(mMargin);
+	const Vector3 d = displacement * mDisplacementMultiplier;
+	for (int i = 0; i < 3; ++i)
+	{
+		if (d.v[i] < 0.0f)
+		{
+			fatMin.v[i] += d.v[i];
+		}
+		else
+		{
+			fatMax.v[i] += d.v[i];
+		}
+	}
+
+	RemoveLeaf(proxyId);
+	node.aabb = AABB::FromMinMax(fatMin, fatMax);
+	if (!node.moved)
+	{
+		node.moved = true;
+		mMoveBuffer.push_back(proxyId);
+	}
+	InsertLeaf(proxyId); // May grow the node pool, node is not valid past this point
+	return true;
+}
+
+void NFGE::Math::DynamicAABBTree::Clear()
+{
+	mNodes.clear();
+	mMoveBuffer.clear();
+	mRoot = kNullNode;
+	mFreeList = kNullNode;
+	mProxyCount = 0;
+}
+
+const AABB& NFGE::Math::DynamicAABBTree::GetFatAABB(int32_t proxyId) const
+{
+	ASSERT(0 <= proxyId && proxyId < static_cast<int32_t>(mNodes.size()), "[DynamicAABBTree] Invalid proxy.");
+	return mNodes[proxyId].aabb;
+}
+
+uint32_t NFGE::Math::DynamicAABBTree::GetUserData(int32_t proxyId) const
+{
+	ASSERT(0 <= proxyId && proxyId < static_cast<int32_t>(mNodes.size()), "[DynamicAABBTree] Invalid proxy.");
+	return mNodes[proxyId].userData;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::DynamicAABBTree::Query(const AABB& aabb, std::vector<int32_t>& results) const
+{
+	Query(aabb, [&results](int32_t proxyId)
+	{
+		results.push_back(proxyId);
+		return true;
+	});
+}
+
+void NFGE::Math::DynamicAABBTree::UpdatePairs(std::vector<Pair>& pairs)
+{
+	pairs.clear();
+	for (const int32_t queryId : mMoveBuffer)
+	{
+		if (queryId == kNullNode)
+		{
+			continue;
+		}
+
+		Query(mNodes[queryId].aabb, [&](int32_t proxyId)
+		{
+			// When both proxies moved the pair is reported from the lower id only
+			if (proxyId == queryId || (mNodes[proxyId].moved && proxyId < queryId))
+			{
+				return true;
+			}
+			pairs.push_back({ Min(queryId, proxyId), Max(queryId, proxyId) });
+			return true;
+		});
+	}
+
+	for (const int32_t proxyId : mMoveBuffer)
+	{
+		if (proxyId != kNullNode)
+		{
+			mNodes[proxyId].moved = false;
+		}
+	}
+	mMoveBuffer.clear();
+
+	std::sort(pairs.begin(), pairs.end());
+	pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+//----------------------------------------------------------------------------------------------------
+
+int32_t NFGE::Math::DynamicAABBTree::AllocateNode()
+{
+	if (mFreeList == kNullNode)
+	{
+		// Grow the pool and thread the new nodes onto the free list
+		const int32_t oldCapacity = static_cast<int32_t>(mNodes.size());
+		const int32_t newCapacity = Max(16, oldCapacity * 2);
+		mNodes.resize(newCapacity);
+		for (int32_t i = oldCapacity; i < newCapacity; ++i)
+		{
+			mNodes[i].parent = (i + 1 < newCapacity) ? i + 1 : kNullNode;
+			mNodes[i].height = -1;
+		}
+		mFreeList = oldCapacity;
+	}
+
+	const int32_t nodeId = mFreeList;
+	Node& node = mNodes[nodeId];
+	mFreeList = node.parent;
+	node = Node();
+	node.height = 0;
+	return nodeId;
+}
+
+void NFGE::Math::DynamicAABBTree::FreeNode(int32_t nodeId)
+{
+	Node& node = mNodes[nodeId];
+	node.parent = mFreeList;
+	node.height = -1;
+	mFreeList = nodeId;
+}
+
+void NFGE::Math::DynamicAABBTree::InsertLeaf(int32_t leaf)
+{
+	if (mRoot == kNullNode)
+	{
+		mRoot = leaf;
+		mNodes[leaf].parent = kNullNode;
+		return;
+	}
+
+	// Reference: Box2D b2DynamicTree, descend towards the sibling with the lowest surface area cost
+	const AABB leafAABB = mNodes[leaf].aabb;
+	int32_t index = mRoot;
+	while (!mNodes[index].IsLeaf())
+	{
+		const Node& node = mNodes[index];
+		const float area = Area(node.aabb);
+		const float combinedArea = UnionArea(node.aabb, leafAABB);
+
+		// Cost of making a new parent for this node and the leaf, and the minimum cost of pushing the leaf further down
+		const float cost = 2.0f * combinedArea;
+		const float inheritanceCost = 2.0f * (combinedArea - area);
+
+		auto descendCost = [&](int32_t child)
+		{
+			const Node& c = mNodes[child];
+			const float newArea = UnionArea(leafAABB, c.aabb);
+			return (c.IsLeaf() ? newArea : newArea - Area(c.aabb)) + inheritanceCost;
+		};
+		const float cost1 = descendCost(node.child1);
+		const float cost2 = descendCost(node.child2);
+
+		if (cost < cost1 && cost < cost2)
+		{
+			break;
+		}
+		index = (cost1 < cost2) ? node.child1 : node.child2;
+	}
+	const int32_t sibling = index;
+
+	// Create a new parent in place of the sibling
+	const int32_t oldParent = mNodes[sibling].parent;
+	const int32_t newParent = AllocateNode();
+	{
+		Node& parent = mNodes[newParent];
+		parent.parent = oldParent;
+		parent.aabb = Union(leafAABB, mNodes[sibling].aabb);
+		parent.height = mNodes[sibling].height + 1;
+		parent.child1 = sibling;
+		parent.child2 = leaf;
+	}
+	if (oldParent != kNullNode)
+	{
+		Node& p = mNodes[oldParent];
+		(p.child1 == sibling ? p.child1 : p.child2) = newParent;
+	}
+	else
+	{
+		mRoot = newParent;
+	}
+	mNodes[sibling].parent = newParent;
+	mNodes[leaf].parent = newParent;
+
+	// Walk back up fixing heights and boxes
+	index = mNodes[leaf].parent;
+	while (index != kNullNode)
+	{
+		index = Balance(index, true);
+		Node& node = mNodes[index];
+		node.height = 1 + Max(mNodes[node.child1].height, mNodes[node.child2].height);
+		node.aabb = Union(mNodes[node.child1].aabb, mNodes[node.child2].aabb);
+		index = node.parent;
+	}
+}
+
+void NFGE::Math::DynamicAABBTree::RemoveLeaf(int32_t leaf)
+{
+	if (leaf == mRoot)
+	{
+		mRoot = kNullNode;
+		return;
+	}
+
+	const int32_t parent = mNodes[leaf].parent;
+	const int32_t grandParent = mNodes[parent].parent;
+	const int32_t sibling = (mNodes[parent].child1 == leaf) ? mNodes[parent].child2 : mNodes[parent].child1;
+
+	if (grandParent == kNullNode)
+	{
+		mRoot = sibling;
+		mNodes[sibling].parent = kNullNode;
+		FreeNode(parent);
+		return;
+	}
+
+	// Splice the sibling into the parent's place
+	Node& g = mNodes[grandParent];
+	(g.child1 == parent ? g.child1 : g.child2) = sibling;
+	mNodes[sibling].parent = grandParent;
+	FreeNode(parent);
+
+	// Only refit on the way up, area rotations happen when the leaf is inserted again
+	int32_t index = grandParent;
+	while (index != kNullNode)
+	{
+		index = Balance(index, false);
+		Node& node = mNodes[index];
+		node.aabb = Union(mNodes[node.child1].aabb, mNodes[node.child2].aabb);
+		node.height = 1 + Max(mNodes[node.child1].height, mNodes[node.child2].height);
+		index = node.parent;
+	}
+}
+
+// Rotates the subtree at iA to reduce its surface area, or to shorten it when the heights of its children
+// drift too far apart. Returns the subtree's new root.
+int32_t NFGE::Math::DynamicAABBTree::Balance(int32_t iA, bool rotateForArea)
+{
+	Node& A = mNodes[iA];
+	if (A.IsLeaf() || A.height < 2)
+	{
+		return iA;
+	}
+
+	const int32_t iB = A.child1;
+	const int32_t iC = A.child2;
+	Node& B = mNodes[iB];
+	Node& C = mNodes[iC];
+	const int32_t balance = C.height - B.height;
+	if (-kMaxImbalance <= balance && balance <= kMaxImbalance)
+	{
+		if (rotateForArea)
+		{
+			RotateForArea(iA);
+		}
+		return iA;
+	}
+
+	// Rotate the taller child up, its taller child stays attached to it and the other moves under iA
+	auto rotate = [&](int32_t iUp, Node& up, const Node& other, bool upIsChild2)
+	{
+		const int32_t iF = up.child1;
+		const int32_t iG = up.child2;
+		Node& F = mNodes[iF];
+		Node& G = mNodes[iG];
+
+		up.child1 = iA;
+		up.parent = A.parent;
+		A.parent = iUp;
+
+		if (up.parent != kNullNode)
+		{
+			Node& p = mNodes[up.parent];
+			(p.child1 == iA ? p.child1 : p.child2) = iUp;
+		}
+		else
+		{
+			mRoot = iUp;
+		}
+
+		const bool keepF = F.height > G.height;
+		const int32_t iKeep = keepF ? iF : iG;
+		const int32_t iMove = keepF ? iG : iF;
+		Node& keep = mNodes[iKeep];
+		Node& move = mNodes[iMove];
+
+		up.child2 = iKeep;
+		(upIsChild2 ? A.child2 : A.child1) = iMove;
+		move.parent = iA;
+		A.aabb = Union(other.aabb, move.aabb);
+		up.aabb = Union(A.aabb, keep.aabb);
+		A.height = 1 + Max(other.height, move.height);
+		up.height = 1 + Max(A.height, keep.height);
+		return iUp;
+	};
+
+	return (balance > 0) ? rotate(iC, C, B, true) : rotate(iB, B, C, false);
+}
+
+// Reference: Box2D v3 b2RotateNodes. Tries swapping one child of iA with a grandchild under the other child
+// and applies the swap that shrinks that child's box the most. iA's own box does not change.
+void NFGE::Math::DynamicAABBTree::RotateForArea(int32_t iA)
+{
+	const Node& A = mNodes[iA];
+	const int32_t iB = A.child1;
+	const int32_t iC = A.child2;
+	const Node& B = mNodes[iB];
+	const Node& C = mNodes[iC];
+
+	int32_t bestDown = kNullNode, bestPivot = kNullNode, bestUp = kNullNode;
+	float bestCost = 0.0f;
+	auto consider = [&](int32_t iDown, const Node& down, int32_t iPivot, const Node& pivot)
+	{
+		if (pivot.IsLeaf())
+		{
+			return;
+		}
+		// Moving down under pivot in place of one grandchild leaves pivot covering down and the other grandchild
+		const float pivotArea = Area(pivot.aabb);
+		const int32_t grandChildren[2] = { pivot.child1, pivot.child2 };
+		for (int i = 0; i < 2; ++i)
+		{
+			const float cost = UnionArea(down.aabb, mNodes[grandChildren[1 - i]].aabb) - pivotArea;
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestDown = iDown;
+				bestPivot = iPivot;
+				bestUp = grandChildren[i];
+			}
+		}
+	};
+	consider(iB, B, iC, C);
+	consider(iC, C, iB, B);
+	if (bestDown == kNullNode)
+	{
+		return;
+	}
+
+	Node& a = mNodes[iA];
+	Node& down = mNodes[bestDown];
+	Node& pivot = mNodes[bestPivot];
+	Node& up = mNodes[bestUp];
+	(a.child1 == bestDown ? a.child1 : a.child2) = bestUp;
+	up.parent = iA;
+	(pivot.child1 == bestUp ? pivot.child1 : pivot.child2) = bestDown;
+	down.parent = bestPivot;
+
+	pivot.aabb = Union(mNodes[pivot.child1].aabb, mNodes[pivot.child2].aabb);
+	pivot.height = 1 + Max(mNodes[pivot.child1].height, mNodes[pivot.child2].height);
+	a.height = 1 + Max(mNodes[a.child1].height, mNodes[a.child2].height);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool NFGE::Math::DynamicAABBTree::Validate() const
+{
+	if (mRoot == kNullNode)
+	{
+		return mProxyCount == 0;
+	}
+	if (mNodes[mRoot].parent != kNullNode)
+	{
+		return false;
+	}
+	const int32_t leafCount = ValidateNode(mRoot);
+	const bool valid = leafCount >= 0 && static_cast<size_t>(leafCount) == mProxyCount;
+	ASSERT(valid, "[DynamicAABBTree] Tree is corrupt.");
+	return valid;
+}
+
+// Returns the number of leaves under nodeId, or -1 if the subtree is inconsistent
+int32_t NFGE::Math::DynamicAABBTree::ValidateNode(int32_t nodeId) const
+{
+	const Node& node = mNodes[nodeId];
+	if (node.IsLeaf())
+	{
+		return node.height == 0 ? 1 : -1;
+	}
+
+	const Node& c1 = mNodes[node.child1];
+	const Node& c2 = mNodes[node.child2];
+	if (c1.parent != nodeId || c2.parent != nodeId)
+	{
+		return -1;
+	}
+	if (node.height != 1 + Max(c1.height, c2.height))
+	{
+		return -1;
+	}
+	// Center/extend round trips through FromMinMax can lose an ulp or so
+	const float tolerance = 1e-4f * (1.0f + Abs(node.aabb.center.x) + Abs(node.aabb.center.y) + Abs(node.aabb.center.z) + node.aabb.extend.x + node.aabb.extend.y + node.aabb.extend.z);
+	if (!Contains(node.aabb, c1.aabb, tolerance) || !Contains(node.aabb, c2.aabb, tolerance))
+	{
+		return -1;
+	}
+
+	const int32_t count1 = ValidateNode(node.child1);
+	const int32_t count2 = ValidateNode(node.child2);
+	return (count1 < 0 || count2 < 0) ? -1 : count1 + count2;
+}
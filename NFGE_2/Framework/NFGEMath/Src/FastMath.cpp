@@ -0,0 +1,232 @@
+//====================================================================================================
+// Filename:	FastMath.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+using namespace NFGE::Math::Fast::Internal;
+
+namespace
+{
+#if NFGE_SIMD_X86
+	// Same reduction and polynomials as Fast::SinCos
+	NFGE_TARGET_AVX2 void SinCosAVX2(__m256 rad, __m256& sinOut, __m256& cosOut)
+	{
+		const __m256i q = _mm256_cvtps_epi32(_mm256_mul_ps(rad, _mm256_set1_ps(kTwoOverPi)));
+		const __m256 qf = _mm256_cvtepi32_ps(q);
+		__m256 x = _mm256_fnmadd_ps(qf, _mm256_set1_ps(kPiOver2A), rad);
+		x = _mm256_fnmadd_ps(qf, _mm256_set1_ps(kPiOver2B), x);
+		x = _mm256_fnmadd_ps(qf, _mm256_set1_ps(kPiOver2C), x);
+		const __m256 z = _mm256_mul_ps(x, x);
+
+		__m256 ps = _mm256_fmadd_ps(z, _mm256_set1_ps(kSin[2]), _mm256_set1_ps(kSin[1]));
+		ps = _mm256_fmadd_ps(z, ps, _mm256_set1_ps(kSin[0]));
+		const __m256 s = _mm256_fmadd_ps(_mm256_mul_ps(x, z), ps, x);
+
+		__m256 pc = _mm256_fmadd_ps(z, _mm256_set1_ps(kCos[2]), _mm256_set1_ps(kCos[1]));
+		pc = _mm256_fmadd_ps(z, pc, _mm256_set1_ps(kCos[0]));
+		const __m256 c = _mm256_fmadd_ps(_mm256_mul_ps(z, z), pc, _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_set1_ps(1.0f)));
+
+		// Odd quadrants swap sin and cos, then the signs follow the quadrant
+		const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+		const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30));
+		const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+		sinOut = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sinSign);
+		cosOut = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cosSign);
+	}
+
+	NFGE_TARGET_AVX2 __m256 Atan2AVX2(__m256 y, __m256 x)
+	{
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 ax = _mm256_andnot_ps(signMask, x);
+		const __m256 ay = _mm256_andnot_ps(signMask, y);
+		const __m256 mx = _mm256_max_ps(ax, ay);
+		const __m256 mn = _mm256_min_ps(ax, ay);
+		const __m256 a = _mm256_and_ps(_mm256_div_ps(mn, mx), _mm256_cmp_ps(mx, zero, _CMP_GT_OQ));
+		const __m256 s = _mm256_mul_ps(a, a);
+
+		__m256 p = _mm256_fmadd_ps(s, _mm256_set1_ps(kAtan[5]), _mm256_set1_ps(kAtan[4]));
+		p = _mm256_fmadd_ps(s, p, _mm256_set1_ps(kAtan[3]));
+		p = _mm256_fmadd_ps(s, p, _mm256_set1_ps(kAtan[2]));
+		p = _mm256_fmadd_ps(s, p, _mm256_set1_ps(kAtan[1]));
+		p = _mm256_fmadd_ps(s, p, _mm256_set1_ps(kAtan[0]));
+		__m256 r = _mm256_mul_ps(a, p);
+
+		r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(Constants::Pi * 0.5f), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+		r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(Constants::Pi), r), _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+		return _mm256_blendv_ps(r, _mm256_sub_ps(zero, r), _mm256_cmp_ps(y, zero, _CMP_LT_OQ));
+	}
+
+	NFGE_TARGET_AVX2 __m256 AcosAVX2(__m256 x)
+	{
+		x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+		const __m256 a = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+
+		__m256 p = _mm256_fmadd_ps(a, _mm256_set1_ps(kAcos[7]), _mm256_set1_ps(kAcos[6]));
+		for (int i = 5; i >= 0; --i)
+		{
+			p = _mm256_fmadd_ps(a, p, _mm256_set1_ps(kAcos[i]));
+		}
+		const __m256 r = _mm256_mul_ps(_mm256_sqrt_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), a)), p);
+		return _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(Constants::Pi), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+	}
+
+	NFGE_TARGET_AVX2 size_t SinCosAVX2(const float* rad, float* sinOut, float* cosOut, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 s, c;
+			SinCosAVX2(_mm256_loadu_ps(rad + i), s, c);
+			_mm256_storeu_ps(sinOut + i, s);
+			_mm256_storeu_ps(cosOut + i, c);
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2 size_t Atan2AVX2(const float* y, const float* x, float* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			_mm256_storeu_ps(out + i, Atan2AVX2(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2 size_t AcosAVX2(const float* x, float* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			_mm256_storeu_ps(out + i, AcosAVX2(_mm256_loadu_ps(x + i)));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2 size_t NormalizeAVX2(const Vector3* in, Vector3* out, size_t count)
+	{
+		const __m256i index = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+		const __m256i spread0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+		const __m256i spread1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+		const __m256i spread2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const float* src = &in[i].x;
+			const __m256 x = _mm256_i32gather_ps(src + 0, index, 4);
+			const __m256 y = _mm256_i32gather_ps(src + 1, index, 4);
+			const __m256 z = _mm256_i32gather_ps(src + 2, index, 4);
+			const __m256 lengthSqr = _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)));
+
+			// rsqrt plus one Newton step, as Fast::RSqrt
+			const __m256 r = _mm256_rsqrt_ps(lengthSqr);
+			const __m256 halfLengthSqr = _mm256_mul_ps(_mm256_set1_ps(0.5f), lengthSqr);
+			const __m256 inv = _mm256_mul_ps(r, _mm256_fnmadd_ps(_mm256_mul_ps(halfLengthSqr, r), r, _mm256_set1_ps(1.5f)));
+
+			const __m256 v0 = _mm256_loadu_ps(src + 0);
+			const __m256 v1 = _mm256_loadu_ps(src + 8);
+			const __m256 v2 = _mm256_loadu_ps(src + 16);
+			float* dst = &out[i].x;
+			_mm256_storeu_ps(dst + 0, _mm256_mul_ps(v0, _mm256_permutevar8x32_ps(inv, spread0)));
+			_mm256_storeu_ps(dst + 8, _mm256_mul_ps(v1, _mm256_permutevar8x32_ps(inv, spread1)));
+			_mm256_storeu_ps(dst + 16, _mm256_mul_ps(v2, _mm256_permutevar8x32_ps(inv, spread2)));
+		}
+		return i;
+	}
+#endif
+}
+
+Quaternion NFGE::Math::Fast::ToQuaternion(float pitch, float yaw, float roll)
+{
+	float sp, cp, sy, cy, sr, cr;
+	SinCos(pitch * 0.5f, sp, cp);
+	SinCos(yaw * 0.5f, sy, cy);
+	SinCos(roll * 0.5f, sr, cr);
+	return Quaternion
+	(
+		sr * cp * cy - cr * sp * sy,
+		cr * sp * cy + sr * cp * sy,
+		cr * cp * sy - sr * sp * cy,
+		cr * cp * cy + sr * sp * sy
+	);
+}
+
+Vector3 NFGE::Math::Fast::GetEular(const Quaternion& quaternion)
+{
+	const Quaternion& q = quaternion;
+	const float roll = Atan2(2.0f * (q.w * q.x + q.y * q.z), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+	const float pitch = Asin(2.0f * (q.w * q.y - q.z * q.x)); // Acos clamps to [-1, 1]
+	const float yaw = Atan2(2.0f * (q.w * q.z + q.x * q.y), 1.0f - 2.0f * (q.y * q.y + q.z * q.z));
+	return Vector3(pitch, yaw, roll);
+}
+
+Matrix4 NFGE::Math::Fast::MatrixRotation(float xDegrees, float yDegrees, float zDegrees)
+{
+	float sinX, cosX, sinY, cosY, sinZ, cosZ;
+	SinCos(DEG2RAD(xDegrees), sinX, cosX);
+	SinCos(DEG2RAD(yDegrees), sinY, cosY);
+	SinCos(DEG2RAD(zDegrees), sinZ, cosZ);
+	return Matrix4
+	(
+		(cosY * cosZ), -(sinX * sinY * cosZ) + (cosX * sinZ), (cosX * sinY * cosZ) + (sinX * sinZ), 0.0f,
+		-(cosY * sinZ), (sinX * sinY * sinZ) + (cosX * cosZ), -(cosX * sinY * sinZ) + (sinX * cosZ), 0.0f,
+		-(sinY), -(sinX * cosY), (cosX * cosY), 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	);
+}
+
+void NFGE::Math::Fast::SinCos(const float* rad, float* sinOut, float* cosOut, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = SinCosAVX2(rad, sinOut, cosOut, count);
+#endif
+	for (; i < count; ++i)
+		SinCos(rad[i], sinOut[i], cosOut[i]);
+}
+
+void NFGE::Math::Fast::Atan2(const float* y, const float* x, float* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = Atan2AVX2(y, x, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = Atan2(y[i], x[i]);
+}
+
+void NFGE::Math::Fast::Acos(const float* x, float* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = AcosAVX2(x, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = Acos(x[i]);
+}
+
+void NFGE::Math::Fast::Normalize(const Vector3* in, Vector3* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = NormalizeAVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = Fast::Normalize(in[i]);
+}
@@ -0,0 +1,267 @@
+//====================================================================================================
+// Filename:	Frustum.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	// Objects are either boxes (center + extents) or spheres (center + radius)
+	struct CullInput
+	{
+		const float* centerX;
+		const float* centerY;
+		const float* centerZ;
+		const float* extendX; // Sphere radius when isSphere
+		const float* extendY;
+		const float* extendZ;
+		bool isSphere;
+	};
+
+	// Signed distance of the object's furthest point along the plane normal, negative when fully outside
+	inline float PlaneDistance(const Plane& plane, const CullInput& in, size_t i)
+	{
+		const float s = plane.n.x * in.centerX[i] + plane.n.y * in.centerY[i] + plane.n.z * in.centerZ[i] - plane.d;
+		const float r = in.isSphere
+			? in.extendX[i]
+			: Abs(plane.n.x) * in.extendX[i] + Abs(plane.n.y) * in.extendY[i] + Abs(plane.n.z) * in.extendZ[i];
+		return s + r;
+	}
+
+	void CullScalar(const Frustum& frustum, const CullInput& in, size_t begin, size_t end, uint32_t* visibleMask, uint8_t* lastPlane)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			bool visible = true;
+			if (lastPlane && lastPlane[i] < Frustum::PlaneCount && PlaneDistance(frustum.planes[lastPlane[i]], in, i) < 0.0f)
+			{
+				visible = false;
+			}
+			for (uint8_t p = 0; visible && p < Frustum::PlaneCount; ++p)
+			{
+				if (PlaneDistance(frustum.planes[p], in, i) < 0.0f)
+				{
+					visible = false;
+					if (lastPlane)
+					{
+						lastPlane[i] = p;
+					}
+				}
+			}
+			if (visible)
+			{
+				visibleMask[i / 32] |= 1u << (i % 32);
+			}
+		}
+	}
+
+#if NFGE_SIMD_X86
+	NFGE_TARGET_AVX2 inline __m256 PlaneDistanceAVX2(bool isSphere, __m256 pnx, __m256 pny, __m256 pnz, __m256 pax, __m256 pay, __m256 paz, __m256 pd,
+		__m256 cx, __m256 cy, __m256 cz, __m256 ex, __m256 ey, __m256 ez)
+	{
+		__m256 s = _mm256_fmsub_ps(pnx, cx, pd);
+		s = _mm256_fmadd_ps(pny, cy, s);
+		s = _mm256_fmadd_ps(pnz, cz, s);
+		if (isSphere)
+		{
+			return _mm256_add_ps(s, ex);
+		}
+		s = _mm256_fmadd_ps(pax, ex, s);
+		s = _mm256_fmadd_ps(pay, ey, s);
+		return _mm256_fmadd_ps(paz, ez, s);
+	}
+
+	NFGE_TARGET_AVX2 size_t CullAVX2(const Frustum& frustum, const CullInput& in, size_t count, uint32_t* visibleMask, uint8_t* lastPlane)
+	{
+		// Plane components laid out one plane per lane, so the cached plane of each object can be fetched
+		// with a permute. Lanes 6 and 7 are zero planes which never reject.
+		alignas(32) float nx[8] = {}, ny[8] = {}, nz[8] = {}, ax[8] = {}, ay[8] = {}, az[8] = {}, d[8] = {};
+		for (int p = 0; p < Frustum::PlaneCount; ++p)
+		{
+			const Plane& plane = frustum.planes[p];
+			nx[p] = plane.n.x; ny[p] = plane.n.y; nz[p] = plane.n.z;
+			ax[p] = Abs(plane.n.x); ay[p] = Abs(plane.n.y); az[p] = Abs(plane.n.z);
+			d[p] = plane.d;
+		}
+		const __m256 tableNX = _mm256_load_ps(nx), tableNY = _mm256_load_ps(ny), tableNZ = _mm256_load_ps(nz);
+		const __m256 tableAX = _mm256_load_ps(ax), tableAY = _mm256_load_ps(ay), tableAZ = _mm256_load_ps(az);
+		const __m256 tableD = _mm256_load_ps(d);
+		const __m256 zero = _mm256_setzero_ps();
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 cx = _mm256_loadu_ps(in.centerX + i);
+			const __m256 cy = _mm256_loadu_ps(in.centerY + i);
+			const __m256 cz = _mm256_loadu_ps(in.centerZ + i);
+			const __m256 ex = _mm256_loadu_ps(in.extendX + i);
+			const __m256 ey = in.isSphere ? ex : _mm256_loadu_ps(in.extendY + i);
+			const __m256 ez = in.isSphere ? ex : _mm256_loadu_ps(in.extendZ + i);
+
+			__m256 outside = zero;
+			__m256i planeIndex = _mm256_setzero_si256();
+			if (lastPlane)
+			{
+				planeIndex = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(lastPlane + i)));
+				const __m256 dist = PlaneDistanceAVX2(in.isSphere,
+					_mm256_permutevar8x32_ps(tableNX, planeIndex), _mm256_permutevar8x32_ps(tableNY, planeIndex), _mm256_permutevar8x32_ps(tableNZ, planeIndex),
+					_mm256_permutevar8x32_ps(tableAX, planeIndex), _mm256_permutevar8x32_ps(tableAY, planeIndex), _mm256_permutevar8x32_ps(tableAZ, planeIndex),
+					_mm256_permutevar8x32_ps(tableD, planeIndex), cx, cy, cz, ex, ey, ez);
+				outside = _mm256_cmp_ps(dist, zero, _CMP_LT_OQ);
+			}
+
+			if (_mm256_movemask_ps(outside) != 0xFF)
+			{
+				__m256 changed = zero;
+				for (int p = 0; p < Frustum::PlaneCount; ++p)
+				{
+					const __m256 dist = PlaneDistanceAVX2(in.isSphere,
+						_mm256_set1_ps(nx[p]), _mm256_set1_ps(ny[p]), _mm256_set1_ps(nz[p]),
+						_mm256_set1_ps(ax[p]), _mm256_set1_ps(ay[p]), _mm256_set1_ps(az[p]),
+						_mm256_set1_ps(d[p]), cx, cy, cz, ex, ey, ez);
+					const __m256 rejected = _mm256_cmp_ps(dist, zero, _CMP_LT_OQ);
+					const __m256 newlyRejected = _mm256_andnot_ps(outside, rejected);
+					planeIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(planeIndex), _mm256_castsi256_ps(_mm256_set1_epi32(p)), newlyRejected));
+					changed = _mm256_or_ps(changed, newlyRejected);
+					outside = _mm256_or_ps(outside, rejected);
+				}
+
+				if (lastPlane && _mm256_movemask_ps(changed) != 0)
+				{
+					// Narrow the 8 indices to bytes: low byte of each dword within each half, then join the halves
+					const __m256i lowBytes = _mm256_shuffle_epi8(planeIndex, _mm256_setr_epi8(
+						0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+						0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+					const __m128i packed = _mm_unpacklo_epi32(_mm256_castsi256_si128(lowBytes), _mm256_extracti128_si256(lowBytes, 1));
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(lastPlane + i), packed);
+				}
+			}
+
+			const uint32_t visible = ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFF;
+			visibleMask[i / 32] |= visible << (i % 32);
+		}
+		return i;
+	}
+#endif
+
+	void Cull(const Frustum& frustum, const CullInput& in, size_t count, uint32_t* visibleMask, uint8_t* lastPlane)
+	{
+		std::fill(visibleMask, visibleMask + (count + 31) / 32, 0u);
+
+		size_t done = 0;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+		{
+			done = CullAVX2(frustum, in, count, visibleMask, lastPlane);
+		}
+#endif
+		CullScalar(frustum, in, done, count, visibleMask, lastPlane);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+NFGE::Math::Frustum::Frustum(const Matrix4& m)
+{
+	// Reference: Gribb & Hartmann, Fast Extraction of Viewing Frustum Planes from the World-View-Projection
+	// Matrix. With row vectors clip = v * m, so the planes come from the columns of m.
+	const Vector4 c1(m._11, m._21, m._31, m._41);
+	const Vector4 c2(m._12, m._22, m._32, m._42);
+	const Vector4 c3(m._13, m._23, m._33, m._43);
+	const Vector4 c4(m._14, m._24, m._34, m._44);
+
+	const Vector4 equations[PlaneCount] =
+	{
+		c4 + c1,	// Left:	-w <= x
+		c4 - c1,	// Right:	 x <= w
+		c4 + c2,	// Bottom:	-w <= y
+		c4 - c2,	// Top:		 y <= w
+		c3,			// Near:	 0 <= z
+		c4 - c3		// Far:		 z <= w
+	};
+
+	// a x + b y + c z + w >= 0 inside, stored as Dot(n, p) >= d with d = -w, both scaled to a unit normal
+	for (int i = 0; i < PlaneCount; ++i)
+	{
+		const Vector4& e = equations[i];
+		const float invLength = 1.0f / Sqrt(e.x * e.x + e.y * e.y + e.z * e.z);
+		planes[i] = Plane(e.x * invLength, e.y * invLength, e.z * invLength, -e.w * invLength);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool NFGE::Math::Intersect(const Frustum& frustum, const Vector3& point)
+{
+	for (const Plane& plane : frustum.planes)
+	{
+		if (Dot(plane.n, point) < plane.d)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool NFGE::Math::Intersect(const Frustum& frustum, const AABB& aabb)
+{
+	const CullInput in{ &aabb.center.x, &aabb.center.y, &aabb.center.z, &aabb.extend.x, &aabb.extend.y, &aabb.extend.z, false };
+	for (const Plane& plane : frustum.planes)
+	{
+		if (PlaneDistance(plane, in, 0) < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool NFGE::Math::Intersect(const Frustum& frustum, const Sphere& sphere)
+{
+	for (const Plane& plane : frustum.planes)
+	{
+		if (Dot(plane.n, sphere.center) - plane.d + sphere.radius < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::CullAABBs(const Frustum& frustum,
+	const float* centerX, const float* centerY, const float* centerZ,
+	const float* extendX, const float* extendY, const float* extendZ,
+	size_t count, uint32_t* visibleMask, uint8_t* lastPlane)
+{
+	Cull(frustum, { centerX, centerY, centerZ, extendX, extendY, extendZ, false }, count, visibleMask, lastPlane);
+}
+
+void NFGE::Math::CullAABBs(const Frustum& frustum, const Vector3Stream& centers, const Vector3Stream& extends, uint32_t* visibleMask, uint8_t* lastPlane)
+{
+	ASSERT(centers.Size() == extends.Size(), "[Frustum] Center and extend streams must have the same size.");
+	CullAABBs(frustum, centers.X(), centers.Y(), centers.Z(), extends.X(), extends.Y(), extends.Z(), centers.Size(), visibleMask, lastPlane);
+}
+
+void NFGE::Math::CullSpheres(const Frustum& frustum,
+	const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+	size_t count, uint32_t* visibleMask, uint8_t* lastPlane)
+{
+	Cull(frustum, { centerX, centerY, centerZ, radius, radius, radius, true }, count, visibleMask, lastPlane);
+}
+
+void NFGE::Math::CullSpheres(const Frustum& frustum, const Vector3Stream& centers, const float* radius, uint32_t* visibleMask, uint8_t* lastPlane)
+{
+	CullSpheres(frustum, centers.X(), centers.Y(), centers.Z(), radius, centers.Size(), visibleMask, lastPlane);
+}
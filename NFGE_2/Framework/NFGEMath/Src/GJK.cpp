@@ -0,0 +1,673 @@
+//====================================================================================================
+// Filename:	GJK.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+using namespace NFGE::Math;
+
+namespace
+{
+	constexpr uint32_t kMaxIterations = 64;
+	constexpr uint32_t kMaxPolytopeVertices = 64;
+	constexpr uint32_t kMaxPolytopeFaces = 128;
+
+	// GJK stops once the lower bound on the squared distance is this close to the upper bound, EPA once
+	// a new support point gains less than this fraction of the polytope's size
+	constexpr float kTolerance = 1e-5f;
+
+	// Squared distances below this fraction of the simplex's squared size count as touching
+	constexpr float kTouchingTolerance = 1e-10f;
+
+	// A point of the Minkowski difference a - b and where it came from
+	struct SupportPoint
+	{
+		Vector3 w;
+		Vector3 a;
+		Vector3 b;
+		Vector3 direction;
+	};
+
+	inline SupportPoint Support(const ConvexShape& a, const ConvexShape& b, const Vector3& direction)
+	{
+		SupportPoint point;
+		point.a = a.Support(direction);
+		point.b = b.Support(-direction);
+		point.w = point.a - point.b;
+		point.direction = direction;
+		return point;
+	}
+
+	struct Simplex
+	{
+		SupportPoint points[4];
+		float weights[4]; // Barycentric coordinates of the point closest to the origin
+		uint32_t count = 0;
+	};
+
+	// Closest point to the origin on a sub-simplex, as indices into the simplex and their weights
+	struct Closest
+	{
+		uint32_t index[3];
+		float weight[3];
+		uint32_t count;
+		Vector3 point;
+	};
+
+	Closest MakeClosest(const SupportPoint* points, uint32_t i)
+	{
+		return { { i, 0, 0 }, { 1.0f, 0.0f, 0.0f }, 1, points[i].w };
+	}
+
+	Closest MakeClosest(const SupportPoint* points, uint32_t i, uint32_t j, float t)
+	{
+		return { { i, j, 0 }, { 1.0f - t, t, 0.0f }, 2, points[i].w + (points[j].w - points[i].w) * t };
+	}
+
+	Closest ClosestOnSegment(const SupportPoint* points, uint32_t i, uint32_t j)
+	{
+		const Vector3& a = points[i].w;
+		const Vector3 ab = points[j].w - a;
+		const float lengthSqr = Dot(ab, ab);
+		const float t = lengthSqr > 0.0f ? -Dot(a, ab) / lengthSqr : 0.0f;
+		if (t <= 0.0f)
+			return MakeClosest(points, i);
+		if (t >= 1.0f)
+			return MakeClosest(points, j);
+		return MakeClosest(points, i, j, t);
+	}
+
+	// Ericson 5.1.5 with the origin as the query point
+	Closest ClosestOnTriangle(const SupportPoint* points, uint32_t i, uint32_t j, uint32_t k)
+	{
+		const Vector3& a = points[i].w;
+		const Vector3& b = points[j].w;
+		const Vector3& c = points[k].w;
+		const Vector3 ab = b - a;
+		const Vector3 ac = c - a;
+
+		const float d1 = -Dot(ab, a);
+		const float d2 = -Dot(ac, a);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+			return MakeClosest(points, i);
+
+		const float d3 = -Dot(ab, b);
+		const float d4 = -Dot(ac, b);
+		if (d3 >= 0.0f && d4 <= d3)
+			return MakeClosest(points, j);
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			return MakeClosest(points, i, j, d1 / (d1 - d3));
+
+		const float d5 = -Dot(ab, c);
+		const float d6 = -Dot(ac, c);
+		if (d6 >= 0.0f && d5 <= d6)
+			return MakeClosest(points, k);
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			return MakeClosest(points, i, k, d2 / (d2 - d6));
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+			return MakeClosest(points, j, k, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+		const float sum = va + vb + vc;
+		if (sum <= 0.0f)
+		{
+			// Collinear points that slipped past the region tests
+			Closest best = ClosestOnSegment(points, i, j);
+			for (const Closest& edge : { ClosestOnSegment(points, j, k), ClosestOnSegment(points, i, k) })
+			{
+				if (MagnitudeSqr(edge.point) < MagnitudeSqr(best.point))
+					best = edge;
+			}
+			return best;
+		}
+
+		const float v = vb / sum;
+		const float w = vc / sum;
+		return { { i, j, k }, { 1.0f - v - w, v, w }, 3, a + ab * v + ac * w };
+	}
+
+	void Reduce(Simplex& simplex, const Closest& closest)
+	{
+		SupportPoint kept[3];
+		for (uint32_t i = 0; i < closest.count; ++i)
+		{
+			kept[i] = simplex.points[closest.index[i]];
+		}
+		for (uint32_t i = 0; i < closest.count; ++i)
+		{
+			simplex.points[i] = kept[i];
+			simplex.weights[i] = closest.weight[i];
+		}
+		simplex.count = closest.count;
+	}
+
+	float SizeSqr(const Simplex& simplex)
+	{
+		float sizeSqr = 0.0f;
+		for (uint32_t i = 0; i < simplex.count; ++i)
+		{
+			sizeSqr = Max(sizeSqr, MagnitudeSqr(simplex.points[i].w));
+		}
+		return sizeSqr;
+	}
+
+	// Replaces the simplex with the smallest sub-simplex holding its closest point to the origin, which
+	// goes in closestPoint. Returns false when the simplex is a tetrahedron containing the origin.
+	bool Solve(Simplex& simplex, Vector3& closestPoint)
+	{
+		const SupportPoint* points = simplex.points;
+		Closest closest;
+		switch (simplex.count)
+		{
+		case 1:
+			closest = MakeClosest(points, 0);
+			break;
+		case 2:
+			closest = ClosestOnSegment(points, 0, 1);
+			break;
+		case 3:
+			closest = ClosestOnTriangle(points, 0, 1, 2);
+			break;
+		default:
+		{
+			// Ericson 5.1.6, only faces with the origin on their outer side can hold the closest point. A flat
+			// tetrahedron has no inside, so all four faces are tried.
+			static constexpr uint32_t kFaces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+			const Vector3& a = points[0].w;
+			const float volume = Dot(points[3].w - a, Cross(points[1].w - a, points[2].w - a));
+			const float sizeSqr = SizeSqr(simplex);
+			const bool flat = volume * volume <= kTouchingTolerance * sizeSqr * sizeSqr * sizeSqr;
+
+			bool outside = false;
+			float bestSqr = FLT_MAX;
+			for (const auto& face : kFaces)
+			{
+				const Vector3& p = points[face[0]].w;
+				const Vector3 n = Cross(points[face[1]].w - p, points[face[2]].w - p);
+				if (!flat && Dot(p, n) * Dot(points[face[3]].w - p, n) <= 0.0f)
+					continue;
+
+				outside = true;
+				const Closest candidate = ClosestOnTriangle(points, face[0], face[1], face[2]);
+				const float distanceSqr = MagnitudeSqr(candidate.point);
+				if (distanceSqr < bestSqr)
+				{
+					bestSqr = distanceSqr;
+					closest = candidate;
+				}
+			}
+			if (!outside)
+			{
+				closestPoint = Vector3::Zero();
+				return false;
+			}
+			break;
+		}
+		}
+
+		Reduce(simplex, closest);
+		closestPoint = closest.point;
+		return true;
+	}
+
+	void GetWitnessPoints(const Simplex& simplex, Vector3& pointA, Vector3& pointB)
+	{
+		pointA = Vector3::Zero();
+		pointB = Vector3::Zero();
+		for (uint32_t i = 0; i < simplex.count; ++i)
+		{
+			pointA += simplex.points[i].a * simplex.weights[i];
+			pointB += simplex.points[i].b * simplex.weights[i];
+		}
+	}
+
+	struct GJKResult
+	{
+		Simplex simplex;
+		Vector3 closest;		// Closest point of a - b to the origin, i.e. coreA - coreB
+		uint32_t iterations = 0;
+		bool overlap = false;	// The cores overlap or touch
+	};
+
+	// GJK on the cores. With separation >= 0 it stops as soon as the cores are proven to be further apart
+	// than separation.
+	void RunGJK(const ConvexShape& a, const ConvexShape& b, const GJKCache* cache, float separation, GJKResult& result)
+	{
+		Simplex& simplex = result.simplex;
+		Vector3& v = result.closest;
+
+		if (cache != nullptr && cache->count > 0)
+		{
+			simplex.count = Min(cache->count, 4u);
+			for (uint32_t i = 0; i < simplex.count; ++i)
+			{
+				simplex.points[i] = Support(a, b, cache->directions[i]);
+			}
+			if (!Solve(simplex, v))
+			{
+				result.overlap = true;
+				return;
+			}
+		}
+		else
+		{
+			Vector3 direction = b.center - a.center;
+			if (MagnitudeSqr(direction) == 0.0f)
+				direction = Vector3::XAxis;
+			simplex.points[0] = Support(a, b, direction);
+			simplex.weights[0] = 1.0f;
+			simplex.count = 1;
+			v = simplex.points[0].w;
+		}
+
+		while (result.iterations < kMaxIterations)
+		{
+			const float vv = Dot(v, v);
+			if (vv <= kTouchingTolerance * SizeSqr(simplex))
+			{
+				result.overlap = true;
+				return;
+			}
+
+			++result.iterations;
+			const SupportPoint point = Support(a, b, -v);
+
+			// Dot(v, w) / |v| is a lower bound on the distance and |v| an upper bound
+			const float vw = Dot(v, point.w);
+			if (separation >= 0.0f && vw > 0.0f && vw * vw > vv * separation * separation)
+				return;
+			if (vv - vw <= kTolerance * vv)
+				return;
+			for (uint32_t i = 0; i < simplex.count; ++i)
+			{
+				if (MagnitudeSqr(point.w - simplex.points[i].w) == 0.0f)
+					return;
+			}
+
+			simplex.points[simplex.count++] = point;
+			if (!Solve(simplex, v))
+			{
+				result.overlap = true;
+				return;
+			}
+
+			// Rounding can stop the distance from shrinking before the tolerance is met
+			if (Dot(v, v) >= vv)
+				return;
+		}
+	}
+
+	void SaveCache(const Simplex& simplex, GJKCache* cache)
+	{
+		if (cache == nullptr)
+			return;
+		cache->count = simplex.count;
+		for (uint32_t i = 0; i < simplex.count; ++i)
+		{
+			cache->directions[i] = simplex.points[i].direction;
+		}
+	}
+
+	// Grows a simplex that touches the origin into a tetrahedron. Returns false when the Minkowski
+	// difference is flat and has no inside, normal is then perpendicular to it.
+	bool CompleteTetrahedron(const ConvexShape& a, const ConvexShape& b, Simplex& simplex, Vector3& normal)
+	{
+		const float sizeSqr = Max(SizeSqr(simplex), FLT_MIN);
+		SupportPoint* points = simplex.points;
+
+		if (simplex.count == 1)
+		{
+			const Vector3 axes[6] = { Vector3::XAxis, -Vector3::XAxis, Vector3::YAxis, -Vector3::YAxis, Vector3::ZAxis, -Vector3::ZAxis };
+			for (const Vector3& axis : axes)
+			{
+				const SupportPoint point = Support(a, b, axis);
+				if (DistanceSqr(point.w, points[0].w) > kTouchingTolerance * Max(sizeSqr, MagnitudeSqr(point.w)))
+				{
+					points[simplex.count++] = point;
+					break;
+				}
+			}
+			if (simplex.count == 1)
+			{
+				normal = Vector3::YAxis;
+				return false;
+			}
+		}
+
+		if (simplex.count == 2)
+		{
+			const Vector3 edge = points[1].w - points[0].w;
+			const Vector3 absEdge(Abs(edge.x), Abs(edge.y), Abs(edge.z));
+			const Vector3& axis = absEdge.x <= absEdge.y && absEdge.x <= absEdge.z ? Vector3::XAxis : (absEdge.y <= absEdge.z ? Vector3::YAxis : Vector3::ZAxis);
+			const Vector3 side0 = Normalize(Cross(edge, axis));
+			const Vector3 side1 = Normalize(Cross(edge, side0));
+			const float edgeSqr = MagnitudeSqr(edge);
+			for (const Vector3& direction : { side0, -side0, side1, -side1 })
+			{
+				const SupportPoint point = Support(a, b, direction);
+				if (MagnitudeSqr(Cross(edge, point.w - points[0].w)) > kTouchingTolerance * edgeSqr * Max(sizeSqr, MagnitudeSqr(point.w)))
+				{
+					points[simplex.count++] = point;
+					break;
+				}
+			}
+			if (simplex.count == 2)
+			{
+				normal = side0;
+				return false;
+			}
+		}
+
+		if (simplex.count == 3)
+		{
+			const Vector3 n = Normalize(Cross(points[1].w - points[0].w, points[2].w - points[0].w));
+			const float epsilon = sqrtf(kTouchingTolerance * sizeSqr);
+			SupportPoint point = Support(a, b, n);
+			if (Dot(point.w - points[0].w, n) <= epsilon)
+			{
+				point = Support(a, b, -n);
+				if (Dot(point.w - points[0].w, n) >= -epsilon)
+				{
+					normal = n;
+					return false;
+				}
+			}
+			points[simplex.count++] = point;
+		}
+		return true;
+	}
+
+	struct PolytopeFace
+	{
+		Vector3 normal;		// Unit, pointing away from the origin
+		float distance;		// From the origin to the face's plane
+		uint32_t vertex[3];
+	};
+
+	struct Polytope
+	{
+		SupportPoint vertices[kMaxPolytopeVertices];
+		PolytopeFace faces[kMaxPolytopeFaces];
+		uint32_t vertexCount = 0;
+		uint32_t faceCount = 0;
+
+		bool AddFace(uint32_t i, uint32_t j, uint32_t k)
+		{
+			if (faceCount == kMaxPolytopeFaces)
+				return false;
+
+			PolytopeFace& face = faces[faceCount++];
+			face.vertex[0] = i;
+			face.vertex[1] = j;
+			face.vertex[2] = k;
+			const Vector3 n = Cross(vertices[j].w - vertices[i].w, vertices[k].w - vertices[i].w);
+			const float length = Magnitude(n);
+			if (length > 0.0f)
+			{
+				face.normal = n / length;
+				face.distance = Dot(face.normal, vertices[i].w);
+			}
+			else
+			{
+				// A sliver, never picked as the closest face and never seen from a new vertex
+				face.normal = Vector3::Zero();
+				face.distance = FLT_MAX;
+			}
+			return true;
+		}
+	};
+
+	// EPA on a tetrahedron around the origin. Returns the depth of the cores along normal, the unit
+	// direction from A towards B.
+	float RunEPA(const ConvexShape& a, const ConvexShape& b, const Simplex& tetrahedron, Vector3& normal, Vector3& coreA, Vector3& coreB, uint32_t& iterations)
+	{
+		Polytope polytope;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			polytope.vertices[i] = tetrahedron.points[i];
+		}
+		polytope.vertexCount = 4;
+
+		// Wind the faces outwards, which needs vertex 3 below the plane of 0, 1, 2
+		const SupportPoint* v = polytope.vertices;
+		if (Dot(Cross(v[1].w - v[0].w, v[2].w - v[0].w), v[3].w - v[0].w) > 0.0f)
+			std::swap(polytope.vertices[1], polytope.vertices[2]);
+		polytope.AddFace(0, 1, 2);
+		polytope.AddFace(0, 3, 1);
+		polytope.AddFace(0, 2, 3);
+		polytope.AddFace(1, 3, 2);
+
+		float sizeSqr = 0.0f;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			sizeSqr = Max(sizeSqr, MagnitudeSqr(v[i].w));
+		}
+		const float tolerance = kTolerance * sqrtf(sizeSqr);
+
+		PolytopeFace closest = polytope.faces[0];
+		for (;;)
+		{
+			uint32_t best = 0;
+			for (uint32_t i = 1; i < polytope.faceCount; ++i)
+			{
+				if (polytope.faces[i].distance < polytope.faces[best].distance)
+					best = i;
+			}
+			closest = polytope.faces[best];
+
+			const SupportPoint point = Support(a, b, closest.normal);
+			if (Dot(point.w, closest.normal) - closest.distance <= tolerance || polytope.vertexCount == kMaxPolytopeVertices)
+				break;
+			++iterations;
+
+			// Remove every face the new point sees, the edges they leave open form the horizon
+			const uint32_t newVertex = polytope.vertexCount;
+			polytope.vertices[polytope.vertexCount++] = point;
+			uint32_t edges[kMaxPolytopeFaces][2];
+			uint32_t edgeCount = 0;
+			bool full = false;
+			for (uint32_t f = polytope.faceCount; f-- > 0;)
+			{
+				const PolytopeFace& face = polytope.faces[f];
+				if (Dot(face.normal, point.w - polytope.vertices[face.vertex[0]].w) <= 0.0f)
+					continue;
+
+				for (uint32_t e = 0; e < 3; ++e)
+				{
+					const uint32_t from = face.vertex[e];
+					const uint32_t to = face.vertex[(e + 1) % 3];
+					uint32_t shared = 0;
+					while (shared < edgeCount && !(edges[shared][0] == to && edges[shared][1] == from))
+						++shared;
+					if (shared < edgeCount)
+					{
+						edges[shared][0] = edges[edgeCount - 1][0];
+						edges[shared][1] = edges[edgeCount - 1][1];
+						--edgeCount;
+					}
+					else if (edgeCount < kMaxPolytopeFaces)
+					{
+						edges[edgeCount][0] = from;
+						edges[edgeCount][1] = to;
+						++edgeCount;
+					}
+					else
+					{
+						full = true;
+					}
+				}
+				polytope.faces[f] = polytope.faces[--polytope.faceCount];
+			}
+
+			for (uint32_t e = 0; e < edgeCount && !full; ++e)
+			{
+				full = !polytope.AddFace(edges[e][0], edges[e][1], newVertex);
+			}
+			if (full)
+				break;
+		}
+
+		// Barycentric coordinates of the origin's projection on the closest face
+		const SupportPoint& p0 = polytope.vertices[closest.vertex[0]];
+		const SupportPoint& p1 = polytope.vertices[closest.vertex[1]];
+		const SupportPoint& p2 = polytope.vertices[closest.vertex[2]];
+		const Vector3 e0 = p1.w - p0.w;
+		const Vector3 e1 = p2.w - p0.w;
+		const Vector3 e2 = closest.normal * closest.distance - p0.w;
+		const float d00 = Dot(e0, e0), d01 = Dot(e0, e1), d11 = Dot(e1, e1);
+		const float d20 = Dot(e2, e0), d21 = Dot(e2, e1);
+		const float denom = d00 * d11 - d01 * d01;
+		const float u = denom > 0.0f ? (d11 * d20 - d01 * d21) / denom : 0.0f;
+		const float w = denom > 0.0f ? (d00 * d21 - d01 * d20) / denom : 0.0f;
+		coreA = p0.a + (p1.a - p0.a) * u + (p2.a - p0.a) * w;
+		coreB = p0.b + (p1.b - p0.b) * u + (p2.b - p0.b) * w;
+		normal = closest.normal;
+		return Max(closest.distance, 0.0f);
+	}
+}
+
+NFGE::Math::ConvexShape::ConvexShape(const Vector3& point)
+	: center(point)
+{
+}
+
+NFGE::Math::ConvexShape::ConvexShape(const Sphere& sphere)
+	: center(sphere.center)
+	, radius(sphere.radius)
+{
+}
+
+NFGE::Math::ConvexShape::ConvexShape(const Capsule& capsule)
+	: center((capsule.a + capsule.b) * 0.5f)
+	, extend((capsule.b - capsule.a) * 0.5f)
+	, radius(capsule.radius)
+	, type(Type::Segment)
+{
+}
+
+NFGE::Math::ConvexShape::ConvexShape(const AABB& aabb)
+	: center(aabb.center)
+	, extend(aabb.extend)
+	, type(Type::Box)
+{
+}
+
+NFGE::Math::ConvexShape::ConvexShape(const OBB& obb)
+	: ConvexShape(CachedOBB(obb))
+{
+}
+
+NFGE::Math::ConvexShape::ConvexShape(const CachedOBB& obb)
+	: axis(obb.axis)
+	, center(obb.center)
+	, extend(obb.extend)
+	, type(Type::Box)
+{
+}
+
+NFGE::Math::ConvexShape::ConvexShape(const Vector3* points, uint32_t count, const Vector3& position, const Quaternion& orientation)
+	: axis(CachedOBB(OBB(position, Vector3::Zero(), orientation)).axis)
+	, center(position)
+	, points(points)
+	, pointCount(count)
+	, type(Type::Hull)
+{
+	ASSERT(points != nullptr && count > 0, "[ConvexShape] A hull needs at least one point.");
+}
+
+Vector3 NFGE::Math::ConvexShape::Support(const Vector3& direction) const
+{
+	switch (type)
+	{
+	case Type::Segment:
+		return Dot(direction, extend) >= 0.0f ? center + extend : center - extend;
+	case Type::Box:
+	{
+		const float x = Dot(direction, axis[0]) >= 0.0f ? extend.x : -extend.x;
+		const float y = Dot(direction, axis[1]) >= 0.0f ? extend.y : -extend.y;
+		const float z = Dot(direction, axis[2]) >= 0.0f ? extend.z : -extend.z;
+		return center + axis[0] * x + axis[1] * y + axis[2] * z;
+	}
+	case Type::Hull:
+	{
+		const Vector3 local(Dot(direction, axis[0]), Dot(direction, axis[1]), Dot(direction, axis[2]));
+		uint32_t best = 0;
+		float bestDot = Dot(points[0], local);
+		for (uint32_t i = 1; i < pointCount; ++i)
+		{
+			const float d = Dot(points[i], local);
+			if (d > bestDot)
+			{
+				bestDot = d;
+				best = i;
+			}
+		}
+		const Vector3& p = points[best];
+		return center + axis[0] * p.x + axis[1] * p.y + axis[2] * p.z;
+	}
+	default:
+		return center;
+	}
+}
+
+bool NFGE::Math::Intersect(const ConvexShape& a, const ConvexShape& b, GJKCache* cache)
+{
+	const float radius = a.radius + b.radius;
+	GJKResult result;
+	RunGJK(a, b, cache, radius, result);
+	SaveCache(result.simplex, cache);
+	return result.overlap || MagnitudeSqr(result.closest) <= radius * radius;
+}
+
+bool NFGE::Math::GetContact(const ConvexShape& a, const ConvexShape& b, ConvexContact& contact, GJKCache* cache)
+{
+	GJKResult result;
+	RunGJK(a, b, cache, -1.0f, result);
+	SaveCache(result.simplex, cache);
+
+	Vector3 coreA, coreB;
+	float coreDistance;
+	contact.epaIterations = 0;
+	if (!result.overlap)
+	{
+		GetWitnessPoints(result.simplex, coreA, coreB);
+		coreDistance = Magnitude(result.closest);
+		contact.normal = result.closest / -coreDistance;
+
+		// Near contact the closest point is a difference of much larger numbers and its direction is mostly
+		// rounding. When it lies on a triangle the triangle's normal is the same direction, without that error.
+		if (result.simplex.count == 3)
+		{
+			const SupportPoint* points = result.simplex.points;
+			const Vector3 n = Cross(points[1].w - points[0].w, points[2].w - points[0].w);
+			const float length = Magnitude(n);
+			if (length > 0.0f)
+				contact.normal = Dot(n, result.closest) > 0.0f ? n / -length : n / length;
+		}
+	}
+	else
+	{
+		// Cores that only touch, or whose Minkowski difference is flat like two crossing segments, have no
+		// depth and skip EPA
+		if (result.simplex.count < 4)
+			GetWitnessPoints(result.simplex, coreA, coreB);
+		if (result.simplex.count == 4 || CompleteTetrahedron(a, b, result.simplex, contact.normal))
+			coreDistance = -RunEPA(a, b, result.simplex, contact.normal, coreA, coreB, contact.epaIterations);
+		else
+			coreDistance = 0.0f;
+	}
+
+	contact.distance = coreDistance - a.radius - b.radius;
+	contact.pointA = coreA + contact.normal * a.radius;
+	contact.pointB = coreB - contact.normal * b.radius;
+	contact.iterations = result.iterations;
+	return contact.distance <= 0.0f;
+}
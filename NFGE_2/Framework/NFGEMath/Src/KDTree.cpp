@@ -0,0 +1,338 @@
+//====================================================================================================
+// Filename:	KDTree.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+using namespace NFGE::Math;
+
+namespace
+{
+	constexpr uint32_t kMaxDepth = 64;
+	constexpr uint32_t kParallelThreshold = 4096;	// Smallest range worth handing to another thread
+	constexpr size_t kMinQueriesPerTask = 1024;		// Below this a worker thread costs more than it saves
+
+	struct BuildPoint
+	{
+		Vector3 position;
+		uint32_t index;
+	};
+
+	class Builder
+	{
+	public:
+		Builder(std::vector<BuildPoint>& points, std::vector<uint8_t>& axes)
+			: mPoints(points)
+			, mAxes(axes)
+		{
+			const uint32_t threads = Max(1u, std::thread::hardware_concurrency());
+			while ((1u << mParallelDepth) < threads)
+			{
+				++mParallelDepth;
+			}
+		}
+
+		void Split(uint32_t first, uint32_t count, uint32_t depth)
+		{
+			if (count <= KDTree::kMaxLeafSize)
+			{
+				return;
+			}
+
+			// Split the widest extent, which keeps cells from going long and thin on clustered clouds
+			Vector3 min{ FLT_MAX }, max{ -FLT_MAX };
+			for (uint32_t i = first; i < first + count; ++i)
+			{
+				const Vector3& p = mPoints[i].position;
+				min = { Min(min.x, p.x), Min(min.y, p.y), Min(min.z, p.z) };
+				max = { Max(max.x, p.x), Max(max.y, p.y), Max(max.z, p.z) };
+			}
+			const Vector3 extent = max - min;
+			const int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z) ? 1 : 2;
+
+			const uint32_t mid = first + count / 2;
+			std::nth_element(&mPoints[first], &mPoints[mid], &mPoints[first] + count, [axis](const BuildPoint& a, const BuildPoint& b)
+			{
+				return a.position.v[axis] < b.position.v[axis];
+			});
+			mAxes[mid] = static_cast<uint8_t>(axis);
+
+			const uint32_t leftCount = mid - first;
+			const uint32_t rightCount = count - leftCount - 1;
+			if (depth < mParallelDepth && rightCount >= kParallelThreshold)
+			{
+				auto task = std::async(std::launch::async, [=]() { Split(first, leftCount, depth + 1); });
+				Split(mid + 1, rightCount, depth + 1);
+				task.get();
+			}
+			else
+			{
+				Split(first, leftCount, depth + 1);
+				Split(mid + 1, rightCount, depth + 1);
+			}
+		}
+
+	private:
+		std::vector<BuildPoint>& mPoints;
+		std::vector<uint8_t>& mAxes;
+		uint32_t mParallelDepth = 0;
+	};
+
+	struct Neighbor
+	{
+		float distanceSqr;
+		uint32_t position;
+
+		bool operator<(const Neighbor& other) const { return distanceSqr < other.distanceSqr; }
+	};
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::KDTree::Build(const Vector3* points, size_t count)
+{
+	Clear();
+	if (count == 0)
+	{
+		return;
+	}
+	ASSERT(count < UINT32_MAX, "[KDTree] Too many points.");
+
+	std::vector<BuildPoint> buildPoints(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		buildPoints[i] = { points[i], static_cast<uint32_t>(i) };
+	}
+
+	mAxes.resize(count);
+	Builder builder(buildPoints, mAxes);
+	builder.Split(0, static_cast<uint32_t>(count), 0);
+
+	mPoints.resize(count);
+	mIndices.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		mPoints[i] = buildPoints[i].position;
+		mIndices[i] = buildPoints[i].index;
+	}
+}
+
+void NFGE::Math::KDTree::Clear()
+{
+	mPoints.clear();
+	mIndices.clear();
+	mAxes.clear();
+}
+
+//----------------------------------------------------------------------------------------------------
+
+// Visits every point within sqrt(boundSqr) of point, near side first. visit(position, distanceSqr) returns
+// the new bound, so nearest neighbour searches can shrink it as they go. Cells are pruned by their exact
+// distance to the query, which follows from the per axis offsets to the cell (Arya and Mount).
+template <typename Visit>
+void NFGE::Math::KDTree::Traverse(const Vector3& point, float boundSqr, Visit&& visit) const
+{
+	struct Cell
+	{
+		uint32_t first;
+		uint32_t count;
+		float distanceSqr;
+		Vector3 offset;
+	};
+
+	if (mPoints.empty())
+	{
+		return;
+	}
+
+	Cell stack[kMaxDepth];
+	uint32_t stackSize = 0;
+	Cell cell{ 0, static_cast<uint32_t>(mPoints.size()), 0.0f, Vector3::Zero() };
+	while (true)
+	{
+		if (cell.distanceSqr <= boundSqr)
+		{
+			uint32_t first = cell.first;
+			uint32_t count = cell.count;
+			while (count > kMaxLeafSize)
+			{
+				const uint32_t mid = first + count / 2;
+				const uint32_t axis = mAxes[mid];
+				const Vector3& split = mPoints[mid];
+				const float distanceSqr = DistanceSqr(point, split);
+				if (distanceSqr <= boundSqr)
+				{
+					boundSqr = visit(mid, distanceSqr);
+				}
+
+				// Step into the side holding the query, keep the other one for later if it is in range
+				const float diff = point.v[axis] - split.v[axis];
+				const uint32_t leftCount = mid - first;
+				const uint32_t rightCount = count - leftCount - 1;
+				const uint32_t farFirst = diff < 0.0f ? mid + 1 : first;
+				const uint32_t farCount = diff < 0.0f ? rightCount : leftCount;
+				const float farDistanceSqr = cell.distanceSqr - cell.offset.v[axis] * cell.offset.v[axis] + diff * diff;
+				if (farCount > 0 && farDistanceSqr <= boundSqr)
+				{
+					Cell& far = stack[stackSize++];
+					far = { farFirst, farCount, farDistanceSqr, cell.offset };
+					far.offset.v[axis] = diff;
+				}
+				if (diff < 0.0f)
+				{
+					count = leftCount;
+				}
+				else
+				{
+					first = mid + 1;
+					count = rightCount;
+				}
+			}
+
+			for (uint32_t i = first; i < first + count; ++i)
+			{
+				const float distanceSqr = DistanceSqr(point, mPoints[i]);
+				if (distanceSqr <= boundSqr)
+				{
+					boundSqr = visit(i, distanceSqr);
+				}
+			}
+		}
+
+		if (stackSize == 0)
+		{
+			return;
+		}
+		cell = stack[--stackSize];
+	}
+}
+
+uint32_t NFGE::Math::KDTree::FindNearest(const Vector3& point, float maxDistance, float* distanceSqr) const
+{
+	uint32_t nearest = kInvalidIndex;
+	float nearestSqr = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+	Traverse(point, nearestSqr, [&](uint32_t position, float dSqr)
+	{
+		if (nearest == kInvalidIndex || dSqr < nearestSqr)
+		{
+			nearest = position;
+			nearestSqr = dSqr;
+		}
+		return nearestSqr;
+	});
+
+	if (nearest == kInvalidIndex)
+	{
+		return kInvalidIndex;
+	}
+	if (distanceSqr)
+	{
+		*distanceSqr = nearestSqr;
+	}
+	return mIndices[nearest];
+}
+
+uint32_t NFGE::Math::KDTree::FindNearest(const Vector3& point, uint32_t k, uint32_t* indices, float* distancesSqr, float maxDistance) const
+{
+	ASSERT(k <= kMaxNeighbors, "[KDTree] k is %u, at most %u neighbours are supported.", k, kMaxNeighbors);
+	if (k == 0)
+	{
+		return 0;
+	}
+
+	// Max heap on distance, the root is the furthest neighbour kept so far
+	Neighbor heap[kMaxNeighbors];
+	uint32_t heapSize = 0;
+	const float maxDistanceSqr = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+	Traverse(point, maxDistanceSqr, [&](uint32_t position, float dSqr)
+	{
+		if (heapSize < k)
+		{
+			heap[heapSize++] = { dSqr, position };
+			std::push_heap(heap, heap + heapSize);
+		}
+		else if (dSqr < heap[0].distanceSqr)
+		{
+			std::pop_heap(heap, heap + heapSize);
+			heap[heapSize - 1] = { dSqr, position };
+			std::push_heap(heap, heap + heapSize);
+		}
+		return heapSize < k ? maxDistanceSqr : heap[0].distanceSqr;
+	});
+
+	std::sort_heap(heap, heap + heapSize);
+	for (uint32_t i = 0; i < heapSize; ++i)
+	{
+		indices[i] = mIndices[heap[i].position];
+		if (distancesSqr)
+		{
+			distancesSqr[i] = heap[i].distanceSqr;
+		}
+	}
+	return heapSize;
+}
+
+size_t NFGE::Math::KDTree::FindInRadius(const Vector3& point, float radius, uint32_t* indices, float* distancesSqr, size_t capacity) const
+{
+	size_t found = 0;
+	const float radiusSqr = radius * radius;
+	Traverse(point, radiusSqr, [&](uint32_t position, float dSqr)
+	{
+		if (found < capacity)
+		{
+			indices[found] = mIndices[position];
+			if (distancesSqr)
+			{
+				distancesSqr[found] = dSqr;
+			}
+		}
+		++found;
+		return radiusSqr;
+	});
+	return found;
+}
+
+void NFGE::Math::KDTree::FindInRadius(const Vector3& point, float radius, std::vector<uint32_t>& results) const
+{
+	const float radiusSqr = radius * radius;
+	Traverse(point, radiusSqr, [&](uint32_t position, float)
+	{
+		results.push_back(mIndices[position]);
+		return radiusSqr;
+	});
+}
+
+void NFGE::Math::KDTree::FindNearest(const Vector3* points, size_t count, uint32_t k, uint32_t* indices, float* distancesSqr, float maxDistance) const
+{
+	ParallelFor(count, kMinQueriesPerTask, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			uint32_t* queryIndices = indices + i * k;
+			float* queryDistances = distancesSqr ? distancesSqr + i * k : nullptr;
+			for (uint32_t found = FindNearest(points[i], k, queryIndices, queryDistances, maxDistance); found < k; ++found)
+			{
+				queryIndices[found] = kInvalidIndex;
+				if (queryDistances)
+				{
+					queryDistances[found] = FLT_MAX;
+				}
+			}
+		}
+	});
+}
+
+void NFGE::Math::KDTree::FindInRadius(const Vector3* points, size_t count, float radius, uint32_t maxPerQuery, uint32_t* indices, uint32_t* counts) const
+{
+	ParallelFor(count, kMinQueriesPerTask, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const size_t found = FindInRadius(points[i], radius, indices + i * maxPerQuery, nullptr, maxPerQuery);
+			counts[i] = static_cast<uint32_t>(found);
+		}
+	});
+}
@@ -0,0 +1,112 @@
+//====================================================================================================
+// Filename:	Matrix3x4.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+#if NFGE_SIMD_X86
+	// Row r of parent * local in column form: p[r][0] * l0 + p[r][1] * l1 + p[r][2] * l2 + (0, 0, 0, p[r][3]),
+	// where l0..l2 are the rows of local. The masked parent row adds the parent translation.
+
+	NFGE_TARGET_SSE41 inline __m128 ConcatRowSSE41(__m128 p, __m128 l0, __m128 l1, __m128 l2, __m128 translationMask)
+	{
+		__m128 r = _mm_and_ps(p, translationMask);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)), l0));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)), l1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2)), l2));
+		return r;
+	}
+
+	NFGE_TARGET_SSE41 void MultiplyBatchSSE41(const Matrix3x4* local, const Matrix3x4* parent, size_t parentStride, Matrix3x4* out, size_t count)
+	{
+		const __m128 translationMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float* l = &local[i]._11;
+			const float* p = &parent[i * parentStride]._11;
+			const __m128 l0 = _mm_loadu_ps(l + 0);
+			const __m128 l1 = _mm_loadu_ps(l + 4);
+			const __m128 l2 = _mm_loadu_ps(l + 8);
+			const __m128 r0 = ConcatRowSSE41(_mm_loadu_ps(p + 0), l0, l1, l2, translationMask);
+			const __m128 r1 = ConcatRowSSE41(_mm_loadu_ps(p + 4), l0, l1, l2, translationMask);
+			const __m128 r2 = ConcatRowSSE41(_mm_loadu_ps(p + 8), l0, l1, l2, translationMask);
+			float* o = &out[i]._11;
+			_mm_storeu_ps(o + 0, r0);
+			_mm_storeu_ps(o + 4, r1);
+			_mm_storeu_ps(o + 8, r2);
+		}
+	}
+
+	NFGE_TARGET_AVX2 void MultiplyBatchAVX2(const Matrix3x4* local, const Matrix3x4* parent, size_t parentStride, Matrix3x4* out, size_t count)
+	{
+		// Parent rows 0 and 1 share a 256 bit register, local rows are duplicated into both lanes
+		const __m256 translationMask = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float* l = &local[i]._11;
+			const float* p = &parent[i * parentStride]._11;
+			const __m256 l0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 0));
+			const __m256 l1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 4));
+			const __m256 l2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 8));
+			const __m256 p01 = _mm256_loadu_ps(p + 0);
+			const __m128 p2 = _mm_loadu_ps(p + 8);
+
+			__m256 r01 = _mm256_and_ps(p01, translationMask);
+			r01 = _mm256_fmadd_ps(_mm256_permute_ps(p01, _MM_SHUFFLE(0, 0, 0, 0)), l0, r01);
+			r01 = _mm256_fmadd_ps(_mm256_permute_ps(p01, _MM_SHUFFLE(1, 1, 1, 1)), l1, r01);
+			r01 = _mm256_fmadd_ps(_mm256_permute_ps(p01, _MM_SHUFFLE(2, 2, 2, 2)), l2, r01);
+
+			__m128 r2 = _mm_and_ps(p2, _mm256_castps256_ps128(translationMask));
+			r2 = _mm_fmadd_ps(_mm_permute_ps(p2, _MM_SHUFFLE(0, 0, 0, 0)), _mm256_castps256_ps128(l0), r2);
+			r2 = _mm_fmadd_ps(_mm_permute_ps(p2, _MM_SHUFFLE(1, 1, 1, 1)), _mm256_castps256_ps128(l1), r2);
+			r2 = _mm_fmadd_ps(_mm_permute_ps(p2, _MM_SHUFFLE(2, 2, 2, 2)), _mm256_castps256_ps128(l2), r2);
+
+			float* o = &out[i]._11;
+			_mm256_storeu_ps(o + 0, r01);
+			_mm_storeu_ps(o + 8, r2);
+		}
+	}
+#endif
+
+	// parentStride is 1 for one parent per matrix and 0 for a shared parent
+	void MultiplyBatch(const Matrix3x4* local, const Matrix3x4* parent, size_t parentStride, Matrix3x4* out, size_t count)
+	{
+		ASSERT((local && parent && out) || count == 0, "[Matrix3x4] Input or output buffer is null.");
+#if NFGE_SIMD_X86
+		switch (GetInstructionSet())
+		{
+		case InstructionSet::AVX2: MultiplyBatchAVX2(local, parent, parentStride, out, count); return;
+		case InstructionSet::SSE41: MultiplyBatchSSE41(local, parent, parentStride, out, count); return;
+		default: break;
+		}
+#endif
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = local[i] * parent[i * parentStride];
+		}
+	}
+}
+
+void NFGE::Math::MultiplyBatch(const Matrix3x4* local, const Matrix3x4* parent, Matrix3x4* out, size_t count)
+{
+	::MultiplyBatch(local, parent, 1, out, count);
+}
+
+void NFGE::Math::MultiplyBatch(const Matrix3x4* local, const Matrix3x4& parent, Matrix3x4* out, size_t count)
+{
+	// Copied first, parent may be an element of out
+	const Matrix3x4 shared = parent;
+	::MultiplyBatch(local, &shared, 0, out, count);
+}
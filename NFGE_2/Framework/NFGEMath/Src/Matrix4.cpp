@@ -9,89 +9,10 @@
 #include "Vector4.h"
 #include "Vector3.h"
 #include "MathUtil.h"
+#include "SIMD.h"
 
 using namespace NFGE::Math;
 
-NFGE::Math::Matrix4::Matrix4(float _11, float _12, float _13, float _14, float _21, float _22, float _23, float _24, float _31, float _32, float _33, float _34, float _41, float _42, float _43, float _44)
-	: _11(_11), _12(_12), _13(_13), _14(_14),
-	_21(_21), _22(_22), _23(_23), _24(_24),
-	_31(_31), _32(_32), _33(_33), _34(_34),
-	_41(_41), _42(_42), _43(_43), _44(_44)
-{
-
-}
-Matrix4::Matrix4(const Matrix4& other)
-{
-	mV[0] = other.mV[0];
-	mV[1] = other.mV[1];
-	mV[2] = other.mV[2];
-	mV[3] = other.mV[3];
-	mV[4] = other.mV[4];
-	mV[5] = other.mV[5];
-	mV[6] = other.mV[6];
-	mV[7] = other.mV[7];
-	mV[8] = other.mV[8];
-	mV[9] = other.mV[9];
-	mV[10] = other.mV[10];
-	mV[11] = other.mV[11];
-	mV[12] = other.mV[12];
-	mV[13] = other.mV[13];
-	mV[14] = other.mV[14];
-	mV[15] = other.mV[15];
-}
-
-Matrix4& NFGE::Math::Matrix4::operator=(const Matrix4& other)
-{
-	if (this == &other)
-		return *this;
-	mV[0] = other.mV[0];
-	mV[1] = other.mV[1];
-	mV[2] = other.mV[2];
-	mV[3] = other.mV[3];
-	mV[4] = other.mV[4];
-	mV[5] = other.mV[5];
-	mV[6] = other.mV[6];
-	mV[7] = other.mV[7];
-	mV[8] = other.mV[8];
-	mV[9] = other.mV[9];
-	mV[10] = other.mV[10];
-	mV[11] = other.mV[11];
-	mV[12] = other.mV[12];
-	mV[13] = other.mV[13];
-	mV[14] = other.mV[14];
-	mV[15] = other.mV[15];
-	return *this;
-}
-
-bool NFGE::Math::Matrix4::operator==(const Matrix4& other) const
-{
-	for (size_t i = 0; i < 16; ++i)
-	{
-		if (!(mV[i] == other.mV[i]))
-			return false;
-	}
-	return true;
-}
-
-
-bool NFGE::Math::Matrix4::operator!=(const Matrix4& other) const
-{
-	for (size_t i = 0; i < 16; ++i)
-	{
-		if (!(mV[i] == other.mV[i]))
-			return true;
-	}
-	return false;
-}
-
-bool NFGE::Math::Matrix4::IsIdentity() const
-{
-	return (_11 == 1.0f && _12 == 0.0f && _13 == 0.0f && _14 == 0.0f &&
-		_21 == 0.0f && _22 == 1.0f && _23 == 0.0f && _24 == 0.0f &&
-		_31 == 0.0f && _32 == 0.0f && _33 == 1.0f && _34 == 0.0f &&
-		_41 == 0.0f && _42 == 0.0f && _43 == 0.0f && _44 == 1.0f);
-}
-
 bool NFGE::Math::Matrix4::IsZero() const
 {
 	for (size_t i = 0; i < 16; ++i)
@@ -275,125 +196,15 @@ Matrix4& NFGE::Math::Matrix4::Rotation(const Vector3& axis, float angle)
 	return *this;
 }
 
-Matrix4 NFGE::Math::Matrix4::sTranslation(const Vector3& v)
-{
-	return Matrix4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, v.x, v.y, v.z, 1.0f);
-}
-
-Matrix4 NFGE::Math::Matrix4::sScaling(const Vector3& s)
-{
-	return Matrix4(s.x, 0.0f, 0.0f, 0.0f, 0.0f, s.y, 0.0f, 0.0f, 0.0f, 0.0f, s.z, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-}
-
-Matrix4 Matrix4::operator+(const Matrix4& other) const
-{
-	Matrix4 retMatrix{};
-	for (size_t i = 0; i < 16; i++)
-	{
-		retMatrix.mV[i] = mV[i] + other.mV[i];
-	}
-	return retMatrix;
-}
-
-Matrix4& Matrix4::operator+=(const Matrix4& other)
-{
-	for (size_t i = 0; i < 16; i++)
-	{
-		mV[i] += other.mV[i];
-	}
-	return *this;
-}
-
-Matrix4 Matrix4::operator-(const Matrix4& other) const
-{
-	Matrix4 retMatrix{};
-	for (size_t i = 0; i < 16; i++)
-	{
-		retMatrix.mV[i] = mV[i] - other.mV[i];
-	}
-	return retMatrix;
-}
-
-Matrix4& Matrix4::operator-=(const Matrix4& other)
-{
-	for (size_t i = 0; i < 16; i++)
-	{
-		mV[i] -= other.mV[i];
-	}
-	return *this;
-}
-Matrix4 Matrix4::operator-() const
-{
-	Matrix4 retMatrix{};
-	for (size_t i = 0; i < 16; i++)
-	{
-		retMatrix.mV[i] = -mV[i];
-	}
-	return retMatrix;
-}
-
 Matrix4& Matrix4::operator*=(const Matrix4& other)
 {
-	Matrix4 temp(*this);
-	for (size_t i = 0; i < 16; i++)
-	{
-		size_t r = i / 4;
-		size_t c = i % 4;
-		float sum = 0.0f;
-		for (size_t j = 0; j < 4; j++)
-		{
-			sum += temp.mV[(r * 4 + j)] * other.mV[(j * 4 + c)];
-		}
-		mV[i] = sum;
-	}
-
+	SIMD::MatrixMultiply(*this, *this, other);
 	return *this;
 }
 
 Matrix4 Matrix4::operator*(const Matrix4& other) const
 {
-	Matrix4 retMatrix(*this);
-	for (size_t i = 0; i < 16; i++)
-	{
-		size_t r = i / 4;
-		size_t c = i % 4;
-		float sum = 0.0f;
-		for (size_t j = 0; j < 4; j++)
-		{
-			sum += mV[(r * 4 + j)] * other.mV[(j * 4 + c)];
-		}
-		retMatrix.mV[i] = sum;
-	}
-
+	Matrix4 retMatrix;
+	SIMD::MatrixMultiply(retMatrix, *this, other);
 	return retMatrix;
 }
-
-Vector4 Matrix4::operator*(const Vector4& vector) const
-{
-	return Vector4
-	(
-		_11 * vector.x + _12 * vector.y + _13 * vector.z + _14 * vector.w,
-		_21 * vector.x + _22 * vector.y + _23 * vector.z + _24 * vector.w,
-		_31 * vector.x + _32 * vector.y + _33 * vector.z + _34 * vector.w,
-		_41 * vector.x + _42 * vector.y + _43 * vector.z + _44 * vector.w
-	);
-}
-
-Matrix4& Matrix4::operator*=(float scalar)
-{
-	for (size_t i = 0; i < 16; i++)
-	{
-		mV[i] *= scalar;
-	}
-	return *this;
-}
-
-Matrix4 Matrix4::operator*(float scalar) const
-{
-	Matrix4 retMatrix{};
-	for (size_t i = 0; i < 16; i++)
-	{
-		retMatrix.mV[i] = mV[i] * scalar;
-	}
-	return retMatrix;
-}
\ No newline at end of file
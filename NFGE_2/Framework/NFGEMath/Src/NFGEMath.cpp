@@ -9,12 +9,6 @@
 
 using namespace NFGE::Math;
 
-namespace
-{
-	std::random_device sRandomDevice{};
-	std::mt19937 sRandomEngine{ sRandomDevice() };
-}
-
 const Vector3 Vector3::XAxis{ 1.0f,0.0f,0.0f };
 const Vector3 Vector3::YAxis{ 0.0f,1.0f,0.0f };
 const Vector3 Vector3::ZAxis{ 0.0f,0.0f,1.0f };
@@ -22,18 +16,34 @@ const Vector3 Vector3::ZAxis{ 0.0f,0.0f,1.0f };
 
 Matrix4 NFGE::Math::Transform(Transform3D transformInfo, Vector3 toOrigin)
 {
-	Matrix4 retMatrix;
-	// ToOri * Rot * Scal* She * Trans * -ToOri
-	Matrix4 ToOri = Matrix4(); ToOri.Identity(); ToOri.Translation(toOrigin.x, toOrigin.y, toOrigin.z);
-	Matrix4 Rot = Matrix4(); Rot.Identity(); Rot.Rotation(transformInfo.rX, transformInfo.rY, transformInfo.rZ);
-	Matrix4 Scal = Matrix4(); Scal.Identity(); Scal.Scaling(Vector4(transformInfo.scX, transformInfo.scY, transformInfo.scZ, 1.0f));
-	Matrix4 She = Matrix4(); She.Identity(); She.Rotation(transformInfo.shX, transformInfo.shY, transformInfo.shZ);
-	Matrix4 Trans = Matrix4(); Trans.Identity(); Trans.Translation(transformInfo.tX, transformInfo.tY, transformInfo.tZ);
-	Matrix4 ToOriNegi = Matrix4(); ToOriNegi.Identity(); ToOriNegi.Translation(-toOrigin.x, -toOrigin.y, -toOrigin.z);
-
-	retMatrix = ToOri * Rot * Scal * She * Trans * ToOriNegi;
-
-	return retMatrix;
+	// ToOri * Rot * Scal * She * Trans * -ToOri, where She is built with Rotation as it always has been.
+	// The two translations only touch the last row, so the 3x3 part is Rot * Scal * She and the last row
+	// is toOrigin * (Rot * Scal * She) + translation - toOrigin.
+	Matrix4 rot; rot.Rotation(transformInfo.rX, transformInfo.rY, transformInfo.rZ);
+	Matrix4 she; she.Rotation(transformInfo.shX, transformInfo.shY, transformInfo.shZ);
+	const float scale[3] = { transformInfo.scX, transformInfo.scY, transformInfo.scZ };
+
+	float m[3][3];
+	for (int r = 0; r < 3; ++r)
+	{
+		const float a0 = rot.mV[r * 4 + 0] * scale[0];
+		const float a1 = rot.mV[r * 4 + 1] * scale[1];
+		const float a2 = rot.mV[r * 4 + 2] * scale[2];
+		for (int c = 0; c < 3; ++c)
+			m[r][c] = a0 * she.mV[c] + a1 * she.mV[4 + c] + a2 * she.mV[8 + c];
+	}
+
+	const Vector3& o = toOrigin;
+	return Matrix4
+	(
+		m[0][0], m[0][1], m[0][2], 0.0f,
+		m[1][0], m[1][1], m[1][2], 0.0f,
+		m[2][0], m[2][1], m[2][2], 0.0f,
+		o.x * m[0][0] + o.y * m[1][0] + o.z * m[2][0] + transformInfo.tX - o.x,
+		o.x * m[0][1] + o.y * m[1][1] + o.z * m[2][1] + transformInfo.tY - o.y,
+		o.x * m[0][2] + o.y * m[1][2] + o.z * m[2][2] + transformInfo.tZ - o.z,
+		1.0f
+	);
 }
 
 Vector3 NFGE::Math::operator*(const Vector3& vector, const Matrix4& matrix)
@@ -51,30 +61,7 @@ Vector3 NFGE::Math::operator*(const Vector3& vector, const Matrix4& matrix)
 
 Vector4 NFGE::Math::operator*(const Vector4& vector, const Matrix4& matrix)
 {
-	return Vector4
-	(
-		matrix._11 * vector.x + matrix._21 * vector.y + matrix._31 * vector.z + matrix._41 * vector.w,
-		matrix._12 * vector.x + matrix._22 * vector.y + matrix._32 * vector.z + matrix._42 * vector.w,
-		matrix._13 * vector.x + matrix._23 * vector.y + matrix._33 * vector.z + matrix._43 * vector.w,
-		matrix._14 * vector.x + matrix._24 * vector.y + matrix._34 * vector.z + matrix._44 * vector.w
-	);
-	/*return Vector4
-	(
-		matrix._11 * vector.x + matrix._12 * vector.y + matrix._13 * vector.z + matrix._14 * vector.w,
-		matrix._21 * vector.x + matrix._22 * vector.y + matrix._23 * vector.z + matrix._24 * vector.w,
-		matrix._31 * vector.x + matrix._32 * vector.y + matrix._33 * vector.z + matrix._34 * vector.w,
-		matrix._41 * vector.x + matrix._42 * vector.y + matrix._43 * vector.z + matrix._44 * vector.w
-	);*/
-}
-
-Matrix4  NFGE::Math::operator*(float scalar, const Matrix4& matrix)
-{
-	Matrix4 retMatrix{};
-	for (size_t i = 0; i < 16; i++)
-	{
-		retMatrix.mV[i] = matrix.mV[i] * scalar;
-	}
-	return retMatrix;
+	return SIMD::Transform(vector, matrix);
 }
 
 Vector3 NFGE::Math::TransfromCoord(const Vector3& vector, const Matrix4& matrix)
@@ -263,32 +250,6 @@ Matrix4 NFGE::Math::MatrixRotationAxis(const Vector3& axis, float rad)
 	);
 }
 
-Matrix4 NFGE::Math::MatrixRotationQuaternion(const Quaternion& q)
-{
-	return Matrix4
-	(
-		1.0f - (2.0f * q.y * q.y) - (2.0f * q.z * q.z),
-		(2.0f * q.x * q.y) + (2.0f * q.z * q.w),
-		(2.0f * q.x * q.z) - (2.0f * q.y * q.w),
-		0.0f,
-
-		(2.0f * q.x * q.y) - (2.0f * q.z * q.w),
-		1.0f - (2.0f * q.x * q.x) - (2.0f * q.z * q.z),
-		(2.0f * q.y * q.z) + (2.0f * q.x * q.w),
-		0.0f,
-
-		(2.0f * q.x * q.z) + (2.0f * q.y * q.w),
-		(2.0f * q.y * q.z) - (2.0f * q.x * q.w),
-		1.0f - (2.0f * q.x * q.x) - (2.0f * q.y * q.y),
-		0.0f,
-
-		0.0f,
-		0.0f,
-		0.0f,
-		1.0f
-	);
-}
-
 Vector3 NFGE::Math::GetEular(const Quaternion& quaternion)
 {
 	float t0 = 2.0f * (quaternion.w * quaternion.x + quaternion.y * quaternion.z);
@@ -309,8 +270,10 @@ Vector3 NFGE::Math::GetEular(const Quaternion& quaternion)
 
 //----------------------------------------------------------------------------------------------------
 
-Quaternion NFGE::Math::Slerp(Quaternion q0, Quaternion q1, float t)
+Quaternion NFGE::Math::Slerp(const Quaternion& q0, const Quaternion& in1, float t)
 {
+	Quaternion q1 = in1;
+
 	// Find the dot product
 	float dot = (q0.x * q1.x) + (q0.y * q1.y) + (q0.z * q1.z) + (q0.w * q1.w);
 
@@ -740,20 +703,53 @@ bool NFGE::Math::Intersect(const Ray& ray, const AABB& aabb, float& distEntry, f
 
 //----------------------------------------------------------------------------------------------------
 
+NFGE::Math::CachedOBB::CachedOBB(const OBB& obb)
+	: center(obb.center)
+	, extend(obb.extend)
+{
+	// Rows of MatrixRotationQuaternion(obb.orientation)
+	const Quaternion& q = obb.orientation;
+	axis[0] = Vector3(1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.z * q.w), 2.0f * (q.x * q.z - q.y * q.w));
+	axis[1] = Vector3(2.0f * (q.x * q.y - q.z * q.w), 1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z + q.x * q.w));
+	axis[2] = Vector3(2.0f * (q.x * q.z + q.y * q.w), 2.0f * (q.y * q.z - q.x * q.w), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+}
+
+Vector3 NFGE::Math::CachedOBB::ToLocal(const Vector3& point) const
+{
+	return ToLocalDirection(point - center);
+}
+
+Vector3 NFGE::Math::CachedOBB::ToLocalDirection(const Vector3& dir) const
+{
+	return Vector3(Dot(dir, axis[0]), Dot(dir, axis[1]), Dot(dir, axis[2]));
+}
+
+Vector3 NFGE::Math::CachedOBB::ToWorld(const Vector3& point) const
+{
+	return center + ToWorldDirection(point);
+}
+
+Vector3 NFGE::Math::CachedOBB::ToWorldDirection(const Vector3& dir) const
+{
+	return axis[0] * dir.x + axis[1] * dir.y + axis[2] * dir.z;
+}
+
+//----------------------------------------------------------------------------------------------------
+
 bool NFGE::Math::Intersect(const Ray& ray, const OBB& obb, float& distEntry, float& distExit)
 {
-	// Compute the local-to-world/world-to-local matrices
-	Matrix4 matTrans = Translation(obb.center.x, obb.center.y, obb.center.z);
-	Matrix4 matRot = MatrixRotationQuaternion(obb.orientation);
-	Matrix4 matWorld = matRot * matTrans;
-	Matrix4 matWorldInv = Inverse(matWorld);
+	return Intersect(ray, CachedOBB(obb), distEntry, distExit);
+}
+
+//----------------------------------------------------------------------------------------------------
 
+bool NFGE::Math::Intersect(const Ray& ray, const CachedOBB& obb, float& distEntry, float& distExit)
+{
 	// Transform the ray into the OBB's local space
-	Vector3 org = TransformCoord(ray.org, matWorldInv);
-	Vector3 dir = TransformNormal(ray.dir, matWorldInv);
+	Ray localRay(obb.ToLocal(ray.org), obb.ToLocalDirection(ray.dir));
 
 	AABB aabb(Vector3::Zero(), obb.extend);
-	return Math::Intersect(Ray(org, dir), aabb, distEntry, distExit);
+	return Math::Intersect(localRay, aabb, distEntry, distExit);
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -771,84 +767,154 @@ bool NFGE::Math::Intersect(const Vector3& point, const AABB& aabb)
 
 bool NFGE::Math::Intersect(const Vector3& point, const OBB& obb)
 {
-	// Compute the local-to-world/world-to-local matrices
-	Matrix4 matTrans = Translation(obb.center.x, obb.center.y, obb.center.z);
-	Matrix4 matRot = MatrixRotationQuaternion(obb.orientation);
-	Matrix4 matWorld = matRot * matTrans;
-	Matrix4 matWorldInv = Inverse(matWorld);
-
-	// Transform the point into the OBB's local space
-	Vector3 localPoint = TransformCoord(point, matWorldInv);
-	AABB aabb(Vector3::Zero(), obb.extend);
+	return Intersect(point, CachedOBB(obb));
+}
+
+//----------------------------------------------------------------------------------------------------
 
-	// Test against local AABB
-	return Math::Intersect(localPoint, aabb);
+bool NFGE::Math::Intersect(const Vector3& point, const CachedOBB& obb)
+{
+	// Test the point in the OBB's local space against the local AABB
+	AABB aabb(Vector3::Zero(), obb.extend);
+	return Math::Intersect(obb.ToLocal(point), aabb);
 }
 
+//----------------------------------------------------------------------------------------------------
+
 bool NFGE::Math::Intersect(const AABB& aabb1, const AABB& aabb2)
 {
-	const Vector3 half = aabb1.extend * 0.5f;
-	const Vector3 bl_f = { aabb1.center.x - half.x, aabb1.center.y - half.y, aabb1.center.z - half.z };
-	const Vector3 br_f = { aabb1.center.x + half.x, aabb1.center.y - half.y, aabb1.center.z - half.z };
-	const Vector3 tl_f = { aabb1.center.x - half.x, aabb1.center.y + half.y, aabb1.center.z - half.z };
-	const Vector3 tr_f = { aabb1.center.x + half.x, aabb1.center.y + half.y, aabb1.center.z - half.z };
-	const Vector3 bl_b = { aabb1.center.x - half.x, aabb1.center.y - half.y, aabb1.center.z + half.z };
-	const Vector3 br_b = { aabb1.center.x + half.x, aabb1.center.y - half.y, aabb1.center.z + half.z };
-	const Vector3 tl_b = { aabb1.center.x - half.x, aabb1.center.y + half.y, aabb1.center.z + half.z };
-	const Vector3 tr_b = { aabb1.center.x + half.x, aabb1.center.y + half.y, aabb1.center.z + half.z };
-
-	if (Intersect(bl_f, aabb2)) return true;
-	if (Intersect(br_f, aabb2)) return true;
-	if (Intersect(tl_f, aabb2)) return true;
-	if (Intersect(tr_f, aabb2)) return true;
-	if (Intersect(bl_b, aabb2)) return true;
-	if (Intersect(br_b, aabb2)) return true;
-	if (Intersect(tl_b, aabb2)) return true;
-	if (Intersect(tr_b, aabb2)) return true;
-	return false;
+	// Boxes overlap when their centers are closer than the summed extents on every axis, touching counts
+	return Abs(aabb1.center.x - aabb2.center.x) <= aabb1.extend.x + aabb2.extend.x
+		&& Abs(aabb1.center.y - aabb2.center.y) <= aabb1.extend.y + aabb2.extend.y
+		&& Abs(aabb1.center.z - aabb2.center.z) <= aabb1.extend.z + aabb2.extend.z;
 }
 
 //----------------------------------------------------------------------------------------------------
 
-void NFGE::Math::GetCorners(const OBB& obb, std::vector<Vector3>& corners)
+bool NFGE::Math::Intersect(const OBB& obb1, const OBB& obb2)
+{
+	return Intersect(CachedOBB(obb1), CachedOBB(obb2));
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool NFGE::Math::Intersect(const CachedOBB& a, const CachedOBB& b)
 {
-	// Compute the local-to-world matrices
-	Matrix4 matTrans = Translation(obb.center.x, obb.center.y, obb.center.z);
-	Matrix4 matRot = MatrixRotationQuaternion(obb.orientation);
-	Matrix4 matWorld = matRot * matTrans;
-
-	// Create a local AABB
-	corners.clear();
-	corners.push_back(Vector3(-obb.extend.x, -obb.extend.y, -obb.extend.z));
-	corners.push_back(Vector3(-obb.extend.x, -obb.extend.y, obb.extend.z));
-	corners.push_back(Vector3(obb.extend.x, -obb.extend.y, obb.extend.z));
-	corners.push_back(Vector3(obb.extend.x, -obb.extend.y, -obb.extend.z));
-	corners.push_back(Vector3(-obb.extend.x, obb.extend.y, -obb.extend.z));
-	corners.push_back(Vector3(-obb.extend.x, obb.extend.y, obb.extend.z));
-	corners.push_back(Vector3(obb.extend.x, obb.extend.y, obb.extend.z));
-	corners.push_back(Vector3(obb.extend.x, obb.extend.y, -obb.extend.z));
-
-	// Transform AABB into world space to form the OBB
-	const uint32_t kNumCorners = (uint32_t)corners.size();
-	for (uint32_t i = 0; i < kNumCorners; ++i)
+	// Real-Time Collision Detection (Ericson) 4.4.1, separating axis test over the 15 candidate axes
+
+	// Rotation expressing b in a's frame, and the translation in a's frame
+	float R[3][3];
+	float absR[3][3];
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			R[i][j] = Dot(a.axis[i], b.axis[j]);
+			// Epsilon keeps the cross product axes stable when two edges are near parallel
+			absR[i][j] = Abs(R[i][j]) + Epsilon;
+		}
+	}
+	const Vector3 d = b.center - a.center;
+	const float t[3] = { Dot(d, a.axis[0]), Dot(d, a.axis[1]), Dot(d, a.axis[2]) };
+	const std::array<float, 3>& ea = a.extend.v;
+	const std::array<float, 3>& eb = b.extend.v;
+
+	// a's axes
+	for (int i = 0; i < 3; ++i)
 	{
-		corners[i] = TransformCoord(corners[i], matWorld);
+		const float ra = ea[i];
+		const float rb = eb[0] * absR[i][0] + eb[1] * absR[i][1] + eb[2] * absR[i][2];
+		if (Abs(t[i]) > ra + rb)
+			return false;
 	}
+
+	// b's axes
+	for (int j = 0; j < 3; ++j)
+	{
+		const float ra = ea[0] * absR[0][j] + ea[1] * absR[1][j] + ea[2] * absR[2][j];
+		const float rb = eb[j];
+		if (Abs(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]) > ra + rb)
+			return false;
+	}
+
+	// a.axis[i] x b.axis[j]
+	for (int i = 0; i < 3; ++i)
+	{
+		const int i1 = (i + 1) % 3;
+		const int i2 = (i + 2) % 3;
+		for (int j = 0; j < 3; ++j)
+		{
+			const int j1 = (j + 1) % 3;
+			const int j2 = (j + 2) % 3;
+			const float ra = ea[i1] * absR[i2][j] + ea[i2] * absR[i1][j];
+			const float rb = eb[j1] * absR[i][j2] + eb[j2] * absR[i][j1];
+			if (Abs(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > ra + rb)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool NFGE::Math::Intersect(const Sphere& sphere, const AABB& aabb)
+{
+	const Vector3 toClosest = GetClosestPoint(sphere.center, aabb) - sphere.center;
+	return Dot(toClosest, toClosest) <= sphere.radius * sphere.radius;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool NFGE::Math::Intersect(const Sphere& sphere, const Vector3& a, const Vector3& b, const Vector3& c)
+{
+	const Vector3 toClosest = GetClosestPoint(sphere.center, a, b, c) - sphere.center;
+	return Dot(toClosest, toClosest) <= sphere.radius * sphere.radius;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::GetCorners(const OBB& obb, std::vector<Vector3>& corners)
+{
+	std::array<Vector3, 8> cornerArray;
+	GetCorners(CachedOBB(obb), cornerArray);
+	corners.assign(cornerArray.begin(), cornerArray.end());
+}
+
+void NFGE::Math::GetCorners(const OBB& obb, std::array<Vector3, 8>& corners)
+{
+	GetCorners(CachedOBB(obb), corners);
+}
+
+void NFGE::Math::GetCorners(const CachedOBB& obb, std::array<Vector3, 8>& corners)
+{
+	// Scale the axes by the extend once, each corner is then center +/- the three half edges
+	const Vector3 x = obb.axis[0] * obb.extend.x;
+	const Vector3 y = obb.axis[1] * obb.extend.y;
+	const Vector3 z = obb.axis[2] * obb.extend.z;
+
+	corners[0] = obb.center - x - y - z;
+	corners[1] = obb.center - x - y + z;
+	corners[2] = obb.center + x - y + z;
+	corners[3] = obb.center + x - y - z;
+	corners[4] = obb.center - x + y - z;
+	corners[5] = obb.center - x + y + z;
+	corners[6] = obb.center + x + y + z;
+	corners[7] = obb.center + x + y - z;
 }
 
 //----------------------------------------------------------------------------------------------------
 
 bool NFGE::Math::GetContactPoint(const Ray& ray, const OBB& obb, Vector3& point, Vector3& normal)
 {
-	// Compute the local-to-world/world-to-local matrices
-	Matrix4 matTrans = Translation(obb.center.x, obb.center.y, obb.center.z);
-	Matrix4 matRot = MatrixRotationQuaternion(obb.orientation);
-	Matrix4 matWorld = matRot * matTrans;
-	Matrix4 matWorldInv = Inverse(matWorld);
+	return GetContactPoint(ray, CachedOBB(obb), point, normal);
+}
 
+bool NFGE::Math::GetContactPoint(const Ray& ray, const CachedOBB& obb, Vector3& point, Vector3& normal)
+{
 	// Transform the ray into the OBB's local space
-	Vector3 org = TransformCoord(ray.org, matWorldInv);
-	Vector3 dir = TransformNormal(ray.dir, matWorldInv);
+	Vector3 org = obb.ToLocal(ray.org);
+	Vector3 dir = obb.ToLocalDirection(ray.dir);
 	Ray localRay(org, dir);
 
 	Plane planes[] =
@@ -888,8 +954,8 @@ bool NFGE::Math::GetContactPoint(const Ray& ray, const OBB& obb, Vector3& point,
 		return false;
 	}
 
-	point = TransformCoord(point, matWorld);
-	normal = TransformNormal(normal, matWorld);
+	point = obb.ToWorld(point);
+	normal = obb.ToWorldDirection(normal);
 	return true;
 }
 
@@ -902,42 +968,93 @@ Vector3 NFGE::Math::GetClosestPoint(const Ray& ray, const Vector3& point)
 	return ray.org + (ray.dir * d);
 }
 
-//----------------------------------------------------------------------------------------------------
+Vector3 NFGE::Math::GetClosestPoint(const Vector3& point, const AABB& aabb)
+{
+	const Vector3 boxMin = aabb.center - aabb.extend;
+	const Vector3 boxMax = aabb.center + aabb.extend;
+	return Vector3(Clamp(point.x, boxMin.x, boxMax.x), Clamp(point.y, boxMin.y, boxMax.y), Clamp(point.z, boxMin.z, boxMax.z));
+}
 
-Vector3 NFGE::Math::Mean(const Vector3* v, uint32_t count)
+Vector3 NFGE::Math::GetClosestPoint(const Vector3& point, const Vector3& a, const Vector3& b, const Vector3& c)
 {
-	Vector3 mean(0.0f, 0.0f, 0.0f);
-	for (uint32_t i = 0; i < count; ++i)
+	// Reference: Real-Time Collision Detection (Ericson) 5.1.5, walks the Voronoi regions of the triangle
+	const Vector3 ab = b - a;
+	const Vector3 ac = c - a;
+	const Vector3 ap = point - a;
+	const float d1 = Dot(ab, ap);
+	const float d2 = Dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
 	{
-		mean += v[i];
+		return a;
 	}
-	return mean / (float)count;
+
+	const Vector3 bp = point - b;
+	const float d3 = Dot(ab, bp);
+	const float d4 = Dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3)
+	{
+		return b;
+	}
+
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		return a + ab * (d1 / (d1 - d3));
+	}
+
+	const Vector3 cp = point - c;
+	const float d5 = Dot(ab, cp);
+	const float d6 = Dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6)
+	{
+		return c;
+	}
+
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		return a + ac * (d2 / (d2 - d6));
+	}
+
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+	}
+
+	const float denom = 1.0f / (va + vb + vc);
+	return a + ab * (vb * denom) + ac * (vc * denom);
 }
 
+//----------------------------------------------------------------------------------------------------
+
 int NFGE::Math::Random()
 {
-	return std::uniform_int_distribution<>{ 0, (std::numeric_limits<int>::max)() }(sRandomEngine);
+	return static_cast<int>(GetThreadRandomEngine().Next() >> 1);
 }
 
 //----------------------------------------------------------------------------------------------------
 
 int NFGE::Math::Random(int min, int max)
 {
-	return std::uniform_int_distribution<>{ min, max }(sRandomEngine);
+	ASSERT(min <= max, "[Math] Random range is empty.");
+	const uint32_t range = static_cast<uint32_t>(max) - static_cast<uint32_t>(min) + 1u; // 0 when it spans every int
+	const uint32_t offset = range == 0 ? GetThreadRandomEngine().Next() : GetThreadRandomEngine().NextBounded(range);
+	return static_cast<int>(static_cast<uint32_t>(min) + offset);
 }
 
 //----------------------------------------------------------------------------------------------------
 
 float NFGE::Math::RandomFloat()
 {
-	return std::uniform_real_distribution<float>{ 0, 1.0f }(sRandomEngine);
+	return GetThreadRandomEngine().NextFloat();
 }
 
 //----------------------------------------------------------------------------------------------------
 
 float NFGE::Math::RandomFloat(float min, float max)
 {
-	return std::uniform_real_distribution<float>{ min, max }(sRandomEngine);
+	return GetThreadRandomEngine().NextFloat(min, max);
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -964,19 +1081,6 @@ Vector2 NFGE::Math::RandomVector2(const Vector2& min, const Vector2& max)
 
 //----------------------------------------------------------------------------------------------------
 
-Vector2 NFGE::Math::RandomUnitCircle(bool normalized)
-{
-	Vector2 randVal{
-		RandomFloat(-1.0f, 1.0f) + 0.001f,
-		RandomFloat(-1.0f, 1.0f)
-	};
-	if (normalized)
-		return Normalize(randVal);
-	return randVal;
-}
-
-//----------------------------------------------------------------------------------------------------
-
 Vector3 NFGE::Math::RandomVector3()
 {
 	return Vector3
@@ -997,46 +1101,4 @@ Vector3 NFGE::Math::RandomVector3(const Vector3& min, const Vector3& max)
 		RandomFloat(min.y, max.y),
 		RandomFloat(min.z, max.z)
 	);
-}
-
-//----------------------------------------------------------------------------------------------------
-
-Vector3 NFGE::Math::RandomUnitSphere()
-{
-	return Normalize(Vector3(
-		RandomFloat(-1.0f, 1.0f) + 0.001f,
-		RandomFloat(-1.0f, 1.0f),
-		RandomFloat(-1.0f, 1.0f))
-	);
-}
-
-//----------------------------------------------------------------------------------------------------
-
-float NFGE::Math::Ease::EaseNone(float t)
-{
-	return Math::Interpolation::LinearSpline(0.0f, 1.0f, t);
-}
-
-float NFGE::Math::Ease::EaseInSine(float t)
-{
-	// -----------------------------------------
-	// --- https://easings.net/en#easeInSine ---
-	// -----------------------------------------
-	return Math::Interpolation::CubicBezier(0.47f, 0.0f, 0.745f, 0.715f, t);
-}
-
-float NFGE::Math::Ease::EaseOutCirc(float t)
-{
-	// -----------------------------------------
-	// --- https://easings.net/en#easeOutCirc ---
-	// -----------------------------------------
-	return Math::Interpolation::CubicBezier(0.075f, 0.82f, 0.165f, 1.0f, t);
-}
-
-float NFGE::Math::Ease::EaseOutMushroom(float t)
-{
-	// -----------------------------------------
-	// --- https://easings.net/en#easeOutCirc ---
-	// -----------------------------------------
-	return Math::Interpolation::CubicBezier(.86f, 0.0f, 0.07f, 1.0f, t);
 }
\ No newline at end of file
@@ -0,0 +1,837 @@
+//====================================================================================================
+// Filename:	Packing.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+#include "SIMDVector3x8.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+using NFGE::Math::Internal::RoundToInt;
+
+namespace
+{
+	constexpr float kSqrt2 = 1.41421356237309505f;
+	constexpr float kHalfSqrt2 = 0.70710678118654752f;
+
+	inline uint32_t AsUInt(float value) { uint32_t bits; std::memcpy(&bits, &value, sizeof(bits)); return bits; }
+	inline float AsFloat(uint32_t bits) { float value; std::memcpy(&value, &bits, sizeof(value)); return value; }
+
+	// Octahedral coordinates are in [-1, 1], the lower hemisphere is folded over the diagonals
+	inline float SignNotZero(float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+
+	// Smallest three quantizes the remaining components from [-1 / sqrt(2), 1 / sqrt(2)]
+	inline uint32_t QuantizeSmallest(float value, float steps)
+	{
+		return static_cast<uint32_t>(RoundToInt(Clamp(value * kHalfSqrt2 + 0.5f, 0.0f, 1.0f) * steps));
+	}
+
+	inline float DequantizeSmallest(uint32_t value, float inverseSteps)
+	{
+		return (static_cast<float>(value) * inverseSteps - 0.5f) * kSqrt2;
+	}
+
+	// Index of the largest component, the first one on ties, with the other three in order and the
+	// signs flipped so the dropped component is positive
+	inline uint32_t SmallestThree(const Quaternion& q, float& a, float& b, float& c)
+	{
+		const float ax = Abs(q.x), ay = Abs(q.y), az = Abs(q.z), aw = Abs(q.w);
+		uint32_t index = 0;
+		float largest = ax;
+		if (ay > largest) { index = 1; largest = ay; }
+		if (az > largest) { index = 2; largest = az; }
+		if (aw > largest) { index = 3; }
+
+		const float dropped = index == 0 ? q.x : index == 1 ? q.y : index == 2 ? q.z : q.w;
+		const float sign = dropped < 0.0f ? -1.0f : 1.0f;
+		a = (index == 0 ? q.y : q.x) * sign;
+		b = (index <= 1 ? q.z : q.y) * sign;
+		c = (index == 3 ? q.z : q.w) * sign;
+		return index;
+	}
+
+	inline Quaternion RebuildSmallestThree(uint32_t index, float a, float b, float c)
+	{
+		const float dropped = sqrtf(Max(1.0f - a * a - b * b - c * c, 0.0f));
+		return Quaternion
+		(
+			index == 0 ? dropped : a,
+			index == 0 ? a : index == 1 ? dropped : b,
+			index <= 1 ? b : index == 2 ? dropped : c,
+			index == 3 ? dropped : c
+		);
+	}
+
+	constexpr float kSteps10 = 1023.0f;
+	constexpr float kSteps20 = 1048575.0f;
+
+#if NFGE_SIMD_X86
+	//----------------------------------------------------------------------------------------------------
+	// AVX2. Each kernel converts whole groups of 8 and returns how many it did, the caller finishes the
+	// tail with the scalar code. The operations match the scalar code one for one, and the kernels are
+	// built without FMA so the compiler cannot contract any of them.
+
+	// 4x4 transpose within each 128 bit lane. Four registers holding two 4 float structs each become
+	// x, y, z, w for structs [0, 2, 4, 6, 1, 3, 5, 7] and back.
+	NFGE_TARGET_AVX2_NO_FMA void Transpose4x2(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+	{
+		const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+		const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+		const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+		const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+		r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+		r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+		r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	// Between struct order [0, 2, 4, 6, 1, 3, 5, 7] and [0 ... 7]
+	NFGE_TARGET_AVX2_NO_FMA __m256i Interleave(__m256i v) { return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)); }
+	NFGE_TARGET_AVX2_NO_FMA __m256i Deinterleave(__m256i v) { return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7)); }
+
+	NFGE_TARGET_AVX2_NO_FMA __m256 Clamp01(__m256 v) { return _mm256_max_ps(_mm256_min_ps(v, _mm256_set1_ps(1.0f)), _mm256_setzero_ps()); }
+	NFGE_TARGET_AVX2_NO_FMA __m256 ClampSigned(__m256 v) { return _mm256_max_ps(_mm256_min_ps(v, _mm256_set1_ps(1.0f)), _mm256_set1_ps(-1.0f)); }
+
+	using NFGE::Math::SIMD::Internal::LoadVector3x8;
+	using NFGE::Math::SIMD::Internal::StoreVector3x8;
+
+	NFGE_TARGET_AVX2_NO_FMA size_t FloatToHalfAVX2(const float* in, uint16_t* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t HalfToFloatAVX2(const uint16_t* in, float* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+			_mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t PackSnorm16AVX2(const float* in, int16_t* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i v = _mm256_cvtps_epi32(_mm256_mul_ps(ClampSigned(_mm256_loadu_ps(in + i)), _mm256_set1_ps(32767.0f)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t PackSnorm8AVX2(const float* in, int8_t* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i v = _mm256_cvtps_epi32(_mm256_mul_ps(ClampSigned(_mm256_loadu_ps(in + i)), _mm256_set1_ps(127.0f)));
+			const __m128i v16 = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi16(v16, v16));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t PackUnorm16AVX2(const float* in, uint16_t* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i v = _mm256_cvtps_epi32(_mm256_mul_ps(Clamp01(_mm256_loadu_ps(in + i)), _mm256_set1_ps(65535.0f)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t PackUnorm8AVX2(const float* in, uint8_t* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i v = _mm256_cvtps_epi32(_mm256_mul_ps(Clamp01(_mm256_loadu_ps(in + i)), _mm256_set1_ps(255.0f)));
+			const __m128i v16 = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(v16, v16));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t UnpackSnorm16AVX2(const int16_t* in, float* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+			_mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_mul_ps(v, _mm256_set1_ps(1.0f / 32767.0f)), _mm256_set1_ps(-1.0f)));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t UnpackSnorm8AVX2(const int8_t* in, float* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i))));
+			_mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_mul_ps(v, _mm256_set1_ps(1.0f / 127.0f)), _mm256_set1_ps(-1.0f)));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t UnpackUnorm16AVX2(const uint16_t* in, float* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+			_mm256_storeu_ps(out + i, _mm256_mul_ps(v, _mm256_set1_ps(1.0f / 65535.0f)));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t UnpackUnorm8AVX2(const uint8_t* in, float* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i))));
+			_mm256_storeu_ps(out + i, _mm256_mul_ps(v, _mm256_set1_ps(1.0f / 255.0f)));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t PackOctahedralAVX2(const Vector3* in, uint32_t* out, size_t count)
+	{
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 minusOne = _mm256_set1_ps(-1.0f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x, y, z;
+			LoadVector3x8(in + i, x, y, z);
+			const __m256 l1 = _mm256_add_ps(_mm256_add_ps(_mm256_andnot_ps(signMask, x), _mm256_andnot_ps(signMask, y)), _mm256_andnot_ps(signMask, z));
+			__m256 px = _mm256_div_ps(x, l1);
+			__m256 py = _mm256_div_ps(y, l1);
+
+			const __m256 foldX = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signMask, py)), _mm256_blendv_ps(minusOne, one, _mm256_cmp_ps(px, zero, _CMP_GE_OQ)));
+			const __m256 foldY = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signMask, px)), _mm256_blendv_ps(minusOne, one, _mm256_cmp_ps(py, zero, _CMP_GE_OQ)));
+			const __m256 lower = _mm256_cmp_ps(z, zero, _CMP_LT_OQ);
+			px = _mm256_blendv_ps(px, foldX, lower);
+			py = _mm256_blendv_ps(py, foldY, lower);
+
+			const __m256i qx = _mm256_cvtps_epi32(_mm256_mul_ps(ClampSigned(px), _mm256_set1_ps(32767.0f)));
+			const __m256i qy = _mm256_cvtps_epi32(_mm256_mul_ps(ClampSigned(py), _mm256_set1_ps(32767.0f)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_or_si256(_mm256_and_si256(qx, _mm256_set1_epi32(0xFFFF)), _mm256_slli_epi32(qy, 16)));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t UnpackOctahedralAVX2(const uint32_t* in, Vector3* out, size_t count)
+	{
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 minusOne = _mm256_set1_ps(-1.0f);
+		const __m256 scale = _mm256_set1_ps(1.0f / 32767.0f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+			__m256 x = _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(p, 16), 16)), scale), minusOne);
+			__m256 y = _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(p, 16)), scale), minusOne);
+			const __m256 z = _mm256_sub_ps(_mm256_sub_ps(one, _mm256_andnot_ps(signMask, x)), _mm256_andnot_ps(signMask, y));
+			const __m256 t = _mm256_max_ps(_mm256_sub_ps(zero, z), zero);
+			const __m256 negT = _mm256_sub_ps(zero, t);
+			x = _mm256_add_ps(x, _mm256_blendv_ps(t, negT, _mm256_cmp_ps(x, zero, _CMP_GE_OQ)));
+			y = _mm256_add_ps(y, _mm256_blendv_ps(t, negT, _mm256_cmp_ps(y, zero, _CMP_GE_OQ)));
+
+			const __m256 lengthSqr = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+			const __m256 inv = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSqr));
+			StoreVector3x8(out + i, _mm256_mul_ps(x, inv), _mm256_mul_ps(y, inv), _mm256_mul_ps(z, inv));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA __m256i QuantizeSmallestAVX2(__m256 v, float steps)
+	{
+		const __m256 u = Clamp01(_mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(kHalfSqrt2)), _mm256_set1_ps(0.5f)));
+		return _mm256_cvtps_epi32(_mm256_mul_ps(u, _mm256_set1_ps(steps)));
+	}
+
+	// Quaternions [0, 2, 4, 6, 1, 3, 5, 7] as index and the three kept components, quantized
+	NFGE_TARGET_AVX2_NO_FMA __m256i SmallestThreeAVX2(const Quaternion* in, float steps, __m256i& a, __m256i& b, __m256i& c)
+	{
+		const float* src = &in->x;
+		__m256 x = _mm256_loadu_ps(src + 0);
+		__m256 y = _mm256_loadu_ps(src + 8);
+		__m256 z = _mm256_loadu_ps(src + 16);
+		__m256 w = _mm256_loadu_ps(src + 24);
+		Transpose4x2(x, y, z, w);
+
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const __m256 ax = _mm256_andnot_ps(signMask, x);
+		const __m256 ay = _mm256_andnot_ps(signMask, y);
+		const __m256 az = _mm256_andnot_ps(signMask, z);
+		const __m256 aw = _mm256_andnot_ps(signMask, w);
+
+		__m256i index = _mm256_setzero_si256();
+		__m256 largest = ax;
+		__m256 dropped = x;
+		__m256 greater = _mm256_cmp_ps(ay, largest, _CMP_GT_OQ);
+		index = _mm256_blendv_epi8(index, _mm256_set1_epi32(1), _mm256_castps_si256(greater));
+		largest = _mm256_blendv_ps(largest, ay, greater);
+		dropped = _mm256_blendv_ps(dropped, y, greater);
+		greater = _mm256_cmp_ps(az, largest, _CMP_GT_OQ);
+		index = _mm256_blendv_epi8(index, _mm256_set1_epi32(2), _mm256_castps_si256(greater));
+		largest = _mm256_blendv_ps(largest, az, greater);
+		dropped = _mm256_blendv_ps(dropped, z, greater);
+		greater = _mm256_cmp_ps(aw, largest, _CMP_GT_OQ);
+		index = _mm256_blendv_epi8(index, _mm256_set1_epi32(3), _mm256_castps_si256(greater));
+		dropped = _mm256_blendv_ps(dropped, w, greater);
+
+		const __m256 sign = _mm256_blendv_ps(_mm256_set1_ps(1.0f), _mm256_set1_ps(-1.0f), _mm256_cmp_ps(dropped, _mm256_setzero_ps(), _CMP_LT_OQ));
+		const __m256 is0 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_setzero_si256()));
+		const __m256 is3 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_set1_epi32(3)));
+		const __m256 upTo1 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(2), index));
+
+		a = QuantizeSmallestAVX2(_mm256_mul_ps(_mm256_blendv_ps(x, y, is0), sign), steps);
+		b = QuantizeSmallestAVX2(_mm256_mul_ps(_mm256_blendv_ps(y, z, upTo1), sign), steps);
+		c = QuantizeSmallestAVX2(_mm256_mul_ps(_mm256_blendv_ps(w, z, is3), sign), steps);
+		return index;
+	}
+
+	// Inverse of SmallestThreeAVX2, quaternions in [0, 2, 4, 6, 1, 3, 5, 7] order
+	NFGE_TARGET_AVX2_NO_FMA void RebuildSmallestThreeAVX2(Quaternion* out, __m256i index, __m256i qa, __m256i qb, __m256i qc, float inverseSteps)
+	{
+		const __m256 half = _mm256_set1_ps(0.5f);
+		const __m256 sqrt2 = _mm256_set1_ps(kSqrt2);
+		const __m256 inverseStepsV = _mm256_set1_ps(inverseSteps);
+		const __m256 a = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(qa), inverseStepsV), half), sqrt2);
+		const __m256 b = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(qb), inverseStepsV), half), sqrt2);
+		const __m256 c = _mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(qc), inverseStepsV), half), sqrt2);
+		__m256 d = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(a, a)), _mm256_mul_ps(b, b)), _mm256_mul_ps(c, c));
+		d = _mm256_sqrt_ps(_mm256_max_ps(d, _mm256_setzero_ps()));
+
+		const __m256 is0 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_setzero_si256()));
+		const __m256 is1 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_set1_epi32(1)));
+		const __m256 is2 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_set1_epi32(2)));
+		const __m256 is3 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(index, _mm256_set1_epi32(3)));
+		const __m256 upTo1 = _mm256_or_ps(is0, is1);
+
+		__m256 x = _mm256_blendv_ps(a, d, is0);
+		__m256 y = _mm256_blendv_ps(_mm256_blendv_ps(b, d, is1), a, is0);
+		__m256 z = _mm256_blendv_ps(_mm256_blendv_ps(c, d, is2), b, upTo1);
+		__m256 w = _mm256_blendv_ps(c, d, is3);
+		Transpose4x2(x, y, z, w);
+		float* dst = &out->x;
+		_mm256_storeu_ps(dst + 0, x);
+		_mm256_storeu_ps(dst + 8, y);
+		_mm256_storeu_ps(dst + 16, z);
+		_mm256_storeu_ps(dst + 24, w);
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t PackQuaternion32AVX2(const Quaternion* in, uint32_t* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i a, b, c;
+			const __m256i index = SmallestThreeAVX2(in + i, kSteps10, a, b, c);
+			const __m256i packed = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(index, 30), _mm256_slli_epi32(a, 20)), _mm256_or_si256(_mm256_slli_epi32(b, 10), c));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), Interleave(packed));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t UnpackQuaternion32AVX2(const uint32_t* in, Quaternion* out, size_t count)
+	{
+		const __m256i mask = _mm256_set1_epi32(0x3FF);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i p = Deinterleave(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+			const __m256i a = _mm256_and_si256(_mm256_srli_epi32(p, 20), mask);
+			const __m256i b = _mm256_and_si256(_mm256_srli_epi32(p, 10), mask);
+			const __m256i c = _mm256_and_si256(p, mask);
+			RebuildSmallestThreeAVX2(out + i, _mm256_srli_epi32(p, 30), a, b, c, 1.0f / kSteps10);
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t PackQuaternion64AVX2(const Quaternion* in, uint64_t* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i a, b, c;
+			const __m256i index = SmallestThreeAVX2(in + i, kSteps20, a, b, c);
+			const __m256i lo = Interleave(_mm256_or_si256(c, _mm256_slli_epi32(b, 20)));
+			const __m256i hi = Interleave(_mm256_or_si256(_mm256_or_si256(_mm256_srli_epi32(b, 12), _mm256_slli_epi32(a, 8)), _mm256_slli_epi32(index, 30)));
+			const __m256i lo64 = _mm256_unpacklo_epi32(lo, hi);
+			const __m256i hi64 = _mm256_unpackhi_epi32(lo, hi);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute2x128_si256(lo64, hi64, 0x20));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 4), _mm256_permute2x128_si256(lo64, hi64, 0x31));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t UnpackQuaternion64AVX2(const uint64_t* in, Quaternion* out, size_t count)
+	{
+		const __m256i mask = _mm256_set1_epi32(0xFFFFF);
+		const __m256i order = _mm256_setr_epi32(0, 4, 2, 6, 1, 5, 3, 7);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 p0 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+			const __m256 p1 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 4)));
+			// Low and high halves of quaternions [0, 1, 4, 5, 2, 3, 6, 7], then reordered
+			const __m256i lo = _mm256_permutevar8x32_epi32(_mm256_castps_si256(_mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0))), order);
+			const __m256i hi = _mm256_permutevar8x32_epi32(_mm256_castps_si256(_mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1))), order);
+			const __m256i a = _mm256_and_si256(_mm256_srli_epi32(hi, 8), mask);
+			const __m256i b = _mm256_or_si256(_mm256_srli_epi32(lo, 20), _mm256_and_si256(_mm256_slli_epi32(hi, 12), mask));
+			const __m256i c = _mm256_and_si256(lo, mask);
+			RebuildSmallestThreeAVX2(out + i, _mm256_srli_epi32(hi, 30), a, b, c, 1.0f / kSteps20);
+		}
+		return i;
+	}
+
+	// colorBits per color channel and the rest of the 32 bits for alpha, r in the low bits
+	NFGE_TARGET_AVX2_NO_FMA size_t PackColorAVX2(const Vector4* in, uint32_t* out, size_t count, int colorBits, float colorSteps, float alphaSteps)
+	{
+		const __m128i shiftG = _mm_cvtsi32_si128(colorBits);
+		const __m128i shiftB = _mm_cvtsi32_si128(colorBits * 2);
+		const __m128i shiftA = _mm_cvtsi32_si128(colorBits * 3);
+		const __m256 colorStepsV = _mm256_set1_ps(colorSteps);
+		const __m256 alphaStepsV = _mm256_set1_ps(alphaSteps);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const float* src = &in[i].x;
+			__m256 r = _mm256_loadu_ps(src + 0);
+			__m256 g = _mm256_loadu_ps(src + 8);
+			__m256 b = _mm256_loadu_ps(src + 16);
+			__m256 a = _mm256_loadu_ps(src + 24);
+			Transpose4x2(r, g, b, a);
+			const __m256i rq = _mm256_cvtps_epi32(_mm256_mul_ps(Clamp01(r), colorStepsV));
+			const __m256i gq = _mm256_cvtps_epi32(_mm256_mul_ps(Clamp01(g), colorStepsV));
+			const __m256i bq = _mm256_cvtps_epi32(_mm256_mul_ps(Clamp01(b), colorStepsV));
+			const __m256i aq = _mm256_cvtps_epi32(_mm256_mul_ps(Clamp01(a), alphaStepsV));
+			const __m256i packed = _mm256_or_si256(_mm256_or_si256(rq, _mm256_sll_epi32(gq, shiftG)), _mm256_or_si256(_mm256_sll_epi32(bq, shiftB), _mm256_sll_epi32(aq, shiftA)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), Interleave(packed));
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA size_t UnpackColorAVX2(const uint32_t* in, Vector4* out, size_t count, int colorBits, float colorScale, float alphaScale)
+	{
+		const __m256i colorMask = _mm256_set1_epi32((1 << colorBits) - 1);
+		const __m128i shiftG = _mm_cvtsi32_si128(colorBits);
+		const __m128i shiftB = _mm_cvtsi32_si128(colorBits * 2);
+		const __m128i shiftA = _mm_cvtsi32_si128(colorBits * 3);
+		const __m256 colorScaleV = _mm256_set1_ps(colorScale);
+		const __m256 alphaScaleV = _mm256_set1_ps(alphaScale);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256i p = Deinterleave(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i)));
+			__m256 r = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(p, colorMask)), colorScaleV);
+			__m256 g = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(p, shiftG), colorMask)), colorScaleV);
+			__m256 b = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(p, shiftB), colorMask)), colorScaleV);
+			__m256 a = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srl_epi32(p, shiftA)), alphaScaleV);
+			Transpose4x2(r, g, b, a);
+			float* dst = &out[i].x;
+			_mm256_storeu_ps(dst + 0, r);
+			_mm256_storeu_ps(dst + 8, g);
+			_mm256_storeu_ps(dst + 16, b);
+			_mm256_storeu_ps(dst + 24, a);
+		}
+		return i;
+	}
+#endif
+}
+
+uint16_t NFGE::Math::FloatToHalf(float value)
+{
+	uint32_t f = AsUInt(value);
+	const uint32_t sign = f & 0x80000000u;
+	f ^= sign;
+
+	uint32_t half;
+	if (f >= 0x47800000u)
+	{
+		// 65536 or more overflows, NaN keeps its top payload bits and is made quiet like vcvtps2ph
+		half = f > 0x7F800000u ? 0x7E00u | ((f >> 13) & 0x3FFu) : 0x7C00u;
+	}
+	else if (f < 0x38800000u)
+	{
+		// Below 2^-14 the result is subnormal, adding 0.5 lines the half's mantissa up with the low bits
+		// and lets the FPU do the rounding
+		half = AsUInt(AsFloat(f) + 0.5f) - AsUInt(0.5f);
+	}
+	else
+	{
+		// Rebias the exponent and round to nearest even on the 13 dropped bits
+		const uint32_t mantissaOdd = (f >> 13) & 1u;
+		f += 0xC8000FFFu + mantissaOdd; // ((15 - 127) << 23) + 0xFFF
+		half = f >> 13;
+	}
+	return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+float NFGE::Math::HalfToFloat(uint16_t half)
+{
+	constexpr uint32_t kExponentMask = 0x7C00u << 13;
+	uint32_t f = (half & 0x7FFFu) << 13;
+	const uint32_t exponent = f & kExponentMask;
+	f += (127 - 15) << 23;
+	if (exponent == kExponentMask)
+	{
+		// Infinity or NaN, NaN is made quiet like vcvtph2ps
+		f += (128 - 16) << 23;
+		if (f & 0x7FFFFFu)
+			f |= 0x400000u;
+	}
+	else if (exponent == 0)
+	{
+		// Subnormal, renormalized by the FPU
+		f = AsUInt(AsFloat(f + (1u << 23)) - AsFloat(113u << 23));
+	}
+	return AsFloat(f | (static_cast<uint32_t>(half & 0x8000u) << 16));
+}
+
+uint32_t NFGE::Math::PackOctahedral(const Vector3& unit)
+{
+	const float l1 = Abs(unit.x) + Abs(unit.y) + Abs(unit.z);
+	float x = unit.x / l1;
+	float y = unit.y / l1;
+	if (unit.z < 0.0f)
+	{
+		const float foldX = (1.0f - Abs(y)) * SignNotZero(x);
+		const float foldY = (1.0f - Abs(x)) * SignNotZero(y);
+		x = foldX;
+		y = foldY;
+	}
+	return static_cast<uint16_t>(PackSnorm16(x)) | (static_cast<uint32_t>(static_cast<uint16_t>(PackSnorm16(y))) << 16);
+}
+
+Vector3 NFGE::Math::UnpackOctahedral(uint32_t packed)
+{
+	float x = UnpackSnorm16(static_cast<int16_t>(packed & 0xFFFFu));
+	float y = UnpackSnorm16(static_cast<int16_t>(packed >> 16));
+	const float z = 1.0f - Abs(x) - Abs(y);
+	const float t = Max(0.0f - z, 0.0f);
+	x += x >= 0.0f ? 0.0f - t : t;
+	y += y >= 0.0f ? 0.0f - t : t;
+	const float inv = 1.0f / sqrtf(x * x + y * y + z * z);
+	return Vector3(x * inv, y * inv, z * inv);
+}
+
+uint32_t NFGE::Math::PackQuaternion32(const Quaternion& unit)
+{
+	float a, b, c;
+	const uint32_t index = SmallestThree(unit, a, b, c);
+	return (index << 30) | (QuantizeSmallest(a, kSteps10) << 20) | (QuantizeSmallest(b, kSteps10) << 10) | QuantizeSmallest(c, kSteps10);
+}
+
+Quaternion NFGE::Math::UnpackQuaternion32(uint32_t packed)
+{
+	constexpr float kInverse = 1.0f / kSteps10;
+	return RebuildSmallestThree
+	(
+		packed >> 30,
+		DequantizeSmallest((packed >> 20) & 0x3FFu, kInverse),
+		DequantizeSmallest((packed >> 10) & 0x3FFu, kInverse),
+		DequantizeSmallest(packed & 0x3FFu, kInverse)
+	);
+}
+
+uint64_t NFGE::Math::PackQuaternion64(const Quaternion& unit)
+{
+	float a, b, c;
+	const uint64_t index = SmallestThree(unit, a, b, c);
+	return (index << 62) | (static_cast<uint64_t>(QuantizeSmallest(a, kSteps20)) << 40) | (static_cast<uint64_t>(QuantizeSmallest(b, kSteps20)) << 20) | QuantizeSmallest(c, kSteps20);
+}
+
+Quaternion NFGE::Math::UnpackQuaternion64(uint64_t packed)
+{
+	constexpr float kInverse = 1.0f / kSteps20;
+	return RebuildSmallestThree
+	(
+		static_cast<uint32_t>(packed >> 62),
+		DequantizeSmallest(static_cast<uint32_t>(packed >> 40) & 0xFFFFFu, kInverse),
+		DequantizeSmallest(static_cast<uint32_t>(packed >> 20) & 0xFFFFFu, kInverse),
+		DequantizeSmallest(static_cast<uint32_t>(packed) & 0xFFFFFu, kInverse)
+	);
+}
+
+uint32_t NFGE::Math::PackRGBA8(const Vector4& color)
+{
+	return static_cast<uint32_t>(PackUnorm8(color.r)) | (static_cast<uint32_t>(PackUnorm8(color.g)) << 8) |
+		(static_cast<uint32_t>(PackUnorm8(color.b)) << 16) | (static_cast<uint32_t>(PackUnorm8(color.a)) << 24);
+}
+
+Vector4 NFGE::Math::UnpackRGBA8(uint32_t packed)
+{
+	return Vector4
+	(
+		UnpackUnorm8(packed & 0xFFu),
+		UnpackUnorm8((packed >> 8) & 0xFFu),
+		UnpackUnorm8((packed >> 16) & 0xFFu),
+		UnpackUnorm8(packed >> 24)
+	);
+}
+
+uint32_t NFGE::Math::PackRGB10A2(const Vector4& color)
+{
+	const auto pack = [](float value, float steps) { return static_cast<uint32_t>(RoundToInt(Clamp(value, 0.0f, 1.0f) * steps)); };
+	return pack(color.r, 1023.0f) | (pack(color.g, 1023.0f) << 10) | (pack(color.b, 1023.0f) << 20) | (pack(color.a, 3.0f) << 30);
+}
+
+Vector4 NFGE::Math::UnpackRGB10A2(uint32_t packed)
+{
+	constexpr float kInverse = 1.0f / 1023.0f;
+	return Vector4
+	(
+		(packed & 0x3FFu) * kInverse,
+		((packed >> 10) & 0x3FFu) * kInverse,
+		((packed >> 20) & 0x3FFu) * kInverse,
+		(packed >> 30) * (1.0f / 3.0f)
+	);
+}
+
+//----------------------------------------------------------------------------------------------------
+// Arrays
+
+void NFGE::Math::FloatToHalf(const float* in, uint16_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = FloatToHalfAVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = FloatToHalf(in[i]);
+}
+
+void NFGE::Math::HalfToFloat(const uint16_t* in, float* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = HalfToFloatAVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = HalfToFloat(in[i]);
+}
+
+void NFGE::Math::PackSnorm16(const float* in, int16_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = PackSnorm16AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = PackSnorm16(in[i]);
+}
+
+void NFGE::Math::PackSnorm8(const float* in, int8_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = PackSnorm8AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = PackSnorm8(in[i]);
+}
+
+void NFGE::Math::PackUnorm16(const float* in, uint16_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = PackUnorm16AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = PackUnorm16(in[i]);
+}
+
+void NFGE::Math::PackUnorm8(const float* in, uint8_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = PackUnorm8AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = PackUnorm8(in[i]);
+}
+
+void NFGE::Math::UnpackSnorm16(const int16_t* in, float* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = UnpackSnorm16AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = UnpackSnorm16(in[i]);
+}
+
+void NFGE::Math::UnpackSnorm8(const int8_t* in, float* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = UnpackSnorm8AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = UnpackSnorm8(in[i]);
+}
+
+void NFGE::Math::UnpackUnorm16(const uint16_t* in, float* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = UnpackUnorm16AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = UnpackUnorm16(in[i]);
+}
+
+void NFGE::Math::UnpackUnorm8(const uint8_t* in, float* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = UnpackUnorm8AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = UnpackUnorm8(in[i]);
+}
+
+void NFGE::Math::PackOctahedral(const Vector3* in, uint32_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = PackOctahedralAVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = PackOctahedral(in[i]);
+}
+
+void NFGE::Math::UnpackOctahedral(const uint32_t* in, Vector3* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = UnpackOctahedralAVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = UnpackOctahedral(in[i]);
+}
+
+void NFGE::Math::PackQuaternion32(const Quaternion* in, uint32_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = PackQuaternion32AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = PackQuaternion32(in[i]);
+}
+
+void NFGE::Math::UnpackQuaternion32(const uint32_t* in, Quaternion* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = UnpackQuaternion32AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = UnpackQuaternion32(in[i]);
+}
+
+void NFGE::Math::PackQuaternion64(const Quaternion* in, uint64_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = PackQuaternion64AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = PackQuaternion64(in[i]);
+}
+
+void NFGE::Math::UnpackQuaternion64(const uint64_t* in, Quaternion* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = UnpackQuaternion64AVX2(in, out, count);
+#endif
+	for (; i < count; ++i)
+		out[i] = UnpackQuaternion64(in[i]);
+}
+
+void NFGE::Math::PackRGBA8(const Vector4* in, uint32_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = PackColorAVX2(in, out, count, 8, 255.0f, 255.0f);
+#endif
+	for (; i < count; ++i)
+		out[i] = PackRGBA8(in[i]);
+}
+
+void NFGE::Math::UnpackRGBA8(const uint32_t* in, Vector4* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = UnpackColorAVX2(in, out, count, 8, 1.0f / 255.0f, 1.0f / 255.0f);
+#endif
+	for (; i < count; ++i)
+		out[i] = UnpackRGBA8(in[i]);
+}
+
+void NFGE::Math::PackRGB10A2(const Vector4* in, uint32_t* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = PackColorAVX2(in, out, count, 10, 1023.0f, 3.0f);
+#endif
+	for (; i < count; ++i)
+		out[i] = PackRGB10A2(in[i]);
+}
+
+void NFGE::Math::UnpackRGB10A2(const uint32_t* in, Vector4* out, size_t count)
+{
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = UnpackColorAVX2(in, out, count, 10, 1.0f / 1023.0f, 1.0f / 3.0f);
+#endif
+	for (; i < count; ++i)
+		out[i] = UnpackRGB10A2(in[i]);
+}
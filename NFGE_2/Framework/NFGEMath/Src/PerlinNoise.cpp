@@ -7,12 +7,18 @@
 #include "Precompiled.h"
 #include "NFGEMath.h"
 
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
 using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
 
-PerlinNoise::PerlinNoise()
+namespace
 {
-	// Initialize the permutation vector with the reference values
-	p = {
+	constexpr size_t kMinSamplesPerTask = 16384; // Below this a worker thread costs more than it saves
+
+	const uint8_t kReferencePermutation[256] = {
 		151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,
 		8,99,37,240,21,10,23,190,6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,
 		35,11,32,57,177,33,88,237,149,56,87,174,20,125,136,171,168,68,175,74,165,71,
@@ -26,39 +32,328 @@ PerlinNoise::PerlinNoise()
 		107,49,192,214,31,181,199,106,157,184,84,204,176,115,121,50,45,127,4,150,254,
 		138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180 };
 
-	// Duplicate the permutation vector
-	p.insert(p.end(), p.begin(), p.end());
+	// Accumulates one octave of signed noise into the running sum
+	inline float FractalTerm(PerlinNoise::FractalType type, float n)
+	{
+		switch (type)
+		{
+		case PerlinNoise::FractalType::Ridged:
+		{
+			const float r = 1.0f - Abs(n);
+			return r * r;
+		}
+		case PerlinNoise::FractalType::Turbulence:
+			return Abs(n);
+		default:
+			return n;
+		}
+	}
+
+#if NFGE_SIMD_X86
+	NFGE_TARGET_AVX2 inline __m256 FadeAVX2(__m256 t)
+	{
+		const __m256 poly = _mm256_fmadd_ps(t, _mm256_fmsub_ps(t, _mm256_set1_ps(6.0f), _mm256_set1_ps(15.0f)), _mm256_set1_ps(10.0f));
+		return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), poly);
+	}
+
+	NFGE_TARGET_AVX2 inline __m256 LerpAVX2(__m256 a, __m256 b, __m256 t)
+	{
+		return _mm256_fmadd_ps(_mm256_sub_ps(b, a), t, a);
+	}
+
+	// The table is bytes, so gather 32 bits at a byte offset and keep the low byte
+	NFGE_TARGET_AVX2 inline __m256i HashAVX2(const uint8_t* table, __m256i index)
+	{
+		return _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 1), _mm256_set1_epi32(0xFF));
+	}
+
+	// Same 12 gradient directions as PerlinNoise::Grad, selected with blends instead of branches
+	NFGE_TARGET_AVX2 inline __m256 GradAVX2(__m256i hash, __m256 x, __m256 y, __m256 z)
+	{
+		const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(0xF));
+		const __m256 hLess8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+		const __m256 hLess4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+		const __m256 h12or14 = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_or_si256(h, _mm256_set1_epi32(2)), _mm256_set1_epi32(14)));
+
+		const __m256 u = _mm256_blendv_ps(y, x, hLess8);
+		const __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, h12or14), y, hLess4);
+
+		// Bit 0 flips u and bit 1 flips v
+		const __m256 uSign = _mm256_castsi256_ps(_mm256_slli_epi32(h, 31));
+		const __m256 vSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+		return _mm256_add_ps(_mm256_xor_ps(u, uSign), _mm256_xor_ps(v, vSign));
+	}
+
+	// Signed noise in [-1, 1] for 8 points
+	NFGE_TARGET_AVX2 __m256 NoiseAVX2(const uint8_t* table, __m256 x, __m256 y, __m256 z)
+	{
+		const __m256i mask = _mm256_set1_epi32(255);
+		const __m256i one = _mm256_set1_epi32(1);
+
+		const __m256 fx = _mm256_floor_ps(x);
+		const __m256 fy = _mm256_floor_ps(y);
+		const __m256 fz = _mm256_floor_ps(z);
+		const __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(fx), mask);
+		const __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(fy), mask);
+		const __m256i Z = _mm256_and_si256(_mm256_cvttps_epi32(fz), mask);
+		x = _mm256_sub_ps(x, fx);
+		y = _mm256_sub_ps(y, fy);
+		z = _mm256_sub_ps(z, fz);
+
+		const __m256 u = FadeAVX2(x);
+		const __m256 v = FadeAVX2(y);
+		const __m256 w = FadeAVX2(z);
+
+		const __m256i A = _mm256_add_epi32(HashAVX2(table, X), Y);
+		const __m256i AA = _mm256_add_epi32(HashAVX2(table, A), Z);
+		const __m256i AB = _mm256_add_epi32(HashAVX2(table, _mm256_add_epi32(A, one)), Z);
+		const __m256i B = _mm256_add_epi32(HashAVX2(table, _mm256_add_epi32(X, one)), Y);
+		const __m256i BA = _mm256_add_epi32(HashAVX2(table, B), Z);
+		const __m256i BB = _mm256_add_epi32(HashAVX2(table, _mm256_add_epi32(B, one)), Z);
+
+		const __m256 oneF = _mm256_set1_ps(1.0f);
+		const __m256 x1 = _mm256_sub_ps(x, oneF);
+		const __m256 y1 = _mm256_sub_ps(y, oneF);
+		const __m256 z1 = _mm256_sub_ps(z, oneF);
+
+		const __m256 u0 = GradAVX2(HashAVX2(table, AA), x, y, z);
+		const __m256 u1 = GradAVX2(HashAVX2(table, BA), x1, y, z);
+		const __m256 u2 = GradAVX2(HashAVX2(table, AB), x, y1, z);
+		const __m256 u3 = GradAVX2(HashAVX2(table, BB), x1, y1, z);
+		const __m256 u4 = GradAVX2(HashAVX2(table, _mm256_add_epi32(AA, one)), x, y, z1);
+		const __m256 u5 = GradAVX2(HashAVX2(table, _mm256_add_epi32(BA, one)), x1, y, z1);
+		const __m256 u6 = GradAVX2(HashAVX2(table, _mm256_add_epi32(AB, one)), x, y1, z1);
+		const __m256 u7 = GradAVX2(HashAVX2(table, _mm256_add_epi32(BB, one)), x1, y1, z1);
+
+		const __m256 w0 = LerpAVX2(LerpAVX2(u0, u1, u), LerpAVX2(u2, u3, u), v);
+		const __m256 w1 = LerpAVX2(LerpAVX2(u4, u5, u), LerpAVX2(u6, u7, u), v);
+		return LerpAVX2(w0, w1, w);
+	}
+
+	// Noise or fractal noise remapped to [0, 1], matching PerlinNoise::Get
+	NFGE_TARGET_AVX2 __m256 SampleAVX2(const uint8_t* table, __m256 x, __m256 y, __m256 z, const PerlinNoise::Fractal* fractal)
+	{
+		const __m256 half = _mm256_set1_ps(0.5f);
+		if (fractal == nullptr)
+		{
+			return _mm256_fmadd_ps(NoiseAVX2(table, x, y, z), half, half);
+		}
+
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const __m256 oneF = _mm256_set1_ps(1.0f);
+		__m256 sum = _mm256_setzero_ps();
+		float amplitude = 1.0f;
+		float amplitudeSum = 0.0f;
+		float frequency = 1.0f;
+		for (uint32_t octave = 0; octave < fractal->octaves; ++octave)
+		{
+			const __m256 f = _mm256_set1_ps(frequency);
+			__m256 n = NoiseAVX2(table, _mm256_mul_ps(x, f), _mm256_mul_ps(y, f), _mm256_mul_ps(z, f));
+			switch (fractal->type)
+			{
+			case PerlinNoise::FractalType::Ridged:
+				n = _mm256_sub_ps(oneF, _mm256_andnot_ps(signMask, n));
+				n = _mm256_mul_ps(n, n);
+				break;
+			case PerlinNoise::FractalType::Turbulence:
+				n = _mm256_andnot_ps(signMask, n);
+				break;
+			default:
+				break;
+			}
+			sum = _mm256_fmadd_ps(n, _mm256_set1_ps(amplitude), sum);
+			amplitudeSum += amplitude;
+			amplitude *= fractal->gain;
+			frequency *= fractal->lacunarity;
+		}
+
+		sum = _mm256_div_ps(sum, _mm256_set1_ps(amplitudeSum));
+		return fractal->type == PerlinNoise::FractalType::FBm ? _mm256_fmadd_ps(sum, half, half) : sum;
+	}
+
+	NFGE_TARGET_AVX2 void FillRowAVX2(const uint8_t* table, float* out, uint32_t width, float originX, float step, float y, float z, const PerlinNoise::Fractal* fractal)
+	{
+		const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+		const __m256 vStep = _mm256_set1_ps(step);
+		const __m256 vOrigin = _mm256_set1_ps(originX);
+		const __m256 vy = _mm256_set1_ps(y);
+		const __m256 vz = _mm256_set1_ps(z);
+
+		for (uint32_t i = 0; i < width; i += 8)
+		{
+			const __m256 vx = _mm256_fmadd_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lanes), vStep, vOrigin);
+			const __m256 result = SampleAVX2(table, vx, vy, vz, fractal);
+			if (i + 8 <= width)
+			{
+				_mm256_storeu_ps(out + i, result);
+			}
+			else
+			{
+				const __m256i store = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(width - i)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+				_mm256_maskstore_ps(out + i, store, result);
+			}
+		}
+	}
+
+	// stride is the distance in floats between consecutive samples, 1 for separate arrays and 3 for Vector3
+	NFGE_TARGET_AVX2 void EvaluateAVX2(const uint8_t* table, const float* x, const float* y, const float* z, size_t stride, float* out, size_t count, const PerlinNoise::Fractal* fractal)
+	{
+		const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const size_t offset = i * stride;
+			__m256 vx, vy, vz;
+			if (stride == 1)
+			{
+				vx = _mm256_loadu_ps(x + offset);
+				vy = _mm256_loadu_ps(y + offset);
+				vz = _mm256_loadu_ps(z + offset);
+			}
+			else
+			{
+				vx = _mm256_i32gather_ps(x + offset, offsets, 4);
+				vy = _mm256_i32gather_ps(y + offset, offsets, 4);
+				vz = _mm256_i32gather_ps(z + offset, offsets, 4);
+			}
+			_mm256_storeu_ps(out + i, SampleAVX2(table, vx, vy, vz, fractal));
+		}
+
+		// Pad the tail so every sample goes through the same kernel
+		if (i < count)
+		{
+			alignas(32) float tx[8] = {}, ty[8] = {}, tz[8] = {}, result[8];
+			for (size_t j = 0; i + j < count; ++j)
+			{
+				const size_t offset = (i + j) * stride;
+				tx[j] = x[offset];
+				ty[j] = y[offset];
+				tz[j] = z[offset];
+			}
+			_mm256_store_ps(result, SampleAVX2(table, _mm256_load_ps(tx), _mm256_load_ps(ty), _mm256_load_ps(tz), fractal));
+			std::copy(result, result + (count - i), out + i);
+		}
+	}
+#endif
 }
 
-PerlinNoise::PerlinNoise(uint32_t seed)
+void NFGE::Math::Internal::FillReferencePermutation(uint8_t* table)
 {
-	// Generate a new permutation vector based on the value of seed
-	p.resize(256);
+	// Initialize the permutation table with the reference values
+	std::copy(std::begin(kReferencePermutation), std::end(kReferencePermutation), table);
 
-	// Fill vector with values from 0 to 255
-	std::iota(p.begin(), p.end(), 0);
+	// Duplicate the permutation table
+	std::copy(table, table + 256, table + 256);
+}
+
+void NFGE::Math::Internal::FillSeededPermutation(uint8_t* table, uint32_t seed)
+{
+	// Fill the first half with values from 0 to 255
+	std::iota(table, table + 256, 0);
 
 	// Initialize a random engine with seed
 	std::default_random_engine engine(seed);
 
 	// Shuffle using the above random engine
-	std::shuffle(p.begin(), p.end(), engine);
+	std::shuffle(table, table + 256, engine);
+
+	// Duplicate the permutation table
+	std::copy(table, table + 256, table + 256);
+}
+
+PerlinNoise::PerlinNoise()
+{
+	Internal::FillReferencePermutation(p.data());
+}
+
+PerlinNoise::PerlinNoise(uint32_t seed)
+{
+	Internal::FillSeededPermutation(p.data(), seed);
+}
+
+float PerlinNoise::Get(float x, float y, float z) const
+{
+	return (Noise(x, y, z) + 1.0f) * 0.5f;
+}
+
+float PerlinNoise::Get(float x, float y, float z, const Fractal& fractal) const
+{
+	ASSERT(fractal.octaves > 0, "[PerlinNoise] Fractal needs at least one octave.");
+
+	float sum = 0.0f;
+	float amplitude = 1.0f;
+	float amplitudeSum = 0.0f;
+	float frequency = 1.0f;
+	for (uint32_t octave = 0; octave < fractal.octaves; ++octave)
+	{
+		sum += amplitude * FractalTerm(fractal.type, Noise(x * frequency, y * frequency, z * frequency));
+		amplitudeSum += amplitude;
+		amplitude *= fractal.gain;
+		frequency *= fractal.lacunarity;
+	}
+
+	sum /= amplitudeSum;
+	return fractal.type == FractalType::FBm ? (sum + 1.0f) * 0.5f : sum;
+}
+
+void PerlinNoise::Fill2D(float* out, uint32_t width, uint32_t height, const Vector2& origin, float step, float z) const
+{
+	FillRows(out, width, height, height, origin.x, origin.y, z, step, nullptr);
+}
+
+void PerlinNoise::Fill2D(float* out, uint32_t width, uint32_t height, const Vector2& origin, float step, float z, const Fractal& fractal) const
+{
+	ASSERT(fractal.octaves > 0, "[PerlinNoise] Fractal needs at least one octave.");
+	FillRows(out, width, height, height, origin.x, origin.y, z, step, &fractal);
+}
+
+void PerlinNoise::Fill3D(float* out, uint32_t width, uint32_t height, uint32_t depth, const Vector3& origin, float step) const
+{
+	FillRows(out, width, height * depth, height, origin.x, origin.y, origin.z, step, nullptr);
+}
+
+void PerlinNoise::Fill3D(float* out, uint32_t width, uint32_t height, uint32_t depth, const Vector3& origin, float step, const Fractal& fractal) const
+{
+	ASSERT(fractal.octaves > 0, "[PerlinNoise] Fractal needs at least one octave.");
+	FillRows(out, width, height * depth, height, origin.x, origin.y, origin.z, step, &fractal);
+}
 
-	// Duplicate the permutation vector
-	p.insert(p.end(), p.begin(), p.end());
+void PerlinNoise::GetBatch(const Vector3* points, float* out, size_t count) const
+{
+	Evaluate(&points->x, &points->y, &points->z, 3, out, count, nullptr);
+}
+
+void PerlinNoise::GetBatch(const Vector3* points, float* out, size_t count, const Fractal& fractal) const
+{
+	ASSERT(fractal.octaves > 0, "[PerlinNoise] Fractal needs at least one octave.");
+	Evaluate(&points->x, &points->y, &points->z, 3, out, count, &fractal);
+}
+
+void PerlinNoise::GetBatch(const float* x, const float* y, const float* z, float* out, size_t count) const
+{
+	Evaluate(x, y, z, 1, out, count, nullptr);
+}
+
+void PerlinNoise::GetBatch(const float* x, const float* y, const float* z, float* out, size_t count, const Fractal& fractal) const
+{
+	ASSERT(fractal.octaves > 0, "[PerlinNoise] Fractal needs at least one octave.");
+	Evaluate(x, y, z, 1, out, count, &fractal);
 }
 
-float PerlinNoise::Get(float x, float y, float z)
+float PerlinNoise::Noise(float x, float y, float z) const
 {
 	// Find the unit cube that contains the point
-	int X = (int)floor(x) & 255;
-	int Y = (int)floor(y) & 255;
-	int Z = (int)floor(z) & 255;
+	const float fx = floor(x);
+	const float fy = floor(y);
+	const float fz = floor(z);
+	int X = (int)fx & 255;
+	int Y = (int)fy & 255;
+	int Z = (int)fz & 255;
 
 	// Find relative x, y, z of point in cube
-	x -= floor(x);
-	y -= floor(y);
-	z -= floor(z);
+	x -= fx;
+	y -= fy;
+	z -= fz;
 
 	// Compute fade curves for each of x, y, z
 	float u = Fade(x);
@@ -92,20 +387,73 @@ float PerlinNoise::Get(float x, float y, float z)
 	float w0 = Lerp(v0, v1, v);
 	float w1 = Lerp(v2, v3, v);
 
-	float res = Lerp(w0, w1, w);
-	return (res + 1.0f) * 0.5f;
+	return Lerp(w0, w1, w);
 }
 
-float PerlinNoise::Fade(float t)
+float PerlinNoise::Fade(float t) const
 {
 	return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
 }
 
-float PerlinNoise::Grad(int hash, float x, float y, float z)
+float PerlinNoise::Grad(int hash, float x, float y, float z) const
 {
 	int h = hash & 0xF;
 	// Convert lower 4 bits of hash into 12 gradient directions
 	float u = h < 8 ? x : y;
 	float v = h < 4 ? y : h == 12 || h == 14 ? x : z;
 	return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
-}
\ No newline at end of file
+}
+
+void PerlinNoise::FillRows(float* out, uint32_t width, uint32_t rows, uint32_t rowsPerSlice, float originX, float originY, float originZ, float step, const Fractal* fractal) const
+{
+	ASSERT(out != nullptr || width == 0 || rows == 0, "[PerlinNoise] Output buffer is null.");
+	if (width == 0 || rows == 0)
+	{
+		return;
+	}
+
+	const size_t minRowsPerTask = std::max<size_t>(1, kMinSamplesPerTask / width);
+	ParallelFor(rows, minRowsPerTask, [&](size_t begin, size_t end)
+	{
+		for (size_t row = begin; row < end; ++row)
+		{
+			const float y = originY + static_cast<float>(row % rowsPerSlice) * step;
+			const float z = originZ + static_cast<float>(row / rowsPerSlice) * step;
+			float* rowOut = out + row * width;
+#if NFGE_SIMD_X86
+			if (GetInstructionSet() == InstructionSet::AVX2)
+			{
+				FillRowAVX2(p.data(), rowOut, width, originX, step, y, z, fractal);
+				continue;
+			}
+#endif
+			for (uint32_t i = 0; i < width; ++i)
+			{
+				const float x = originX + static_cast<float>(i) * step;
+				rowOut[i] = fractal ? Get(x, y, z, *fractal) : Get(x, y, z);
+			}
+		}
+	});
+}
+
+void PerlinNoise::Evaluate(const float* x, const float* y, const float* z, size_t stride, float* out, size_t count, const Fractal* fractal) const
+{
+	ASSERT((x && y && z && out) || count == 0, "[PerlinNoise] Input or output buffer is null.");
+
+	ParallelFor(count, kMinSamplesPerTask, [&](size_t begin, size_t end)
+	{
+		const size_t offset = begin * stride;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+		{
+			EvaluateAVX2(p.data(), x + offset, y + offset, z + offset, stride, out + begin, end - begin, fractal);
+			return;
+		}
+#endif
+		for (size_t i = begin; i < end; ++i)
+		{
+			const size_t index = i * stride;
+			out[i] = fractal ? Get(x[index], y[index], z[index], *fractal) : Get(x[index], y[index], z[index]);
+		}
+	});
+}
@@ -0,0 +1,803 @@
+//====================================================================================================
+// Filename:	PointCloud.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+#include "SIMDVector3x8.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	constexpr size_t kPairwiseLeafSize = 1024;	// Summed straight into the SIMD lanes, 128 points per lane
+	constexpr size_t kBlockSize = 1 << 16;		// Unit of work handed to the threads, always a multiple of kPairwiseLeafSize
+	constexpr size_t kMinBlocksPerTask = 4;		// Below this a worker thread costs more than it saves
+	constexpr uint32_t kMaxGrowPasses = 8;
+	constexpr float kGrowTolerance = 1e-6f;		// Relative, a point this close to the sphere ends the growing
+	constexpr float kContainTolerance = 1e-5f;	// Relative, for the exact sphere of the extreme points
+	constexpr float kRadiusPadding = 1e-6f;		// Relative, about 8 ulp
+	constexpr int kEPOSNormalCount = 7;			// EPOS-14: the axes and the four diagonals
+
+	struct SecondMoments
+	{
+		float xx = 0.0f, xy = 0.0f, xz = 0.0f;
+		float yy = 0.0f, yz = 0.0f, zz = 0.0f;
+
+		SecondMoments operator+(const SecondMoments& rhs) const
+		{
+			return { xx + rhs.xx, xy + rhs.xy, xz + rhs.xz, yy + rhs.yy, yz + rhs.yz, zz + rhs.zz };
+		}
+	};
+
+	struct Extents
+	{
+		Vector3 min{ FLT_MAX };
+		Vector3 max{ -FLT_MAX };
+
+		void Grow(const Vector3& p)
+		{
+			min = { Min(min.x, p.x), Min(min.y, p.y), Min(min.z, p.z) };
+			max = { Max(max.x, p.x), Max(max.y, p.y), Max(max.z, p.z) };
+		}
+
+		Extents operator+(const Extents& rhs) const
+		{
+			Extents result = *this;
+			result.Grow(rhs.min);
+			result.Grow(rhs.max);
+			return result;
+		}
+	};
+
+	// Largest value seen and where it came from
+	struct ArgMax
+	{
+		float value = -FLT_MAX;
+		size_t index = 0;
+
+		// Ties go to the lower index, so the result does not depend on how the array was split
+		void Merge(float v, size_t i)
+		{
+			if (v > value || (v == value && i < index))
+			{
+				value = v;
+				index = i;
+			}
+		}
+
+		ArgMax operator+(const ArgMax& rhs) const
+		{
+			ArgMax result = *this;
+			result.Merge(rhs.value, rhs.index);
+			return result;
+		}
+	};
+
+	// Lowest and highest projection on each EPOS normal and the points they came from
+	struct ExtremePoints
+	{
+		std::array<ArgMax, kEPOSNormalCount> min;	// Of the negated projections
+		std::array<ArgMax, kEPOSNormalCount> max;
+
+		ExtremePoints operator+(const ExtremePoints& rhs) const
+		{
+			ExtremePoints result = *this;
+			for (int k = 0; k < kEPOSNormalCount; ++k)
+			{
+				result.min[k].Merge(rhs.min[k].value, rhs.min[k].index);
+				result.max[k].Merge(rhs.max[k].value, rhs.max[k].index);
+			}
+			return result;
+		}
+	};
+
+	// Unnormalised, the extreme points do not need true distances: x, y, z, x+y+z, x+y-z, x-y+z, x-y-z
+	inline void ProjectEPOS(float x, float y, float z, float* out)
+	{
+		out[0] = x;
+		out[1] = y;
+		out[2] = z;
+		out[3] = x + y + z;
+		out[4] = x + y - z;
+		out[5] = x - y + z;
+		out[6] = x - y - z;
+	}
+
+#if NFGE_SIMD_X86
+	using NFGE::Math::SIMD::Internal::LoadVector3x8;
+
+	NFGE_TARGET_AVX2 float HorizontalSum(__m256 v)
+	{
+		__m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+		s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+		s = _mm_add_ss(s, _mm_movehdup_ps(s));
+		return _mm_cvtss_f32(s);
+	}
+
+	// Picks the best lane with ArgMax::Merge, lane indices are relative to first
+	NFGE_TARGET_AVX2 void MergeLanes(ArgMax& result, __m256 value, __m256i index, size_t first)
+	{
+		alignas(32) float values[8];
+		alignas(32) int32_t indices[8];
+		_mm256_store_ps(values, value);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(indices), index);
+		for (int lane = 0; lane < 8; ++lane)
+		{
+			result.Merge(values[lane], first + indices[lane]);
+		}
+	}
+
+	NFGE_TARGET_AVX2 size_t SumAVX2(const Vector3* points, size_t count, Vector3& sum)
+	{
+		// Summing the raw floats puts a fixed component in every lane: lane j of s0 holds component
+		// j % 3, of s1 (j + 2) % 3 and of s2 (j + 1) % 3
+		const float* src = &points->x;
+		__m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps(), s2 = _mm256_setzero_ps();
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			s0 = _mm256_add_ps(s0, _mm256_loadu_ps(src + i * 3 + 0));
+			s1 = _mm256_add_ps(s1, _mm256_loadu_ps(src + i * 3 + 8));
+			s2 = _mm256_add_ps(s2, _mm256_loadu_ps(src + i * 3 + 16));
+		}
+
+		alignas(32) float l0[8], l1[8], l2[8];
+		_mm256_store_ps(l0, s0);
+		_mm256_store_ps(l1, s1);
+		_mm256_store_ps(l2, s2);
+		float c[3] = {};
+		for (int j = 0; j < 8; ++j)
+		{
+			c[j % 3] += l0[j];
+			c[(j + 2) % 3] += l1[j];
+			c[(j + 1) % 3] += l2[j];
+		}
+		sum = { c[0], c[1], c[2] };
+		return i;
+	}
+
+	NFGE_TARGET_AVX2 size_t MomentsAVX2(const Vector3* points, size_t count, const Vector3& mean, SecondMoments& moments)
+	{
+		const __m256 mx = _mm256_set1_ps(mean.x), my = _mm256_set1_ps(mean.y), mz = _mm256_set1_ps(mean.z);
+		__m256 xx = _mm256_setzero_ps(), xy = _mm256_setzero_ps(), xz = _mm256_setzero_ps();
+		__m256 yy = _mm256_setzero_ps(), yz = _mm256_setzero_ps(), zz = _mm256_setzero_ps();
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x, y, z;
+			LoadVector3x8(points + i, x, y, z);
+			x = _mm256_sub_ps(x, mx);
+			y = _mm256_sub_ps(y, my);
+			z = _mm256_sub_ps(z, mz);
+			xx = _mm256_fmadd_ps(x, x, xx);
+			xy = _mm256_fmadd_ps(x, y, xy);
+			xz = _mm256_fmadd_ps(x, z, xz);
+			yy = _mm256_fmadd_ps(y, y, yy);
+			yz = _mm256_fmadd_ps(y, z, yz);
+			zz = _mm256_fmadd_ps(z, z, zz);
+		}
+		moments = { HorizontalSum(xx), HorizontalSum(xy), HorizontalSum(xz), HorizontalSum(yy), HorizontalSum(yz), HorizontalSum(zz) };
+		return i;
+	}
+
+	NFGE_TARGET_AVX2 size_t ExtentsAVX2(const Vector3* points, size_t count, Extents& extents)
+	{
+		// Same fixed lane components as SumAVX2
+		const float* src = &points->x;
+		__m256 min0 = _mm256_set1_ps(FLT_MAX), min1 = min0, min2 = min0;
+		__m256 max0 = _mm256_set1_ps(-FLT_MAX), max1 = max0, max2 = max0;
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 a = _mm256_loadu_ps(src + i * 3 + 0);
+			const __m256 b = _mm256_loadu_ps(src + i * 3 + 8);
+			const __m256 c = _mm256_loadu_ps(src + i * 3 + 16);
+			min0 = _mm256_min_ps(min0, a); max0 = _mm256_max_ps(max0, a);
+			min1 = _mm256_min_ps(min1, b); max1 = _mm256_max_ps(max1, b);
+			min2 = _mm256_min_ps(min2, c); max2 = _mm256_max_ps(max2, c);
+		}
+
+		alignas(32) float lanes[6][8];
+		_mm256_store_ps(lanes[0], min0);
+		_mm256_store_ps(lanes[1], min1);
+		_mm256_store_ps(lanes[2], min2);
+		_mm256_store_ps(lanes[3], max0);
+		_mm256_store_ps(lanes[4], max1);
+		_mm256_store_ps(lanes[5], max2);
+		for (int j = 0; j < 8; ++j)
+		{
+			const int c0 = j % 3, c1 = (j + 2) % 3, c2 = (j + 1) % 3;
+			extents.min.v[c0] = Min(extents.min.v[c0], lanes[0][j]);
+			extents.min.v[c1] = Min(extents.min.v[c1], lanes[1][j]);
+			extents.min.v[c2] = Min(extents.min.v[c2], lanes[2][j]);
+			extents.max.v[c0] = Max(extents.max.v[c0], lanes[3][j]);
+			extents.max.v[c1] = Max(extents.max.v[c1], lanes[4][j]);
+			extents.max.v[c2] = Max(extents.max.v[c2], lanes[5][j]);
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2 size_t ProjectedExtentsAVX2(const Vector3* points, size_t count, const Vector3* axes, Extents& extents)
+	{
+		__m256 ax[3], ay[3], az[3], mins[3], maxs[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			ax[k] = _mm256_set1_ps(axes[k].x);
+			ay[k] = _mm256_set1_ps(axes[k].y);
+			az[k] = _mm256_set1_ps(axes[k].z);
+			mins[k] = _mm256_set1_ps(FLT_MAX);
+			maxs[k] = _mm256_set1_ps(-FLT_MAX);
+		}
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x, y, z;
+			LoadVector3x8(points + i, x, y, z);
+			for (int k = 0; k < 3; ++k)
+			{
+				const __m256 d = _mm256_fmadd_ps(x, ax[k], _mm256_fmadd_ps(y, ay[k], _mm256_mul_ps(z, az[k])));
+				mins[k] = _mm256_min_ps(mins[k], d);
+				maxs[k] = _mm256_max_ps(maxs[k], d);
+			}
+		}
+
+		alignas(32) float lanes[2][8];
+		for (int k = 0; k < 3; ++k)
+		{
+			_mm256_store_ps(lanes[0], mins[k]);
+			_mm256_store_ps(lanes[1], maxs[k]);
+			for (int j = 0; j < 8; ++j)
+			{
+				extents.min.v[k] = Min(extents.min.v[k], lanes[0][j]);
+				extents.max.v[k] = Max(extents.max.v[k], lanes[1][j]);
+			}
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2 size_t FarthestAVX2(const Vector3* points, size_t count, size_t first, const Vector3& center, ArgMax& result)
+	{
+		const __m256 cx = _mm256_set1_ps(center.x), cy = _mm256_set1_ps(center.y), cz = _mm256_set1_ps(center.z);
+		__m256 best = _mm256_set1_ps(-FLT_MAX);
+		__m256i bestIndex = _mm256_setzero_si256();
+		__m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i eight = _mm256_set1_epi32(8);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x, y, z;
+			LoadVector3x8(points + i, x, y, z);
+			x = _mm256_sub_ps(x, cx);
+			y = _mm256_sub_ps(y, cy);
+			z = _mm256_sub_ps(z, cz);
+			const __m256 d = _mm256_fmadd_ps(x, x, _mm256_fmadd_ps(y, y, _mm256_mul_ps(z, z)));
+			const __m256 better = _mm256_cmp_ps(d, best, _CMP_GT_OQ);
+			best = _mm256_blendv_ps(best, d, better);
+			bestIndex = _mm256_blendv_epi8(bestIndex, index, _mm256_castps_si256(better));
+			index = _mm256_add_epi32(index, eight);
+		}
+		if (i > 0)
+		{
+			MergeLanes(result, best, bestIndex, first);
+		}
+		return i;
+	}
+
+	NFGE_TARGET_AVX2 size_t ExtremePointsAVX2(const Vector3* points, size_t count, size_t first, ExtremePoints& result)
+	{
+		__m256 mins[kEPOSNormalCount], maxs[kEPOSNormalCount];
+		__m256i minIndices[kEPOSNormalCount], maxIndices[kEPOSNormalCount];
+		for (int k = 0; k < kEPOSNormalCount; ++k)
+		{
+			mins[k] = _mm256_set1_ps(-FLT_MAX); // Negated projections, so both sides look for the largest value
+			maxs[k] = _mm256_set1_ps(-FLT_MAX);
+			minIndices[k] = _mm256_setzero_si256();
+			maxIndices[k] = _mm256_setzero_si256();
+		}
+
+		__m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i eight = _mm256_set1_epi32(8);
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x, y, z;
+			LoadVector3x8(points + i, x, y, z);
+			const __m256 xPlusY = _mm256_add_ps(x, y);
+			const __m256 xMinusY = _mm256_sub_ps(x, y);
+			const __m256 projections[kEPOSNormalCount] =
+			{
+				x, y, z,
+				_mm256_add_ps(xPlusY, z), _mm256_sub_ps(xPlusY, z),
+				_mm256_add_ps(xMinusY, z), _mm256_sub_ps(xMinusY, z)
+			};
+			for (int k = 0; k < kEPOSNormalCount; ++k)
+			{
+				const __m256 up = _mm256_cmp_ps(projections[k], maxs[k], _CMP_GT_OQ);
+				maxs[k] = _mm256_blendv_ps(maxs[k], projections[k], up);
+				maxIndices[k] = _mm256_blendv_epi8(maxIndices[k], index, _mm256_castps_si256(up));
+
+				const __m256 negated = _mm256_xor_ps(projections[k], signMask);
+				const __m256 down = _mm256_cmp_ps(negated, mins[k], _CMP_GT_OQ);
+				mins[k] = _mm256_blendv_ps(mins[k], negated, down);
+				minIndices[k] = _mm256_blendv_epi8(minIndices[k], index, _mm256_castps_si256(down));
+			}
+			index = _mm256_add_epi32(index, eight);
+		}
+		if (i > 0)
+		{
+			for (int k = 0; k < kEPOSNormalCount; ++k)
+			{
+				MergeLanes(result.min[k], mins[k], minIndices[k], first);
+				MergeLanes(result.max[k], maxs[k], maxIndices[k], first);
+			}
+		}
+		return i;
+	}
+#endif
+
+	// Leaf and block kernels: the AVX2 loop takes whole groups of 8 points, the scalar loop the rest
+
+	Vector3 SumLeaf(const Vector3* points, size_t count)
+	{
+		Vector3 sum = Vector3::Zero();
+		size_t i = 0;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+			i = SumAVX2(points, count, sum);
+#endif
+		for (; i < count; ++i)
+		{
+			sum += points[i];
+		}
+		return sum;
+	}
+
+	SecondMoments MomentsLeaf(const Vector3* points, size_t count, const Vector3& mean)
+	{
+		SecondMoments moments;
+		size_t i = 0;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+			i = MomentsAVX2(points, count, mean, moments);
+#endif
+		for (; i < count; ++i)
+		{
+			const Vector3 d = points[i] - mean;
+			moments.xx += d.x * d.x;
+			moments.xy += d.x * d.y;
+			moments.xz += d.x * d.z;
+			moments.yy += d.y * d.y;
+			moments.yz += d.y * d.z;
+			moments.zz += d.z * d.z;
+		}
+		return moments;
+	}
+
+	Extents ExtentsBlock(const Vector3* points, size_t count)
+	{
+		Extents extents;
+		size_t i = 0;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+			i = ExtentsAVX2(points, count, extents);
+#endif
+		for (; i < count; ++i)
+		{
+			extents.Grow(points[i]);
+		}
+		return extents;
+	}
+
+	Extents ProjectedExtentsBlock(const Vector3* points, size_t count, const Vector3* axes)
+	{
+		Extents extents;
+		size_t i = 0;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+			i = ProjectedExtentsAVX2(points, count, axes, extents);
+#endif
+		for (; i < count; ++i)
+		{
+			extents.Grow({ Dot(points[i], axes[0]), Dot(points[i], axes[1]), Dot(points[i], axes[2]) });
+		}
+		return extents;
+	}
+
+	ArgMax FarthestBlock(const Vector3* points, size_t count, size_t first, const Vector3& center)
+	{
+		ArgMax result;
+		size_t i = 0;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+			i = FarthestAVX2(points, count, first, center, result);
+#endif
+		for (; i < count; ++i)
+		{
+			result.Merge(DistanceSqr(points[i], center), first + i);
+		}
+		return result;
+	}
+
+	ExtremePoints ExtremePointsBlock(const Vector3* points, size_t count, size_t first)
+	{
+		ExtremePoints result;
+		size_t i = 0;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+			i = ExtremePointsAVX2(points, count, first, result);
+#endif
+		for (; i < count; ++i)
+		{
+			float projections[kEPOSNormalCount];
+			ProjectEPOS(points[i].x, points[i].y, points[i].z, projections);
+			for (int k = 0; k < kEPOSNormalCount; ++k)
+			{
+				result.max[k].Merge(projections[k], first + i);
+				result.min[k].Merge(-projections[k], first + i);
+			}
+		}
+		return result;
+	}
+
+	// Splits in halves on leaf boundaries, so only the last leaf has a scalar tail
+	template <typename T, typename Leaf>
+	T PairwiseSum(const Vector3* points, size_t count, Leaf&& leaf)
+	{
+		if (count <= kPairwiseLeafSize)
+		{
+			return leaf(points, count);
+		}
+		const size_t half = (count / 2 + kPairwiseLeafSize - 1) / kPairwiseLeafSize * kPairwiseLeafSize;
+		return PairwiseSum<T>(points, half, leaf) + PairwiseSum<T>(points + half, count - half, leaf);
+	}
+
+	template <typename T>
+	T CombinePairwise(const T* values, size_t count)
+	{
+		if (count == 1)
+		{
+			return values[0];
+		}
+		const size_t half = count / 2;
+		return CombinePairwise(values, half) + CombinePairwise(values + half, count - half);
+	}
+
+	// Runs block(points, count, first) on every kBlockSize block, on several threads when there are enough
+	// of them, and adds the results up pairwise in block order. The blocks are the same for any thread count.
+	template <typename T, typename Block>
+	T ReduceBlocks(const Vector3* points, size_t count, Block&& block)
+	{
+		const size_t blockCount = (count + kBlockSize - 1) / kBlockSize;
+		if (blockCount <= 1)
+		{
+			return block(points, count, size_t(0));
+		}
+
+		std::vector<T> results(blockCount);
+		ParallelFor(blockCount, kMinBlocksPerTask, [&](size_t begin, size_t end)
+		{
+			for (size_t b = begin; b < end; ++b)
+			{
+				const size_t first = b * kBlockSize;
+				results[b] = block(points + first, Min(kBlockSize, count - first), first);
+			}
+		});
+		return CombinePairwise(results.data(), blockCount);
+	}
+
+	Vector3 SumPoints(const Vector3* points, size_t count)
+	{
+		return ReduceBlocks<Vector3>(points, count, [](const Vector3* blockPoints, size_t blockCount, size_t)
+		{
+			return PairwiseSum<Vector3>(blockPoints, blockCount, SumLeaf);
+		});
+	}
+
+	ArgMax FindFarthest(const Vector3* points, size_t count, const Vector3& center)
+	{
+		return ReduceBlocks<ArgMax>(points, count, [&center](const Vector3* blockPoints, size_t blockCount, size_t first)
+		{
+			return FarthestBlock(blockPoints, blockCount, first, center);
+		});
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// Spheres
+
+	Sphere SphereFromPair(const Vector3& a, const Vector3& b)
+	{
+		return { (a + b) * 0.5f, Distance(a, b) * 0.5f };
+	}
+
+	// The slack scales with the coordinates as well as the radius, a circumcenter's rounding error grows
+	// with how far its points are from the origin
+	bool Contains(const Sphere& sphere, const Vector3& point)
+	{
+		const float scale = Max(Max(Abs(point.x), Abs(point.y)), Max(Abs(point.z), sphere.radius));
+		const float limit = sphere.radius + kContainTolerance * scale;
+		return sphere.radius >= 0.0f && DistanceSqr(sphere.center, point) <= limit * limit;
+	}
+
+	// Smallest sphere through all of the given points. Degenerate triangles and tetrahedra fall back to the
+	// smallest sphere of a subset that still contains every point.
+	Sphere SphereFromBoundary(const Vector3* boundary, int count)
+	{
+		switch (count)
+		{
+		case 0:
+			return { Vector3::Zero(), -1.0f };
+		case 1:
+			return { boundary[0], 0.0f };
+		case 2:
+			return SphereFromPair(boundary[0], boundary[1]);
+		case 3:
+		{
+			const Vector3 a = boundary[1] - boundary[0];
+			const Vector3 b = boundary[2] - boundary[0];
+			const Vector3 n = Cross(a, b);
+			const float nn = MagnitudeSqr(n);
+			if (nn <= 1e-12f * MagnitudeSqr(a) * MagnitudeSqr(b))
+			{
+				// Collinear, the two furthest apart points span the sphere
+				const Sphere ab = SphereFromPair(boundary[0], boundary[1]);
+				const Sphere ac = SphereFromPair(boundary[0], boundary[2]);
+				const Sphere bc = SphereFromPair(boundary[1], boundary[2]);
+				return ab.radius > ac.radius ? (ab.radius > bc.radius ? ab : bc) : (ac.radius > bc.radius ? ac : bc);
+			}
+			const Vector3 offset = (Cross(n, a) * MagnitudeSqr(b) + Cross(b, n) * MagnitudeSqr(a)) / (2.0f * nn);
+			return { boundary[0] + offset, Magnitude(offset) };
+		}
+		default:
+		{
+			const Vector3 a = boundary[1] - boundary[0];
+			const Vector3 b = boundary[2] - boundary[0];
+			const Vector3 c = boundary[3] - boundary[0];
+			const float det = 2.0f * Dot(a, Cross(b, c));
+			if (Abs(det) <= 1e-6f * Magnitude(a) * Magnitude(b) * Magnitude(c))
+			{
+				// Coplanar, take the smallest face sphere that holds the fourth point. If rounding leaves none
+				// that does, the largest one is returned and GrowToFit takes in whatever it misses.
+				Sphere best{ Vector3::Zero(), -1.0f };
+				Sphere largest{ Vector3::Zero(), -1.0f };
+				for (int skip = 0; skip < 4; ++skip)
+				{
+					Vector3 face[3];
+					for (int i = 0, j = 0; i < 4; ++i)
+					{
+						if (i != skip)
+							face[j++] = boundary[i];
+					}
+					const Sphere sphere = SphereFromBoundary(face, 3);
+					if (Contains(sphere, boundary[skip]) && (best.radius < 0.0f || sphere.radius < best.radius))
+						best = sphere;
+					if (sphere.radius > largest.radius)
+						largest = sphere;
+				}
+				return best.radius >= 0.0f ? best : largest;
+			}
+			const Vector3 offset = (Cross(b, c) * MagnitudeSqr(a) + Cross(c, a) * MagnitudeSqr(b) + Cross(a, b) * MagnitudeSqr(c)) / det;
+			return { boundary[0] + offset, Magnitude(offset) };
+		}
+		}
+	}
+
+	// Welzl's algorithm, for the handful of extreme points only
+	Sphere MinimumSphere(const Vector3* points, int count, Vector3* boundary, int boundaryCount)
+	{
+		Sphere sphere = SphereFromBoundary(boundary, boundaryCount);
+		if (boundaryCount == 4)
+		{
+			return sphere;
+		}
+		for (int i = 0; i < count; ++i)
+		{
+			if (!Contains(sphere, points[i]))
+			{
+				boundary[boundaryCount] = points[i];
+				sphere = MinimumSphere(points, i, boundary, boundaryCount + 1);
+			}
+		}
+		return sphere;
+	}
+
+	// Grows the sphere until it holds every point. Each pass finds the point furthest from the center and
+	// moves the sphere just enough to take it in, which vectorises where Ritter's running update cannot.
+	// The last pass settles for the furthest distance around the current center. The final radius is
+	// padded by kRadiusPadding, the SIMD and scalar squared distances can differ in the last bit.
+	Sphere GrowToFit(const Vector3* points, size_t count, Sphere sphere)
+	{
+		for (uint32_t pass = 0; ; ++pass)
+		{
+			const ArgMax farthest = FindFarthest(points, count, sphere.center);
+			const float distance = Sqrt(farthest.value);
+			if (pass + 1 == kMaxGrowPasses || distance <= sphere.radius * (1.0f + kGrowTolerance))
+			{
+				sphere.radius = Max(sphere.radius, distance) * (1.0f + kRadiusPadding);
+				return sphere;
+			}
+
+			const float radius = (sphere.radius + distance) * 0.5f;
+			sphere.center += (points[farthest.index] - sphere.center) * ((radius - sphere.radius) / distance);
+			sphere.radius = radius;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	// PCA
+
+	// Cyclic Jacobi rotations on a symmetric matrix. Eigenvectors come out as unit columns of vectors.
+	void SymmetricEigen(const Matrix3& m, float values[3], Vector3 vectors[3])
+	{
+		float a[3][3] = { { m._11, m._12, m._13 }, { m._21, m._22, m._23 }, { m._31, m._32, m._33 } };
+		float v[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+		const float scale = Abs(a[0][0]) + Abs(a[1][1]) + Abs(a[2][2]);
+
+		for (int sweep = 0; sweep < 16; ++sweep)
+		{
+			const float off = Abs(a[0][1]) + Abs(a[0][2]) + Abs(a[1][2]);
+			if (off <= 1e-7f * scale || off == 0.0f)
+			{
+				break;
+			}
+
+			for (int p = 0; p < 2; ++p)
+			{
+				for (int q = p + 1; q < 3; ++q)
+				{
+					if (a[p][q] == 0.0f)
+					{
+						continue;
+					}
+					const float theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+					const float t = (theta >= 0.0f ? 1.0f : -1.0f) / (Abs(theta) + Sqrt(theta * theta + 1.0f));
+					const float c = 1.0f / Sqrt(t * t + 1.0f);
+					const float s = t * c;
+					for (int k = 0; k < 3; ++k)
+					{
+						const float akp = a[k][p], akq = a[k][q];
+						a[k][p] = c * akp - s * akq;
+						a[k][q] = s * akp + c * akq;
+					}
+					for (int k = 0; k < 3; ++k)
+					{
+						const float apk = a[p][k], aqk = a[q][k];
+						a[p][k] = c * apk - s * aqk;
+						a[q][k] = s * apk + c * aqk;
+					}
+					for (int k = 0; k < 3; ++k)
+					{
+						const float vkp = v[k][p], vkq = v[k][q];
+						v[k][p] = c * vkp - s * vkq;
+						v[k][q] = s * vkp + c * vkq;
+					}
+				}
+			}
+		}
+
+		for (int i = 0; i < 3; ++i)
+		{
+			values[i] = a[i][i];
+			vectors[i] = { v[0][i], v[1][i], v[2][i] };
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Vector3 NFGE::Math::Mean(const Vector3* v, uint32_t count)
+{
+	if (count == 0)
+	{
+		return Vector3::Zero();
+	}
+	return SumPoints(v, count) / static_cast<float>(count);
+}
+
+AABB NFGE::Math::ComputeAABB(const Vector3* points, size_t count)
+{
+	ASSERT(count > 0, "[PointCloud] No points to bound.");
+	const Extents extents = ReduceBlocks<Extents>(points, count, [](const Vector3* blockPoints, size_t blockCount, size_t)
+	{
+		return ExtentsBlock(blockPoints, blockCount);
+	});
+	return AABB::FromMinMax(extents.min, extents.max);
+}
+
+Matrix3 NFGE::Math::ComputeCovariance(const Vector3* points, size_t count, Vector3* mean)
+{
+	ASSERT(count > 0, "[PointCloud] No points to compute the covariance of.");
+	const Vector3 center = SumPoints(points, count) / static_cast<float>(count);
+	const SecondMoments moments = ReduceBlocks<SecondMoments>(points, count, [&center](const Vector3* blockPoints, size_t blockCount, size_t)
+	{
+		return PairwiseSum<SecondMoments>(blockPoints, blockCount, [&center](const Vector3* leafPoints, size_t leafCount)
+		{
+			return MomentsLeaf(leafPoints, leafCount, center);
+		});
+	});
+
+	if (mean)
+	{
+		*mean = center;
+	}
+	const float invCount = 1.0f / static_cast<float>(count);
+	return Matrix3(
+		moments.xx, moments.xy, moments.xz,
+		moments.xy, moments.yy, moments.yz,
+		moments.xz, moments.yz, moments.zz) * invCount;
+}
+
+OBB NFGE::Math::ComputeOBB(const Vector3* points, size_t count)
+{
+	ASSERT(count > 0, "[PointCloud] No points to bound.");
+	float variances[3];
+	Vector3 axes[3];
+	SymmetricEigen(ComputeCovariance(points, count), variances, axes);
+
+	// Longest axis first, and a right handed frame so the axes make a rotation
+	int order[3] = { 0, 1, 2 };
+	std::sort(order, order + 3, [&variances](int a, int b) { return variances[a] > variances[b]; });
+	Vector3 sorted[3] = { Normalize(axes[order[0]]), Normalize(axes[order[1]]), Vector3::Zero() };
+	sorted[2] = Normalize(Cross(sorted[0], sorted[1]));
+
+	const Extents extents = ReduceBlocks<Extents>(points, count, [&sorted](const Vector3* blockPoints, size_t blockCount, size_t)
+	{
+		return ProjectedExtentsBlock(blockPoints, blockCount, sorted);
+	});
+
+	const Vector3 localCenter = (extents.min + extents.max) * 0.5f;
+	const Matrix4 rotation(
+		sorted[0].x, sorted[1].x, sorted[2].x, 0.0f,
+		sorted[0].y, sorted[1].y, sorted[2].y, 0.0f,
+		sorted[0].z, sorted[1].z, sorted[2].z, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+
+	OBB obb;
+	obb.center = sorted[0] * localCenter.x + sorted[1] * localCenter.y + sorted[2] * localCenter.z;
+	obb.extend = (extents.max - extents.min) * 0.5f;
+	obb.orientation = RotMatToQuaternion(rotation);
+	return obb;
+}
+
+Sphere NFGE::Math::ComputeBoundingSphereRitter(const Vector3* points, size_t count)
+{
+	ASSERT(count > 0, "[PointCloud] No points to bound.");
+	const ArgMax y = FindFarthest(points, count, points[0]);
+	const ArgMax z = FindFarthest(points, count, points[y.index]);
+	return GrowToFit(points, count, SphereFromPair(points[y.index], points[z.index]));
+}
+
+Sphere NFGE::Math::ComputeBoundingSphereEPOS(const Vector3* points, size_t count)
+{
+	ASSERT(count > 0, "[PointCloud] No points to bound.");
+	const ExtremePoints extremes = ReduceBlocks<ExtremePoints>(points, count, [](const Vector3* blockPoints, size_t blockCount, size_t first)
+	{
+		return ExtremePointsBlock(blockPoints, blockCount, first);
+	});
+
+	// Relative to the first candidate, so the circumcenters are computed from small coordinates even for
+	// clouds far from the origin
+	const Vector3 origin = points[extremes.min[0].index];
+	Vector3 candidates[2 * kEPOSNormalCount];
+	for (int k = 0; k < kEPOSNormalCount; ++k)
+	{
+		candidates[2 * k + 0] = points[extremes.min[k].index] - origin;
+		candidates[2 * k + 1] = points[extremes.max[k].index] - origin;
+	}
+	Vector3 boundary[4];
+	Sphere sphere = MinimumSphere(candidates, 2 * kEPOSNormalCount, boundary, 0);
+	sphere.center += origin;
+
+	sphere = GrowToFit(points, count, sphere);
+	ASSERT(sphere.radius >= 0.0f && sphere.radius < FLT_MAX, "[PointCloud] Bounding sphere radius %f is not finite.", sphere.radius);
+	return sphere;
+}
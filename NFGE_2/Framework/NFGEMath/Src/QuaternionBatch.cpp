@@ -0,0 +1,377 @@
+//====================================================================================================
+// Filename:	QuaternionBatch.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	// Eberly's coefficients, sin(t theta) / sin(theta) = t * (1 + b1 * (1 + b2 * (... (1 + b8)))) with
+	// b[i] = (u[i] * t^2 - v[i]) * (cos(theta) - 1). The last pair is scaled by 1 + mu to balance the error
+	// of truncating the series after 8 terms.
+	constexpr float kOnePlusMu = 1.85298109240830f;
+	constexpr float kSlerpU[8] = { 1.0f / 3.0f, 1.0f / 10.0f, 1.0f / 21.0f, 1.0f / 36.0f, 1.0f / 55.0f, 1.0f / 78.0f, 1.0f / 105.0f, kOnePlusMu / 136.0f };
+	constexpr float kSlerpV[8] = { 1.0f / 3.0f, 2.0f / 5.0f, 3.0f / 7.0f, 4.0f / 9.0f, 5.0f / 11.0f, 6.0f / 13.0f, 7.0f / 15.0f, kOnePlusMu * 8.0f / 17.0f };
+
+	float SlerpSeries(float t2, float cosThetaMinusOne)
+	{
+		float f = 1.0f;
+		for (int i = 7; i >= 0; --i)
+		{
+			f = 1.0f + (kSlerpU[i] * t2 - kSlerpV[i]) * cosThetaMinusOne * f;
+		}
+		return f;
+	}
+
+	inline float Dot(const Quaternion& a, const Quaternion& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	}
+
+	Quaternion SlerpScalar(const Quaternion& q0, const Quaternion& q1, float t)
+	{
+		float cosTheta = Dot(q0, q1);
+		const float sign = cosTheta < 0.0f ? -1.0f : 1.0f;
+		cosTheta *= sign;
+
+		const float d = 1.0f - t;
+		const float s0 = d * SlerpSeries(d * d, cosTheta - 1.0f);
+		const float s1 = sign * t * SlerpSeries(t * t, cosTheta - 1.0f);
+		return Quaternion(
+			q0.x * s0 + q1.x * s1,
+			q0.y * s0 + q1.y * s1,
+			q0.z * s0 + q1.z * s1,
+			q0.w * s0 + q1.w * s1);
+	}
+
+	Quaternion NlerpScalar(const Quaternion& q0, const Quaternion& q1, float t)
+	{
+		const float s1 = Dot(q0, q1) < 0.0f ? -t : t;
+		const float s0 = 1.0f - t;
+		const Quaternion q(
+			q0.x * s0 + q1.x * s1,
+			q0.y * s0 + q1.y * s1,
+			q0.z * s0 + q1.z * s1,
+			q0.w * s0 + q1.w * s1);
+		return q * (1.0f / sqrtf(Dot(q, q)));
+	}
+
+	// Rows of the rotation matrix, identical to MatrixRotationQuaternion
+	void RotationRows(const Quaternion& q, float* r0, float* r1, float* r2)
+	{
+		const float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+		const float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+		const float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+		const float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+		r0[0] = 1.0f - yy - zz; r0[1] = xy + wz; r0[2] = xz - wy;
+		r1[0] = xy - wz; r1[1] = 1.0f - xx - zz; r1[2] = yz + wx;
+		r2[0] = xz + wy; r2[1] = yz - wx; r2[2] = 1.0f - xx - yy;
+	}
+
+#if NFGE_SIMD_X86
+	// 8 quaternions as components. Loading deinterleaves into lane order 0 2 4 6 1 3 5 7, storing undoes it.
+	struct QuaternionsAVX2
+	{
+		__m256 x, y, z, w;
+	};
+
+	NFGE_TARGET_AVX2 inline void TransposeIn(__m256 r0, __m256 r1, __m256 r2, __m256 r3, __m256& x, __m256& y, __m256& z, __m256& w)
+	{
+		const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+		const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+		const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+		const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+		x = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		y = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		z = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		w = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	// Inverse of TransposeIn, r[k] holds elements 2k and 2k + 1
+	NFGE_TARGET_AVX2 inline void TransposeOut(__m256 x, __m256 y, __m256 z, __m256 w, __m256* r)
+	{
+		const __m256 u0 = _mm256_unpacklo_ps(x, y);
+		const __m256 u1 = _mm256_unpackhi_ps(x, y);
+		const __m256 u2 = _mm256_unpacklo_ps(z, w);
+		const __m256 u3 = _mm256_unpackhi_ps(z, w);
+		r[0] = _mm256_shuffle_ps(u0, u2, _MM_SHUFFLE(1, 0, 1, 0));
+		r[1] = _mm256_shuffle_ps(u0, u2, _MM_SHUFFLE(3, 2, 3, 2));
+		r[2] = _mm256_shuffle_ps(u1, u3, _MM_SHUFFLE(1, 0, 1, 0));
+		r[3] = _mm256_shuffle_ps(u1, u3, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	NFGE_TARGET_AVX2 inline QuaternionsAVX2 LoadAVX2(const Quaternion* q)
+	{
+		const float* f = &q->x;
+		QuaternionsAVX2 result;
+		TransposeIn(_mm256_loadu_ps(f), _mm256_loadu_ps(f + 8), _mm256_loadu_ps(f + 16), _mm256_loadu_ps(f + 24), result.x, result.y, result.z, result.w);
+		return result;
+	}
+
+	NFGE_TARGET_AVX2 inline void StoreAVX2(const QuaternionsAVX2& q, Quaternion* out)
+	{
+		__m256 r[4];
+		TransposeOut(q.x, q.y, q.z, q.w, r);
+		float* f = &out->x;
+		for (int k = 0; k < 4; ++k)
+		{
+			_mm256_storeu_ps(f + 8 * k, r[k]);
+		}
+	}
+
+	NFGE_TARGET_AVX2 inline __m256 LoadWeightsAVX2(const float* t, float constantT)
+	{
+		if (t == nullptr)
+		{
+			return _mm256_set1_ps(constantT);
+		}
+		return _mm256_permutevar8x32_ps(_mm256_loadu_ps(t), _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+	}
+
+	NFGE_TARGET_AVX2 inline __m256 DotAVX2(const QuaternionsAVX2& a, const QuaternionsAVX2& b)
+	{
+		__m256 d = _mm256_mul_ps(a.x, b.x);
+		d = _mm256_fmadd_ps(a.y, b.y, d);
+		d = _mm256_fmadd_ps(a.z, b.z, d);
+		return _mm256_fmadd_ps(a.w, b.w, d);
+	}
+
+	NFGE_TARGET_AVX2 inline QuaternionsAVX2 CombineAVX2(const QuaternionsAVX2& a, __m256 s0, const QuaternionsAVX2& b, __m256 s1)
+	{
+		return {
+			_mm256_fmadd_ps(b.x, s1, _mm256_mul_ps(a.x, s0)),
+			_mm256_fmadd_ps(b.y, s1, _mm256_mul_ps(a.y, s0)),
+			_mm256_fmadd_ps(b.z, s1, _mm256_mul_ps(a.z, s0)),
+			_mm256_fmadd_ps(b.w, s1, _mm256_mul_ps(a.w, s0)) };
+	}
+
+	NFGE_TARGET_AVX2 inline __m256 SlerpSeriesAVX2(__m256 t2, __m256 cosThetaMinusOne)
+	{
+		const __m256 one = _mm256_set1_ps(1.0f);
+		__m256 f = one;
+		for (int i = 7; i >= 0; --i)
+		{
+			const __m256 b = _mm256_mul_ps(_mm256_fmsub_ps(_mm256_set1_ps(kSlerpU[i]), t2, _mm256_set1_ps(kSlerpV[i])), cosThetaMinusOne);
+			f = _mm256_fmadd_ps(b, f, one);
+		}
+		return f;
+	}
+
+	// Slerp or nlerp of 8 quaternion pairs
+	NFGE_TARGET_AVX2 QuaternionsAVX2 BlendAVX2(const QuaternionsAVX2& a, const QuaternionsAVX2& b, __m256 t, bool slerp)
+	{
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const __m256 dot = DotAVX2(a, b);
+		const __m256 sign = _mm256_and_ps(dot, signMask);
+		const __m256 d = _mm256_sub_ps(one, t);
+		if (slerp)
+		{
+			const __m256 cosThetaMinusOne = _mm256_sub_ps(_mm256_andnot_ps(signMask, dot), one);
+			const __m256 s0 = _mm256_mul_ps(d, SlerpSeriesAVX2(_mm256_mul_ps(d, d), cosThetaMinusOne));
+			const __m256 s1 = _mm256_xor_ps(_mm256_mul_ps(t, SlerpSeriesAVX2(_mm256_mul_ps(t, t), cosThetaMinusOne)), sign);
+			return CombineAVX2(a, s0, b, s1);
+		}
+
+		QuaternionsAVX2 q = CombineAVX2(a, d, b, _mm256_xor_ps(t, sign));
+		const __m256 lengthSqr = DotAVX2(q, q);
+
+		// rsqrt plus one Newton step
+		const __m256 r = _mm256_rsqrt_ps(lengthSqr);
+		const __m256 invLength = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), r), _mm256_fnmadd_ps(_mm256_mul_ps(lengthSqr, r), r, _mm256_set1_ps(3.0f)));
+		q.x = _mm256_mul_ps(q.x, invLength);
+		q.y = _mm256_mul_ps(q.y, invLength);
+		q.z = _mm256_mul_ps(q.z, invLength);
+		q.w = _mm256_mul_ps(q.w, invLength);
+		return q;
+	}
+
+	NFGE_TARGET_AVX2 void BlendBatchAVX2(const Quaternion* q0, const Quaternion* q1, const float* t, float constantT, Quaternion* out, size_t count, bool slerp)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 weights = LoadWeightsAVX2(t ? t + i : nullptr, constantT);
+			StoreAVX2(BlendAVX2(LoadAVX2(q0 + i), LoadAVX2(q1 + i), weights, slerp), out + i);
+		}
+
+		// Pad the tail with identity so every element goes through the same kernel
+		if (i < count)
+		{
+			const size_t remaining = count - i;
+			Quaternion a[8], b[8], result[8];
+			float weights[8] = {};
+			std::copy(q0 + i, q0 + count, a);
+			std::copy(q1 + i, q1 + count, b);
+			if (t)
+			{
+				std::copy(t + i, t + count, weights);
+			}
+			StoreAVX2(BlendAVX2(LoadAVX2(a), LoadAVX2(b), LoadWeightsAVX2(t ? weights : nullptr, constantT), slerp), result);
+			std::copy(result, result + remaining, out + i);
+		}
+	}
+
+	// Writes 8 rotations, either as Matrix4 rows (transpose false) or as 3x4 rows holding the columns
+	NFGE_TARGET_AVX2 void RotationBatchAVX2(const Quaternion* q, float* out, size_t count, bool transpose)
+	{
+		const size_t stride = transpose ? 12 : 16;
+		const size_t rows = transpose ? 3 : 4;
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 zero = _mm256_setzero_ps();
+		for (size_t i = 0; i < count; i += 8)
+		{
+			const size_t lanes = std::min<size_t>(8, count - i);
+			Quaternion padded[8];
+			const Quaternion* src = q + i;
+			if (lanes < 8)
+			{
+				std::copy(q + i, q + count, padded);
+				src = padded;
+			}
+
+			const QuaternionsAVX2 v = LoadAVX2(src);
+			const __m256 x2 = _mm256_add_ps(v.x, v.x), y2 = _mm256_add_ps(v.y, v.y), z2 = _mm256_add_ps(v.z, v.z);
+			const __m256 xx = _mm256_mul_ps(v.x, x2), yy = _mm256_mul_ps(v.y, y2), zz = _mm256_mul_ps(v.z, z2);
+			const __m256 xy = _mm256_mul_ps(v.x, y2), xz = _mm256_mul_ps(v.x, z2), yz = _mm256_mul_ps(v.y, z2);
+			const __m256 wx = _mm256_mul_ps(v.w, x2), wy = _mm256_mul_ps(v.w, y2), wz = _mm256_mul_ps(v.w, z2);
+
+			__m256 m[3][3];
+			m[0][0] = _mm256_sub_ps(_mm256_sub_ps(one, yy), zz); m[0][1] = _mm256_add_ps(xy, wz); m[0][2] = _mm256_sub_ps(xz, wy);
+			m[1][0] = _mm256_sub_ps(xy, wz); m[1][1] = _mm256_sub_ps(_mm256_sub_ps(one, xx), zz); m[1][2] = _mm256_add_ps(yz, wx);
+			m[2][0] = _mm256_add_ps(xz, wy); m[2][1] = _mm256_sub_ps(yz, wx); m[2][2] = _mm256_sub_ps(_mm256_sub_ps(one, xx), yy);
+
+			for (size_t row = 0; row < rows; ++row)
+			{
+				__m256 r[4];
+				if (row == 3)
+				{
+					TransposeOut(zero, zero, zero, one, r);
+				}
+				else if (transpose)
+				{
+					TransposeOut(m[0][row], m[1][row], m[2][row], zero, r);
+				}
+				else
+				{
+					TransposeOut(m[row][0], m[row][1], m[row][2], zero, r);
+				}
+
+				for (size_t k = 0; k < 4; ++k)
+				{
+					const size_t element = 2 * k;
+					if (element < lanes)
+					{
+						_mm_storeu_ps(out + (i + element) * stride + row * 4, _mm256_castps256_ps128(r[k]));
+					}
+					if (element + 1 < lanes)
+					{
+						_mm_storeu_ps(out + (i + element + 1) * stride + row * 4, _mm256_extractf128_ps(r[k], 1));
+					}
+				}
+			}
+		}
+	}
+#endif
+
+	void BlendBatch(const Quaternion* q0, const Quaternion* q1, const float* t, float constantT, Quaternion* out, size_t count, bool slerp)
+	{
+		ASSERT((q0 && q1 && out) || count == 0, "[QuaternionBatch] Input or output buffer is null.");
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+		{
+			BlendBatchAVX2(q0, q1, t, constantT, out, count, slerp);
+			return;
+		}
+#endif
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float weight = t ? t[i] : constantT;
+			out[i] = slerp ? SlerpScalar(q0[i], q1[i], weight) : NlerpScalar(q0[i], q1[i], weight);
+		}
+	}
+}
+
+Quaternion NFGE::Math::Fast::Slerp(const Quaternion& q0, const Quaternion& q1, float t)
+{
+	return SlerpScalar(q0, q1, t);
+}
+
+void NFGE::Math::SlerpBatch(const Quaternion* q0, const Quaternion* q1, float t, Quaternion* out, size_t count)
+{
+	BlendBatch(q0, q1, nullptr, t, out, count, true);
+}
+
+void NFGE::Math::SlerpBatch(const Quaternion* q0, const Quaternion* q1, const float* t, Quaternion* out, size_t count)
+{
+	BlendBatch(q0, q1, t, 0.0f, out, count, true);
+}
+
+void NFGE::Math::NlerpBatch(const Quaternion* q0, const Quaternion* q1, float t, Quaternion* out, size_t count)
+{
+	BlendBatch(q0, q1, nullptr, t, out, count, false);
+}
+
+void NFGE::Math::NlerpBatch(const Quaternion* q0, const Quaternion* q1, const float* t, Quaternion* out, size_t count)
+{
+	BlendBatch(q0, q1, t, 0.0f, out, count, false);
+}
+
+void NFGE::Math::QuaternionToMatrixBatch(const Quaternion* q, Matrix4* out, size_t count)
+{
+	ASSERT((q && out) || count == 0, "[QuaternionBatch] Input or output buffer is null.");
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+	{
+		RotationBatchAVX2(q, out->mV.data(), count, false);
+		return;
+	}
+#endif
+	for (size_t i = 0; i < count; ++i)
+	{
+		float* m = out[i].mV.data();
+		RotationRows(q[i], m, m + 4, m + 8);
+		m[3] = m[7] = m[11] = m[12] = m[13] = m[14] = 0.0f;
+		m[15] = 1.0f;
+	}
+}
+
+void NFGE::Math::QuaternionToMatrix3x4Batch(const Quaternion* q, float* out, size_t count)
+{
+	ASSERT((q && out) || count == 0, "[QuaternionBatch] Input or output buffer is null.");
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+	{
+		RotationBatchAVX2(q, out, count, true);
+		return;
+	}
+#endif
+	for (size_t i = 0; i < count; ++i)
+	{
+		float rows[3][3];
+		RotationRows(q[i], rows[0], rows[1], rows[2]);
+		float* m = out + i * 12;
+		for (int c = 0; c < 3; ++c)
+		{
+			m[c * 4 + 0] = rows[0][c];
+			m[c * 4 + 1] = rows[1][c];
+			m[c * 4 + 2] = rows[2][c];
+			m[c * 4 + 3] = 0.0f;
+		}
+	}
+}
+
+void NFGE::Math::QuaternionToMatrix3x4Batch(const Quaternion* q, Matrix3x4* out, size_t count)
+{
+	QuaternionToMatrix3x4Batch(q, &out->_11, count);
+}
@@ -0,0 +1,367 @@
+//====================================================================================================
+// Filename:	Random.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	constexpr size_t kLanes = 8;
+	constexpr float kHalfPi = Constants::Pi * 0.5f;
+
+	uint64_t SplitMix64(uint64_t& x)
+	{
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// Expands a 64 bit seed into xoshiro state, SplitMix64 never yields the forbidden all zero state in practice
+	void ExpandSeed(uint64_t seed, uint32_t* state)
+	{
+		const uint64_t a = SplitMix64(seed);
+		const uint64_t b = SplitMix64(seed);
+		state[0] = static_cast<uint32_t>(a);
+		state[1] = static_cast<uint32_t>(a >> 32);
+		state[2] = static_cast<uint32_t>(b);
+		state[3] = static_cast<uint32_t>(b >> 32);
+	}
+
+	uint64_t NextThreadSeed()
+	{
+		static const uint64_t sBaseSeed = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+		static std::atomic<uint64_t> sThreadCount{ 0 };
+		return sBaseSeed + 0x9E3779B97F4A7C15ull * ++sThreadCount;
+	}
+
+	// One seed per stream, drawn from the engine so a seeded engine gives reproducible bulk output
+	void DrawLaneSeeds(RandomEngine& engine, uint64_t* seeds)
+	{
+		for (size_t lane = 0; lane < kLanes; ++lane)
+		{
+			const uint64_t high = engine.Next();
+			seeds[lane] = (high << 32) | engine.Next();
+		}
+	}
+
+	// cos and sin of 2 pi t for t in [0, 1). Quadrant reduction plus Taylor polynomials on [0, pi / 2), max
+	// error about 1e-7. Written with plain multiplies and adds so the scalar and AVX2 paths round the same.
+	void SinCosTurns(float t, float& cosOut, float& sinOut)
+	{
+		const float a = t * 4.0f;
+		const float quadrant = floorf(a);
+		const float x = (a - quadrant) * kHalfPi;
+		const float x2 = x * x;
+		const float s = x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f + x2 * (-1.0f / 39916800.0f))))));
+		const float c = 1.0f + x2 * (-0.5f + x2 * (1.0f / 24.0f + x2 * (-1.0f / 720.0f + x2 * (1.0f / 40320.0f + x2 * (-1.0f / 3628800.0f + x2 * (1.0f / 479001600.0f))))));
+
+		const int q = static_cast<int>(quadrant) & 3;
+		cosOut = (q & 1) ? s : c;
+		sinOut = (q & 1) ? c : s;
+		if ((q + 1) & 2)
+		{
+			cosOut = -cosOut;
+		}
+		if (q & 2)
+		{
+			sinOut = -sinOut;
+		}
+	}
+
+	Vector3 SphereSample(float u, float v)
+	{
+		const float z = 1.0f - 2.0f * u;
+		const float r = sqrtf(Max(0.0f, 1.0f - z * z));
+		float c, s;
+		SinCosTurns(v, c, s);
+		return { r * c, r * s, z };
+	}
+
+#if NFGE_SIMD_X86
+	struct LanesAVX2
+	{
+		__m256i s0, s1, s2, s3;
+	};
+
+	NFGE_TARGET_AVX2_NO_FMA LanesAVX2 SeedLanesAVX2(const uint64_t* seeds)
+	{
+		alignas(32) uint32_t words[4][kLanes];
+		for (size_t lane = 0; lane < kLanes; ++lane)
+		{
+			uint32_t state[4];
+			ExpandSeed(seeds[lane], state);
+			for (size_t w = 0; w < 4; ++w)
+			{
+				words[w][lane] = state[w];
+			}
+		}
+		LanesAVX2 lanes;
+		lanes.s0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(words[0]));
+		lanes.s1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(words[1]));
+		lanes.s2 = _mm256_load_si256(reinterpret_cast<const __m256i*>(words[2]));
+		lanes.s3 = _mm256_load_si256(reinterpret_cast<const __m256i*>(words[3]));
+		return lanes;
+	}
+
+	// RandomEngine::Next for 8 streams, then the same top 24 bit conversion as NextFloat
+	NFGE_TARGET_AVX2_NO_FMA inline __m256 NextFloatAVX2(LanesAVX2& l)
+	{
+		const __m256i result = _mm256_add_epi32(l.s0, l.s3);
+		const __m256i t = _mm256_slli_epi32(l.s1, 9);
+		l.s2 = _mm256_xor_si256(l.s2, l.s0);
+		l.s3 = _mm256_xor_si256(l.s3, l.s1);
+		l.s1 = _mm256_xor_si256(l.s1, l.s2);
+		l.s0 = _mm256_xor_si256(l.s0, l.s3);
+		l.s2 = _mm256_xor_si256(l.s2, t);
+		l.s3 = _mm256_or_si256(_mm256_slli_epi32(l.s3, 11), _mm256_srli_epi32(l.s3, 21));
+		return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(result, 8)), _mm256_set1_ps(1.0f / 16777216.0f));
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA inline __m256 PolyAVX2(__m256 x2, const float* coefficients, int count)
+	{
+		__m256 p = _mm256_set1_ps(coefficients[count - 1]);
+		for (int i = count - 2; i >= 0; --i)
+		{
+			p = _mm256_add_ps(_mm256_set1_ps(coefficients[i]), _mm256_mul_ps(x2, p));
+		}
+		return p;
+	}
+
+	// Same reduction and polynomials as SinCosTurns
+	NFGE_TARGET_AVX2_NO_FMA void SinCosTurnsAVX2(__m256 t, __m256& cosOut, __m256& sinOut)
+	{
+		static const float kSin[6] = { 1.0f, -1.0f / 6.0f, 1.0f / 120.0f, -1.0f / 5040.0f, 1.0f / 362880.0f, -1.0f / 39916800.0f };
+		static const float kCos[7] = { 1.0f, -0.5f, 1.0f / 24.0f, -1.0f / 720.0f, 1.0f / 40320.0f, -1.0f / 3628800.0f, 1.0f / 479001600.0f };
+
+		const __m256 a = _mm256_mul_ps(t, _mm256_set1_ps(4.0f));
+		const __m256 quadrant = _mm256_floor_ps(a);
+		const __m256 x = _mm256_mul_ps(_mm256_sub_ps(a, quadrant), _mm256_set1_ps(kHalfPi));
+		const __m256 x2 = _mm256_mul_ps(x, x);
+		const __m256 s = _mm256_mul_ps(x, PolyAVX2(x2, kSin, 6));
+		const __m256 c = PolyAVX2(x2, kCos, 7);
+
+		const __m256i q = _mm256_and_si256(_mm256_cvttps_epi32(quadrant), _mm256_set1_epi32(3));
+		const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+		const __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+		const __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30));
+		cosOut = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), cosSign);
+		sinOut = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), sinSign);
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA void RandomFloatsAVX2(const uint64_t* seeds, float* out, size_t count, float min, float max)
+	{
+		LanesAVX2 lanes = SeedLanesAVX2(seeds);
+		const __m256 vMin = _mm256_set1_ps(min);
+		const __m256 vRange = _mm256_set1_ps(max - min);
+		alignas(32) float tail[kLanes];
+		for (size_t i = 0; i < count; i += kLanes)
+		{
+			const __m256 value = _mm256_add_ps(vMin, _mm256_mul_ps(vRange, NextFloatAVX2(lanes)));
+			if (i + kLanes <= count)
+			{
+				_mm256_storeu_ps(out + i, value);
+			}
+			else
+			{
+				_mm256_store_ps(tail, value);
+				std::copy(tail, tail + (count - i), out + i);
+			}
+		}
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA void RandomUnitCircleAVX2(const uint64_t* seeds, Vector2* out, size_t count, bool normalized)
+	{
+		LanesAVX2 lanes = SeedLanesAVX2(seeds);
+		alignas(32) float x[kLanes], y[kLanes];
+		for (size_t i = 0; i < count; i += kLanes)
+		{
+			__m256 radius = _mm256_set1_ps(1.0f);
+			if (!normalized)
+			{
+				radius = _mm256_sqrt_ps(NextFloatAVX2(lanes));
+			}
+			__m256 c, s;
+			SinCosTurnsAVX2(NextFloatAVX2(lanes), c, s);
+			_mm256_store_ps(x, _mm256_mul_ps(radius, c));
+			_mm256_store_ps(y, _mm256_mul_ps(radius, s));
+			for (size_t lane = 0; lane < kLanes && i + lane < count; ++lane)
+			{
+				out[i + lane] = { x[lane], y[lane] };
+			}
+		}
+	}
+
+	NFGE_TARGET_AVX2_NO_FMA void RandomUnitSphereAVX2(const uint64_t* seeds, Vector3* out, size_t count)
+	{
+		LanesAVX2 lanes = SeedLanesAVX2(seeds);
+		const __m256 one = _mm256_set1_ps(1.0f);
+		alignas(32) float x[kLanes], y[kLanes], z[kLanes];
+		for (size_t i = 0; i < count; i += kLanes)
+		{
+			const __m256 vz = _mm256_sub_ps(one, _mm256_mul_ps(_mm256_set1_ps(2.0f), NextFloatAVX2(lanes)));
+			const __m256 r = _mm256_sqrt_ps(_mm256_max_ps(_mm256_setzero_ps(), _mm256_sub_ps(one, _mm256_mul_ps(vz, vz))));
+			__m256 c, s;
+			SinCosTurnsAVX2(NextFloatAVX2(lanes), c, s);
+			_mm256_store_ps(x, _mm256_mul_ps(r, c));
+			_mm256_store_ps(y, _mm256_mul_ps(r, s));
+			_mm256_store_ps(z, vz);
+			for (size_t lane = 0; lane < kLanes && i + lane < count; ++lane)
+			{
+				out[i + lane] = { x[lane], y[lane], z[lane] };
+			}
+		}
+	}
+#endif
+}
+
+void RandomEngine::Seed(uint64_t seed)
+{
+	ExpandSeed(seed, mState);
+}
+
+uint32_t RandomEngine::NextBounded(uint32_t bound)
+{
+	ASSERT(bound > 0, "[RandomEngine] Bound must be greater than zero.");
+
+	// Multiply-shift keeps the high bits, rejecting the few low products that would bias the result
+	uint64_t product = static_cast<uint64_t>(Next()) * bound;
+	uint32_t low = static_cast<uint32_t>(product);
+	if (low < bound)
+	{
+		const uint32_t threshold = (0u - bound) % bound;
+		while (low < threshold)
+		{
+			product = static_cast<uint64_t>(Next()) * bound;
+			low = static_cast<uint32_t>(product);
+		}
+	}
+	return static_cast<uint32_t>(product >> 32);
+}
+
+RandomEngine& NFGE::Math::GetThreadRandomEngine()
+{
+	thread_local RandomEngine sEngine{ NextThreadSeed() };
+	return sEngine;
+}
+
+void NFGE::Math::SeedThreadRandomEngine(uint64_t seed)
+{
+	GetThreadRandomEngine().Seed(seed);
+}
+
+void NFGE::Math::RandomFloats(RandomEngine& engine, float* out, size_t count, float min, float max)
+{
+	ASSERT(out != nullptr || count == 0, "[Random] Output buffer is null.");
+	uint64_t seeds[kLanes];
+	DrawLaneSeeds(engine, seeds);
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+	{
+		RandomFloatsAVX2(seeds, out, count, min, max);
+		return;
+	}
+#endif
+	RandomEngine lanes[kLanes];
+	for (size_t lane = 0; lane < kLanes; ++lane)
+	{
+		lanes[lane].Seed(seeds[lane]);
+	}
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i] = lanes[i % kLanes].NextFloat(min, max);
+	}
+}
+
+void NFGE::Math::RandomUnitCircle(RandomEngine& engine, Vector2* out, size_t count, bool normalized)
+{
+	ASSERT(out != nullptr || count == 0, "[Random] Output buffer is null.");
+	uint64_t seeds[kLanes];
+	DrawLaneSeeds(engine, seeds);
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+	{
+		RandomUnitCircleAVX2(seeds, out, count, normalized);
+		return;
+	}
+#endif
+	RandomEngine lanes[kLanes];
+	for (size_t lane = 0; lane < kLanes; ++lane)
+	{
+		lanes[lane].Seed(seeds[lane]);
+	}
+	for (size_t i = 0; i < count; ++i)
+	{
+		RandomEngine& lane = lanes[i % kLanes];
+		const float radius = normalized ? 1.0f : sqrtf(lane.NextFloat());
+		float c, s;
+		SinCosTurns(lane.NextFloat(), c, s);
+		out[i] = { radius * c, radius * s };
+	}
+}
+
+void NFGE::Math::RandomUnitSphere(RandomEngine& engine, Vector3* out, size_t count)
+{
+	ASSERT(out != nullptr || count == 0, "[Random] Output buffer is null.");
+	uint64_t seeds[kLanes];
+	DrawLaneSeeds(engine, seeds);
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+	{
+		RandomUnitSphereAVX2(seeds, out, count);
+		return;
+	}
+#endif
+	RandomEngine lanes[kLanes];
+	for (size_t lane = 0; lane < kLanes; ++lane)
+	{
+		lanes[lane].Seed(seeds[lane]);
+	}
+	for (size_t i = 0; i < count; ++i)
+	{
+		RandomEngine& lane = lanes[i % kLanes];
+		const float u = lane.NextFloat();
+		out[i] = SphereSample(u, lane.NextFloat());
+	}
+}
+
+void NFGE::Math::RandomFloats(float* out, size_t count, float min, float max)
+{
+	RandomFloats(GetThreadRandomEngine(), out, count, min, max);
+}
+
+void NFGE::Math::RandomUnitCircle(Vector2* out, size_t count, bool normalized)
+{
+	RandomUnitCircle(GetThreadRandomEngine(), out, count, normalized);
+}
+
+void NFGE::Math::RandomUnitSphere(Vector3* out, size_t count)
+{
+	RandomUnitSphere(GetThreadRandomEngine(), out, count);
+}
+
+Vector2 NFGE::Math::RandomUnitCircle(bool normalized)
+{
+	RandomEngine& engine = GetThreadRandomEngine();
+	const float radius = normalized ? 1.0f : sqrtf(engine.NextFloat());
+	float c, s;
+	SinCosTurns(engine.NextFloat(), c, s);
+	return { radius * c, radius * s };
+}
+
+Vector3 NFGE::Math::RandomUnitSphere()
+{
+	RandomEngine& engine = GetThreadRandomEngine();
+	const float u = engine.NextFloat();
+	return SphereSample(u, engine.NextFloat());
+}
@@ -0,0 +1,304 @@
+//====================================================================================================
+// Filename:	RayPacket.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	// Same sequence of operations as Intersect(Ray, AABB), with the per axis swap done by selecting the slab
+	// bounds from the direction signs
+	inline bool SlabScalar(
+		float ox, float oy, float oz, float ix, float iy, float iz, const std::array<int, 3>& sign,
+		float minX, float minY, float minZ, float maxX, float maxY, float maxZ,
+		float& distEntry, float& distExit)
+	{
+		float tmin = ((sign[0] ? maxX : minX) - ox) * ix;
+		float tmax = ((sign[0] ? minX : maxX) - ox) * ix;
+		const float tymin = ((sign[1] ? maxY : minY) - oy) * iy;
+		const float tymax = ((sign[1] ? minY : maxY) - oy) * iy;
+		if ((tmin > tymax) || (tymin > tmax))
+			return false;
+		tmin = (tymin > tmin) ? tymin : tmin;
+		tmax = (tymax < tmax) ? tymax : tmax;
+
+		const float tzmin = ((sign[2] ? maxZ : minZ) - oz) * iz;
+		const float tzmax = ((sign[2] ? minZ : maxZ) - oz) * iz;
+		if ((tmin > tzmax) || (tzmin > tmax))
+			return false;
+		tmin = (tzmin > tmin) ? tzmin : tmin;
+		tmax = (tzmax < tmax) ? tzmax : tmax;
+
+		distEntry = tmin;
+		distExit = tmax;
+		return true;
+	}
+
+#if NFGE_SIMD_X86
+	NFGE_TARGET_SSE41 inline __m128 SlabSSE41(
+		__m128 ox, __m128 oy, __m128 oz, __m128 ix, __m128 iy, __m128 iz,
+		__m128 minX, __m128 minY, __m128 minZ, __m128 maxX, __m128 maxY, __m128 maxZ,
+		float* distEntry, float* distExit)
+	{
+		const __m128 zero = _mm_setzero_ps();
+
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(minX, ox), ix);
+		__m128 t2 = _mm_mul_ps(_mm_sub_ps(maxX, ox), ix);
+		__m128 swap = _mm_cmpnge_ps(ix, zero);
+		__m128 tmin = _mm_blendv_ps(t1, t2, swap);
+		__m128 tmax = _mm_blendv_ps(t2, t1, swap);
+
+		t1 = _mm_mul_ps(_mm_sub_ps(minY, oy), iy);
+		t2 = _mm_mul_ps(_mm_sub_ps(maxY, oy), iy);
+		swap = _mm_cmpnge_ps(iy, zero);
+		const __m128 tymin = _mm_blendv_ps(t1, t2, swap);
+		const __m128 tymax = _mm_blendv_ps(t2, t1, swap);
+		__m128 miss = _mm_or_ps(_mm_cmpgt_ps(tmin, tymax), _mm_cmpgt_ps(tymin, tmax));
+		tmin = _mm_blendv_ps(tmin, tymin, _mm_cmpgt_ps(tymin, tmin));
+		tmax = _mm_blendv_ps(tmax, tymax, _mm_cmplt_ps(tymax, tmax));
+
+		t1 = _mm_mul_ps(_mm_sub_ps(minZ, oz), iz);
+		t2 = _mm_mul_ps(_mm_sub_ps(maxZ, oz), iz);
+		swap = _mm_cmpnge_ps(iz, zero);
+		const __m128 tzmin = _mm_blendv_ps(t1, t2, swap);
+		const __m128 tzmax = _mm_blendv_ps(t2, t1, swap);
+		miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(tmin, tzmax), _mm_cmpgt_ps(tzmin, tmax)));
+		tmin = _mm_blendv_ps(tmin, tzmin, _mm_cmpgt_ps(tzmin, tmin));
+		tmax = _mm_blendv_ps(tmax, tzmax, _mm_cmplt_ps(tzmax, tmax));
+
+		_mm_storeu_ps(distEntry, tmin);
+		_mm_storeu_ps(distExit, tmax);
+		return miss;
+	}
+
+	NFGE_TARGET_SSE41 uint32_t RaysVsBoxSSE41(const float* ox, const float* oy, const float* oz, const float* ix, const float* iy, const float* iz, const AABB& aabb, float* distEntry, float* distExit)
+	{
+		const Vector3 boxMin = aabb.center - aabb.extend;
+		const Vector3 boxMax = aabb.center + aabb.extend;
+		const __m128 miss = SlabSSE41(
+			_mm_load_ps(ox), _mm_load_ps(oy), _mm_load_ps(oz), _mm_load_ps(ix), _mm_load_ps(iy), _mm_load_ps(iz),
+			_mm_set1_ps(boxMin.x), _mm_set1_ps(boxMin.y), _mm_set1_ps(boxMin.z), _mm_set1_ps(boxMax.x), _mm_set1_ps(boxMax.y), _mm_set1_ps(boxMax.z),
+			distEntry, distExit);
+		return ~static_cast<uint32_t>(_mm_movemask_ps(miss)) & 0xF;
+	}
+
+	NFGE_TARGET_SSE41 uint32_t RayVsBoxesSSE41(const CachedRay& ray, const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, float* distEntry, float* distExit)
+	{
+		const __m128 miss = SlabSSE41(
+			_mm_set1_ps(ray.org.x), _mm_set1_ps(ray.org.y), _mm_set1_ps(ray.org.z), _mm_set1_ps(ray.invDir.x), _mm_set1_ps(ray.invDir.y), _mm_set1_ps(ray.invDir.z),
+			_mm_load_ps(minX), _mm_load_ps(minY), _mm_load_ps(minZ), _mm_load_ps(maxX), _mm_load_ps(maxY), _mm_load_ps(maxZ),
+			distEntry, distExit);
+		return ~static_cast<uint32_t>(_mm_movemask_ps(miss)) & 0xF;
+	}
+
+	NFGE_TARGET_AVX2 inline __m256 SlabAVX2(
+		__m256 ox, __m256 oy, __m256 oz, __m256 ix, __m256 iy, __m256 iz,
+		__m256 minX, __m256 minY, __m256 minZ, __m256 maxX, __m256 maxY, __m256 maxZ,
+		float* distEntry, float* distExit)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+
+		__m256 t1 = _mm256_mul_ps(_mm256_sub_ps(minX, ox), ix);
+		__m256 t2 = _mm256_mul_ps(_mm256_sub_ps(maxX, ox), ix);
+		__m256 swap = _mm256_cmp_ps(ix, zero, _CMP_NGE_UQ);
+		__m256 tmin = _mm256_blendv_ps(t1, t2, swap);
+		__m256 tmax = _mm256_blendv_ps(t2, t1, swap);
+
+		t1 = _mm256_mul_ps(_mm256_sub_ps(minY, oy), iy);
+		t2 = _mm256_mul_ps(_mm256_sub_ps(maxY, oy), iy);
+		swap = _mm256_cmp_ps(iy, zero, _CMP_NGE_UQ);
+		const __m256 tymin = _mm256_blendv_ps(t1, t2, swap);
+		const __m256 tymax = _mm256_blendv_ps(t2, t1, swap);
+		__m256 miss = _mm256_or_ps(_mm256_cmp_ps(tmin, tymax, _CMP_GT_OQ), _mm256_cmp_ps(tymin, tmax, _CMP_GT_OQ));
+		tmin = _mm256_blendv_ps(tmin, tymin, _mm256_cmp_ps(tymin, tmin, _CMP_GT_OQ));
+		tmax = _mm256_blendv_ps(tmax, tymax, _mm256_cmp_ps(tymax, tmax, _CMP_LT_OQ));
+
+		t1 = _mm256_mul_ps(_mm256_sub_ps(minZ, oz), iz);
+		t2 = _mm256_mul_ps(_mm256_sub_ps(maxZ, oz), iz);
+		swap = _mm256_cmp_ps(iz, zero, _CMP_NGE_UQ);
+		const __m256 tzmin = _mm256_blendv_ps(t1, t2, swap);
+		const __m256 tzmax = _mm256_blendv_ps(t2, t1, swap);
+		miss = _mm256_or_ps(miss, _mm256_or_ps(_mm256_cmp_ps(tmin, tzmax, _CMP_GT_OQ), _mm256_cmp_ps(tzmin, tmax, _CMP_GT_OQ)));
+		tmin = _mm256_blendv_ps(tmin, tzmin, _mm256_cmp_ps(tzmin, tmin, _CMP_GT_OQ));
+		tmax = _mm256_blendv_ps(tmax, tzmax, _mm256_cmp_ps(tzmax, tmax, _CMP_LT_OQ));
+
+		_mm256_storeu_ps(distEntry, tmin);
+		_mm256_storeu_ps(distExit, tmax);
+		return miss;
+	}
+
+	NFGE_TARGET_AVX2 uint32_t RaysVsBoxAVX2(const RayPacket<8>& rays, const AABB& aabb, float* distEntry, float* distExit)
+	{
+		const Vector3 boxMin = aabb.center - aabb.extend;
+		const Vector3 boxMax = aabb.center + aabb.extend;
+		const __m256 miss = SlabAVX2(
+			_mm256_load_ps(rays.orgX.data()), _mm256_load_ps(rays.orgY.data()), _mm256_load_ps(rays.orgZ.data()),
+			_mm256_load_ps(rays.invDirX.data()), _mm256_load_ps(rays.invDirY.data()), _mm256_load_ps(rays.invDirZ.data()),
+			_mm256_set1_ps(boxMin.x), _mm256_set1_ps(boxMin.y), _mm256_set1_ps(boxMin.z), _mm256_set1_ps(boxMax.x), _mm256_set1_ps(boxMax.y), _mm256_set1_ps(boxMax.z),
+			distEntry, distExit);
+		return ~static_cast<uint32_t>(_mm256_movemask_ps(miss)) & 0xFF;
+	}
+
+	NFGE_TARGET_AVX2 uint32_t RayVsBoxesAVX2(const CachedRay& ray, const AABBPacket<8>& boxes, float* distEntry, float* distExit)
+	{
+		const __m256 miss = SlabAVX2(
+			_mm256_set1_ps(ray.org.x), _mm256_set1_ps(ray.org.y), _mm256_set1_ps(ray.org.z),
+			_mm256_set1_ps(ray.invDir.x), _mm256_set1_ps(ray.invDir.y), _mm256_set1_ps(ray.invDir.z),
+			_mm256_load_ps(boxes.minX.data()), _mm256_load_ps(boxes.minY.data()), _mm256_load_ps(boxes.minZ.data()),
+			_mm256_load_ps(boxes.maxX.data()), _mm256_load_ps(boxes.maxY.data()), _mm256_load_ps(boxes.maxZ.data()),
+			distEntry, distExit);
+		return ~static_cast<uint32_t>(_mm256_movemask_ps(miss)) & 0xFF;
+	}
+#endif
+
+	template <size_t N>
+	uint32_t RaysVsBoxScalar(const RayPacket<N>& rays, const AABB& aabb, float* distEntry, float* distExit)
+	{
+		const Vector3 boxMin = aabb.center - aabb.extend;
+		const Vector3 boxMax = aabb.center + aabb.extend;
+		uint32_t mask = 0;
+		for (size_t i = 0; i < N; ++i)
+		{
+			// Every lane is a different ray, so its signs are taken here
+			const std::array<int, 3> sign{ !(rays.invDirX[i] >= 0.0f), !(rays.invDirY[i] >= 0.0f), !(rays.invDirZ[i] >= 0.0f) };
+			if (SlabScalar(rays.orgX[i], rays.orgY[i], rays.orgZ[i], rays.invDirX[i], rays.invDirY[i], rays.invDirZ[i], sign,
+				boxMin.x, boxMin.y, boxMin.z, boxMax.x, boxMax.y, boxMax.z, distEntry[i], distExit[i]))
+			{
+				mask |= 1u << i;
+			}
+		}
+		return mask;
+	}
+
+	template <size_t N>
+	uint32_t RayVsBoxesScalar(const CachedRay& ray, const AABBPacket<N>& boxes, float* distEntry, float* distExit)
+	{
+		uint32_t mask = 0;
+		for (size_t i = 0; i < N; ++i)
+		{
+			if (SlabScalar(ray.org.x, ray.org.y, ray.org.z, ray.invDir.x, ray.invDir.y, ray.invDir.z, ray.sign,
+				boxes.minX[i], boxes.minY[i], boxes.minZ[i], boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i], distEntry[i], distExit[i]))
+			{
+				mask |= 1u << i;
+			}
+		}
+		return mask;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+template <size_t N>
+void NFGE::Math::RayPacket<N>::Set(size_t lane, const Ray& ray)
+{
+	ASSERT(lane < N, "[RayPacket] Lane out of bound.");
+	orgX[lane] = ray.org.x;
+	orgY[lane] = ray.org.y;
+	orgZ[lane] = ray.org.z;
+	invDirX[lane] = 1.0f / ray.dir.x;
+	invDirY[lane] = 1.0f / ray.dir.y;
+	invDirZ[lane] = 1.0f / ray.dir.z;
+}
+
+template <size_t N>
+void NFGE::Math::AABBPacket<N>::Set(size_t lane, const AABB& aabb)
+{
+	ASSERT(lane < N, "[AABBPacket] Lane out of bound.");
+	const Vector3 boxMin = aabb.center - aabb.extend;
+	const Vector3 boxMax = aabb.center + aabb.extend;
+	minX[lane] = boxMin.x;
+	minY[lane] = boxMin.y;
+	minZ[lane] = boxMin.z;
+	maxX[lane] = boxMax.x;
+	maxY[lane] = boxMax.y;
+	maxZ[lane] = boxMax.z;
+}
+
+template struct NFGE::Math::RayPacket<4>;
+template struct NFGE::Math::RayPacket<8>;
+template struct NFGE::Math::AABBPacket<4>;
+template struct NFGE::Math::AABBPacket<8>;
+
+//----------------------------------------------------------------------------------------------------
+
+bool NFGE::Math::Intersect(const CachedRay& ray, const AABB& aabb, float& distEntry, float& distExit)
+{
+	const Vector3 boxMin = aabb.center - aabb.extend;
+	const Vector3 boxMax = aabb.center + aabb.extend;
+	return SlabScalar(ray.org.x, ray.org.y, ray.org.z, ray.invDir.x, ray.invDir.y, ray.invDir.z, ray.sign,
+		boxMin.x, boxMin.y, boxMin.z, boxMax.x, boxMax.y, boxMax.z, distEntry, distExit);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t NFGE::Math::Intersect(const RayPacket<4>& rays, const AABB& aabb, float* distEntry, float* distExit)
+{
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() != InstructionSet::Scalar)
+	{
+		return RaysVsBoxSSE41(rays.orgX.data(), rays.orgY.data(), rays.orgZ.data(), rays.invDirX.data(), rays.invDirY.data(), rays.invDirZ.data(), aabb, distEntry, distExit);
+	}
+#endif
+	return RaysVsBoxScalar(rays, aabb, distEntry, distExit);
+}
+
+uint32_t NFGE::Math::Intersect(const RayPacket<8>& rays, const AABB& aabb, float* distEntry, float* distExit)
+{
+	switch (GetInstructionSet())
+	{
+#if NFGE_SIMD_X86
+	case InstructionSet::AVX2:
+		return RaysVsBoxAVX2(rays, aabb, distEntry, distExit);
+	case InstructionSet::SSE41:
+	{
+		const uint32_t lo = RaysVsBoxSSE41(rays.orgX.data(), rays.orgY.data(), rays.orgZ.data(), rays.invDirX.data(), rays.invDirY.data(), rays.invDirZ.data(), aabb, distEntry, distExit);
+		const uint32_t hi = RaysVsBoxSSE41(rays.orgX.data() + 4, rays.orgY.data() + 4, rays.orgZ.data() + 4, rays.invDirX.data() + 4, rays.invDirY.data() + 4, rays.invDirZ.data() + 4, aabb, distEntry + 4, distExit + 4);
+		return lo | (hi << 4);
+	}
+#endif
+	default:
+		return RaysVsBoxScalar(rays, aabb, distEntry, distExit);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+uint32_t NFGE::Math::Intersect(const CachedRay& ray, const AABBPacket<4>& boxes, float* distEntry, float* distExit)
+{
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() != InstructionSet::Scalar)
+	{
+		return RayVsBoxesSSE41(ray, boxes.minX.data(), boxes.minY.data(), boxes.minZ.data(), boxes.maxX.data(), boxes.maxY.data(), boxes.maxZ.data(), distEntry, distExit);
+	}
+#endif
+	return RayVsBoxesScalar(ray, boxes, distEntry, distExit);
+}
+
+uint32_t NFGE::Math::Intersect(const CachedRay& ray, const AABBPacket<8>& boxes, float* distEntry, float* distExit)
+{
+	switch (GetInstructionSet())
+	{
+#if NFGE_SIMD_X86
+	case InstructionSet::AVX2:
+		return RayVsBoxesAVX2(ray, boxes, distEntry, distExit);
+	case InstructionSet::SSE41:
+	{
+		const uint32_t lo = RayVsBoxesSSE41(ray, boxes.minX.data(), boxes.minY.data(), boxes.minZ.data(), boxes.maxX.data(), boxes.maxY.data(), boxes.maxZ.data(), distEntry, distExit);
+		const uint32_t hi = RayVsBoxesSSE41(ray, boxes.minX.data() + 4, boxes.minY.data() + 4, boxes.minZ.data() + 4, boxes.maxX.data() + 4, boxes.maxY.data() + 4, boxes.maxZ.data() + 4, distEntry + 4, distExit + 4);
+		return lo | (hi << 4);
+	}
+#endif
+	default:
+		return RayVsBoxesScalar(ray, boxes, distEntry, distExit);
+	}
+}
@@ -0,0 +1,288 @@
+//====================================================================================================
+// Filename:	SIMD.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	InstructionSet DetectInstructionSet()
+	{
+#if NFGE_SIMD_X86
+		int info1[4]{};
+		int info7[4]{};
+#if defined(_MSC_VER)
+		__cpuid(info1, 1);
+		__cpuidex(info7, 7, 0);
+#else
+		__cpuid_count(1, 0, info1[0], info1[1], info1[2], info1[3]);
+		__cpuid_count(7, 0, info7[0], info7[1], info7[2], info7[3]);
+#endif
+		const bool sse41 = (info1[2] & (1 << 19)) != 0;
+		const bool fma = (info1[2] & (1 << 12)) != 0;
+		const bool osxsave = (info1[2] & (1 << 27)) != 0;
+		const bool avx = (info1[2] & (1 << 28)) != 0;
+		const bool f16c = (info1[2] & (1 << 29)) != 0;
+		const bool avx2 = (info7[1] & (1 << 5)) != 0;
+
+		// The OS also has to save the ymm registers on context switch
+		bool ymmEnabled = false;
+		if (osxsave && avx)
+		{
+#if defined(_MSC_VER)
+			const unsigned long long xcr0 = _xgetbv(0);
+#else
+			uint32_t eax = 0, edx = 0;
+			__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			const unsigned long long xcr0 = ((unsigned long long)edx << 32) | eax;
+#endif
+			ymmEnabled = (xcr0 & 0x6) == 0x6;
+		}
+
+		if (ymmEnabled && avx2 && fma && f16c)
+			return InstructionSet::AVX2;
+		if (sse41)
+			return InstructionSet::SSE41;
+#endif
+		return InstructionSet::Scalar;
+	}
+
+	const InstructionSet sSupportedInstructionSet = DetectInstructionSet();
+
+	//----------------------------------------------------------------------------------------------------
+	// Scalar
+
+	void MatrixMultiplyScalar(float* out, const float* a, const float* b)
+	{
+		float r[16];
+		for (int i = 0; i < 4; ++i)
+		{
+			const float a0 = a[i * 4 + 0], a1 = a[i * 4 + 1], a2 = a[i * 4 + 2], a3 = a[i * 4 + 3];
+			r[i * 4 + 0] = a0 * b[0] + a1 * b[4] + a2 * b[8] + a3 * b[12];
+			r[i * 4 + 1] = a0 * b[1] + a1 * b[5] + a2 * b[9] + a3 * b[13];
+			r[i * 4 + 2] = a0 * b[2] + a1 * b[6] + a2 * b[10] + a3 * b[14];
+			r[i * 4 + 3] = a0 * b[3] + a1 * b[7] + a2 * b[11] + a3 * b[15];
+		}
+		std::copy(r, r + 16, out);
+	}
+
+	void TransformScalar(float* out, const float* v, const float* m)
+	{
+		const float x = v[0], y = v[1], z = v[2], w = v[3];
+		out[0] = x * m[0] + y * m[4] + z * m[8] + w * m[12];
+		out[1] = x * m[1] + y * m[5] + z * m[9] + w * m[13];
+		out[2] = x * m[2] + y * m[6] + z * m[10] + w * m[14];
+		out[3] = x * m[3] + y * m[7] + z * m[11] + w * m[15];
+	}
+
+#if NFGE_SIMD_X86
+	//----------------------------------------------------------------------------------------------------
+	// SSE4.1
+
+	NFGE_TARGET_SSE41 inline __m128 RowTimesMatrix(__m128 row, __m128 b0, __m128 b1, __m128 b2, __m128 b3)
+	{
+		__m128 r = _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+		return r;
+	}
+
+	NFGE_TARGET_SSE41 void MatrixMultiplySSE41(float* out, const float* a, const float* b)
+	{
+		const __m128 b0 = _mm_loadu_ps(b + 0);
+		const __m128 b1 = _mm_loadu_ps(b + 4);
+		const __m128 b2 = _mm_loadu_ps(b + 8);
+		const __m128 b3 = _mm_loadu_ps(b + 12);
+		const __m128 a0 = _mm_loadu_ps(a + 0);
+		const __m128 a1 = _mm_loadu_ps(a + 4);
+		const __m128 a2 = _mm_loadu_ps(a + 8);
+		const __m128 a3 = _mm_loadu_ps(a + 12);
+		_mm_storeu_ps(out + 0, RowTimesMatrix(a0, b0, b1, b2, b3));
+		_mm_storeu_ps(out + 4, RowTimesMatrix(a1, b0, b1, b2, b3));
+		_mm_storeu_ps(out + 8, RowTimesMatrix(a2, b0, b1, b2, b3));
+		_mm_storeu_ps(out + 12, RowTimesMatrix(a3, b0, b1, b2, b3));
+	}
+
+	NFGE_TARGET_SSE41 inline __m128 TransformSSE41(__m128 v, const float* m)
+	{
+		return RowTimesMatrix(v, _mm_loadu_ps(m + 0), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12));
+	}
+
+	NFGE_TARGET_SSE41 void TransformSSE41(float* out, const float* v, const float* m)
+	{
+		_mm_storeu_ps(out, TransformSSE41(_mm_loadu_ps(v), m));
+	}
+
+	NFGE_TARGET_SSE41 void TransformCoordSSE41(float* out, const float* v, const float* m)
+	{
+		const __m128 r = TransformSSE41(_mm_setr_ps(v[0], v[1], v[2], 1.0f), m);
+		const __m128 p = _mm_div_ps(r, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
+		alignas(16) float f[4];
+		_mm_store_ps(f, p);
+		out[0] = f[0]; out[1] = f[1]; out[2] = f[2];
+	}
+
+	NFGE_TARGET_SSE41 void TransformNormalSSE41(float* out, const float* v, const float* m)
+	{
+		alignas(16) float f[4];
+		_mm_store_ps(f, TransformSSE41(_mm_setr_ps(v[0], v[1], v[2], 0.0f), m));
+		out[0] = f[0]; out[1] = f[1]; out[2] = f[2];
+	}
+
+	//----------------------------------------------------------------------------------------------------
+	// AVX2 + FMA
+
+	NFGE_TARGET_AVX2 inline __m256 TwoRowsTimesMatrix(__m256 rows, __m256 b0, __m256 b1, __m256 b2, __m256 b3)
+	{
+		__m256 r = _mm256_mul_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+		r = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(1, 1, 1, 1)), b1, r);
+		r = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(2, 2, 2, 2)), b2, r);
+		r = _mm256_fmadd_ps(_mm256_permute_ps(rows, _MM_SHUFFLE(3, 3, 3, 3)), b3, r);
+		return r;
+	}
+
+	NFGE_TARGET_AVX2 void MatrixMultiplyAVX2(float* out, const float* a, const float* b)
+	{
+		// Each 256 bit register holds two rows of a, b rows are duplicated into both lanes
+		const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 0));
+		const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+		const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+		const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+		const __m256 a01 = _mm256_loadu_ps(a + 0);
+		const __m256 a23 = _mm256_loadu_ps(a + 8);
+		_mm256_storeu_ps(out + 0, TwoRowsTimesMatrix(a01, b0, b1, b2, b3));
+		_mm256_storeu_ps(out + 8, TwoRowsTimesMatrix(a23, b0, b1, b2, b3));
+	}
+
+	NFGE_TARGET_AVX2 inline __m128 TransformAVX2(__m128 v, const float* m)
+	{
+		__m128 r = _mm_mul_ps(_mm_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)), _mm_loadu_ps(m + 0));
+		r = _mm_fmadd_ps(_mm_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1)), _mm_loadu_ps(m + 4), r);
+		r = _mm_fmadd_ps(_mm_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2)), _mm_loadu_ps(m + 8), r);
+		r = _mm_fmadd_ps(_mm_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3)), _mm_loadu_ps(m + 12), r);
+		return r;
+	}
+
+	NFGE_TARGET_AVX2 void TransformAVX2(float* out, const float* v, const float* m)
+	{
+		_mm_storeu_ps(out, TransformAVX2(_mm_loadu_ps(v), m));
+	}
+
+	NFGE_TARGET_AVX2 void TransformCoordAVX2(float* out, const float* v, const float* m)
+	{
+		const __m128 r = TransformAVX2(_mm_setr_ps(v[0], v[1], v[2], 1.0f), m);
+		const __m128 p = _mm_div_ps(r, _mm_permute_ps(r, _MM_SHUFFLE(3, 3, 3, 3)));
+		alignas(16) float f[4];
+		_mm_store_ps(f, p);
+		out[0] = f[0]; out[1] = f[1]; out[2] = f[2];
+	}
+
+	NFGE_TARGET_AVX2 void TransformNormalAVX2(float* out, const float* v, const float* m)
+	{
+		alignas(16) float f[4];
+		_mm_store_ps(f, TransformAVX2(_mm_setr_ps(v[0], v[1], v[2], 0.0f), m));
+		out[0] = f[0]; out[1] = f[1]; out[2] = f[2];
+	}
+#endif
+}
+
+InstructionSet NFGE::Math::SIMD::Internal::sInstructionSet = sSupportedInstructionSet;
+
+InstructionSet NFGE::Math::SIMD::GetSupportedInstructionSet()
+{
+	return sSupportedInstructionSet;
+}
+
+void NFGE::Math::SIMD::SetInstructionSet(InstructionSet instructionSet)
+{
+	Internal::sInstructionSet = Min(instructionSet, sSupportedInstructionSet);
+}
+
+const char* NFGE::Math::SIMD::GetInstructionSetName(InstructionSet instructionSet)
+{
+	switch (instructionSet)
+	{
+	case InstructionSet::SSE41: return "SSE4.1";
+	case InstructionSet::AVX2: return "AVX2+FMA";
+	default: return "Scalar";
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::SIMD::MatrixMultiply(Matrix4& out, const Matrix4& a, const Matrix4& b)
+{
+	switch (GetInstructionSet())
+	{
+#if NFGE_SIMD_X86
+	case InstructionSet::AVX2: MatrixMultiplyAVX2(out.mV.data(), a.mV.data(), b.mV.data()); break;
+	case InstructionSet::SSE41: MatrixMultiplySSE41(out.mV.data(), a.mV.data(), b.mV.data()); break;
+#endif
+	default: MatrixMultiplyScalar(out.mV.data(), a.mV.data(), b.mV.data()); break;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Vector4 NFGE::Math::SIMD::Transform(const Vector4& v, const Matrix4& m)
+{
+	const float in[4] = { v.x, v.y, v.z, v.w };
+	float out[4];
+	switch (GetInstructionSet())
+	{
+#if NFGE_SIMD_X86
+	case InstructionSet::AVX2: TransformAVX2(out, in, m.mV.data()); break;
+	case InstructionSet::SSE41: TransformSSE41(out, in, m.mV.data()); break;
+#endif
+	default: TransformScalar(out, in, m.mV.data()); break;
+	}
+	return Vector4(out[0], out[1], out[2], out[3]);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Vector3 NFGE::Math::SIMD::TransformCoord(const Vector3& v, const Matrix4& m)
+{
+	Vector3 ret;
+	switch (GetInstructionSet())
+	{
+#if NFGE_SIMD_X86
+	case InstructionSet::AVX2: TransformCoordAVX2(ret.v.data(), v.v.data(), m.mV.data()); break;
+	case InstructionSet::SSE41: TransformCoordSSE41(ret.v.data(), v.v.data(), m.mV.data()); break;
+#endif
+	default: ret = Math::TransformCoord(v, m); break;
+	}
+	return ret;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Vector3 NFGE::Math::SIMD::TransformNormal(const Vector3& v, const Matrix4& m)
+{
+	Vector3 ret;
+	switch (GetInstructionSet())
+	{
+#if NFGE_SIMD_X86
+	case InstructionSet::AVX2: TransformNormalAVX2(ret.v.data(), v.v.data(), m.mV.data()); break;
+	case InstructionSet::SSE41: TransformNormalSSE41(ret.v.data(), v.v.data(), m.mV.data()); break;
+#endif
+	default: ret = Math::TransformNormal(v, m); break;
+	}
+	return ret;
+}
@@ -0,0 +1,49 @@
+//====================================================================================================
+// Filename:	SIMDVector3x8.h
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+// Description:	Internal to NFGEMath. Conversion between 8 consecutive Vector3 and one AVX2 register per
+//				component, shared by the kernels that work on Vector3 arrays. Built without FMA, there
+//				is no arithmetic, so they inline into both NFGE_TARGET_AVX2 and _NO_FMA kernels.
+//====================================================================================================
+
+#pragma once
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+
+namespace NFGE::Math::SIMD::Internal
+{
+	// Three unaligned loads, then blends and one permute per component instead of gathers
+	NFGE_TARGET_AVX2_NO_FMA inline void LoadVector3x8(const Vector3* in, __m256& x, __m256& y, __m256& z)
+	{
+		const float* src = &in->x;
+		const __m256 a = _mm256_loadu_ps(src + 0);	// x0 y0 z0 x1 y1 z1 x2 y2
+		const __m256 b = _mm256_loadu_ps(src + 8);	// z2 x3 y3 z3 x4 y4 z4 x5
+		const __m256 c = _mm256_loadu_ps(src + 16);	// y5 z5 x6 y6 z6 x7 y7 z7
+
+		x = _mm256_blend_ps(_mm256_blend_ps(a, b, 0x92), c, 0x24);
+		y = _mm256_blend_ps(_mm256_blend_ps(a, b, 0x24), c, 0x49);
+		z = _mm256_blend_ps(_mm256_blend_ps(a, b, 0x49), c, 0x92);
+		x = _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5));
+		y = _mm256_permutevar8x32_ps(y, _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6));
+		z = _mm256_permutevar8x32_ps(z, _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7));
+	}
+
+	// The inverse of LoadVector3x8
+	NFGE_TARGET_AVX2_NO_FMA inline void StoreVector3x8(Vector3* out, __m256 x, __m256 y, __m256 z)
+	{
+		const __m256i spread0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2);
+		const __m256i spread1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5);
+		const __m256i spread2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+		float* dst = &out->x;
+
+		__m256 v = _mm256_blend_ps(_mm256_permutevar8x32_ps(x, spread0), _mm256_permutevar8x32_ps(y, spread0), 0x92);
+		_mm256_storeu_ps(dst + 0, _mm256_blend_ps(v, _mm256_permutevar8x32_ps(z, spread0), 0x24));
+		v = _mm256_blend_ps(_mm256_permutevar8x32_ps(x, spread1), _mm256_permutevar8x32_ps(y, spread1), 0x24);
+		_mm256_storeu_ps(dst + 8, _mm256_blend_ps(v, _mm256_permutevar8x32_ps(z, spread1), 0x49));
+		v = _mm256_blend_ps(_mm256_permutevar8x32_ps(x, spread2), _mm256_permutevar8x32_ps(y, spread2), 0x49);
+		_mm256_storeu_ps(dst + 16, _mm256_blend_ps(v, _mm256_permutevar8x32_ps(z, spread2), 0x92));
+	}
+}
+#endif
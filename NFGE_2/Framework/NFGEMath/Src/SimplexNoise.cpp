@@ -0,0 +1,644 @@
+//====================================================================================================
+// Filename:	SimplexNoise.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	constexpr size_t kMinSamplesPerTask = 16384; // Below this a worker thread costs more than it saves
+
+	// Skew to and unskew from the simplex lattice, F = (sqrt(n + 1) - 1) / n, G = (1 - 1 / sqrt(n + 1)) / n
+	constexpr float F2 = 0.366025403784f;
+	constexpr float G2 = 0.211324865405f;
+	constexpr float F3 = 1.0f / 3.0f;
+	constexpr float G3 = 1.0f / 6.0f;
+	constexpr float F4 = 0.309016994375f;
+	constexpr float G4 = 0.138196601125f;
+
+	// Corner falloff is (r2 - d^2)^4. 0.5 keeps every corner's kernel inside the simplices that share it, so
+	// the noise and its derivative stay continuous in 3D and 4D as well
+	constexpr float kRadiusSqr = 0.5f;
+
+	// Bring the peak amplitude close to 1, the measured peaks over 4M random samples are 0.976, 0.988 and 0.995
+	constexpr float kScale2 = 99.2f;
+	constexpr float kScale3 = 76.0f;
+	constexpr float kScale4 = 62.5f;
+
+	// 2D uses 12 evenly spaced unit directions, 3D the 12 cube edge midpoints
+	constexpr float kGrad2X[12] = { 1.0f, 0.866025404f, 0.5f, 0.0f, -0.5f, -0.866025404f, -1.0f, -0.866025404f, -0.5f, 0.0f, 0.5f, 0.866025404f };
+	constexpr float kGrad2Y[12] = { 0.0f, 0.5f, 0.866025404f, 1.0f, 0.866025404f, 0.5f, 0.0f, -0.5f, -0.866025404f, -1.0f, -0.866025404f, -0.5f };
+
+	constexpr float kGrad3X[12] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	constexpr float kGrad3Y[12] = { 1.0f, 1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+	constexpr float kGrad3Z[12] = { 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f };
+
+	// 4D uses the 32 edge midpoints of a tesseract
+	constexpr float kGrad4X[32] = {
+		0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f,
+		1.0f, 1.0f, 1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f };
+	constexpr float kGrad4Y[32] = {
+		1.0f, 1.0f, 1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+		1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f };
+	constexpr float kGrad4Z[32] = {
+		1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f,
+		0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f };
+	constexpr float kGrad4W[32] = {
+		1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f,
+		1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+	inline int FastFloor(float x)
+	{
+		const int i = static_cast<int>(x);
+		return x < static_cast<float>(i) ? i - 1 : i;
+	}
+
+	// Adds the corner's value t^4 (g . d) and its gradient to the running sums
+	template <int D>
+	inline void AddCorner(const float* offset, const float* gradient, float& n, float* derivative)
+	{
+		float t = kRadiusSqr;
+		float gd = 0.0f;
+		for (int c = 0; c < D; ++c)
+		{
+			t -= offset[c] * offset[c];
+			gd += gradient[c] * offset[c];
+		}
+		if (t <= 0.0f)
+		{
+			return;
+		}
+
+		const float t2 = t * t;
+		const float t4 = t2 * t2;
+		const float s = -8.0f * t2 * t * gd;
+		n += t4 * gd;
+		for (int c = 0; c < D; ++c)
+		{
+			derivative[c] += s * offset[c] + t4 * gradient[c];
+		}
+	}
+
+	// Signed noise in about [-1, 1], the gradient goes to d
+	float Simplex2(const uint8_t* perm, const uint8_t* permMod12, const float* p, float* d)
+	{
+		const float s = (p[0] + p[1]) * F2;
+		const int i = FastFloor(p[0] + s);
+		const int j = FastFloor(p[1] + s);
+		const float t = static_cast<float>(i + j) * G2;
+		const float x0 = p[0] - (static_cast<float>(i) - t);
+		const float y0 = p[1] - (static_cast<float>(j) - t);
+
+		// Lower or upper triangle of the skewed cell
+		const int i1 = x0 > y0 ? 1 : 0;
+		const int j1 = 1 - i1;
+
+		const int ii = i & 255;
+		const int jj = j & 255;
+		const int gi0 = permMod12[ii + perm[jj]];
+		const int gi1 = permMod12[ii + i1 + perm[jj + j1]];
+		const int gi2 = permMod12[ii + 1 + perm[jj + 1]];
+
+		const float c0[2] = { x0, y0 };
+		const float c1[2] = { x0 - i1 + G2, y0 - j1 + G2 };
+		const float c2[2] = { x0 - 1.0f + 2.0f * G2, y0 - 1.0f + 2.0f * G2 };
+
+		float n = 0.0f;
+		d[0] = d[1] = 0.0f;
+		const float g0[2] = { kGrad2X[gi0], kGrad2Y[gi0] };
+		const float g1[2] = { kGrad2X[gi1], kGrad2Y[gi1] };
+		const float g2[2] = { kGrad2X[gi2], kGrad2Y[gi2] };
+		AddCorner<2>(c0, g0, n, d);
+		AddCorner<2>(c1, g1, n, d);
+		AddCorner<2>(c2, g2, n, d);
+
+		d[0] *= kScale2;
+		d[1] *= kScale2;
+		return n * kScale2;
+	}
+
+	float Simplex3(const uint8_t* perm, const uint8_t* permMod12, const float* p, float* d)
+	{
+		const float s = (p[0] + p[1] + p[2]) * F3;
+		const int i = FastFloor(p[0] + s);
+		const int j = FastFloor(p[1] + s);
+		const int k = FastFloor(p[2] + s);
+		const float t = static_cast<float>(i + j + k) * G3;
+		const float x0 = p[0] - (static_cast<float>(i) - t);
+		const float y0 = p[1] - (static_cast<float>(j) - t);
+		const float z0 = p[2] - (static_cast<float>(k) - t);
+
+		// Order the offsets to find which of the six tetrahedra holds the point, the second and third
+		// corners step along the largest and then the two largest axes
+		const bool xy = x0 >= y0;
+		const bool xz = x0 >= z0;
+		const bool yz = y0 >= z0;
+		const int i1 = xy && xz;
+		const int j1 = !xy && yz;
+		const int k1 = !xz && !yz;
+		const int i2 = xy || xz;
+		const int j2 = !xy || yz;
+		const int k2 = !(xz && yz);
+
+		const int ii = i & 255;
+		const int jj = j & 255;
+		const int kk = k & 255;
+		const int gi0 = permMod12[ii + perm[jj + perm[kk]]];
+		const int gi1 = permMod12[ii + i1 + perm[jj + j1 + perm[kk + k1]]];
+		const int gi2 = permMod12[ii + i2 + perm[jj + j2 + perm[kk + k2]]];
+		const int gi3 = permMod12[ii + 1 + perm[jj + 1 + perm[kk + 1]]];
+
+		const float c0[3] = { x0, y0, z0 };
+		const float c1[3] = { x0 - i1 + G3, y0 - j1 + G3, z0 - k1 + G3 };
+		const float c2[3] = { x0 - i2 + 2.0f * G3, y0 - j2 + 2.0f * G3, z0 - k2 + 2.0f * G3 };
+		const float c3[3] = { x0 - 1.0f + 3.0f * G3, y0 - 1.0f + 3.0f * G3, z0 - 1.0f + 3.0f * G3 };
+
+		float n = 0.0f;
+		d[0] = d[1] = d[2] = 0.0f;
+		const float g0[3] = { kGrad3X[gi0], kGrad3Y[gi0], kGrad3Z[gi0] };
+		const float g1[3] = { kGrad3X[gi1], kGrad3Y[gi1], kGrad3Z[gi1] };
+		const float g2[3] = { kGrad3X[gi2], kGrad3Y[gi2], kGrad3Z[gi2] };
+		const float g3[3] = { kGrad3X[gi3], kGrad3Y[gi3], kGrad3Z[gi3] };
+		AddCorner<3>(c0, g0, n, d);
+		AddCorner<3>(c1, g1, n, d);
+		AddCorner<3>(c2, g2, n, d);
+		AddCorner<3>(c3, g3, n, d);
+
+		d[0] *= kScale3;
+		d[1] *= kScale3;
+		d[2] *= kScale3;
+		return n * kScale3;
+	}
+
+	float Simplex4(const uint8_t* perm, const float* p, float* d)
+	{
+		const float s = (p[0] + p[1] + p[2] + p[3]) * F4;
+		const int i = FastFloor(p[0] + s);
+		const int j = FastFloor(p[1] + s);
+		const int k = FastFloor(p[2] + s);
+		const int l = FastFloor(p[3] + s);
+		const float t = static_cast<float>(i + j + k + l) * G4;
+		const float x0 = p[0] - (static_cast<float>(i) - t);
+		const float y0 = p[1] - (static_cast<float>(j) - t);
+		const float z0 = p[2] - (static_cast<float>(k) - t);
+		const float w0 = p[3] - (static_cast<float>(l) - t);
+
+		// Rank each axis by how many others it exceeds, corner n steps along every axis ranked >= 4 - n
+		int rankX = 0, rankY = 0, rankZ = 0, rankW = 0;
+		(x0 > y0 ? rankX : rankY)++;
+		(x0 > z0 ? rankX : rankZ)++;
+		(x0 > w0 ? rankX : rankW)++;
+		(y0 > z0 ? rankY : rankZ)++;
+		(y0 > w0 ? rankY : rankW)++;
+		(z0 > w0 ? rankZ : rankW)++;
+
+		const int i1 = rankX >= 3, j1 = rankY >= 3, k1 = rankZ >= 3, l1 = rankW >= 3;
+		const int i2 = rankX >= 2, j2 = rankY >= 2, k2 = rankZ >= 2, l2 = rankW >= 2;
+		const int i3 = rankX >= 1, j3 = rankY >= 1, k3 = rankZ >= 1, l3 = rankW >= 1;
+
+		const int ii = i & 255;
+		const int jj = j & 255;
+		const int kk = k & 255;
+		const int ll = l & 255;
+		const int gi[5] = {
+			perm[ii + perm[jj + perm[kk + perm[ll]]]] & 31,
+			perm[ii + i1 + perm[jj + j1 + perm[kk + k1 + perm[ll + l1]]]] & 31,
+			perm[ii + i2 + perm[jj + j2 + perm[kk + k2 + perm[ll + l2]]]] & 31,
+			perm[ii + i3 + perm[jj + j3 + perm[kk + k3 + perm[ll + l3]]]] & 31,
+			perm[ii + 1 + perm[jj + 1 + perm[kk + 1 + perm[ll + 1]]]] & 31 };
+
+		const float corners[5][4] = {
+			{ x0, y0, z0, w0 },
+			{ x0 - i1 + G4, y0 - j1 + G4, z0 - k1 + G4, w0 - l1 + G4 },
+			{ x0 - i2 + 2.0f * G4, y0 - j2 + 2.0f * G4, z0 - k2 + 2.0f * G4, w0 - l2 + 2.0f * G4 },
+			{ x0 - i3 + 3.0f * G4, y0 - j3 + 3.0f * G4, z0 - k3 + 3.0f * G4, w0 - l3 + 3.0f * G4 },
+			{ x0 - 1.0f + 4.0f * G4, y0 - 1.0f + 4.0f * G4, z0 - 1.0f + 4.0f * G4, w0 - 1.0f + 4.0f * G4 } };
+
+		float n = 0.0f;
+		d[0] = d[1] = d[2] = d[3] = 0.0f;
+		for (int c = 0; c < 5; ++c)
+		{
+			const float g[4] = { kGrad4X[gi[c]], kGrad4Y[gi[c]], kGrad4Z[gi[c]], kGrad4W[gi[c]] };
+			AddCorner<4>(corners[c], g, n, d);
+		}
+
+		for (int c = 0; c < 4; ++c)
+		{
+			d[c] *= kScale4;
+		}
+		return n * kScale4;
+	}
+
+#if NFGE_SIMD_X86
+	// The tables are bytes, so gather 32 bits at a byte offset and keep the low byte
+	NFGE_TARGET_AVX2 inline __m256i HashAVX2(const uint8_t* table, __m256i index)
+	{
+		return _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 1), _mm256_set1_epi32(0xFF));
+	}
+
+	// 1.0f in lanes where mask is set
+	NFGE_TARGET_AVX2 inline __m256 MaskToOneAVX2(__m256i mask)
+	{
+		return _mm256_and_ps(_mm256_castsi256_ps(mask), _mm256_set1_ps(1.0f));
+	}
+
+	// Gradient index of the corner offset by the step masks, which are -1 where set so subtracting steps one cell
+	NFGE_TARGET_AVX2 inline __m256i Hash3AVX2(const uint8_t* perm, const uint8_t* permMod12, __m256i ii, __m256i jj, __m256i kk, __m256i di, __m256i dj, __m256i dk)
+	{
+		const __m256i hk = HashAVX2(perm, _mm256_sub_epi32(kk, dk));
+		const __m256i hj = HashAVX2(perm, _mm256_add_epi32(_mm256_sub_epi32(jj, dj), hk));
+		return HashAVX2(permMod12, _mm256_add_epi32(_mm256_sub_epi32(ii, di), hj));
+	}
+
+	template <int D>
+	NFGE_TARGET_AVX2 inline void AddCornerAVX2(const __m256* offset, const float* const* gradientTable, __m256i gi, __m256& n, __m256* derivative)
+	{
+		__m256 t = _mm256_set1_ps(kRadiusSqr);
+		__m256 gd = _mm256_setzero_ps();
+		__m256 g[D];
+		for (int c = 0; c < D; ++c)
+		{
+			g[c] = _mm256_i32gather_ps(gradientTable[c], gi, 4);
+			t = _mm256_fnmadd_ps(offset[c], offset[c], t);
+			gd = _mm256_fmadd_ps(g[c], offset[c], gd);
+		}
+		t = _mm256_max_ps(t, _mm256_setzero_ps());
+
+		const __m256 t2 = _mm256_mul_ps(t, t);
+		const __m256 t4 = _mm256_mul_ps(t2, t2);
+		const __m256 s = _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(-8.0f), _mm256_mul_ps(t2, t)), gd);
+		n = _mm256_fmadd_ps(t4, gd, n);
+		for (int c = 0; c < D; ++c)
+		{
+			derivative[c] = _mm256_fmadd_ps(s, offset[c], _mm256_fmadd_ps(t4, g[c], derivative[c]));
+		}
+	}
+
+	NFGE_TARGET_AVX2 __m256 Simplex2AVX2(const uint8_t* perm, const uint8_t* permMod12, const __m256* p, __m256* d)
+	{
+		static const float* const kGradients[2] = { kGrad2X, kGrad2Y };
+		const __m256i mask = _mm256_set1_epi32(255);
+		const __m256i one = _mm256_set1_epi32(1);
+		const __m256 g2 = _mm256_set1_ps(G2);
+
+		const __m256 s = _mm256_mul_ps(_mm256_add_ps(p[0], p[1]), _mm256_set1_ps(F2));
+		const __m256 fi = _mm256_floor_ps(_mm256_add_ps(p[0], s));
+		const __m256 fj = _mm256_floor_ps(_mm256_add_ps(p[1], s));
+		const __m256 t = _mm256_mul_ps(_mm256_add_ps(fi, fj), g2);
+		const __m256 x0 = _mm256_sub_ps(p[0], _mm256_sub_ps(fi, t));
+		const __m256 y0 = _mm256_sub_ps(p[1], _mm256_sub_ps(fj, t));
+
+		const __m256i xy = _mm256_castps_si256(_mm256_cmp_ps(x0, y0, _CMP_GT_OQ));
+		const __m256i i1 = _mm256_and_si256(xy, one);
+		const __m256i j1 = _mm256_andnot_si256(xy, one);
+
+		const __m256i ii = _mm256_and_si256(_mm256_cvttps_epi32(fi), mask);
+		const __m256i jj = _mm256_and_si256(_mm256_cvttps_epi32(fj), mask);
+		const __m256i gi0 = HashAVX2(permMod12, _mm256_add_epi32(ii, HashAVX2(perm, jj)));
+		const __m256i gi1 = HashAVX2(permMod12, _mm256_add_epi32(_mm256_add_epi32(ii, i1), HashAVX2(perm, _mm256_add_epi32(jj, j1))));
+		const __m256i gi2 = HashAVX2(permMod12, _mm256_add_epi32(_mm256_add_epi32(ii, one), HashAVX2(perm, _mm256_add_epi32(jj, one))));
+
+		const __m256 c0[2] = { x0, y0 };
+		const __m256 c1[2] = {
+			_mm256_add_ps(_mm256_sub_ps(x0, MaskToOneAVX2(xy)), g2),
+			_mm256_add_ps(_mm256_sub_ps(y0, _mm256_cvtepi32_ps(j1)), g2) };
+		const __m256 last = _mm256_set1_ps(2.0f * G2 - 1.0f);
+		const __m256 c2[2] = { _mm256_add_ps(x0, last), _mm256_add_ps(y0, last) };
+
+		__m256 n = _mm256_setzero_ps();
+		d[0] = d[1] = _mm256_setzero_ps();
+		AddCornerAVX2<2>(c0, kGradients, gi0, n, d);
+		AddCornerAVX2<2>(c1, kGradients, gi1, n, d);
+		AddCornerAVX2<2>(c2, kGradients, gi2, n, d);
+
+		const __m256 scale = _mm256_set1_ps(kScale2);
+		d[0] = _mm256_mul_ps(d[0], scale);
+		d[1] = _mm256_mul_ps(d[1], scale);
+		return _mm256_mul_ps(n, scale);
+	}
+
+	NFGE_TARGET_AVX2 __m256 Simplex3AVX2(const uint8_t* perm, const uint8_t* permMod12, const __m256* p, __m256* d)
+	{
+		static const float* const kGradients[3] = { kGrad3X, kGrad3Y, kGrad3Z };
+		const __m256i mask = _mm256_set1_epi32(255);
+		const __m256i allSet = _mm256_set1_epi32(-1);
+
+		const __m256 s = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(p[0], p[1]), p[2]), _mm256_set1_ps(F3));
+		const __m256 fi = _mm256_floor_ps(_mm256_add_ps(p[0], s));
+		const __m256 fj = _mm256_floor_ps(_mm256_add_ps(p[1], s));
+		const __m256 fk = _mm256_floor_ps(_mm256_add_ps(p[2], s));
+		const __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(fi, fj), fk), _mm256_set1_ps(G3));
+		const __m256 x0 = _mm256_sub_ps(p[0], _mm256_sub_ps(fi, t));
+		const __m256 y0 = _mm256_sub_ps(p[1], _mm256_sub_ps(fj, t));
+		const __m256 z0 = _mm256_sub_ps(p[2], _mm256_sub_ps(fk, t));
+
+		// Same tetrahedron selection as the scalar path, as lane masks
+		const __m256i xy = _mm256_castps_si256(_mm256_cmp_ps(x0, y0, _CMP_GE_OQ));
+		const __m256i xz = _mm256_castps_si256(_mm256_cmp_ps(x0, z0, _CMP_GE_OQ));
+		const __m256i yz = _mm256_castps_si256(_mm256_cmp_ps(y0, z0, _CMP_GE_OQ));
+		const __m256i i1 = _mm256_and_si256(xy, xz);
+		const __m256i j1 = _mm256_andnot_si256(xy, yz);
+		const __m256i k1 = _mm256_andnot_si256(_mm256_or_si256(xz, yz), allSet);
+		const __m256i i2 = _mm256_or_si256(xy, xz);
+		const __m256i j2 = _mm256_or_si256(_mm256_andnot_si256(xy, allSet), yz);
+		const __m256i k2 = _mm256_andnot_si256(_mm256_and_si256(xz, yz), allSet);
+
+		const __m256i ii = _mm256_and_si256(_mm256_cvttps_epi32(fi), mask);
+		const __m256i jj = _mm256_and_si256(_mm256_cvttps_epi32(fj), mask);
+		const __m256i kk = _mm256_and_si256(_mm256_cvttps_epi32(fk), mask);
+
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i gi0 = Hash3AVX2(perm, permMod12, ii, jj, kk, zero, zero, zero);
+		const __m256i gi1 = Hash3AVX2(perm, permMod12, ii, jj, kk, i1, j1, k1);
+		const __m256i gi2 = Hash3AVX2(perm, permMod12, ii, jj, kk, i2, j2, k2);
+		const __m256i gi3 = Hash3AVX2(perm, permMod12, ii, jj, kk, allSet, allSet, allSet);
+
+		const __m256 g1 = _mm256_set1_ps(G3);
+		const __m256 g2 = _mm256_set1_ps(2.0f * G3);
+		const __m256 last = _mm256_set1_ps(3.0f * G3 - 1.0f);
+		const __m256 c0[3] = { x0, y0, z0 };
+		const __m256 c1[3] = {
+			_mm256_add_ps(_mm256_sub_ps(x0, MaskToOneAVX2(i1)), g1),
+			_mm256_add_ps(_mm256_sub_ps(y0, MaskToOneAVX2(j1)), g1),
+			_mm256_add_ps(_mm256_sub_ps(z0, MaskToOneAVX2(k1)), g1) };
+		const __m256 c2[3] = {
+			_mm256_add_ps(_mm256_sub_ps(x0, MaskToOneAVX2(i2)), g2),
+			_mm256_add_ps(_mm256_sub_ps(y0, MaskToOneAVX2(j2)), g2),
+			_mm256_add_ps(_mm256_sub_ps(z0, MaskToOneAVX2(k2)), g2) };
+		const __m256 c3[3] = { _mm256_add_ps(x0, last), _mm256_add_ps(y0, last), _mm256_add_ps(z0, last) };
+
+		__m256 n = _mm256_setzero_ps();
+		d[0] = d[1] = d[2] = _mm256_setzero_ps();
+		AddCornerAVX2<3>(c0, kGradients, gi0, n, d);
+		AddCornerAVX2<3>(c1, kGradients, gi1, n, d);
+		AddCornerAVX2<3>(c2, kGradients, gi2, n, d);
+		AddCornerAVX2<3>(c3, kGradients, gi3, n, d);
+
+		const __m256 scale = _mm256_set1_ps(kScale3);
+		for (int c = 0; c < 3; ++c)
+		{
+			d[c] = _mm256_mul_ps(d[c], scale);
+		}
+		return _mm256_mul_ps(n, scale);
+	}
+
+	NFGE_TARGET_AVX2 __m256 Simplex4AVX2(const uint8_t* perm, const uint8_t*, const __m256* p, __m256* d)
+	{
+		static const float* const kGradients[4] = { kGrad4X, kGrad4Y, kGrad4Z, kGrad4W };
+		const __m256i mask = _mm256_set1_epi32(255);
+		const __m256i one = _mm256_set1_epi32(1);
+
+		const __m256 s = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(p[0], p[1]), _mm256_add_ps(p[2], p[3])), _mm256_set1_ps(F4));
+		__m256 f[4];
+		__m256 cellSum = _mm256_setzero_ps();
+		for (int c = 0; c < 4; ++c)
+		{
+			f[c] = _mm256_floor_ps(_mm256_add_ps(p[c], s));
+			cellSum = _mm256_add_ps(cellSum, f[c]);
+		}
+		const __m256 t = _mm256_mul_ps(cellSum, _mm256_set1_ps(G4));
+		__m256 c0[4];
+		__m256i cell[4];
+		for (int c = 0; c < 4; ++c)
+		{
+			c0[c] = _mm256_sub_ps(p[c], _mm256_sub_ps(f[c], t));
+			cell[c] = _mm256_and_si256(_mm256_cvttps_epi32(f[c]), mask);
+		}
+
+		// Ranks as in the scalar path, a true compare is -1 so subtracting it counts a win
+		__m256i rank[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+		for (int a = 0; a < 4; ++a)
+		{
+			for (int b = a + 1; b < 4; ++b)
+			{
+				const __m256i greater = _mm256_castps_si256(_mm256_cmp_ps(c0[a], c0[b], _CMP_GT_OQ));
+				rank[a] = _mm256_sub_epi32(rank[a], greater);
+				rank[b] = _mm256_add_epi32(rank[b], _mm256_add_epi32(greater, one));
+			}
+		}
+
+		__m256 n = _mm256_setzero_ps();
+		d[0] = d[1] = d[2] = d[3] = _mm256_setzero_ps();
+		for (int corner = 0; corner < 5; ++corner)
+		{
+			// Corner n steps along every axis ranked >= 4 - n
+			const __m256i threshold = _mm256_set1_epi32(3 - corner);
+			const __m256 offset = _mm256_set1_ps(corner * G4);
+			__m256i step[4];
+			__m256 position[4];
+			for (int c = 0; c < 4; ++c)
+			{
+				step[c] = _mm256_cmpgt_epi32(rank[c], threshold);
+				position[c] = _mm256_add_ps(_mm256_sub_ps(c0[c], MaskToOneAVX2(step[c])), offset);
+			}
+
+			__m256i h = HashAVX2(perm, _mm256_sub_epi32(cell[3], step[3]));
+			h = HashAVX2(perm, _mm256_add_epi32(_mm256_sub_epi32(cell[2], step[2]), h));
+			h = HashAVX2(perm, _mm256_add_epi32(_mm256_sub_epi32(cell[1], step[1]), h));
+			h = HashAVX2(perm, _mm256_add_epi32(_mm256_sub_epi32(cell[0], step[0]), h));
+			const __m256i gi = _mm256_and_si256(h, _mm256_set1_epi32(31));
+			AddCornerAVX2<4>(position, kGradients, gi, n, d);
+		}
+
+		const __m256 scale = _mm256_set1_ps(kScale4);
+		for (int c = 0; c < 4; ++c)
+		{
+			d[c] = _mm256_mul_ps(d[c], scale);
+		}
+		return _mm256_mul_ps(n, scale);
+	}
+
+	// points and derivatives are interleaved with D floats per entry
+	template <int D, __m256 (*Kernel)(const uint8_t*, const uint8_t*, const __m256*, __m256*)>
+	NFGE_TARGET_AVX2 void BatchAVX2(const uint8_t* perm, const uint8_t* permMod12, const float* points, float* out, size_t count, float* derivatives)
+	{
+		const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(D));
+		const __m256 half = _mm256_set1_ps(0.5f);
+		for (size_t i = 0; i < count; i += 8)
+		{
+			const size_t lanes = std::min<size_t>(8, count - i);
+			const float* src = points + i * D;
+			__m256 p[D];
+			__m256 d[D];
+			if (lanes == 8)
+			{
+				for (int c = 0; c < D; ++c)
+				{
+					p[c] = _mm256_i32gather_ps(src + c, offsets, 4);
+				}
+			}
+			else
+			{
+				// Pad the tail so every sample goes through the same kernel
+				alignas(32) float padded[D][8] = {};
+				for (size_t j = 0; j < lanes; ++j)
+				{
+					for (int c = 0; c < D; ++c)
+					{
+						padded[c][j] = src[j * D + c];
+					}
+				}
+				for (int c = 0; c < D; ++c)
+				{
+					p[c] = _mm256_load_ps(padded[c]);
+				}
+			}
+
+			alignas(32) float value[8];
+			_mm256_store_ps(value, _mm256_fmadd_ps(Kernel(perm, permMod12, p, d), half, half));
+			std::copy(value, value + lanes, out + i);
+
+			if (derivatives)
+			{
+				alignas(32) float gradient[D][8];
+				for (int c = 0; c < D; ++c)
+				{
+					_mm256_store_ps(gradient[c], _mm256_mul_ps(d[c], half));
+				}
+				float* dst = derivatives + i * D;
+				for (size_t j = 0; j < lanes; ++j)
+				{
+					for (int c = 0; c < D; ++c)
+					{
+						dst[j * D + c] = gradient[c][j];
+					}
+				}
+			}
+		}
+	}
+#endif
+}
+
+SimplexNoise::SimplexNoise()
+{
+	Internal::FillReferencePermutation(mPermutation.data());
+	for (size_t i = 0; i < 512; ++i)
+	{
+		mPermutationMod12[i] = mPermutation[i] % 12;
+	}
+}
+
+SimplexNoise::SimplexNoise(uint32_t seed)
+{
+	Internal::FillSeededPermutation(mPermutation.data(), seed);
+	for (size_t i = 0; i < 512; ++i)
+	{
+		mPermutationMod12[i] = mPermutation[i] % 12;
+	}
+}
+
+float SimplexNoise::Get(float x, float y) const
+{
+	Vector2 derivative;
+	return Get(x, y, derivative);
+}
+
+float SimplexNoise::Get(float x, float y, float z) const
+{
+	Vector3 derivative;
+	return Get(x, y, z, derivative);
+}
+
+float SimplexNoise::Get(float x, float y, float z, float w) const
+{
+	Vector4 derivative;
+	return Get(x, y, z, w, derivative);
+}
+
+float SimplexNoise::Get(float x, float y, Vector2& derivative) const
+{
+	const float p[2] = { x, y };
+	float d[2];
+	const float n = Simplex2(mPermutation.data(), mPermutationMod12.data(), p, d);
+	derivative = { d[0] * 0.5f, d[1] * 0.5f };
+	return (n + 1.0f) * 0.5f;
+}
+
+float SimplexNoise::Get(float x, float y, float z, Vector3& derivative) const
+{
+	const float p[3] = { x, y, z };
+	float d[3];
+	const float n = Simplex3(mPermutation.data(), mPermutationMod12.data(), p, d);
+	derivative = { d[0] * 0.5f, d[1] * 0.5f, d[2] * 0.5f };
+	return (n + 1.0f) * 0.5f;
+}
+
+float SimplexNoise::Get(float x, float y, float z, float w, Vector4& derivative) const
+{
+	const float p[4] = { x, y, z, w };
+	float d[4];
+	const float n = Simplex4(mPermutation.data(), p, d);
+	derivative = { d[0] * 0.5f, d[1] * 0.5f, d[2] * 0.5f, d[3] * 0.5f };
+	return (n + 1.0f) * 0.5f;
+}
+
+void SimplexNoise::GetBatch(const Vector2* points, float* out, size_t count, Vector2* derivatives) const
+{
+	Batch(2, &points->x, out, count, derivatives ? &derivatives->x : nullptr);
+}
+
+void SimplexNoise::GetBatch(const Vector3* points, float* out, size_t count, Vector3* derivatives) const
+{
+	Batch(3, &points->x, out, count, derivatives ? &derivatives->x : nullptr);
+}
+
+void SimplexNoise::GetBatch(const Vector4* points, float* out, size_t count, Vector4* derivatives) const
+{
+	Batch(4, &points->x, out, count, derivatives ? &derivatives->x : nullptr);
+}
+
+void SimplexNoise::Batch(int dimension, const float* points, float* out, size_t count, float* derivatives) const
+{
+	ASSERT((points && out) || count == 0, "[SimplexNoise] Input or output buffer is null.");
+
+	const uint8_t* perm = mPermutation.data();
+	const uint8_t* permMod12 = mPermutationMod12.data();
+	ParallelFor(count, kMinSamplesPerTask, [&](size_t begin, size_t end)
+	{
+		const float* src = points + begin * dimension;
+		float* dst = derivatives ? derivatives + begin * dimension : nullptr;
+		const size_t n = end - begin;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+		{
+			switch (dimension)
+			{
+			case 2: BatchAVX2<2, Simplex2AVX2>(perm, permMod12, src, out + begin, n, dst); break;
+			case 3: BatchAVX2<3, Simplex3AVX2>(perm, permMod12, src, out + begin, n, dst); break;
+			default: BatchAVX2<4, Simplex4AVX2>(perm, permMod12, src, out + begin, n, dst); break;
+			}
+			return;
+		}
+#endif
+		float d[4];
+		for (size_t i = 0; i < n; ++i)
+		{
+			const float* p = src + i * dimension;
+			float value;
+			switch (dimension)
+			{
+			case 2: value = Simplex2(perm, permMod12, p, d); break;
+			case 3: value = Simplex3(perm, permMod12, p, d); break;
+			default: value = Simplex4(perm, p, d); break;
+			}
+			out[begin + i] = (value + 1.0f) * 0.5f;
+			if (dst)
+			{
+				for (int c = 0; c < dimension; ++c)
+				{
+					dst[i * dimension + c] = d[c] * 0.5f;
+				}
+			}
+		}
+	});
+}
@@ -0,0 +1,445 @@
+//====================================================================================================
+// Filename:	SpatialHashGrid.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+using namespace NFGE::Math;
+
+namespace
+{
+	inline uint32_t HashCell(int32_t x, int32_t y)
+	{
+		// Reference: Teschner et al. 2003, Optimized Spatial Hashing for Collision Detection of Deformable Objects
+		return (static_cast<uint32_t>(x) * 73856093u) ^ (static_cast<uint32_t>(y) * 19349663u);
+	}
+
+	inline Rect GetBounds(const Circle& c)
+	{
+		return { c.center.x - c.radius, c.center.y - c.radius, c.center.x + c.radius, c.center.y + c.radius };
+	}
+
+	// Entry parameter of the segment from + (to - from) * t into the circle, t in [0, 1]
+	bool SegmentEntry(const LineSegment& segment, const Circle& circle, float& t)
+	{
+		const Vector2 d = segment.to - segment.from;
+		const Vector2 f = segment.from - circle.center;
+		const float c = Dot(f, f) - circle.radius * circle.radius;
+		if (c <= 0.0f)
+		{
+			t = 0.0f;
+			return true;
+		}
+
+		const float a = Dot(d, d);
+		const float b = Dot(f, d);
+		const float discriminant = b * b - a * c;
+		if (a == 0.0f || discriminant < 0.0f)
+		{
+			return false;
+		}
+		t = (-b - Sqrt(discriminant)) / a;
+		return t >= 0.0f && t <= 1.0f;
+	}
+
+	// Same for a rect, slab test on both axes
+	bool SegmentEntry(const LineSegment& segment, const Rect& rect, float& t)
+	{
+		const Vector2 d = segment.to - segment.from;
+		float tMin = 0.0f;
+		float tMax = 1.0f;
+		for (int axis = 0; axis < 2; ++axis)
+		{
+			const float origin = segment.from.v[axis];
+			const float lo = rect.min.v[axis];
+			const float hi = rect.max.v[axis];
+			if (d.v[axis] == 0.0f)
+			{
+				if (origin < lo || origin > hi)
+				{
+					return false;
+				}
+				continue;
+			}
+			const float inv = 1.0f / d.v[axis];
+			float t0 = (lo - origin) * inv;
+			float t1 = (hi - origin) * inv;
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+			}
+			tMin = Max(tMin, t0);
+			tMax = Min(tMax, t1);
+			if (tMin > tMax)
+			{
+				return false;
+			}
+		}
+		t = tMin;
+		return true;
+	}
+
+	uint32_t NextPowerOfTwo(size_t n)
+	{
+		uint32_t p = 16;
+		while (p < n)
+		{
+			p <<= 1;
+		}
+		return p;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+NFGE::Math::SpatialHashGrid::SpatialHashGrid(float cellSize)
+{
+	SetCellSize(cellSize);
+}
+
+void NFGE::Math::SpatialHashGrid::SetCellSize(float cellSize)
+{
+	ASSERT(cellSize > 0.0f, "[SpatialHashGrid] Cell size must be positive.");
+	mCellSize = cellSize;
+	mInvCellSize = 1.0f / cellSize;
+}
+
+void NFGE::Math::SpatialHashGrid::Build(const Circle* circles, size_t count)
+{
+	mRects.clear();
+	mCircles.assign(circles, circles + count);
+	mBounds.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		mBounds[i] = GetBounds(circles[i]);
+	}
+	BuildCells();
+}
+
+void NFGE::Math::SpatialHashGrid::Build(const Rect* rects, size_t count)
+{
+	mCircles.clear();
+	mRects.assign(rects, rects + count);
+	mBounds.assign(rects, rects + count);
+	BuildCells();
+}
+
+void NFGE::Math::SpatialHashGrid::Clear()
+{
+	mCircles.clear();
+	mRects.clear();
+	mBounds.clear();
+	mRanges.clear();
+	mCells.clear();
+	mEntries.clear();
+	std::fill(mSlots.begin(), mSlots.end(), Slot{ 0, 0, -1 });
+}
+
+void NFGE::Math::SpatialHashGrid::BuildCells()
+{
+	ASSERT(mBounds.size() < 0x7fffffff, "[SpatialHashGrid] Too many entities.");
+	const size_t count = mBounds.size();
+
+	size_t refCount = 0;
+	mRanges.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const CellRange range = GetCellRange(mBounds[i]);
+		mRanges[i] = range;
+		refCount += static_cast<size_t>(range.maxX - range.minX + 1) * static_cast<size_t>(range.maxY - range.minY + 1);
+	}
+
+	// Distinct cells never exceed the reference count, so this keeps the load factor at or below 3/4.
+	// Shrinking a vector does not free it, so steady state frames reuse memory.
+	mSlots.resize(NextPowerOfTwo(refCount + refCount / 3 + 1));
+	std::fill(mSlots.begin(), mSlots.end(), Slot{ 0, 0, -1 });
+	mCells.clear();
+
+	// Count entities per cell, remembering each reference's cell so the fill pass does not hash again
+	mRefCells.resize(refCount);
+	size_t ref = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const CellRange& range = mRanges[i];
+		for (int32_t y = range.minY; y <= range.maxY; ++y)
+		{
+			for (int32_t x = range.minX; x <= range.maxX; ++x)
+			{
+				const int32_t cell = FindOrAddCell(x, y);
+				++mCells[cell].count;
+				mRefCells[ref++] = cell;
+			}
+		}
+	}
+
+	uint32_t start = 0;
+	for (Cell& cell : mCells)
+	{
+		cell.start = start;
+		start += cell.count;
+		cell.count = 0;
+	}
+
+	mEntries.resize(refCount);
+	ref = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const CellRange& range = mRanges[i];
+		const size_t cellsCovered = static_cast<size_t>(range.maxX - range.minX + 1) * static_cast<size_t>(range.maxY - range.minY + 1);
+		for (size_t j = 0; j < cellsCovered; ++j)
+		{
+			Cell& cell = mCells[mRefCells[ref++]];
+			mEntries[cell.start + cell.count++] = static_cast<uint32_t>(i);
+		}
+	}
+}
+
+NFGE::Math::SpatialHashGrid::CellRange NFGE::Math::SpatialHashGrid::GetCellRange(const Rect& bounds) const
+{
+	return {
+		static_cast<int32_t>(std::floor(bounds.left * mInvCellSize)),
+		static_cast<int32_t>(std::floor(bounds.top * mInvCellSize)),
+		static_cast<int32_t>(std::floor(bounds.right * mInvCellSize)),
+		static_cast<int32_t>(std::floor(bounds.bottom * mInvCellSize)) };
+}
+
+int32_t NFGE::Math::SpatialHashGrid::FindCell(int32_t x, int32_t y) const
+{
+	if (mCells.empty())
+	{
+		return -1;
+	}
+
+	const uint32_t mask = static_cast<uint32_t>(mSlots.size()) - 1;
+	for (uint32_t i = HashCell(x, y) & mask;; i = (i + 1) & mask)
+	{
+		const Slot& slot = mSlots[i];
+		if (slot.cell < 0 || (slot.x == x && slot.y == y))
+		{
+			return slot.cell;
+		}
+	}
+}
+
+int32_t NFGE::Math::SpatialHashGrid::FindOrAddCell(int32_t x, int32_t y)
+{
+	const uint32_t mask = static_cast<uint32_t>(mSlots.size()) - 1;
+	for (uint32_t i = HashCell(x, y) & mask;; i = (i + 1) & mask)
+	{
+		Slot& slot = mSlots[i];
+		if (slot.cell < 0)
+		{
+			slot = { x, y, static_cast<int32_t>(mCells.size()) };
+			mCells.push_back({ x, y, 0, 0 });
+			return slot.cell;
+		}
+		if (slot.x == x && slot.y == y)
+		{
+			return slot.cell;
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+// Calls func(index) once per entity whose cell range overlaps the cells under bounds. An entity spanning
+// several of those cells is only reported from the first cell it shares with the query.
+template <typename Func>
+void NFGE::Math::SpatialHashGrid::ForEachCandidate(const Rect& bounds, Func&& func) const
+{
+	const CellRange query = GetCellRange(bounds);
+	for (int32_t y = query.minY; y <= query.maxY; ++y)
+	{
+		for (int32_t x = query.minX; x <= query.maxX; ++x)
+		{
+			const int32_t cellIndex = FindCell(x, y);
+			if (cellIndex < 0)
+			{
+				continue;
+			}
+			const Cell& cell = mCells[cellIndex];
+			for (uint32_t i = cell.start; i < cell.start + cell.count; ++i)
+			{
+				const uint32_t index = mEntries[i];
+				const CellRange& range = mRanges[index];
+				if (x == Max(range.minX, query.minX) && y == Max(range.minY, query.minY))
+				{
+					func(index);
+				}
+			}
+		}
+	}
+}
+
+void NFGE::Math::SpatialHashGrid::Query(const Circle& circle, std::vector<uint32_t>& results) const
+{
+	ForEachCandidate(GetBounds(circle), [&](uint32_t index)
+	{
+		const bool hit = mCircles.empty() ? Intersect(mRects[index], circle) : Intersect(mCircles[index], circle);
+		if (hit)
+		{
+			results.push_back(index);
+		}
+	});
+}
+
+void NFGE::Math::SpatialHashGrid::Query(const Rect& rect, std::vector<uint32_t>& results) const
+{
+	ForEachCandidate(rect, [&](uint32_t index)
+	{
+		const bool hit = mCircles.empty() ? Intersect(mRects[index], rect) : Intersect(mCircles[index], rect);
+		if (hit)
+		{
+			results.push_back(index);
+		}
+	});
+}
+
+void NFGE::Math::SpatialHashGrid::QueryPairs(std::vector<Pair>& pairs) const
+{
+	for (const Cell& cell : mCells)
+	{
+		const uint32_t* entries = &mEntries[cell.start];
+		for (uint32_t i = 0; i < cell.count; ++i)
+		{
+			const uint32_t a = entries[i];
+			const CellRange& rangeA = mRanges[a];
+			for (uint32_t j = i + 1; j < cell.count; ++j)
+			{
+				// Entries are sorted by index within a cell, so a < b. Report from the first cell the two share.
+				const uint32_t b = entries[j];
+				const CellRange& rangeB = mRanges[b];
+				if (cell.x != Max(rangeA.minX, rangeB.minX) || cell.y != Max(rangeA.minY, rangeB.minY))
+				{
+					continue;
+				}
+				const bool hit = mCircles.empty() ? Intersect(mRects[a], mRects[b]) : Intersect(mCircles[a], mCircles[b]);
+				if (hit)
+				{
+					pairs.push_back({ a, b });
+				}
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+bool NFGE::Math::SpatialHashGrid::TestEntity(uint32_t index, const LineSegment& segment, float& t) const
+{
+	return mCircles.empty() ? SegmentEntry(segment, mRects[index], t) : SegmentEntry(segment, mCircles[index], t);
+}
+
+namespace
+{
+	// Reference: Amanatides & Woo 1987, A Fast Voxel Traversal Algorithm for Ray Tracing. Visits the cells
+	// crossed by the segment in order, calling func(x, y, tExit) where tExit is where the segment leaves
+	// the cell. Stops early when func returns false.
+	template <typename Func>
+	void WalkCells(const LineSegment& segment, float invCellSize, Func&& func)
+	{
+		const Vector2 from = segment.from * invCellSize;
+		const Vector2 to = segment.to * invCellSize;
+		const Vector2 d = to - from;
+
+		int32_t x = static_cast<int32_t>(std::floor(from.x));
+		int32_t y = static_cast<int32_t>(std::floor(from.y));
+		const int32_t endX = static_cast<int32_t>(std::floor(to.x));
+		const int32_t endY = static_cast<int32_t>(std::floor(to.y));
+		const int32_t stepX = (d.x > 0.0f) ? 1 : -1;
+		const int32_t stepY = (d.y > 0.0f) ? 1 : -1;
+
+		const float tDeltaX = (d.x != 0.0f) ? Abs(1.0f / d.x) : FLT_MAX;
+		const float tDeltaY = (d.y != 0.0f) ? Abs(1.0f / d.y) : FLT_MAX;
+		float tMaxX = (d.x != 0.0f) ? ((stepX > 0 ? (x + 1.0f) - from.x : from.x - x) * tDeltaX) : FLT_MAX;
+		float tMaxY = (d.y != 0.0f) ? ((stepY > 0 ? (y + 1.0f) - from.y : from.y - y) * tDeltaY) : FLT_MAX;
+
+		// The number of cells is fixed by the end points, so rounding in tMax can not walk past the end
+		int32_t steps = std::abs(endX - x) + std::abs(endY - y);
+		while (true)
+		{
+			if (!func(x, y, steps == 0 ? 1.0f : Min(tMaxX, tMaxY)))
+			{
+				return;
+			}
+			if (steps-- == 0)
+			{
+				return;
+			}
+			if ((tMaxX < tMaxY && x != endX) || y == endY)
+			{
+				x += stepX;
+				tMaxX += tDeltaX;
+			}
+			else
+			{
+				y += stepY;
+				tMaxY += tDeltaY;
+			}
+		}
+	}
+}
+
+void NFGE::Math::SpatialHashGrid::Query(const LineSegment& segment, std::vector<uint32_t>& results) const
+{
+	// The cells an entity covers form a rectangle, so the walk passes through them in one run. Each entity is
+	// tested when the walk enters its run.
+	bool first = true;
+	int32_t prevX = 0, prevY = 0;
+	WalkCells(segment, mInvCellSize, [&](int32_t x, int32_t y, float)
+	{
+		const int32_t cellIndex = FindCell(x, y);
+		if (cellIndex >= 0)
+		{
+			const Cell& cell = mCells[cellIndex];
+			for (uint32_t i = cell.start; i < cell.start + cell.count; ++i)
+			{
+				const uint32_t index = mEntries[i];
+				float t = 0.0f;
+				if ((first || !mRanges[index].Contains(prevX, prevY)) && TestEntity(index, segment, t))
+				{
+					results.push_back(index);
+				}
+			}
+		}
+		first = false;
+		prevX = x;
+		prevY = y;
+		return true;
+	});
+}
+
+bool NFGE::Math::SpatialHashGrid::Raycast(const LineSegment& segment, uint32_t& index, float& t) const
+{
+	bool found = false;
+	float closest = FLT_MAX;
+	WalkCells(segment, mInvCellSize, [&](int32_t x, int32_t y, float tExit)
+	{
+		const int32_t cellIndex = FindCell(x, y);
+		if (cellIndex >= 0)
+		{
+			const Cell& cell = mCells[cellIndex];
+			for (uint32_t i = cell.start; i < cell.start + cell.count; ++i)
+			{
+				float entry = 0.0f;
+				if (TestEntity(mEntries[i], segment, entry) && entry < closest)
+				{
+					closest = entry;
+					index = mEntries[i];
+					found = true;
+				}
+			}
+		}
+		// Anything in later cells is hit after tExit
+		return !(found && closest <= tExit);
+	});
+
+	if (found)
+	{
+		t = closest;
+	}
+	return found;
+}
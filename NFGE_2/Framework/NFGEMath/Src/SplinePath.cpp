@@ -0,0 +1,419 @@
+//====================================================================================================
+// Filename:	SplinePath.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+#include "SIMDVector3x8.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	// 5 point Gauss-Legendre on [-1, 1], integrates the speed |p'(t)| over each arc length table step
+	constexpr double kGaussNodes[5] = { -0.9061798459386640, -0.5384693101056831, 0.0, 0.5384693101056831, 0.9061798459386640 };
+	constexpr double kGaussWeights[5] = { 0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891 };
+
+	inline Vector3 Evaluate(const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& d, float t)
+	{
+		return ((a * t + b) * t + c) * t + d;
+	}
+
+	inline Vector3 Derivative(const Vector3& a, const Vector3& b, const Vector3& c, float t)
+	{
+		return (a * (3.0f * t) + b * 2.0f) * t + c;
+	}
+
+	inline Vector3 Direction(const Vector3& tangent)
+	{
+		const float length = Magnitude(tangent);
+		return length > 0.0f ? tangent / length : Vector3(0.0f, 0.0f, 0.0f);
+	}
+
+#if NFGE_SIMD_X86
+	using NFGE::Math::SIMD::Internal::StoreVector3x8;
+
+	// Clamped to [0, range] or wrapped into it, the same as WrapParameter and WrapDistance
+	NFGE_TARGET_AVX2 __m256 WrapAVX2(__m256 v, float range, bool loop)
+	{
+		const __m256 rangeV = _mm256_set1_ps(range);
+		if (loop)
+			return _mm256_sub_ps(v, _mm256_mul_ps(_mm256_floor_ps(_mm256_div_ps(v, rangeV)), rangeV));
+		return _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), rangeV);
+	}
+
+	// Points and optionally unit directions at 8 wrapped parameters. Segments are 12 floats, a b c d.
+	NFGE_TARGET_AVX2 void EvaluateAVX2(const float* segments, size_t segmentCount, __m256 u, Vector3* points, Vector3* directions)
+	{
+		const __m256i segment = _mm256_min_epi32(_mm256_cvttps_epi32(u), _mm256_set1_epi32(static_cast<int>(segmentCount) - 1));
+		const __m256 t = _mm256_sub_ps(u, _mm256_cvtepi32_ps(segment));
+		const __m256i base = _mm256_mullo_epi32(segment, _mm256_set1_epi32(12));
+		const __m256 three = _mm256_set1_ps(3.0f);
+		const __m256 two = _mm256_set1_ps(2.0f);
+
+		__m256 p[3], dp[3];
+		for (int k = 0; k < 3; ++k)
+		{
+			const __m256 a = _mm256_i32gather_ps(segments + k, base, 4);
+			const __m256 b = _mm256_i32gather_ps(segments + 3 + k, base, 4);
+			const __m256 c = _mm256_i32gather_ps(segments + 6 + k, base, 4);
+			const __m256 d = _mm256_i32gather_ps(segments + 9 + k, base, 4);
+			p[k] = _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_fmadd_ps(a, t, b), t, c), t, d);
+			dp[k] = _mm256_fmadd_ps(_mm256_fmadd_ps(_mm256_mul_ps(a, three), t, _mm256_mul_ps(b, two)), t, c);
+		}
+		StoreVector3x8(points, p[0], p[1], p[2]);
+
+		if (directions != nullptr)
+		{
+			const __m256 length = _mm256_sqrt_ps(_mm256_fmadd_ps(dp[2], dp[2], _mm256_fmadd_ps(dp[1], dp[1], _mm256_mul_ps(dp[0], dp[0]))));
+			const __m256 valid = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_GT_OQ);
+			const __m256 inv = _mm256_and_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), length), valid);
+			StoreVector3x8(directions, _mm256_mul_ps(dp[0], inv), _mm256_mul_ps(dp[1], inv), _mm256_mul_ps(dp[2], inv));
+		}
+	}
+
+	NFGE_TARGET_AVX2 size_t GetPointsAVX2(const float* segments, size_t segmentCount, bool loop, const float* u, Vector3* points, Vector3* directions, size_t count)
+	{
+		const float range = static_cast<float>(segmentCount);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 v = WrapAVX2(_mm256_loadu_ps(u + i), range, loop);
+			EvaluateAVX2(segments, segmentCount, v, points + i, directions != nullptr ? directions + i : nullptr);
+		}
+		return i;
+	}
+
+	// GetParameterAtDistance for 8 distances. steps are 4 floats each, see SplinePath::ArcStep.
+	NFGE_TARGET_AVX2 __m256 ParameterAtDistanceAVX2(const float* steps, size_t stepCount, float samplesPerSegment, const float* parameters, float distanceScale, __m256 distance)
+	{
+		const __m256 x = _mm256_mul_ps(distance, _mm256_set1_ps(distanceScale));
+		const __m256i j = _mm256_min_epi32(_mm256_cvttps_epi32(x), _mm256_set1_epi32(static_cast<int>(stepCount) - 1));
+		const __m256 u0 = _mm256_i32gather_ps(parameters, j, 4);
+		const __m256 u1 = _mm256_i32gather_ps(parameters + 1, j, 4);
+		__m256 u = _mm256_fmadd_ps(_mm256_sub_ps(u1, u0), _mm256_sub_ps(x, _mm256_cvtepi32_ps(j)), u0);
+
+		const __m256 scale = _mm256_set1_ps(samplesPerSegment);
+		const __m256 inverseScale = _mm256_set1_ps(1.0f / samplesPerSegment);
+		const __m256i lastStep = _mm256_set1_epi32(static_cast<int>(stepCount) - 1);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 two = _mm256_set1_ps(2.0f);
+		const __m256 three = _mm256_set1_ps(3.0f);
+		for (int iteration = 0; iteration < 2; ++iteration)
+		{
+			const __m256 y = _mm256_mul_ps(u, scale);
+			const __m256i k = _mm256_min_epi32(_mm256_cvttps_epi32(y), lastStep);
+			const __m256i base = _mm256_slli_epi32(k, 2);
+			__m256 f = _mm256_sub_ps(y, _mm256_cvtepi32_ps(k));
+			const __m256 length = _mm256_i32gather_ps(steps + 0, base, 4);
+			const __m256 c1 = _mm256_i32gather_ps(steps + 1, base, 4);
+			const __m256 c2 = _mm256_i32gather_ps(steps + 2, base, 4);
+			const __m256 c3 = _mm256_i32gather_ps(steps + 3, base, 4);
+			const __m256 l = _mm256_fmadd_ps(f, _mm256_fmadd_ps(f, _mm256_fmadd_ps(f, c3, c2), c1), length);
+			const __m256 dl = _mm256_fmadd_ps(f, _mm256_fmadd_ps(_mm256_mul_ps(three, f), c3, _mm256_mul_ps(two, c2)), c1);
+			const __m256 valid = _mm256_cmp_ps(dl, zero, _CMP_GT_OQ);
+			f = _mm256_sub_ps(f, _mm256_and_ps(_mm256_div_ps(_mm256_sub_ps(l, distance), dl), valid));
+			u = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_cvtepi32_ps(k), f), inverseScale), zero), _mm256_set1_ps(stepCount / samplesPerSegment));
+		}
+		return u;
+	}
+
+	NFGE_TARGET_AVX2 size_t GetPointsAtDistanceAVX2(const float* segments, size_t segmentCount, bool loop, const float* steps, size_t stepCount, float samplesPerSegment,
+		const float* parameters, float length, float distanceScale, const float* distances, Vector3* points, Vector3* directions, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 distance = WrapAVX2(_mm256_loadu_ps(distances + i), length, loop);
+			const __m256 u = ParameterAtDistanceAVX2(steps, stepCount, samplesPerSegment, parameters, distanceScale, distance);
+			EvaluateAVX2(segments, segmentCount, u, points + i, directions != nullptr ? directions + i : nullptr);
+		}
+		return i;
+	}
+#endif
+}
+
+void NFGE::Math::SplinePath::SetCatmullRom(const Vector3* points, size_t count, bool loop)
+{
+	ASSERT(count >= 2, "[SplinePath] Need at least 2 points, got %zu.", count);
+	mSegments.clear();
+	mLoop = loop;
+
+	// Tangents are half the difference of the neighbours, an open path uses the one neighbour at its ends
+	const auto tangent = [&](size_t i)
+	{
+		if (loop)
+			return (points[(i + 1) % count] - points[(i + count - 1) % count]) * 0.5f;
+		if (i == 0)
+			return points[1] - points[0];
+		if (i == count - 1)
+			return points[count - 1] - points[count - 2];
+		return (points[i + 1] - points[i - 1]) * 0.5f;
+	};
+
+	const size_t segmentCount = loop ? count : count - 1;
+	mSegments.reserve(segmentCount);
+	for (size_t i = 0; i < segmentCount; ++i)
+	{
+		const size_t next = (i + 1) % count;
+		AddHermiteSegment(points[i], tangent(i), points[next], tangent(next));
+	}
+	BuildArcLengthTable(mSamplesPerSegment);
+}
+
+void NFGE::Math::SplinePath::SetCubicBezier(const Vector3* controlPoints, size_t count)
+{
+	ASSERT(count >= 4 && (count - 1) % 3 == 0, "[SplinePath] Need 3n + 1 control points, got %zu.", count);
+	mSegments.clear();
+	mLoop = false;
+
+	const size_t segmentCount = (count - 1) / 3;
+	mSegments.reserve(segmentCount);
+	for (size_t i = 0; i < segmentCount; ++i)
+	{
+		const Vector3* p = controlPoints + i * 3;
+		Segment& segment = mSegments.emplace_back();
+		segment.a = p[3] - p[0] + (p[1] - p[2]) * 3.0f;
+		segment.b = (p[2] - p[1] * 2.0f + p[0]) * 3.0f;
+		segment.c = (p[1] - p[0]) * 3.0f;
+		segment.d = p[0];
+	}
+	BuildArcLengthTable(mSamplesPerSegment);
+}
+
+void NFGE::Math::SplinePath::SetHermite(const Vector3* points, const Vector3* tangents, size_t count)
+{
+	ASSERT(count >= 2, "[SplinePath] Need at least 2 points, got %zu.", count);
+	mSegments.clear();
+	mLoop = false;
+
+	mSegments.reserve(count - 1);
+	for (size_t i = 0; i + 1 < count; ++i)
+		AddHermiteSegment(points[i], tangents[i], points[i + 1], tangents[i + 1]);
+	BuildArcLengthTable(mSamplesPerSegment);
+}
+
+void NFGE::Math::SplinePath::Clear()
+{
+	mSegments.clear();
+	mSteps.clear();
+	mParameters.clear();
+	mLength = 0.0f;
+	mDistanceScale = 0.0f;
+	mLoop = false;
+}
+
+void NFGE::Math::SplinePath::BuildArcLengthTable(uint32_t samplesPerSegment)
+{
+	ASSERT(samplesPerSegment > 0, "[SplinePath] samplesPerSegment must be positive.");
+	mSamplesPerSegment = samplesPerSegment;
+
+	// Length over each step of u from the speed, plus the speeds at its ends as the slopes of the cubic
+	const size_t stepCount = mSegments.size() * samplesPerSegment;
+	const float h = 1.0f / samplesPerSegment;
+	const double halfStep = 0.5 / samplesPerSegment;
+	mSteps.resize(stepCount);
+	double total = 0.0;
+	for (size_t s = 0; s < mSegments.size(); ++s)
+	{
+		const Segment& segment = mSegments[s];
+		for (uint32_t k = 0; k < samplesPerSegment; ++k)
+		{
+			const double mid = (k + 0.5) / samplesPerSegment;
+			double length = 0.0;
+			for (int g = 0; g < 5; ++g)
+			{
+				const float t = static_cast<float>(mid + halfStep * kGaussNodes[g]);
+				length += kGaussWeights[g] * Magnitude(Derivative(segment.a, segment.b, segment.c, t));
+			}
+			length *= halfStep;
+
+			const float d = static_cast<float>(length);
+			const float v0 = Magnitude(Derivative(segment.a, segment.b, segment.c, k * h)) * h;
+			const float v1 = Magnitude(Derivative(segment.a, segment.b, segment.c, (k + 1) * h)) * h;
+			ArcStep& step = mSteps[s * samplesPerSegment + k];
+			step.length = static_cast<float>(total);
+			step.c1 = v0;
+			step.c2 = 3.0f * d - 2.0f * v0 - v1;
+			step.c3 = v0 + v1 - 2.0f * d;
+			total += length;
+		}
+	}
+	mLength = static_cast<float>(total);
+
+	// Starting guesses at evenly spaced distance, from a lerp of the lengths
+	mParameters.resize(stepCount + 1);
+	if (mLength <= 0.0f)
+	{
+		std::fill(mParameters.begin(), mParameters.end(), 0.0f);
+		mDistanceScale = 0.0f;
+		return;
+	}
+	mDistanceScale = stepCount / mLength;
+	size_t k = 0;
+	for (size_t j = 0; j < stepCount; ++j)
+	{
+		const float distance = j / mDistanceScale;
+		while (k + 1 < stepCount && mSteps[k + 1].length <= distance)
+			++k;
+		const float next = k + 1 < stepCount ? mSteps[k + 1].length : mLength;
+		const float step = next - mSteps[k].length;
+		const float f = step > 0.0f ? Min((distance - mSteps[k].length) / step, 1.0f) : 0.0f;
+		mParameters[j] = (k + f) * h;
+	}
+	mParameters[stepCount] = static_cast<float>(mSegments.size());
+}
+
+Vector3 NFGE::Math::SplinePath::GetPoint(float u) const
+{
+	ASSERT(!mSegments.empty(), "[SplinePath] Path is empty.");
+	u = WrapParameter(u);
+	const size_t index = Min(static_cast<size_t>(u), mSegments.size() - 1);
+	const Segment& segment = mSegments[index];
+	return Evaluate(segment.a, segment.b, segment.c, segment.d, u - index);
+}
+
+Vector3 NFGE::Math::SplinePath::GetTangent(float u) const
+{
+	ASSERT(!mSegments.empty(), "[SplinePath] Path is empty.");
+	u = WrapParameter(u);
+	const size_t index = Min(static_cast<size_t>(u), mSegments.size() - 1);
+	const Segment& segment = mSegments[index];
+	return Derivative(segment.a, segment.b, segment.c, u - index);
+}
+
+float NFGE::Math::SplinePath::GetParameterAtDistance(float distance) const
+{
+	ASSERT(!mSegments.empty(), "[SplinePath] Path is empty.");
+	distance = WrapDistance(distance);
+	const float x = distance * mDistanceScale;
+	const size_t j = Min(static_cast<size_t>(x), mSteps.size() - 1);
+	float u = Lerp(mParameters[j], mParameters[j + 1], x - j);
+
+	// Newton steps on the length cubic of the step u falls in
+	const float scale = static_cast<float>(mSamplesPerSegment);
+	for (int iteration = 0; iteration < 2; ++iteration)
+	{
+		const float y = u * scale;
+		const size_t k = Min(static_cast<size_t>(y), mSteps.size() - 1);
+		const ArcStep& step = mSteps[k];
+		float f = y - k;
+		const float length = step.length + f * (step.c1 + f * (step.c2 + f * step.c3));
+		const float slope = step.c1 + f * (2.0f * step.c2 + 3.0f * f * step.c3);
+		if (slope > 0.0f)
+			f -= (length - distance) / slope;
+		u = Clamp((k + f) / scale, 0.0f, static_cast<float>(mSegments.size()));
+	}
+	return u;
+}
+
+void NFGE::Math::SplinePath::Sample(Vector3* out, size_t count) const
+{
+	ASSERT(!mSegments.empty(), "[SplinePath] Path is empty.");
+	if (count == 0)
+		return;
+	if (count == 1)
+	{
+		out[0] = GetPoint(0.0f);
+		return;
+	}
+
+	const size_t segmentCount = mSegments.size();
+	const float h = static_cast<float>(segmentCount) / (count - 1);
+	const float h2 = h * h;
+	const float h3 = h2 * h;
+	size_t i = 0;
+	for (size_t s = 0; s < segmentCount && i < count; ++s)
+	{
+		// Samples that start in this segment, the last segment takes the rest
+		size_t end = i;
+		if (s + 1 == segmentCount)
+			end = count;
+		else
+			while (end < count && end * h < s + 1)
+				++end;
+		if (end == i)
+			continue;
+
+		// Finite differences of the cubic at t with step h, then each point is three adds
+		const Segment& seg = mSegments[s];
+		const float t = i * h - s;
+		Vector3 p = Evaluate(seg.a, seg.b, seg.c, seg.d, t);
+		Vector3 d1 = seg.a * (3.0f * t * t * h + 3.0f * t * h2 + h3) + seg.b * (2.0f * t * h + h2) + seg.c * h;
+		Vector3 d2 = seg.a * (6.0f * t * h2 + 6.0f * h3) + seg.b * (2.0f * h2);
+		const Vector3 d3 = seg.a * (6.0f * h3);
+		for (; i < end; ++i)
+		{
+			out[i] = p;
+			p += d1;
+			d1 += d2;
+			d2 += d3;
+		}
+	}
+	out[count - 1] = GetPoint(static_cast<float>(segmentCount));
+}
+
+void NFGE::Math::SplinePath::GetPoints(const float* u, Vector3* points, Vector3* directions, size_t count) const
+{
+	ASSERT(!mSegments.empty(), "[SplinePath] Path is empty.");
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2)
+		i = GetPointsAVX2(&mSegments[0].a.x, mSegments.size(), mLoop, u, points, directions, count);
+#endif
+	for (; i < count; ++i)
+	{
+		points[i] = GetPoint(u[i]);
+		if (directions != nullptr)
+			directions[i] = Direction(GetTangent(u[i]));
+	}
+}
+
+void NFGE::Math::SplinePath::GetPointsAtDistance(const float* distances, Vector3* points, Vector3* directions, size_t count) const
+{
+	ASSERT(!mSegments.empty(), "[SplinePath] Path is empty.");
+	size_t i = 0;
+#if NFGE_SIMD_X86
+	if (GetInstructionSet() == InstructionSet::AVX2 && mLength > 0.0f)
+		i = GetPointsAtDistanceAVX2(&mSegments[0].a.x, mSegments.size(), mLoop, &mSteps[0].length, mSteps.size(), static_cast<float>(mSamplesPerSegment),
+			mParameters.data(), mLength, mDistanceScale, distances, points, directions, count);
+#endif
+	for (; i < count; ++i)
+	{
+		const float u = GetParameterAtDistance(distances[i]);
+		points[i] = GetPoint(u);
+		if (directions != nullptr)
+			directions[i] = Direction(GetTangent(u));
+	}
+}
+
+void NFGE::Math::SplinePath::AddHermiteSegment(const Vector3& p0, const Vector3& m0, const Vector3& p1, const Vector3& m1)
+{
+	Segment& segment = mSegments.emplace_back();
+	segment.a = (p0 - p1) * 2.0f + m0 + m1;
+	segment.b = (p1 - p0) * 3.0f - m0 * 2.0f - m1;
+	segment.c = m0;
+	segment.d = p0;
+}
+
+float NFGE::Math::SplinePath::WrapParameter(float u) const
+{
+	const float range = static_cast<float>(mSegments.size());
+	if (mLoop)
+		return u - floorf(u / range) * range;
+	return Clamp(u, 0.0f, range);
+}
+
+float NFGE::Math::SplinePath::WrapDistance(float distance) const
+{
+	if (mLoop && mLength > 0.0f)
+		return distance - floorf(distance / mLength) * mLength;
+	return Clamp(distance, 0.0f, mLength);
+}
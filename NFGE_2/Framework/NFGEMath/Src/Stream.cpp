@@ -0,0 +1,447 @@
+//====================================================================================================
+// Filename:	Stream.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+// The scalar loops below are plain SoA loops the compiler vectorizes on its own with the baseline
+// instruction set, so only the 8 wide AVX2 variants are written by hand.
+
+namespace
+{
+	inline size_t PaddedCount(size_t count)
+	{
+		return (count + Vector3Stream::kLaneCount - 1) & ~(Vector3Stream::kLaneCount - 1);
+	}
+
+	void ResizeLanes(AlignedVector<float>& lanes, size_t count)
+	{
+		lanes.resize(PaddedCount(count), 0.0f);
+		std::fill(lanes.begin() + count, lanes.end(), 0.0f);
+	}
+
+#if NFGE_SIMD_X86
+	NFGE_TARGET_AVX2 void CrossAVX2(const float* ax, const float* ay, const float* az, const float* bx, const float* by, const float* bz, float* ox, float* oy, float* oz, size_t paddedCount)
+	{
+		for (size_t i = 0; i < paddedCount; i += 8)
+		{
+			const __m256 x0 = _mm256_load_ps(ax + i), y0 = _mm256_load_ps(ay + i), z0 = _mm256_load_ps(az + i);
+			const __m256 x1 = _mm256_load_ps(bx + i), y1 = _mm256_load_ps(by + i), z1 = _mm256_load_ps(bz + i);
+			_mm256_store_ps(ox + i, _mm256_fmsub_ps(y0, z1, _mm256_mul_ps(z0, y1)));
+			_mm256_store_ps(oy + i, _mm256_fmsub_ps(z0, x1, _mm256_mul_ps(x0, z1)));
+			_mm256_store_ps(oz + i, _mm256_fmsub_ps(x0, y1, _mm256_mul_ps(y0, x1)));
+		}
+	}
+
+	NFGE_TARGET_AVX2 void DotAVX2(const float* ax, const float* ay, const float* az, const float* bx, const float* by, const float* bz, float* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 d = _mm256_mul_ps(_mm256_load_ps(ax + i), _mm256_load_ps(bx + i));
+			d = _mm256_fmadd_ps(_mm256_load_ps(ay + i), _mm256_load_ps(by + i), d);
+			d = _mm256_fmadd_ps(_mm256_load_ps(az + i), _mm256_load_ps(bz + i), d);
+			_mm256_storeu_ps(out + i, d);
+		}
+		for (; i < count; ++i)
+		{
+			out[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+		}
+	}
+
+	NFGE_TARGET_AVX2 inline __m256 SafeInverseLength(__m256 lengthSqr)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(lengthSqr));
+		return _mm256_blendv_ps(zero, inv, _mm256_cmp_ps(lengthSqr, zero, _CMP_GT_OQ));
+	}
+
+	NFGE_TARGET_AVX2 void NormalizeAVX2(const float* const* in, float* const* out, size_t componentCount, size_t paddedCount)
+	{
+		for (size_t i = 0; i < paddedCount; i += 8)
+		{
+			__m256 lengthSqr = _mm256_setzero_ps();
+			for (size_t c = 0; c < componentCount; ++c)
+			{
+				const __m256 v = _mm256_load_ps(in[c] + i);
+				lengthSqr = _mm256_fmadd_ps(v, v, lengthSqr);
+			}
+			const __m256 inv = SafeInverseLength(lengthSqr);
+			for (size_t c = 0; c < componentCount; ++c)
+			{
+				_mm256_store_ps(out[c] + i, _mm256_mul_ps(_mm256_load_ps(in[c] + i), inv));
+			}
+		}
+	}
+
+	NFGE_TARGET_AVX2 void LerpAVX2(const float* a, const float* b, float t, float* out, size_t paddedCount)
+	{
+		const __m256 vt = _mm256_set1_ps(t);
+		for (size_t i = 0; i < paddedCount; i += 8)
+		{
+			const __m256 va = _mm256_load_ps(a + i);
+			_mm256_store_ps(out + i, _mm256_fmadd_ps(_mm256_sub_ps(_mm256_load_ps(b + i), va), vt, va));
+		}
+	}
+
+	NFGE_TARGET_AVX2 void NlerpAVX2(const QuaternionStream& a, const QuaternionStream& b, float t, QuaternionStream& out)
+	{
+		const __m256 vt = _mm256_set1_ps(t);
+		const __m256 signMask = _mm256_set1_ps(-0.0f);
+		const size_t paddedCount = a.PaddedSize();
+		for (size_t i = 0; i < paddedCount; i += 8)
+		{
+			const __m256 ax = _mm256_load_ps(a.X() + i), ay = _mm256_load_ps(a.Y() + i), az = _mm256_load_ps(a.Z() + i), aw = _mm256_load_ps(a.W() + i);
+			__m256 bx = _mm256_load_ps(b.X() + i), by = _mm256_load_ps(b.Y() + i), bz = _mm256_load_ps(b.Z() + i), bw = _mm256_load_ps(b.W() + i);
+
+			// Flip b where the dot product is negative so we take the shorter arc
+			__m256 dot = _mm256_mul_ps(ax, bx);
+			dot = _mm256_fmadd_ps(ay, by, dot);
+			dot = _mm256_fmadd_ps(az, bz, dot);
+			dot = _mm256_fmadd_ps(aw, bw, dot);
+			const __m256 flip = _mm256_and_ps(dot, signMask);
+			bx = _mm256_xor_ps(bx, flip);
+			by = _mm256_xor_ps(by, flip);
+			bz = _mm256_xor_ps(bz, flip);
+			bw = _mm256_xor_ps(bw, flip);
+
+			const __m256 x = _mm256_fmadd_ps(_mm256_sub_ps(bx, ax), vt, ax);
+			const __m256 y = _mm256_fmadd_ps(_mm256_sub_ps(by, ay), vt, ay);
+			const __m256 z = _mm256_fmadd_ps(_mm256_sub_ps(bz, az), vt, az);
+			const __m256 w = _mm256_fmadd_ps(_mm256_sub_ps(bw, aw), vt, aw);
+			__m256 lengthSqr = _mm256_mul_ps(x, x);
+			lengthSqr = _mm256_fmadd_ps(y, y, lengthSqr);
+			lengthSqr = _mm256_fmadd_ps(z, z, lengthSqr);
+			lengthSqr = _mm256_fmadd_ps(w, w, lengthSqr);
+			const __m256 inv = SafeInverseLength(lengthSqr);
+			_mm256_store_ps(out.X() + i, _mm256_mul_ps(x, inv));
+			_mm256_store_ps(out.Y() + i, _mm256_mul_ps(y, inv));
+			_mm256_store_ps(out.Z() + i, _mm256_mul_ps(z, inv));
+			_mm256_store_ps(out.W() + i, _mm256_mul_ps(w, inv));
+		}
+	}
+
+	NFGE_TARGET_AVX2 void MinMaxAVX2(const Vector3Stream& v, Vector3& min, Vector3& max)
+	{
+		__m256 minX = _mm256_set1_ps(FLT_MAX), minY = minX, minZ = minX;
+		__m256 maxX = _mm256_set1_ps(-FLT_MAX), maxY = maxX, maxZ = maxX;
+
+		// Only whole blocks of real elements, the padding lanes would pull the result towards zero
+		const size_t count = v.Size();
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 x = _mm256_load_ps(v.X() + i), y = _mm256_load_ps(v.Y() + i), z = _mm256_load_ps(v.Z() + i);
+			minX = _mm256_min_ps(minX, x); maxX = _mm256_max_ps(maxX, x);
+			minY = _mm256_min_ps(minY, y); maxY = _mm256_max_ps(maxY, y);
+			minZ = _mm256_min_ps(minZ, z); maxZ = _mm256_max_ps(maxZ, z);
+		}
+
+		alignas(32) float lanes[6][8];
+		_mm256_store_ps(lanes[0], minX); _mm256_store_ps(lanes[1], minY); _mm256_store_ps(lanes[2], minZ);
+		_mm256_store_ps(lanes[3], maxX); _mm256_store_ps(lanes[4], maxY); _mm256_store_ps(lanes[5], maxZ);
+		for (size_t l = 0; l < 8; ++l)
+		{
+			min.x = Min(min.x, lanes[0][l]); min.y = Min(min.y, lanes[1][l]); min.z = Min(min.z, lanes[2][l]);
+			max.x = Max(max.x, lanes[3][l]); max.y = Max(max.y, lanes[4][l]); max.z = Max(max.z, lanes[5][l]);
+		}
+		for (; i < count; ++i)
+		{
+			min.x = Min(min.x, v.X()[i]); min.y = Min(min.y, v.Y()[i]); min.z = Min(min.z, v.Z()[i]);
+			max.x = Max(max.x, v.X()[i]); max.y = Max(max.y, v.Y()[i]); max.z = Max(max.z, v.Z()[i]);
+		}
+	}
+#endif
+
+	inline bool UseAVX2()
+	{
+		return NFGE_SIMD_X86 && GetInstructionSet() == InstructionSet::AVX2;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::Vector3Stream::Resize(size_t count)
+{
+	ResizeLanes(mX, count);
+	ResizeLanes(mY, count);
+	ResizeLanes(mZ, count);
+	mCount = count;
+}
+
+void NFGE::Math::Vector3Stream::Assign(const Vector3* v, size_t count)
+{
+	Resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		mX[i] = v[i].x;
+		mY[i] = v[i].y;
+		mZ[i] = v[i].z;
+	}
+}
+
+void NFGE::Math::Vector3Stream::ToVector(std::vector<Vector3>& v) const
+{
+	v.resize(mCount);
+	for (size_t i = 0; i < mCount; ++i)
+	{
+		v[i] = Vector3(mX[i], mY[i], mZ[i]);
+	}
+}
+
+Vector3 NFGE::Math::Vector3Stream::Get(size_t i) const
+{
+	ASSERT(i < mCount, "[Vector3Stream] Index out of bound.");
+	return Vector3(mX[i], mY[i], mZ[i]);
+}
+
+void NFGE::Math::Vector3Stream::Set(size_t i, const Vector3& v)
+{
+	ASSERT(i < mCount, "[Vector3Stream] Index out of bound.");
+	mX[i] = v.x;
+	mY[i] = v.y;
+	mZ[i] = v.z;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::QuaternionStream::Resize(size_t count)
+{
+	ResizeLanes(mX, count);
+	ResizeLanes(mY, count);
+	ResizeLanes(mZ, count);
+	ResizeLanes(mW, count);
+	mCount = count;
+}
+
+void NFGE::Math::QuaternionStream::Assign(const Quaternion* q, size_t count)
+{
+	Resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		mX[i] = q[i].x;
+		mY[i] = q[i].y;
+		mZ[i] = q[i].z;
+		mW[i] = q[i].w;
+	}
+}
+
+void NFGE::Math::QuaternionStream::ToVector(std::vector<Quaternion>& q) const
+{
+	q.resize(mCount);
+	for (size_t i = 0; i < mCount; ++i)
+	{
+		q[i] = Quaternion(mX[i], mY[i], mZ[i], mW[i]);
+	}
+}
+
+Quaternion NFGE::Math::QuaternionStream::Get(size_t i) const
+{
+	ASSERT(i < mCount, "[QuaternionStream] Index out of bound.");
+	return Quaternion(mX[i], mY[i], mZ[i], mW[i]);
+}
+
+void NFGE::Math::QuaternionStream::Set(size_t i, const Quaternion& q)
+{
+	ASSERT(i < mCount, "[QuaternionStream] Index out of bound.");
+	mX[i] = q.x;
+	mY[i] = q.y;
+	mZ[i] = q.z;
+	mW[i] = q.w;
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::Dot(const Vector3Stream& a, const Vector3Stream& b, float* out)
+{
+	ASSERT(a.Size() == b.Size(), "[Stream] Size mismatch.");
+#if NFGE_SIMD_X86
+	if (UseAVX2())
+	{
+		DotAVX2(a.X(), a.Y(), a.Z(), b.X(), b.Y(), b.Z(), out, a.Size());
+		return;
+	}
+#endif
+	for (size_t i = 0; i < a.Size(); ++i)
+	{
+		out[i] = a.X()[i] * b.X()[i] + a.Y()[i] * b.Y()[i] + a.Z()[i] * b.Z()[i];
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::Cross(const Vector3Stream& a, const Vector3Stream& b, Vector3Stream& out)
+{
+	ASSERT(a.Size() == b.Size(), "[Stream] Size mismatch.");
+	out.Resize(a.Size());
+#if NFGE_SIMD_X86
+	if (UseAVX2())
+	{
+		CrossAVX2(a.X(), a.Y(), a.Z(), b.X(), b.Y(), b.Z(), out.X(), out.Y(), out.Z(), a.PaddedSize());
+		return;
+	}
+#endif
+	for (size_t i = 0; i < a.PaddedSize(); ++i)
+	{
+		const float ax = a.X()[i], ay = a.Y()[i], az = a.Z()[i];
+		const float bx = b.X()[i], by = b.Y()[i], bz = b.Z()[i];
+		out.X()[i] = ay * bz - az * by;
+		out.Y()[i] = az * bx - ax * bz;
+		out.Z()[i] = ax * by - ay * bx;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::Normalize(const Vector3Stream& v, Vector3Stream& out)
+{
+	out.Resize(v.Size());
+#if NFGE_SIMD_X86
+	if (UseAVX2())
+	{
+		const float* in[] = { v.X(), v.Y(), v.Z() };
+		float* dst[] = { out.X(), out.Y(), out.Z() };
+		NormalizeAVX2(in, dst, 3, v.PaddedSize());
+		return;
+	}
+#endif
+	for (size_t i = 0; i < v.PaddedSize(); ++i)
+	{
+		const float x = v.X()[i], y = v.Y()[i], z = v.Z()[i];
+		const float lengthSqr = x * x + y * y + z * z;
+		const float inv = lengthSqr > 0.0f ? 1.0f / sqrtf(lengthSqr) : 0.0f;
+		out.X()[i] = x * inv;
+		out.Y()[i] = y * inv;
+		out.Z()[i] = z * inv;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::Lerp(const Vector3Stream& a, const Vector3Stream& b, float t, Vector3Stream& out)
+{
+	ASSERT(a.Size() == b.Size(), "[Stream] Size mismatch.");
+	out.Resize(a.Size());
+#if NFGE_SIMD_X86
+	if (UseAVX2())
+	{
+		LerpAVX2(a.X(), b.X(), t, out.X(), a.PaddedSize());
+		LerpAVX2(a.Y(), b.Y(), t, out.Y(), a.PaddedSize());
+		LerpAVX2(a.Z(), b.Z(), t, out.Z(), a.PaddedSize());
+		return;
+	}
+#endif
+	for (size_t i = 0; i < a.PaddedSize(); ++i)
+	{
+		out.X()[i] = Lerp(a.X()[i], b.X()[i], t);
+		out.Y()[i] = Lerp(a.Y()[i], b.Y()[i], t);
+		out.Z()[i] = Lerp(a.Z()[i], b.Z()[i], t);
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::Normalize(const QuaternionStream& q, QuaternionStream& out)
+{
+	out.Resize(q.Size());
+#if NFGE_SIMD_X86
+	if (UseAVX2())
+	{
+		const float* in[] = { q.X(), q.Y(), q.Z(), q.W() };
+		float* dst[] = { out.X(), out.Y(), out.Z(), out.W() };
+		NormalizeAVX2(in, dst, 4, q.PaddedSize());
+		return;
+	}
+#endif
+	for (size_t i = 0; i < q.PaddedSize(); ++i)
+	{
+		const float x = q.X()[i], y = q.Y()[i], z = q.Z()[i], w = q.W()[i];
+		const float lengthSqr = x * x + y * y + z * z + w * w;
+		const float inv = lengthSqr > 0.0f ? 1.0f / sqrtf(lengthSqr) : 0.0f;
+		out.X()[i] = x * inv;
+		out.Y()[i] = y * inv;
+		out.Z()[i] = z * inv;
+		out.W()[i] = w * inv;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::Nlerp(const QuaternionStream& a, const QuaternionStream& b, float t, QuaternionStream& out)
+{
+	ASSERT(a.Size() == b.Size(), "[Stream] Size mismatch.");
+	out.Resize(a.Size());
+#if NFGE_SIMD_X86
+	if (UseAVX2())
+	{
+		NlerpAVX2(a, b, t, out);
+		return;
+	}
+#endif
+	for (size_t i = 0; i < a.PaddedSize(); ++i)
+	{
+		const float ax = a.X()[i], ay = a.Y()[i], az = a.Z()[i], aw = a.W()[i];
+		float bx = b.X()[i], by = b.Y()[i], bz = b.Z()[i], bw = b.W()[i];
+		if (ax * bx + ay * by + az * bz + aw * bw < 0.0f)
+		{
+			bx = -bx; by = -by; bz = -bz; bw = -bw;
+		}
+		const float x = Lerp(ax, bx, t), y = Lerp(ay, by, t), z = Lerp(az, bz, t), w = Lerp(aw, bw, t);
+		const float lengthSqr = x * x + y * y + z * z + w * w;
+		const float inv = lengthSqr > 0.0f ? 1.0f / sqrtf(lengthSqr) : 0.0f;
+		out.X()[i] = x * inv;
+		out.Y()[i] = y * inv;
+		out.Z()[i] = z * inv;
+		out.W()[i] = w * inv;
+	}
+}
+
+//----------------------------------------------------------------------------------------------------
+
+Vector3 NFGE::Math::Min(const Vector3Stream& v)
+{
+	Vector3 min(FLT_MAX), max(-FLT_MAX);
+	MinMax(v, min, max);
+	return min;
+}
+
+Vector3 NFGE::Math::Max(const Vector3Stream& v)
+{
+	Vector3 min(FLT_MAX), max(-FLT_MAX);
+	MinMax(v, min, max);
+	return max;
+}
+
+void NFGE::Math::MinMax(const Vector3Stream& v, Vector3& min, Vector3& max)
+{
+	if (v.Empty())
+		return;
+
+	Vector3 resultMin(FLT_MAX), resultMax(-FLT_MAX);
+#if NFGE_SIMD_X86
+	if (UseAVX2())
+	{
+		MinMaxAVX2(v, resultMin, resultMax);
+		min = resultMin;
+		max = resultMax;
+		return;
+	}
+#endif
+	for (size_t i = 0; i < v.Size(); ++i)
+	{
+		resultMin.x = Min(resultMin.x, v.X()[i]); resultMin.y = Min(resultMin.y, v.Y()[i]); resultMin.z = Min(resultMin.z, v.Z()[i]);
+		resultMax.x = Max(resultMax.x, v.X()[i]); resultMax.y = Max(resultMax.y, v.Y()[i]); resultMax.z = Max(resultMax.z, v.Z()[i]);
+	}
+	min = resultMin;
+	max = resultMax;
+}
@@ -0,0 +1,680 @@
+//====================================================================================================
+// Filename:	Sweep.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+using namespace NFGE::Math;
+
+namespace
+{
+	constexpr uint32_t kNoTriangle = UINT32_MAX;
+
+	// Edge pairs whose cross product is below this fraction of their lengths are treated as parallel,
+	// their contacts are found at the segment ends instead
+	constexpr float kParallelTolerance = 1e-10f;
+
+	inline Vector3 MinPerAxis(const Vector3& a, const Vector3& b) { return Vector3(Min(a.x, b.x), Min(a.y, b.y), Min(a.z, b.z)); }
+	inline Vector3 MaxPerAxis(const Vector3& a, const Vector3& b) { return Vector3(Max(a.x, b.x), Max(a.y, b.y), Max(a.z, b.z)); }
+
+	// p is expected to lie in the plane of abc, n is the unnormalized triangle normal
+	inline bool InsideTriangle(const Vector3& p, const Vector3& a, const Vector3& b, const Vector3& c, const Vector3& n)
+	{
+		return Dot(Cross(b - a, p - a), n) >= 0.0f && Dot(Cross(c - b, p - b), n) >= 0.0f && Dot(Cross(a - c, p - c), n) >= 0.0f;
+	}
+
+	// Unit direction from the contact to the moving shape. When the shape's core touches the target itself,
+	// as a zero radius sphere does, the separation says nothing and the surface normal n is used instead,
+	// turned to face against the motion.
+	Vector3 ContactNormal(const Vector3& separation, float radius, Vector3 n, const Vector3& displacement)
+	{
+		const float separationSqr = MagnitudeSqr(separation);
+		if (separationSqr > 0.0f && separationSqr > Sqr(radius * 1e-3f))
+			return separation / Sqrt(separationSqr);
+
+		if (MagnitudeSqr(n) == 0.0f)
+			n = -displacement;
+		if (MagnitudeSqr(n) == 0.0f)
+			return Vector3::YAxis;
+		return Normalize(Dot(n, displacement) > 0.0f ? -n : n);
+	}
+
+	// Smallest time in [0, maxTime] at which org + dir * time is radius from center. Uses the c / (-b + root)
+	// form of the smaller root, which keeps its precision when the ray starts close to the sphere.
+	bool RaySphere(const Vector3& org, const Vector3& dir, const Vector3& center, float radius, float maxTime, float& time)
+	{
+		const Vector3 m = org - center;
+		const float c = Dot(m, m) - radius * radius;
+		if (c <= 0.0f)
+		{
+			time = 0.0f;
+			return true;
+		}
+
+		const float b = Dot(m, dir);
+		if (b >= 0.0f)
+			return false;
+
+		const float discriminant = b * b - Dot(dir, dir) * c;
+		if (discriminant < 0.0f)
+			return false;
+
+		const float t = c / (Sqrt(discriminant) - b);
+		if (t > maxTime)
+			return false;
+		time = t;
+		return true;
+	}
+
+	// Side of the cylinder of radius around p-q, between its end planes. Rays starting inside the infinite
+	// cylinder miss, the caps are left to RaySphere. Every term is scaled by |q - p|^2 to avoid divides.
+	bool RayCylinder(const Vector3& org, const Vector3& dir, const Vector3& p, const Vector3& q, float radius, float maxTime, float& time)
+	{
+		const Vector3 e = q - p;
+		const Vector3 m = org - p;
+		const float ee = Dot(e, e);
+		const float md = Dot(m, e);
+		const float nd = Dot(dir, e);
+
+		const float c = ee * (Dot(m, m) - radius * radius) - md * md;
+		const float b = ee * Dot(m, dir) - nd * md;
+		if (c <= 0.0f || b >= 0.0f)
+			return false;
+
+		const float a = ee * Dot(dir, dir) - nd * nd;
+		const float discriminant = b * b - a * c;
+		if (discriminant < 0.0f)
+			return false;
+
+		const float t = c / (Sqrt(discriminant) - b);
+		if (t > maxTime)
+			return false;
+
+		const float s = md + t * nd;
+		if (s < 0.0f || s > ee)
+			return false;
+		time = t;
+		return true;
+	}
+
+	bool RayCapsule(const Vector3& org, const Vector3& dir, const Vector3& p, const Vector3& q, float radius, float maxTime, float& time)
+	{
+		bool hit = false;
+		float t;
+		if (RayCylinder(org, dir, p, q, radius, maxTime, t)) { maxTime = t; hit = true; }
+		if (RaySphere(org, dir, p, radius, maxTime, t)) { maxTime = t; hit = true; }
+		if (RaySphere(org, dir, q, radius, maxTime, t)) { maxTime = t; hit = true; }
+		time = maxTime;
+		return hit;
+	}
+
+	// Closest points of segments p0-p1 and q0-q1, returns their squared distance. Ericson 5.1.9.
+	float ClosestSegmentSegment(const Vector3& p0, const Vector3& p1, const Vector3& q0, const Vector3& q1, Vector3& onP, Vector3& onQ)
+	{
+		const Vector3 dp = p1 - p0;
+		const Vector3 dq = q1 - q0;
+		const Vector3 r = p0 - q0;
+		const float a = Dot(dp, dp);
+		const float e = Dot(dq, dq);
+		const float f = Dot(dq, r);
+
+		float s = 0.0f;
+		float t = 0.0f;
+		if (a <= 0.0f)
+		{
+			t = e > 0.0f ? Clamp(f / e, 0.0f, 1.0f) : 0.0f;
+		}
+		else
+		{
+			const float c = Dot(dp, r);
+			if (e <= 0.0f)
+			{
+				s = Clamp(-c / a, 0.0f, 1.0f);
+			}
+			else
+			{
+				const float b = Dot(dp, dq);
+				const float denom = a * e - b * b;
+				s = denom != 0.0f ? Clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+				t = (b * s + f) / e;
+				if (t < 0.0f)
+				{
+					t = 0.0f;
+					s = Clamp(-c / a, 0.0f, 1.0f);
+				}
+				else if (t > 1.0f)
+				{
+					t = 1.0f;
+					s = Clamp((b - c) / a, 0.0f, 1.0f);
+				}
+			}
+		}
+
+		onP = p0 + dp * s;
+		onQ = q0 + dq * t;
+		return MagnitudeSqr(onP - onQ);
+	}
+
+	// Closest points of segment p0-p1 and triangle abc, returns their squared distance. Apart from a
+	// segment crossing the triangle, the closest pair always involves a segment end or a triangle edge.
+	float ClosestSegmentTriangle(const Vector3& p0, const Vector3& p1, const Vector3& a, const Vector3& b, const Vector3& c, Vector3& onSegment, Vector3& onTriangle)
+	{
+		const Vector3 n = Cross(b - a, c - a);
+		const float s0 = Dot(p0 - a, n);
+		const float s1 = Dot(p1 - a, n);
+		if (s0 != s1 && ((s0 <= 0.0f && s1 >= 0.0f) || (s0 >= 0.0f && s1 <= 0.0f)))
+		{
+			const Vector3 crossing = p0 + (p1 - p0) * (s0 / (s0 - s1));
+			if (InsideTriangle(crossing, a, b, c, n))
+			{
+				onSegment = onTriangle = crossing;
+				return 0.0f;
+			}
+		}
+
+		onSegment = p0;
+		onTriangle = GetClosestPoint(p0, a, b, c);
+		float bestSqr = MagnitudeSqr(onSegment - onTriangle);
+
+		const Vector3 closestToEnd = GetClosestPoint(p1, a, b, c);
+		const float endSqr = MagnitudeSqr(p1 - closestToEnd);
+		if (endSqr < bestSqr)
+		{
+			bestSqr = endSqr;
+			onSegment = p1;
+			onTriangle = closestToEnd;
+		}
+
+		const Vector3 vertices[3] = { a, b, c };
+		for (int i = 0; i < 3; ++i)
+		{
+			Vector3 onP, onQ;
+			const float distanceSqr = ClosestSegmentSegment(p0, p1, vertices[i], vertices[(i + 1) % 3], onP, onQ);
+			if (distanceSqr < bestSqr)
+			{
+				bestSqr = distanceSqr;
+				onSegment = onP;
+				onTriangle = onQ;
+			}
+		}
+		return bestSqr;
+	}
+
+	// First contact of a sphere moving from center that does not touch the triangle at the start. The face
+	// is tried first: when the sphere reaches the plane inside the triangle that is the first contact, and
+	// when it cannot reach the plane in time nothing else can be hit either. Otherwise the first contact is
+	// with an edge (ray against the edge cylinder) or a vertex (ray against a sphere around it).
+	bool SphereTriangleFirstContact(const Vector3& center, float radius, const Vector3& displacement, const Vector3& a, const Vector3& b, const Vector3& c, float maxTime, float& time)
+	{
+		const Vector3 n = Cross(b - a, c - a);
+		const float nn = Dot(n, n);
+		if (nn > 0.0f)
+		{
+			// Distances along n are scaled by |n|
+			const float scaledRadius = radius * Sqrt(nn);
+			const float s0 = Dot(center - a, n);
+			const float sn = Dot(displacement, n);
+			const float side = s0 >= 0.0f ? 1.0f : -1.0f;
+			if (Abs(s0) > scaledRadius)
+			{
+				if (side * sn >= 0.0f)
+					return false;
+
+				const float t = (side * scaledRadius - s0) / sn;
+				if (t > maxTime)
+					return false;
+
+				const Vector3 contact = center + displacement * t - n * (side * scaledRadius / nn);
+				if (InsideTriangle(contact, a, b, c, n))
+				{
+					time = t;
+					return true;
+				}
+			}
+		}
+
+		bool hit = false;
+		float t;
+		const Vector3 vertices[3] = { a, b, c };
+		for (int i = 0; i < 3; ++i)
+		{
+			if (RayCylinder(center, displacement, vertices[i], vertices[(i + 1) % 3], radius, maxTime, t)) { maxTime = t; hit = true; }
+			if (RaySphere(center, displacement, vertices[i], radius, maxTime, t)) { maxTime = t; hit = true; }
+		}
+		time = maxTime;
+		return hit;
+	}
+
+	bool SphereTriangleTime(const Vector3& center, float radius, const Vector3& displacement, const Vector3& a, const Vector3& b, const Vector3& c, float maxTime, float& time)
+	{
+		if (MagnitudeSqr(GetClosestPoint(center, a, b, c) - center) <= radius * radius)
+		{
+			time = 0.0f;
+			return true;
+		}
+		return SphereTriangleFirstContact(center, radius, displacement, a, b, c, maxTime, time);
+	}
+
+	void SphereTriangleContact(const Vector3& center, float radius, const Vector3& displacement, const Vector3& a, const Vector3& b, const Vector3& c, float time, SweepHit& hit)
+	{
+		const Vector3 centerAtTime = center + displacement * time;
+		hit.point = GetClosestPoint(centerAtTime, a, b, c);
+		hit.normal = ContactNormal(centerAtTime - hit.point, radius, Cross(b - a, c - a), displacement);
+		hit.time = time;
+	}
+
+	// The capsule is its segment swept by a sphere, so the first contact is either a segment end against the
+	// triangle, a triangle vertex against the segment's side, or the segment's side against an edge's side.
+	// The last happens when the two lines come within radius along their common normal with the closest
+	// points inside both segments.
+	bool CapsuleTriangleTime(const Vector3& p0, const Vector3& p1, float radius, const Vector3& displacement, const Vector3& a, const Vector3& b, const Vector3& c, float maxTime, float& time)
+	{
+		Vector3 onSegment, onTriangle;
+		if (ClosestSegmentTriangle(p0, p1, a, b, c, onSegment, onTriangle) <= radius * radius)
+		{
+			time = 0.0f;
+			return true;
+		}
+
+		bool hit = false;
+		float t;
+		if (SphereTriangleFirstContact(p0, radius, displacement, a, b, c, maxTime, t)) { maxTime = t; hit = true; }
+		if (SphereTriangleFirstContact(p1, radius, displacement, a, b, c, maxTime, t)) { maxTime = t; hit = true; }
+
+		const Vector3 u = p1 - p0;
+		const float uu = Dot(u, u);
+		const Vector3 vertices[3] = { a, b, c };
+		for (int i = 0; i < 3; ++i)
+		{
+			// The vertex moves against the capsule instead of the capsule towards it
+			if (RayCylinder(vertices[i], -displacement, p0, p1, radius, maxTime, t)) { maxTime = t; hit = true; }
+
+			const Vector3& e0 = vertices[i];
+			const Vector3 w = vertices[(i + 1) % 3] - e0;
+			const float ww = Dot(w, w);
+			const Vector3 n = Cross(u, w);
+			const float nn = Dot(n, n);
+			if (nn <= kParallelTolerance * uu * ww)
+				continue;
+
+			const float scaledRadius = radius * Sqrt(nn);
+			const float s0 = Dot(p0 - e0, n);
+			const float sn = Dot(displacement, n);
+			const float side = s0 >= 0.0f ? 1.0f : -1.0f;
+			if (Abs(s0) <= scaledRadius || side * sn >= 0.0f)
+				continue;
+
+			const float tEdge = (side * scaledRadius - s0) / sn;
+			if (tEdge > maxTime)
+				continue;
+
+			// Closest points of the two lines at that time, both parameters are scaled by nn = uu * ww - uw^2
+			const Vector3 r = p0 + displacement * tEdge - e0;
+			const float uw = Dot(u, w);
+			const float ur = Dot(u, r);
+			const float wr = Dot(w, r);
+			const float s = uw * wr - ww * ur;
+			const float v = uu * wr - uw * ur;
+			if (s >= 0.0f && s <= nn && v >= 0.0f && v <= nn)
+			{
+				maxTime = tEdge;
+				hit = true;
+			}
+		}
+		time = maxTime;
+		return hit;
+	}
+
+	void CapsuleTriangleContact(const Vector3& p0, const Vector3& p1, float radius, const Vector3& displacement, const Vector3& a, const Vector3& b, const Vector3& c, float time, SweepHit& hit)
+	{
+		const Vector3 offset = displacement * time;
+		Vector3 onSegment;
+		ClosestSegmentTriangle(p0 + offset, p1 + offset, a, b, c, onSegment, hit.point);
+		hit.normal = ContactNormal(onSegment - hit.point, radius, Cross(b - a, c - a), displacement);
+		hit.time = time;
+	}
+
+	// The core of the swept shape is the segment p0-p1, a single point for a sphere. Each hit shortens the
+	// sweep, and a triangle is only tested exactly when it overlaps the bounds of the remaining sweep and
+	// the core comes within radius of its plane somewhere along it.
+	template <typename GetTriangle, typename TimeFunc>
+	bool SweepTriangles(const Vector3& p0, const Vector3& p1, float radius, const Vector3& displacement, size_t triangleCount, GetTriangle&& getTriangle, TimeFunc&& timeOfImpact, Vector3 (&hitTriangle)[3], uint32_t& hitIndex, float& hitTime)
+	{
+		const Vector3 coreMin = MinPerAxis(p0, p1) - Vector3(radius);
+		const Vector3 coreMax = MaxPerAxis(p0, p1) + Vector3(radius);
+
+		float best = 1.0f;
+		hitIndex = kNoTriangle;
+		for (size_t i = 0; i < triangleCount; ++i)
+		{
+			Vector3 a, b, c;
+			getTriangle(i, a, b, c);
+
+			const Vector3 step = displacement * best;
+			const Vector3 sweptMin = coreMin + MinPerAxis(step, Vector3::Zero());
+			const Vector3 sweptMax = coreMax + MaxPerAxis(step, Vector3::Zero());
+			const Vector3 triangleMin = MinPerAxis(MinPerAxis(a, b), c);
+			const Vector3 triangleMax = MaxPerAxis(MaxPerAxis(a, b), c);
+			if (triangleMin.x > sweptMax.x || triangleMin.y > sweptMax.y || triangleMin.z > sweptMax.z ||
+				triangleMax.x < sweptMin.x || triangleMax.y < sweptMin.y || triangleMax.z < sweptMin.z)
+				continue;
+
+			const Vector3 n = Cross(b - a, c - a);
+			const float scaledRadius = radius * Magnitude(n);
+			const float s0 = Dot(p0 - a, n);
+			const float s1 = Dot(p1 - a, n);
+			const float sn = Dot(step, n);
+			if (Min(s0, s1) + Min(sn, 0.0f) > scaledRadius || Max(s0, s1) + Max(sn, 0.0f) < -scaledRadius)
+				continue;
+
+			float t;
+			if (timeOfImpact(a, b, c, best, t) && (t < best || hitIndex == kNoTriangle))
+			{
+				best = t;
+				hitIndex = static_cast<uint32_t>(i);
+				hitTriangle[0] = a;
+				hitTriangle[1] = b;
+				hitTriangle[2] = c;
+				if (t == 0.0f)
+					break;
+			}
+		}
+		hitTime = best;
+		return hitIndex != kNoTriangle;
+	}
+
+	template <typename GetTriangle>
+	bool SweepSphereTriangles(const Sphere& sphere, const Vector3& displacement, size_t triangleCount, GetTriangle&& getTriangle, SweepHit& hit, uint32_t* triangle)
+	{
+		const auto timeOfImpact = [&](const Vector3& a, const Vector3& b, const Vector3& c, float maxTime, float& time)
+		{
+			return SphereTriangleTime(sphere.center, sphere.radius, displacement, a, b, c, maxTime, time);
+		};
+
+		Vector3 hitTriangle[3];
+		uint32_t hitIndex;
+		float time;
+		if (!SweepTriangles(sphere.center, sphere.center, sphere.radius, displacement, triangleCount, getTriangle, timeOfImpact, hitTriangle, hitIndex, time))
+			return false;
+
+		SphereTriangleContact(sphere.center, sphere.radius, displacement, hitTriangle[0], hitTriangle[1], hitTriangle[2], time, hit);
+		if (triangle)
+			*triangle = hitIndex;
+		return true;
+	}
+
+	template <typename GetTriangle>
+	bool SweepCapsuleTriangles(const Capsule& capsule, const Vector3& displacement, size_t triangleCount, GetTriangle&& getTriangle, SweepHit& hit, uint32_t* triangle)
+	{
+		const auto timeOfImpact = [&](const Vector3& a, const Vector3& b, const Vector3& c, float maxTime, float& time)
+		{
+			return CapsuleTriangleTime(capsule.a, capsule.b, capsule.radius, displacement, a, b, c, maxTime, time);
+		};
+
+		Vector3 hitTriangle[3];
+		uint32_t hitIndex;
+		float time;
+		if (!SweepTriangles(capsule.a, capsule.b, capsule.radius, displacement, triangleCount, getTriangle, timeOfImpact, hitTriangle, hitIndex, time))
+			return false;
+
+		CapsuleTriangleContact(capsule.a, capsule.b, capsule.radius, displacement, hitTriangle[0], hitTriangle[1], hitTriangle[2], time, hit);
+		if (triangle)
+			*triangle = hitIndex;
+		return true;
+	}
+}
+
+bool NFGE::Math::Sweep(const Sphere& sphere, const Vector3& displacement, const Plane& plane, SweepHit& hit)
+{
+	const float s0 = Dot(plane.n, sphere.center) - plane.d;
+	const float sn = Dot(plane.n, displacement);
+	if (Abs(s0) <= sphere.radius)
+	{
+		hit.point = sphere.center - plane.n * s0;
+		hit.normal = (s0 > 0.0f || (s0 == 0.0f && sn <= 0.0f)) ? plane.n : -plane.n;
+		hit.time = 0.0f;
+		return true;
+	}
+
+	const float side = s0 > 0.0f ? 1.0f : -1.0f;
+	if (side * sn >= 0.0f)
+		return false;
+
+	const float t = (side * sphere.radius - s0) / sn;
+	if (t > 1.0f)
+		return false;
+
+	hit.normal = plane.n * side;
+	hit.point = sphere.center + displacement * t - hit.normal * sphere.radius;
+	hit.time = t;
+	return true;
+}
+
+bool NFGE::Math::Sweep(const Sphere& sphere, const Vector3& displacement, const Vector3& a, const Vector3& b, const Vector3& c, SweepHit& hit)
+{
+	float time;
+	if (!SphereTriangleTime(sphere.center, sphere.radius, displacement, a, b, c, 1.0f, time))
+		return false;
+	SphereTriangleContact(sphere.center, sphere.radius, displacement, a, b, c, time, hit);
+	return true;
+}
+
+bool NFGE::Math::Sweep(const Capsule& capsule, const Vector3& displacement, const Vector3& a, const Vector3& b, const Vector3& c, SweepHit& hit)
+{
+	float time;
+	if (!CapsuleTriangleTime(capsule.a, capsule.b, capsule.radius, displacement, a, b, c, 1.0f, time))
+		return false;
+	CapsuleTriangleContact(capsule.a, capsule.b, capsule.radius, displacement, a, b, c, time, hit);
+	return true;
+}
+
+bool NFGE::Math::Sweep(const AABB& aabb, const Vector3& displacement, const AABB& target, SweepHit& hit)
+{
+	// The moving box's center against the target grown by the moving box's extend
+	const Vector3 relative = aabb.center - target.center;
+	const Vector3 extend = aabb.extend + target.extend;
+
+	float tEnter = 0.0f;
+	float tExit = 1.0f;
+	int axis = -1;
+	for (int i = 0; i < 3; ++i)
+	{
+		if (displacement.v[i] == 0.0f)
+		{
+			if (Abs(relative.v[i]) > extend.v[i])
+				return false;
+			continue;
+		}
+
+		float t0 = (-extend.v[i] - relative.v[i]) / displacement.v[i];
+		float t1 = (extend.v[i] - relative.v[i]) / displacement.v[i];
+		if (t0 > t1)
+			std::swap(t0, t1);
+		if (t0 > tEnter)
+		{
+			tEnter = t0;
+			axis = i;
+		}
+		tExit = Min(tExit, t1);
+		if (tEnter > tExit)
+			return false;
+	}
+
+	hit.normal = Vector3::Zero();
+	if (axis < 0)
+	{
+		// Overlapping at the start, push out along the axis of least penetration
+		axis = 0;
+		for (int i = 1; i < 3; ++i)
+		{
+			if (extend.v[i] - Abs(relative.v[i]) < extend.v[axis] - Abs(relative.v[axis]))
+				axis = i;
+		}
+		hit.normal.v[axis] = relative.v[axis] >= 0.0f ? 1.0f : -1.0f;
+	}
+	else
+	{
+		hit.normal.v[axis] = displacement.v[axis] > 0.0f ? -1.0f : 1.0f;
+	}
+
+	// Middle of the region where the boxes touch, on the target's face along the normal
+	const Vector3 movedCenter = aabb.center + displacement * tEnter;
+	const Vector3 low = MaxPerAxis(movedCenter - aabb.extend, target.Min());
+	const Vector3 high = MinPerAxis(movedCenter + aabb.extend, target.Max());
+	hit.point = (low + high) * 0.5f;
+	if (tEnter > 0.0f)
+		hit.point.v[axis] = target.center.v[axis] + hit.normal.v[axis] * target.extend.v[axis];
+	hit.time = tEnter;
+	return true;
+}
+
+bool NFGE::Math::Sweep(const Sphere& sphere, const Vector3& displacement, const OBB& obb, SweepHit& hit)
+{
+	return Sweep(sphere, displacement, CachedOBB(obb), hit);
+}
+
+bool NFGE::Math::Sweep(const Sphere& sphere, const Vector3& displacement, const CachedOBB& obb, SweepHit& hit)
+{
+	// In the box's frame, where it is an AABB centered at the origin. Ericson 5.5.7: the ray against the box
+	// grown by the radius gives the time when the entry point is in a face region, otherwise the contact is
+	// with the edges around the entry point, which are tested as capsules.
+	const Vector3 center = obb.ToLocal(sphere.center);
+	const Vector3 direction = obb.ToLocalDirection(displacement);
+	const Vector3& extend = obb.extend;
+	const float radius = sphere.radius;
+
+	const AABB box(Vector3::Zero(), extend);
+	const Vector3 closest = GetClosestPoint(center, box);
+	float time = 0.0f;
+	int axis = -1;
+	if (MagnitudeSqr(center - closest) > radius * radius)
+	{
+		float tExit = 1.0f;
+		for (int i = 0; i < 3; ++i)
+		{
+			const float grown = extend.v[i] + radius;
+			if (direction.v[i] == 0.0f)
+			{
+				if (Abs(center.v[i]) > grown)
+					return false;
+				continue;
+			}
+
+			float t0 = (-grown - center.v[i]) / direction.v[i];
+			float t1 = (grown - center.v[i]) / direction.v[i];
+			if (t0 > t1)
+				std::swap(t0, t1);
+			if (t0 > time)
+			{
+				time = t0;
+				axis = i;
+			}
+			tExit = Min(tExit, t1);
+			if (time > tExit)
+				return false;
+		}
+
+		const Vector3 entry = center + direction * time;
+		Vector3 corner;
+		int outside = 0;
+		int freeAxis = 0;
+		for (int i = 0; i < 3; ++i)
+		{
+			if (Abs(entry.v[i]) > extend.v[i])
+			{
+				corner.v[i] = entry.v[i] > 0.0f ? extend.v[i] : -extend.v[i];
+				++outside;
+			}
+			else
+			{
+				corner.v[i] = -extend.v[i];
+				freeAxis = i;
+			}
+		}
+
+		if (outside >= 2)
+		{
+			bool edgeHit = false;
+			float maxTime = 1.0f;
+			float t;
+			for (int i = 0; i < 3; ++i)
+			{
+				// In an edge region only the edge along the free axis, in a vertex region all three
+				if (outside == 2 && i != freeAxis)
+					continue;
+				Vector3 end = corner;
+				end.v[i] = -corner.v[i];
+				if (RayCapsule(center, direction, corner, end, radius, maxTime, t))
+				{
+					maxTime = t;
+					edgeHit = true;
+				}
+			}
+			if (!edgeHit)
+				return false;
+			time = maxTime;
+		}
+	}
+
+	const Vector3 centerAtTime = center + direction * time;
+	const Vector3 point = GetClosestPoint(centerAtTime, box);
+	Vector3 faceNormal = Vector3::Zero();
+	if (axis >= 0)
+		faceNormal.v[axis] = direction.v[axis] > 0.0f ? -1.0f : 1.0f;
+
+	hit.point = obb.ToWorld(point);
+	hit.normal = obb.ToWorldDirection(ContactNormal(centerAtTime - point, radius, faceNormal, direction));
+	hit.time = time;
+	return true;
+}
+
+bool NFGE::Math::Sweep(const Sphere& sphere, const Vector3& displacement, const Vector3* vertices, size_t triangleCount, SweepHit& hit, uint32_t* triangle)
+{
+	ASSERT(vertices || triangleCount == 0, "[Sweep] Vertex buffer is null.");
+	const auto getTriangle = [vertices](size_t i, Vector3& a, Vector3& b, Vector3& c)
+	{
+		a = vertices[i * 3];
+		b = vertices[i * 3 + 1];
+		c = vertices[i * 3 + 2];
+	};
+	return SweepSphereTriangles(sphere, displacement, triangleCount, getTriangle, hit, triangle);
+}
+
+bool NFGE::Math::Sweep(const Sphere& sphere, const Vector3& displacement, const Vector3* vertices, const uint32_t* indices, size_t triangleCount, SweepHit& hit, uint32_t* triangle)
+{
+	ASSERT((vertices && indices) || triangleCount == 0, "[Sweep] Vertex or index buffer is null.");
+	const auto getTriangle = [vertices, indices](size_t i, Vector3& a, Vector3& b, Vector3& c)
+	{
+		a = vertices[indices[i * 3]];
+		b = vertices[indices[i * 3 + 1]];
+		c = vertices[indices[i * 3 + 2]];
+	};
+	return SweepSphereTriangles(sphere, displacement, triangleCount, getTriangle, hit, triangle);
+}
+
+bool NFGE::Math::Sweep(const Capsule& capsule, const Vector3& displacement, const Vector3* vertices, size_t triangleCount, SweepHit& hit, uint32_t* triangle)
+{
+	ASSERT(vertices || triangleCount == 0, "[Sweep] Vertex buffer is null.");
+	const auto getTriangle = [vertices](size_t i, Vector3& a, Vector3& b, Vector3& c)
+	{
+		a = vertices[i * 3];
+		b = vertices[i * 3 + 1];
+		c = vertices[i * 3 + 2];
+	};
+	return SweepCapsuleTriangles(capsule, displacement, triangleCount, getTriangle, hit, triangle);
+}
+
+bool NFGE::Math::Sweep(const Capsule& capsule, const Vector3& displacement, const Vector3* vertices, const uint32_t* indices, size_t triangleCount, SweepHit& hit, uint32_t* triangle)
+{
+	ASSERT((vertices && indices) || triangleCount == 0, "[Sweep] Vertex or index buffer is null.");
+	const auto getTriangle = [vertices, indices](size_t i, Vector3& a, Vector3& b, Vector3& c)
+	{
+		a = vertices[indices[i * 3]];
+		b = vertices[indices[i * 3 + 1]];
+		c = vertices[indices[i * 3 + 2]];
+	};
+	return SweepCapsuleTriangles(capsule, displacement, triangleCount, getTriangle, hit, triangle);
+}
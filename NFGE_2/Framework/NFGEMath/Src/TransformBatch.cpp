@@ -0,0 +1,227 @@
+//====================================================================================================
+// Filename:	TransformBatch.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	enum class TransformMode
+	{
+		Coord,
+		Normal,
+		Affine
+	};
+
+	inline const float* PointAt(const void* base, size_t stride, size_t i)
+	{
+		return reinterpret_cast<const float*>(static_cast<const uint8_t*>(base) + i * stride);
+	}
+
+	inline float* PointAt(void* base, size_t stride, size_t i)
+	{
+		return reinterpret_cast<float*>(static_cast<uint8_t*>(base) + i * stride);
+	}
+
+	template <TransformMode mode>
+	void TransformScalar(const void* in, size_t inStride, void* out, size_t outStride, size_t begin, size_t end, const Matrix4& m)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			const float* src = PointAt(in, inStride, i);
+			const float x = src[0], y = src[1], z = src[2];
+			float ox, oy, oz;
+			if constexpr (mode == TransformMode::Normal)
+			{
+				ox = x * m._11 + y * m._21 + z * m._31;
+				oy = x * m._12 + y * m._22 + z * m._32;
+				oz = x * m._13 + y * m._23 + z * m._33;
+			}
+			else
+			{
+				ox = x * m._11 + y * m._21 + z * m._31 + m._41;
+				oy = x * m._12 + y * m._22 + z * m._32 + m._42;
+				oz = x * m._13 + y * m._23 + z * m._33 + m._43;
+				if constexpr (mode == TransformMode::Coord)
+				{
+					const float w = x * m._14 + y * m._24 + z * m._34 + m._44;
+					ox /= w; oy /= w; oz /= w;
+				}
+			}
+			float* dst = PointAt(out, outStride, i);
+			dst[0] = ox; dst[1] = oy; dst[2] = oz;
+		}
+	}
+
+#if NFGE_SIMD_X86
+	template <TransformMode mode>
+	NFGE_TARGET_SSE41 size_t TransformSSE41(const void* in, size_t inStride, void* out, size_t outStride, size_t count, const Matrix4& m)
+	{
+		const __m128 m11 = _mm_set1_ps(m._11), m12 = _mm_set1_ps(m._12), m13 = _mm_set1_ps(m._13), m14 = _mm_set1_ps(m._14);
+		const __m128 m21 = _mm_set1_ps(m._21), m22 = _mm_set1_ps(m._22), m23 = _mm_set1_ps(m._23), m24 = _mm_set1_ps(m._24);
+		const __m128 m31 = _mm_set1_ps(m._31), m32 = _mm_set1_ps(m._32), m33 = _mm_set1_ps(m._33), m34 = _mm_set1_ps(m._34);
+		const __m128 m41 = _mm_set1_ps(m._41), m42 = _mm_set1_ps(m._42), m43 = _mm_set1_ps(m._43), m44 = _mm_set1_ps(m._44);
+
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			const float* p0 = PointAt(in, inStride, i + 0);
+			const float* p1 = PointAt(in, inStride, i + 1);
+			const float* p2 = PointAt(in, inStride, i + 2);
+			const float* p3 = PointAt(in, inStride, i + 3);
+			const __m128 x = _mm_setr_ps(p0[0], p1[0], p2[0], p3[0]);
+			const __m128 y = _mm_setr_ps(p0[1], p1[1], p2[1], p3[1]);
+			const __m128 z = _mm_setr_ps(p0[2], p1[2], p2[2], p3[2]);
+
+			__m128 ox = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m11), _mm_mul_ps(y, m21)), _mm_mul_ps(z, m31));
+			__m128 oy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m12), _mm_mul_ps(y, m22)), _mm_mul_ps(z, m32));
+			__m128 oz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m13), _mm_mul_ps(y, m23)), _mm_mul_ps(z, m33));
+			if constexpr (mode != TransformMode::Normal)
+			{
+				ox = _mm_add_ps(ox, m41);
+				oy = _mm_add_ps(oy, m42);
+				oz = _mm_add_ps(oz, m43);
+			}
+			if constexpr (mode == TransformMode::Coord)
+			{
+				const __m128 w = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m14), _mm_mul_ps(y, m24)), _mm_mul_ps(z, m34)), m44);
+				ox = _mm_div_ps(ox, w);
+				oy = _mm_div_ps(oy, w);
+				oz = _mm_div_ps(oz, w);
+			}
+
+			alignas(16) float rx[4], ry[4], rz[4];
+			_mm_store_ps(rx, ox);
+			_mm_store_ps(ry, oy);
+			_mm_store_ps(rz, oz);
+			for (size_t j = 0; j < 4; ++j)
+			{
+				float* dst = PointAt(out, outStride, i + j);
+				dst[0] = rx[j]; dst[1] = ry[j]; dst[2] = rz[j];
+			}
+		}
+		return i;
+	}
+
+	template <TransformMode mode>
+	NFGE_TARGET_AVX2 size_t TransformAVX2(const void* in, size_t inStride, void* out, size_t outStride, size_t count, const Matrix4& m)
+	{
+		const __m256 m11 = _mm256_set1_ps(m._11), m12 = _mm256_set1_ps(m._12), m13 = _mm256_set1_ps(m._13), m14 = _mm256_set1_ps(m._14);
+		const __m256 m21 = _mm256_set1_ps(m._21), m22 = _mm256_set1_ps(m._22), m23 = _mm256_set1_ps(m._23), m24 = _mm256_set1_ps(m._24);
+		const __m256 m31 = _mm256_set1_ps(m._31), m32 = _mm256_set1_ps(m._32), m33 = _mm256_set1_ps(m._33), m34 = _mm256_set1_ps(m._34);
+		const __m256 m41 = _mm256_set1_ps(m._41), m42 = _mm256_set1_ps(m._42), m43 = _mm256_set1_ps(m._43), m44 = _mm256_set1_ps(m._44);
+
+		// Gather offsets in floats for 8 consecutive points
+		const int step = static_cast<int>(inStride / sizeof(float));
+		const __m256i offsetX = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(step));
+		const __m256i offsetY = _mm256_add_epi32(offsetX, _mm256_set1_epi32(1));
+		const __m256i offsetZ = _mm256_add_epi32(offsetX, _mm256_set1_epi32(2));
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const float* base = PointAt(in, inStride, i);
+			const __m256 x = _mm256_i32gather_ps(base, offsetX, 4);
+			const __m256 y = _mm256_i32gather_ps(base, offsetY, 4);
+			const __m256 z = _mm256_i32gather_ps(base, offsetZ, 4);
+
+			__m256 ox, oy, oz;
+			if constexpr (mode == TransformMode::Normal)
+			{
+				ox = _mm256_mul_ps(x, m11);
+				oy = _mm256_mul_ps(x, m12);
+				oz = _mm256_mul_ps(x, m13);
+			}
+			else
+			{
+				ox = _mm256_fmadd_ps(x, m11, m41);
+				oy = _mm256_fmadd_ps(x, m12, m42);
+				oz = _mm256_fmadd_ps(x, m13, m43);
+			}
+			ox = _mm256_fmadd_ps(z, m31, _mm256_fmadd_ps(y, m21, ox));
+			oy = _mm256_fmadd_ps(z, m32, _mm256_fmadd_ps(y, m22, oy));
+			oz = _mm256_fmadd_ps(z, m33, _mm256_fmadd_ps(y, m23, oz));
+			if constexpr (mode == TransformMode::Coord)
+			{
+				const __m256 w = _mm256_fmadd_ps(z, m34, _mm256_fmadd_ps(y, m24, _mm256_fmadd_ps(x, m14, m44)));
+				ox = _mm256_div_ps(ox, w);
+				oy = _mm256_div_ps(oy, w);
+				oz = _mm256_div_ps(oz, w);
+			}
+
+			alignas(32) float rx[8], ry[8], rz[8];
+			_mm256_store_ps(rx, ox);
+			_mm256_store_ps(ry, oy);
+			_mm256_store_ps(rz, oz);
+			for (size_t j = 0; j < 8; ++j)
+			{
+				float* dst = PointAt(out, outStride, i + j);
+				dst[0] = rx[j]; dst[1] = ry[j]; dst[2] = rz[j];
+			}
+		}
+		return i;
+	}
+#endif
+
+	template <TransformMode mode>
+	void TransformBatch(const void* in, size_t inStride, void* out, size_t outStride, size_t count, const Matrix4& m)
+	{
+		ASSERT(inStride % sizeof(float) == 0 && outStride % sizeof(float) == 0, "[TransformBatch] Stride must be a multiple of 4 bytes.");
+		ASSERT(inStride / sizeof(float) < 0x7fffffff / 8, "[TransformBatch] Stride is too large.");
+
+		size_t done = 0;
+		switch (GetInstructionSet())
+		{
+#if NFGE_SIMD_X86
+		case InstructionSet::AVX2: done = TransformAVX2<mode>(in, inStride, out, outStride, count, m); break;
+		case InstructionSet::SSE41: done = TransformSSE41<mode>(in, inStride, out, outStride, count, m); break;
+#endif
+		default: break;
+		}
+		TransformScalar<mode>(in, inStride, out, outStride, done, count, m);
+	}
+}
+
+void NFGE::Math::TransformCoordBatch(const Vector3* in, Vector3* out, size_t count, const Matrix4& m)
+{
+	TransformBatch<TransformMode::Coord>(in, sizeof(Vector3), out, sizeof(Vector3), count, m);
+}
+
+void NFGE::Math::TransformCoordBatch(const void* in, size_t inStride, void* out, size_t outStride, size_t count, const Matrix4& m)
+{
+	TransformBatch<TransformMode::Coord>(in, inStride, out, outStride, count, m);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::TransformNormalBatch(const Vector3* in, Vector3* out, size_t count, const Matrix4& m)
+{
+	TransformBatch<TransformMode::Normal>(in, sizeof(Vector3), out, sizeof(Vector3), count, m);
+}
+
+void NFGE::Math::TransformNormalBatch(const void* in, size_t inStride, void* out, size_t outStride, size_t count, const Matrix4& m)
+{
+	TransformBatch<TransformMode::Normal>(in, inStride, out, outStride, count, m);
+}
+
+//----------------------------------------------------------------------------------------------------
+
+void NFGE::Math::TransformAffineBatch(const Vector3* in, Vector3* out, size_t count, const Matrix4& m)
+{
+	TransformBatch<TransformMode::Affine>(in, sizeof(Vector3), out, sizeof(Vector3), count, m);
+}
+
+void NFGE::Math::TransformAffineBatch(const void* in, size_t inStride, void* out, size_t outStride, size_t count, const Matrix4& m)
+{
+	TransformBatch<TransformMode::Affine>(in, inStride, out, outStride, count, m);
+}
@@ -0,0 +1,161 @@
+//====================================================================================================
+// Filename:	TransformTRS.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+using namespace NFGE::Math;
+
+namespace
+{
+	// Rows of MatrixRotationQuaternion(q) scaled by s, i.e. the 3x3 part of Scaling * Rotation
+	void ScaledRotationRows(const Quaternion& q, const Vector3& s, float rows[3][3])
+	{
+		const float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+		const float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+		const float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+		const float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+		rows[0][0] = (1.0f - yy - zz) * s.x;	rows[0][1] = (xy + wz) * s.x;			rows[0][2] = (xz - wy) * s.x;
+		rows[1][0] = (xy - wz) * s.y;			rows[1][1] = (1.0f - xx - zz) * s.y;	rows[1][2] = (yz + wx) * s.y;
+		rows[2][0] = (xz + wy) * s.z;			rows[2][1] = (yz - wx) * s.z;			rows[2][2] = (1.0f - xx - yy) * s.z;
+	}
+
+	void WriteMatrix(const TransformTRS& transform, Matrix4& out)
+	{
+		float r[3][3];
+		ScaledRotationRows(transform.rotation, transform.scale, r);
+		const Vector3& t = transform.translation;
+		out = Matrix4
+		(
+			r[0][0], r[0][1], r[0][2], 0.0f,
+			r[1][0], r[1][1], r[1][2], 0.0f,
+			r[2][0], r[2][1], r[2][2], 0.0f,
+			t.x, t.y, t.z, 1.0f
+		);
+	}
+
+	void WriteMatrix3x4(const TransformTRS& transform, float* out)
+	{
+		float r[3][3];
+		ScaledRotationRows(transform.rotation, transform.scale, r);
+		const Vector3& t = transform.translation;
+		out[0] = r[0][0]; out[1] = r[1][0]; out[2] = r[2][0]; out[3] = t.x;
+		out[4] = r[0][1]; out[5] = r[1][1]; out[6] = r[2][1]; out[7] = t.y;
+		out[8] = r[0][2]; out[9] = r[1][2]; out[10] = r[2][2]; out[11] = t.z;
+	}
+}
+
+TransformTRS NFGE::Math::operator*(const TransformTRS& local, const TransformTRS& parent)
+{
+	return TransformTRS
+	(
+		TransformPoint(parent, local.translation),
+		parent.rotation * local.rotation,
+		Vector3(local.scale.x * parent.scale.x, local.scale.y * parent.scale.y, local.scale.z * parent.scale.z)
+	);
+}
+
+TransformTRS NFGE::Math::Inverse(const TransformTRS& transform)
+{
+	const Quaternion& q = transform.rotation;
+	const Quaternion inverseRotation(-q.x, -q.y, -q.z, q.w);
+	const Vector3 inverseScale(1.0f / transform.scale.x, 1.0f / transform.scale.y, 1.0f / transform.scale.z);
+	const Vector3 t = Rotate(-transform.translation, inverseRotation);
+	return TransformTRS(Vector3(t.x * inverseScale.x, t.y * inverseScale.y, t.z * inverseScale.z), inverseRotation, inverseScale);
+}
+
+Matrix4 NFGE::Math::ToMatrix(const TransformTRS& transform)
+{
+	Matrix4 m;
+	WriteMatrix(transform, m);
+	return m;
+}
+
+void NFGE::Math::ToMatrix3x4(const TransformTRS& transform, float* out)
+{
+	WriteMatrix3x4(transform, out);
+}
+
+Matrix3x4 NFGE::Math::ToMatrix3x4(const TransformTRS& transform)
+{
+	Matrix3x4 m;
+	WriteMatrix3x4(transform, &m._11);
+	return m;
+}
+
+void NFGE::Math::TransformTRSToMatrixBatch(const TransformTRS* transforms, Matrix4* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		WriteMatrix(transforms[i], out[i]);
+}
+
+void NFGE::Math::TransformTRSToMatrix3x4Batch(const TransformTRS* transforms, float* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		WriteMatrix3x4(transforms[i], out + i * 12);
+}
+
+void NFGE::Math::TransformTRSToMatrix3x4Batch(const TransformTRS* transforms, Matrix3x4* out, size_t count)
+{
+	TransformTRSToMatrix3x4Batch(transforms, &out->_11, count);
+}
+
+void NFGE::Math::UpdateHierarchy(const TransformTRS* local, const uint32_t* parents, TransformTRS* world, size_t count)
+{
+	ASSERT(local != world, "[TransformTRS] world may not alias local.");
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint32_t parent = parents[i];
+		if (parent == kNoParent)
+		{
+			world[i] = local[i];
+		}
+		else
+		{
+			ASSERT(parent < i, "[TransformTRS] Parent %u of node %zu must come before it.", parent, i);
+			world[i] = local[i] * world[parent];
+		}
+	}
+}
+
+void NFGE::Math::UpdateHierarchy(const TransformTRS* local, const uint32_t* parents, TransformTRS* world, Matrix4* worldMatrices, size_t count)
+{
+	ASSERT(local != world, "[TransformTRS] world may not alias local.");
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint32_t parent = parents[i];
+		if (parent == kNoParent)
+		{
+			world[i] = local[i];
+		}
+		else
+		{
+			ASSERT(parent < i, "[TransformTRS] Parent %u of node %zu must come before it.", parent, i);
+			world[i] = local[i] * world[parent];
+		}
+		WriteMatrix(world[i], worldMatrices[i]);
+	}
+}
+
+void NFGE::Math::UpdateHierarchy(const TransformTRS* local, const uint32_t* parents, TransformTRS* world, Matrix3x4* worldMatrices, size_t count)
+{
+	ASSERT(local != world, "[TransformTRS] world may not alias local.");
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint32_t parent = parents[i];
+		if (parent == kNoParent)
+		{
+			world[i] = local[i];
+		}
+		else
+		{
+			ASSERT(parent < i, "[TransformTRS] Parent %u of node %zu must come before it.", parent, i);
+			world[i] = local[i] * world[parent];
+		}
+		WriteMatrix3x4(world[i], &worldMatrices[i]._11);
+	}
+}
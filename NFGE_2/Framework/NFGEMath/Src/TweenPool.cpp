@@ -0,0 +1,314 @@
+//====================================================================================================
+// Filename:	TweenPool.cpp
+// Created by:	Mingzhuo Zhang
+// Date:		2022/7
+//====================================================================================================
+
+#include "Precompiled.h"
+#include "NFGEMath.h"
+
+#if NFGE_SIMD_X86
+#include <immintrin.h>
+#endif
+
+using namespace NFGE::Math;
+using namespace NFGE::Math::SIMD;
+
+namespace
+{
+	using EaseFunction = float(*)(float);
+	using EaseArrayFunction = void(*)(const float*, float*, size_t);
+
+	// In EaseType order
+	constexpr EaseFunction kEaseFunctions[] =
+	{
+		Ease::EaseNone,
+		Ease::EaseInSine, Ease::EaseOutSine, Ease::EaseInOutSine,
+		Ease::EaseInQuad, Ease::EaseOutQuad, Ease::EaseInOutQuad,
+		Ease::EaseInCubic, Ease::EaseOutCubic, Ease::EaseInOutCubic,
+		Ease::EaseInQuart, Ease::EaseOutQuart, Ease::EaseInOutQuart,
+		Ease::EaseInQuint, Ease::EaseOutQuint, Ease::EaseInOutQuint,
+		Ease::EaseInExpo, Ease::EaseOutExpo, Ease::EaseInOutExpo,
+		Ease::EaseInCirc, Ease::EaseOutCirc, Ease::EaseInOutCirc,
+		Ease::EaseInBack, Ease::EaseOutBack, Ease::EaseInOutBack,
+		Ease::EaseInElastic, Ease::EaseOutElastic, Ease::EaseInOutElastic,
+		Ease::EaseInBounce, Ease::EaseOutBounce, Ease::EaseInOutBounce,
+		Ease::EaseOutMushroom
+	};
+	static_assert(std::size(kEaseFunctions) == static_cast<size_t>(EaseType::Count), "kEaseFunctions must list every EaseType");
+
+	// The curve is a template argument, so it is a direct call the compiler inlines into the loop
+	template <EaseFunction Function>
+	void EaseArray(const float* t, float* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			out[i] = Function(t[i]);
+		}
+	}
+
+	template <size_t... Types>
+	constexpr std::array<EaseArrayFunction, sizeof...(Types)> MakeEaseArrays(std::index_sequence<Types...>)
+	{
+		return { EaseArray<kEaseFunctions[Types]>... };
+	}
+
+	// Picked once per group
+	constexpr auto kEaseArrays = MakeEaseArrays(std::make_index_sequence<static_cast<size_t>(EaseType::Count)>());
+
+	template <typename T>
+	void LerpTargets(const T* from, const T* to, T* const* targets, const float* t, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			*targets[i] = Lerp(from[i], to[i], t[i]);
+		}
+	}
+
+	template <typename T>
+	void SwapRemove(std::vector<T>& values, uint32_t index)
+	{
+		values[index] = values.back();
+		values.pop_back();
+	}
+
+#if NFGE_SIMD_X86
+	NFGE_TARGET_AVX2 size_t AdvanceTimeAVX2(float* elapsed, const float* invDuration, float deltaTime, float* times, size_t count)
+	{
+		const __m256 dt = _mm256_set1_ps(deltaTime);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const __m256 e = _mm256_add_ps(_mm256_loadu_ps(elapsed + i), dt);
+			_mm256_storeu_ps(elapsed + i, e);
+			const __m256 t = _mm256_mul_ps(e, _mm256_loadu_ps(invDuration + i));
+			_mm256_storeu_ps(times + i, _mm256_min_ps(_mm256_max_ps(t, zero), one));
+		}
+		return i;
+	}
+#endif
+
+	// times is clamped to [0, 1], 0 while the delay runs
+	void AdvanceTime(float* elapsed, const float* invDuration, float deltaTime, float* times, size_t count)
+	{
+		size_t i = 0;
+#if NFGE_SIMD_X86
+		if (GetInstructionSet() == InstructionSet::AVX2)
+			i = AdvanceTimeAVX2(elapsed, invDuration, deltaTime, times, count);
+#endif
+		for (; i < count; ++i)
+		{
+			elapsed[i] += deltaTime;
+			times[i] = Min(Max(elapsed[i] * invDuration[i], 0.0f), 1.0f);
+		}
+	}
+}
+
+float(*NFGE::Math::GetEaseFunction(EaseType type))(float)
+{
+	ASSERT(type < EaseType::Count, "[TweenPool] Invalid ease type %d.", static_cast<int>(type));
+	return kEaseFunctions[static_cast<size_t>(type)];
+}
+
+TweenHandle NFGE::Math::TweenPool::Add(float& target, float from, float to, float duration, EaseType ease, float delay)
+{
+	return AddTween(mFloats, FloatValue, target, from, to, duration, ease, delay);
+}
+
+TweenHandle NFGE::Math::TweenPool::Add(Vector2& target, const Vector2& from, const Vector2& to, float duration, EaseType ease, float delay)
+{
+	return AddTween(mVector2s, Vector2Value, target, from, to, duration, ease, delay);
+}
+
+TweenHandle NFGE::Math::TweenPool::Add(Vector3& target, const Vector3& from, const Vector3& to, float duration, EaseType ease, float delay)
+{
+	return AddTween(mVector3s, Vector3Value, target, from, to, duration, ease, delay);
+}
+
+TweenHandle NFGE::Math::TweenPool::Add(Vector4& target, const Vector4& from, const Vector4& to, float duration, EaseType ease, float delay)
+{
+	return AddTween(mVector4s, Vector4Value, target, from, to, duration, ease, delay);
+}
+
+TweenHandle NFGE::Math::TweenPool::Add(Quaternion& target, const Quaternion& from, const Quaternion& to, float duration, EaseType ease, float delay)
+{
+	return AddTween(mQuaternions, QuaternionValue, target, from, to, duration, ease, delay);
+}
+
+bool NFGE::Math::TweenPool::Stop(TweenHandle handle)
+{
+	if (!IsActive(handle))
+		return false;
+
+	const Slot& slot = mSlots[handle.index];
+	const size_t ease = static_cast<size_t>(slot.ease);
+	switch (slot.valueType)
+	{
+	case FloatValue: RemoveTween(mFloats[ease], slot.index); break;
+	case Vector2Value: RemoveTween(mVector2s[ease], slot.index); break;
+	case Vector3Value: RemoveTween(mVector3s[ease], slot.index); break;
+	case Vector4Value: RemoveTween(mVector4s[ease], slot.index); break;
+	case QuaternionValue: RemoveTween(mQuaternions[ease], slot.index); break;
+	}
+	FreeSlot(handle.index);
+	return true;
+}
+
+bool NFGE::Math::TweenPool::IsActive(TweenHandle handle) const
+{
+	return handle.index < mSlots.size() && mSlots[handle.index].valueType != kFreeSlot && mSlots[handle.index].generation == handle.generation;
+}
+
+void NFGE::Math::TweenPool::Clear()
+{
+	auto clearGroups = [](auto& groups)
+	{
+		for (auto& group : groups)
+		{
+			group.elapsed.clear();
+			group.invDuration.clear();
+			group.from.clear();
+			group.to.clear();
+			group.targets.clear();
+			group.slots.clear();
+		}
+	};
+	clearGroups(mFloats);
+	clearGroups(mVector2s);
+	clearGroups(mVector3s);
+	clearGroups(mVector4s);
+	clearGroups(mQuaternions);
+
+	// Keep the generations so handles from before the Clear stay stale
+	for (uint32_t i = 0; i < mSlots.size(); ++i)
+	{
+		if (mSlots[i].valueType != kFreeSlot)
+			FreeSlot(i);
+	}
+	mCompleted.clear();
+}
+
+const std::vector<TweenHandle>& NFGE::Math::TweenPool::Update(float deltaTime)
+{
+	mCompleted.clear();
+	UpdateGroups(mFloats, deltaTime);
+	UpdateGroups(mVector2s, deltaTime);
+	UpdateGroups(mVector3s, deltaTime);
+	UpdateGroups(mVector4s, deltaTime);
+	UpdateGroups(mQuaternions, deltaTime);
+	return mCompleted;
+}
+
+template <typename T>
+TweenHandle NFGE::Math::TweenPool::AddTween(std::array<Group<T>, kEaseCount>& groups, ValueType valueType, T& target, const T& from, const T& to, float duration, EaseType ease, float delay)
+{
+	ASSERT(ease < EaseType::Count, "[TweenPool] Invalid ease type %d.", static_cast<int>(ease));
+	ASSERT(duration >= 0.0f && delay >= 0.0f, "[TweenPool] Duration and delay must not be negative.");
+
+	Group<T>& group = groups[static_cast<size_t>(ease)];
+	const uint32_t slot = AllocateSlot();
+	mSlots[slot].index = static_cast<uint32_t>(group.slots.size());
+	mSlots[slot].valueType = valueType;
+	mSlots[slot].ease = ease;
+
+	// A zero duration tween ends on the first Update that takes it past its delay
+	group.elapsed.push_back(-delay);
+	group.invDuration.push_back(duration > 0.0f ? 1.0f / duration : FLT_MAX);
+	group.from.push_back(from);
+	group.to.push_back(to);
+	group.targets.push_back(&target);
+	group.slots.push_back(slot);
+	return { slot, mSlots[slot].generation };
+}
+
+template <typename T>
+void NFGE::Math::TweenPool::RemoveTween(Group<T>& group, uint32_t index)
+{
+	mSlots[group.slots.back()].index = index;
+	SwapRemove(group.elapsed, index);
+	SwapRemove(group.invDuration, index);
+	SwapRemove(group.from, index);
+	SwapRemove(group.to, index);
+	SwapRemove(group.targets, index);
+	SwapRemove(group.slots, index);
+}
+
+template <typename T>
+void NFGE::Math::TweenPool::UpdateGroups(std::array<Group<T>, kEaseCount>& groups, float deltaTime)
+{
+	for (size_t ease = 0; ease < kEaseCount; ++ease)
+	{
+		Group<T>& group = groups[ease];
+		const size_t count = group.slots.size();
+		if (count == 0)
+			continue;
+
+		// In chunks so the times stay in L1 between the passes
+		for (size_t first = 0; first < count; first += kChunkSize)
+		{
+			const size_t chunk = Min(count - first, kChunkSize);
+			float times[kChunkSize];
+			float eased[kChunkSize];
+			AdvanceTime(group.elapsed.data() + first, group.invDuration.data() + first, deltaTime, times, chunk);
+			kEaseArrays[ease](times, eased, chunk);
+
+			if constexpr (std::is_same_v<T, Quaternion>)
+			{
+				Quaternion rotations[kChunkSize];
+				SlerpBatch(group.from.data() + first, group.to.data() + first, eased, rotations, chunk);
+				for (size_t i = 0; i < chunk; ++i)
+				{
+					*group.targets[first + i] = rotations[i];
+				}
+			}
+			else
+			{
+				LerpTargets(group.from.data() + first, group.to.data() + first, group.targets.data() + first, eased, chunk);
+			}
+
+			for (size_t i = 0; i < chunk; ++i)
+			{
+				if (times[i] >= 1.0f)
+					mFinished.push_back(static_cast<uint32_t>(first + i));
+			}
+		}
+
+		// From the back, so the tween swapped into a removed spot has already been checked. Finished
+		// tweens get their end value exactly, Lerp and the curves can be an ulp off at t = 1.
+		for (auto it = mFinished.rbegin(); it != mFinished.rend(); ++it)
+		{
+			const uint32_t index = *it;
+			const uint32_t slot = group.slots[index];
+			*group.targets[index] = group.to[index];
+			mCompleted.push_back({ slot, mSlots[slot].generation });
+			RemoveTween(group, index);
+			FreeSlot(slot);
+		}
+		mFinished.clear();
+	}
+}
+
+uint32_t NFGE::Math::TweenPool::AllocateSlot()
+{
+	if (mFreeSlot == UINT32_MAX)
+	{
+		mSlots.emplace_back();
+		++mActiveCount;
+		return static_cast<uint32_t>(mSlots.size() - 1);
+	}
+	const uint32_t slot = mFreeSlot;
+	mFreeSlot = mSlots[slot].index;
+	++mActiveCount;
+	return slot;
+}
+
+void NFGE::Math::TweenPool::FreeSlot(uint32_t slot)
+{
+	mSlots[slot].valueType = kFreeSlot;
+	mSlots[slot].index = mFreeSlot;
+	++mSlots[slot].generation;
+	mFreeSlot = slot;
+	--mActiveCount;
+}